@@ -1,5 +1,6 @@
 const path = require('path');
 const fs = require('fs');
+const EventEmitter = require('events');
 
 // Find the compiled addon
 const addonPath = path.join(__dirname, 'build', 'node-addon', 'obs_screen_capture.node');
@@ -18,4 +19,119 @@ if (process.platform === 'darwin') {
     process.env.PATH = libPath + ';' + (process.env.PATH || '');
 }
 
-module.exports = require(addonPath);
\ No newline at end of file
+const native = require(addonPath);
+
+// Views over the packed enumeration results (see PackColumns in
+// obs_screen_capture.cpp): numbers are read from typed arrays and strings
+// decoded only when an entry's property is accessed.
+class PackedList {
+    constructor(packed, stringFields) {
+        this.length = packed.count;
+        this._ids = packed.ids;
+        this._geometry = packed.geometry;
+        this._offsets = packed.offsets;
+        this._text = Buffer.from(packed.text.buffer, packed.text.byteOffset, packed.text.byteLength);
+        this._stringFields = stringFields;
+    }
+
+    _string(index, field) {
+        const slot = index * this._stringFields + field;
+        return this._text.toString('utf8', this._offsets[slot], this._offsets[slot + 1]);
+    }
+
+    at(index) {
+        if (index < 0) {
+            index += this.length;
+        }
+        return index >= 0 && index < this.length ? new this.constructor.Entry(this, index) : undefined;
+    }
+
+    *[Symbol.iterator]() {
+        for (let i = 0; i < this.length; i++) {
+            yield new this.constructor.Entry(this, i);
+        }
+    }
+
+    // Plain objects, as listWindows()/listDisplays() return
+    toArray() {
+        return Array.from(this, entry => entry.toJSON());
+    }
+}
+
+class PackedEntry {
+    constructor(list, index) {
+        this._list = list;
+        this._index = index;
+    }
+
+    get x() { return this._list._geometry[this._index * 4]; }
+    get y() { return this._list._geometry[this._index * 4 + 1]; }
+    get width() { return this._list._geometry[this._index * 4 + 2]; }
+    get height() { return this._list._geometry[this._index * 4 + 3]; }
+}
+
+class WindowEntry extends PackedEntry {
+    get id() { return this._list._ids[this._index]; }
+    get name() { return this._list._string(this._index, 0); }
+    get owner() { return this._list._string(this._index, 1); }
+
+    toJSON() {
+        const { id, name, owner, width, height, x, y } = this;
+        return { id, name, owner, width, height, x, y };
+    }
+}
+
+class DisplayEntry extends PackedEntry {
+    get id() { return this._list._string(this._index, 0); }
+    get name() { return this._list._string(this._index, 1); }
+
+    toJSON() {
+        const { id, name, width, height, x, y } = this;
+        return { id, name, width, height, x, y };
+    }
+}
+
+class WindowList extends PackedList {
+    constructor(packed) {
+        super(packed, 2);
+    }
+
+    // Index of the window with this id, or -1; reads no strings
+    indexOfId(id) {
+        return this._ids.indexOf(id);
+    }
+}
+WindowList.Entry = WindowEntry;
+
+class DisplayList extends PackedList {
+    constructor(packed) {
+        super(packed, 2);
+    }
+}
+DisplayList.Entry = DisplayEntry;
+
+// Output lifecycle events, emitted by type: 'start', 'stop', 'stopping',
+// 'activate', 'deactivate', 'reconnect', 'reconnect_success'. Each carries
+// { type, output, code, reason, error } (the last three on 'stop' only).
+// The native listener is installed with the first listener and does not
+// keep the process alive.
+class OutputEvents extends EventEmitter {
+    constructor() {
+        super();
+        this.once('newListener', () => native.onOutputEvent(event => this.emit(event.type, event)));
+    }
+}
+
+const outputEvents = new OutputEvents();
+
+module.exports = {
+    ...native,
+    listWindowsPacked: () => new WindowList(native.listWindowsPacked()),
+    listDisplaysPacked: () => new DisplayList(native.listDisplaysPacked()),
+    listWindowsPackedAsync: () => native.listWindowsPackedAsync().then(packed => new WindowList(packed)),
+    listDisplaysPackedAsync: () => native.listDisplaysPackedAsync().then(packed => new DisplayList(packed)),
+    outputEvents,
+    // Wrap packed objects, e.g. from a benchmark build's marshalTestWindows
+    WindowList,
+    DisplayList
+};
\ No newline at end of file
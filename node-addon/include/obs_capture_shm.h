@@ -0,0 +1,225 @@
+/*
+ * obs_capture_shm.h - shared-memory frame ring exported by obs-screen-capture
+ *
+ * The addon publishes captured frames into a POSIX shared-memory object
+ * (see startFrameExport in the JS API). Out-of-process consumers attach by
+ * name with this header only; no library is required.
+ *
+ * Layout: one obs_shm_ring_header followed by slot_count slots, each made of
+ * an obs_shm_slot_header and slot_size bytes of tightly packed pixel data.
+ * Every slot is protected by a sequence counter (seqlock): the writer makes
+ * it odd while a slot is being filled and even once it is complete. Readers
+ * never take locks and make no syscalls after attaching.
+ *
+ * Reading pattern:
+ *
+ *     obs_shm_reader reader;
+ *     if (obs_shm_reader_open(&reader, "/my-frames") != 0) ...;
+ *     for (;;) {
+ *         obs_shm_frame frame;
+ *         int rc = obs_shm_reader_next(&reader, &frame);
+ *         if (rc == OBS_SHM_NONE) { wait a little; continue; }
+ *         process(frame.data, &frame.info);      // zero-copy view
+ *         if (!obs_shm_reader_validate(&reader, &frame))
+ *             discard results, the writer lapped us;
+ *     }
+ *     obs_shm_reader_close(&reader);
+ *
+ * POSIX only (Linux, macOS). Link with -lrt on older glibc.
+ */
+#ifndef OBS_CAPTURE_SHM_H
+#define OBS_CAPTURE_SHM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OBS_SHM_MAGIC 0x4f425346u /* "OBSF" */
+#define OBS_SHM_VERSION 1u
+
+/* Pixel formats, matching the addon's frame formats */
+#define OBS_SHM_FORMAT_BGRA 0u
+#define OBS_SHM_FORMAT_RGBA 1u
+#define OBS_SHM_FORMAT_NV12 2u
+#define OBS_SHM_FORMAT_I420 3u
+
+/* obs_shm_reader_next() results */
+#define OBS_SHM_FRAME 1
+#define OBS_SHM_NONE 0
+#define OBS_SHM_LAPPED -1
+
+typedef struct obs_shm_ring_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;     /* pixel bytes per slot */
+    uint64_t slot_stride;   /* bytes between slot headers */
+    uint64_t data_offset;   /* offset of slot 0 from the mapping start */
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+    uint32_t reserved;
+    uint64_t write_index;   /* frames published so far (atomic) */
+    uint64_t writer_alive;  /* 1 while the writer owns the ring (atomic) */
+} obs_shm_ring_header;
+
+typedef struct obs_shm_slot_header {
+    uint64_t seq;           /* seqlock counter, odd while writing (atomic) */
+    uint64_t frame_index;   /* value of write_index when published */
+    uint64_t timestamp_ns;  /* OBS video clock */
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t plane_count;
+    uint32_t stride[4];
+    uint32_t offset[4];
+    uint32_t data_size;
+    uint32_t reserved;
+} obs_shm_slot_header;
+
+typedef struct obs_shm_frame_info {
+    uint64_t frame_index;
+    uint64_t timestamp_ns;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t plane_count;
+    uint32_t stride[4];
+    uint32_t offset[4];
+    uint32_t data_size;
+} obs_shm_frame_info;
+
+typedef struct obs_shm_frame {
+    obs_shm_frame_info info;
+    const uint8_t* data;    /* points into shared memory */
+    uint64_t seq;           /* token for obs_shm_reader_validate */
+    uint32_t slot;
+} obs_shm_frame;
+
+typedef struct obs_shm_reader {
+    int fd;
+    void* base;
+    size_t size;
+    const obs_shm_ring_header* header;
+    uint64_t next_index;    /* next frame this reader expects */
+    uint64_t lapped;        /* frames skipped because the writer overtook us */
+} obs_shm_reader;
+
+#define OBS_SHM_LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define OBS_SHM_LOAD_RELAXED(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+
+static inline const obs_shm_slot_header* obs_shm_slot(const obs_shm_reader* r, uint32_t slot) {
+    return (const obs_shm_slot_header*)((const uint8_t*)r->base + r->header->data_offset +
+                                        (uint64_t)slot * r->header->slot_stride);
+}
+
+/* Attach to a ring by shm name (e.g. "/obs-frames"). Returns 0 on success. */
+static inline int obs_shm_reader_open(obs_shm_reader* r, const char* name) {
+    struct stat st;
+    memset(r, 0, sizeof(*r));
+    r->fd = shm_open(name, O_RDONLY, 0);
+    if (r->fd < 0)
+        return -1;
+    if (fstat(r->fd, &st) != 0 || (size_t)st.st_size < sizeof(obs_shm_ring_header)) {
+        close(r->fd);
+        return -1;
+    }
+    r->size = (size_t)st.st_size;
+    r->base = mmap(NULL, r->size, PROT_READ, MAP_SHARED, r->fd, 0);
+    if (r->base == MAP_FAILED) {
+        close(r->fd);
+        r->base = NULL;
+        return -1;
+    }
+    r->header = (const obs_shm_ring_header*)r->base;
+    if (r->header->magic != OBS_SHM_MAGIC || r->header->version != OBS_SHM_VERSION) {
+        munmap(r->base, r->size);
+        close(r->fd);
+        r->base = NULL;
+        return -1;
+    }
+    /* Start from the newest frame rather than replaying the ring */
+    r->next_index = OBS_SHM_LOAD_ACQUIRE(&r->header->write_index);
+    return 0;
+}
+
+static inline void obs_shm_reader_close(obs_shm_reader* r) {
+    if (r->base)
+        munmap(r->base, r->size);
+    if (r->fd >= 0)
+        close(r->fd);
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+}
+
+static inline int obs_shm_writer_alive(const obs_shm_reader* r) {
+    return OBS_SHM_LOAD_ACQUIRE(&r->header->writer_alive) != 0;
+}
+
+/* Fetch the next unread frame as a zero-copy view. Returns OBS_SHM_FRAME,
+ * OBS_SHM_NONE when nothing new was published, or OBS_SHM_LAPPED when frames
+ * were overwritten before we got to them (the reader then resyncs to the
+ * oldest frame still in the ring and the caller should simply call again). */
+static inline int obs_shm_reader_next(obs_shm_reader* r, obs_shm_frame* frame) {
+    const obs_shm_ring_header* h = r->header;
+    uint64_t written = OBS_SHM_LOAD_ACQUIRE(&h->write_index);
+    const obs_shm_slot_header* slot;
+    uint64_t seq;
+
+    if (r->next_index >= written)
+        return OBS_SHM_NONE;
+
+    /* The newest slot may still be partially written, so keep one slot of margin */
+    if (written - r->next_index >= h->slot_count) {
+        uint64_t oldest = written - (h->slot_count - 1);
+        r->lapped += oldest - r->next_index;
+        r->next_index = oldest;
+        return OBS_SHM_LAPPED;
+    }
+
+    frame->slot = (uint32_t)(r->next_index % h->slot_count);
+    slot = obs_shm_slot(r, frame->slot);
+    seq = OBS_SHM_LOAD_ACQUIRE(&slot->seq);
+    if ((seq & 1u) || OBS_SHM_LOAD_RELAXED(&slot->frame_index) != r->next_index) {
+        r->lapped++;
+        r->next_index++;
+        return OBS_SHM_LAPPED;
+    }
+
+    frame->seq = seq;
+    frame->info.frame_index = slot->frame_index;
+    frame->info.timestamp_ns = slot->timestamp_ns;
+    frame->info.format = slot->format;
+    frame->info.width = slot->width;
+    frame->info.height = slot->height;
+    frame->info.plane_count = slot->plane_count;
+    memcpy(frame->info.stride, slot->stride, sizeof(frame->info.stride));
+    memcpy(frame->info.offset, slot->offset, sizeof(frame->info.offset));
+    frame->info.data_size = slot->data_size;
+    frame->data = (const uint8_t*)slot + sizeof(obs_shm_slot_header);
+
+    r->next_index++;
+    return OBS_SHM_FRAME;
+}
+
+/* Returns non-zero if the frame returned by obs_shm_reader_next was not
+ * overwritten while it was being read. Call after consuming frame->data. */
+static inline int obs_shm_reader_validate(const obs_shm_reader* r, const obs_shm_frame* frame) {
+    const obs_shm_slot_header* slot = obs_shm_slot(r, frame->slot);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return OBS_SHM_LOAD_RELAXED(&slot->seq) == frame->seq;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OBS_CAPTURE_SHM_H */
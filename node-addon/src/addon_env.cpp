@@ -0,0 +1,64 @@
+#include "addon_env.h"
+#include <mutex>
+#include <set>
+
+namespace {
+
+struct CoreUsers {
+    std::mutex mutex;
+    std::set<napi_env> live;    // environments that have not exited
+    std::set<napi_env> holders; // environments that initialized the core
+};
+
+// Leaked: environments may still exit while statics are destroyed
+CoreUsers& GetCoreUsers() {
+    static CoreUsers* users = new CoreUsers();
+    return *users;
+}
+
+// Runs before the environment's instance data is freed. Exiting drops the
+// environment's hold but leaves the core running for the others (and, as
+// before, for the process if nobody called shutdown).
+void OnEnvExit(AddonEnv* addon) {
+    CoreUsers& users = GetCoreUsers();
+    std::lock_guard<std::mutex> lock(users.mutex);
+    users.live.erase(addon->env);
+    users.holders.erase(addon->env);
+}
+
+} // namespace
+
+void SetupAddonEnv(Napi::Env env) {
+    auto* addon = new AddonEnv();
+    addon->env = env;
+    env.SetInstanceData(addon);
+    env.AddCleanupHook(OnEnvExit, addon);
+
+    CoreUsers& users = GetCoreUsers();
+    std::lock_guard<std::mutex> lock(users.mutex);
+    users.live.insert(env);
+}
+
+AddonEnv& GetAddonEnv(Napi::Env env) {
+    return *env.GetInstanceData<AddonEnv>();
+}
+
+bool InitCore(napi_env env, const InitOptions& options) {
+    CoreUsers& users = GetCoreUsers();
+    std::lock_guard<std::mutex> lock(users.mutex);
+    bool success = OBSManager::getInstance().initialize(options);
+    // An async init can finish after its environment has exited
+    if (success && users.live.count(env)) {
+        users.holders.insert(env);
+    }
+    return success;
+}
+
+void ShutdownCore(napi_env env) {
+    CoreUsers& users = GetCoreUsers();
+    std::lock_guard<std::mutex> lock(users.mutex);
+    users.holders.erase(env);
+    if (users.holders.empty()) {
+        OBSManager::getInstance().shutdown();
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <napi.h>
+#include <map>
+#include "obs_wrapper.h"
+
+class JsFrameTap;
+class JsAudioTap;
+
+// State owned by one environment that loaded the addon: the main thread or
+// a worker_thread. Bindings keep per-caller state here rather than in
+// globals, so workers cannot see or release each other's taps, and it is
+// torn down with the environment.
+struct AddonEnv {
+    napi_env env = nullptr;
+    std::map<int, JsFrameTap*> frame_taps;
+    std::map<int, JsAudioTap*> audio_taps;
+};
+
+// Called from the module's Init, once per environment
+void SetupAddonEnv(Napi::Env env);
+AddonEnv& GetAddonEnv(Napi::Env env);
+
+// The OBS core is shared by every environment. Each environment that
+// initialized it holds it until it calls shutdown or exits, and the core is
+// only shut down by the last holder's shutdown. Both run on any thread and
+// serialize against each other.
+bool InitCore(napi_env env, const InitOptions& options);
+void ShutdownCore(napi_env env);
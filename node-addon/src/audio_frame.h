@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+
+// Most channels OBS mixes (7.1)
+constexpr int kMaxAudioChannels = 8;
+
+// A borrowed view of one block of the audio mix: planar 32-bit float, one
+// plane per channel. Plane pointers are only valid for the duration of the
+// callback that receives it.
+struct AudioFrame {
+    const float* data[kMaxAudioChannels] = {};
+    uint32_t frames = 0;
+    uint32_t channels = 0;
+    uint32_t sample_rate = 0;
+    uint64_t timestamp = 0; // ns, OBS audio clock
+};
@@ -0,0 +1,340 @@
+#include "audio_meter.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define AUDIO_METER_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#define AUDIO_METER_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+float ScalarPeak(const float* samples, size_t count) {
+    float peak = 0;
+    for (size_t i = 0; i < count; ++i) {
+        peak = std::max(peak, std::fabs(samples[i]));
+    }
+    return peak;
+}
+
+double ScalarSumSquares(const float* samples, size_t count) {
+    double sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += static_cast<double>(samples[i]) * samples[i];
+    }
+    return sum;
+}
+
+const MeterKernels kScalarMeterKernels = {"scalar", ScalarPeak, ScalarSumSquares};
+
+#ifdef AUDIO_METER_SSE2
+float Sse2Peak(const float* samples, size_t count) {
+    // Clearing the sign bit is |x|
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 peak0 = _mm_setzero_ps();
+    __m128 peak1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        peak0 = _mm_max_ps(peak0, _mm_and_ps(_mm_loadu_ps(samples + i), abs_mask));
+        peak1 = _mm_max_ps(peak1, _mm_and_ps(_mm_loadu_ps(samples + i + 4), abs_mask));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_max_ps(peak0, peak1));
+    float peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    return std::max(peak, ScalarPeak(samples + i, count - i));
+}
+
+double Sse2SumSquares(const float* samples, size_t count) {
+    // Float lanes over one block (4800 frames at most) lose well under
+    // 0.001 dB; each chunk is widened to double before it is added up
+    double sum = 0;
+    size_t i = 0;
+    while (count - i >= 8) {
+        size_t end = i + std::min<size_t>((count - i) & ~size_t(7), 4096);
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        for (; i < end; i += 8) {
+            __m128 a = _mm_loadu_ps(samples + i);
+            __m128 b = _mm_loadu_ps(samples + i + 4);
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(a, a));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(b, b));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+        sum += static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    }
+    return sum + ScalarSumSquares(samples + i, count - i);
+}
+
+const MeterKernels kSse2MeterKernels = {"sse2", Sse2Peak, Sse2SumSquares};
+#endif // AUDIO_METER_SSE2
+
+#ifdef AUDIO_METER_NEON
+float NeonPeak(const float* samples, size_t count) {
+    float32x4_t peak0 = vdupq_n_f32(0);
+    float32x4_t peak1 = vdupq_n_f32(0);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        peak0 = vmaxq_f32(peak0, vabsq_f32(vld1q_f32(samples + i)));
+        peak1 = vmaxq_f32(peak1, vabsq_f32(vld1q_f32(samples + i + 4)));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, vmaxq_f32(peak0, peak1));
+    float peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    return std::max(peak, ScalarPeak(samples + i, count - i));
+}
+
+double NeonSumSquares(const float* samples, size_t count) {
+    double sum = 0;
+    size_t i = 0;
+    while (count - i >= 8) {
+        size_t end = i + std::min<size_t>((count - i) & ~size_t(7), 4096);
+        float32x4_t acc0 = vdupq_n_f32(0);
+        float32x4_t acc1 = vdupq_n_f32(0);
+        for (; i < end; i += 8) {
+            float32x4_t a = vld1q_f32(samples + i);
+            float32x4_t b = vld1q_f32(samples + i + 4);
+            acc0 = vmlaq_f32(acc0, a, a);
+            acc1 = vmlaq_f32(acc1, b, b);
+        }
+        float lanes[4];
+        vst1q_f32(lanes, vaddq_f32(acc0, acc1));
+        sum += static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    }
+    return sum + ScalarSumSquares(samples + i, count - i);
+}
+
+const MeterKernels kNeonMeterKernels = {"neon", NeonPeak, NeonSumSquares};
+#endif // AUDIO_METER_NEON
+
+// BS.1770 channel weights for the OBS speaker layouts: LFE is left out and
+// surround channels count 1.41 (+1.5 dB)
+double ChannelWeight(uint32_t channel, uint32_t channels) {
+    if (channels == 3) {
+        return channel == 2 ? 0.0 : 1.0; // 2.1
+    }
+    if (channels == 4) {
+        return channel == 3 ? 1.41 : 1.0; // 4.0: FL FR FC RC
+    }
+    if (channels >= 5) {
+        if (channel == 3) {
+            return 0.0; // 4.1, 5.1, 7.1: LFE
+        }
+        return channel >= 4 ? 1.41 : 1.0;
+    }
+    return 1.0;
+}
+
+double Loudness(double weighted_mean_square) {
+    if (weighted_mean_square <= 0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    return -0.691 + 10.0 * std::log10(weighted_mean_square);
+}
+
+} // namespace
+
+std::vector<const MeterKernels*> AvailableMeterKernels() {
+    std::vector<const MeterKernels*> kernels = {&kScalarMeterKernels};
+#ifdef AUDIO_METER_SSE2
+    kernels.push_back(&kSse2MeterKernels);
+#endif
+#ifdef AUDIO_METER_NEON
+    kernels.push_back(&kNeonMeterKernels);
+#endif
+    return kernels;
+}
+
+const MeterKernels& BestMeterKernels() {
+    static const MeterKernels* best = AvailableMeterKernels().back();
+    return *best;
+}
+
+void AudioMeter::configure(uint32_t channels, uint32_t sample_rate) {
+    kernels_ = &BestMeterKernels();
+    channels_ = channels;
+    sample_rate_ = sample_rate;
+    block_frames_ = std::max<uint32_t>(1, sample_rate / 10);
+    block_filled_ = 0;
+    blocks_ = 0;
+    std::fill(std::begin(history_), std::end(history_), 0.0);
+
+    // K-weighting for any sample rate: the BS.1770 high shelf and high pass,
+    // bilinear-transformed from their analog prototypes (as in libebur128)
+    double f0 = 1681.974450955533;
+    double gain_db = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = std::tan(kPi * f0 / sample_rate);
+    double vh = std::pow(10.0, gain_db / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    shelf_.b0 = (vh + vb * k / q + k * k) / a0;
+    shelf_.b1 = 2.0 * (k * k - vh) / a0;
+    shelf_.b2 = (vh - vb * k / q + k * k) / a0;
+    shelf_.a1 = 2.0 * (k * k - 1.0) / a0;
+    shelf_.a2 = (1.0 - k / q + k * k) / a0;
+
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = std::tan(kPi * f0 / sample_rate);
+    a0 = 1.0 + k / q + k * k;
+    highpass_.b0 = 1.0;
+    highpass_.b1 = -2.0;
+    highpass_.b2 = 1.0;
+    highpass_.a1 = 2.0 * (k * k - 1.0) / a0;
+    highpass_.a2 = (1.0 - k / q + k * k) / a0;
+
+    for (uint32_t ch = 0; ch < kMaxAudioChannels; ++ch) {
+        shelf_state_[ch] = FilterState();
+        highpass_state_[ch] = FilterState();
+        weight_[ch] = ChannelWeight(ch, channels);
+        block_peak_[ch] = 0;
+        block_squares_[ch] = 0;
+        block_weighted_[ch] = 0;
+    }
+    filtered_.assign(block_frames_, 0.0f);
+}
+
+void AudioMeter::process(const AudioFrame& frame) {
+    uint32_t channels = std::min<uint32_t>(frame.channels, kMaxAudioChannels);
+    if (channels == 0 || frame.sample_rate == 0) {
+        return;
+    }
+    if (channels != channels_ || frame.sample_rate != sample_rate_) {
+        configure(channels, frame.sample_rate);
+    }
+
+    // Split at block boundaries so every block covers exactly 100 ms
+    uint32_t offset = 0;
+    while (offset < frame.frames) {
+        uint32_t count = std::min(frame.frames - offset, block_frames_ - block_filled_);
+        processSpan(frame, offset, count);
+        offset += count;
+        block_filled_ += count;
+        if (block_filled_ == block_frames_) {
+            finishBlock();
+        }
+    }
+}
+
+void AudioMeter::processSpan(const AudioFrame& frame, uint32_t offset, uint32_t count) {
+    float* filtered = filtered_.data();
+    for (uint32_t ch = 0; ch < channels_; ++ch) {
+        const float* samples = frame.data[ch];
+        if (!samples) {
+            continue;
+        }
+        samples += offset;
+        block_peak_[ch] = std::max(block_peak_[ch], kernels_->peak(samples, count));
+        block_squares_[ch] += kernels_->sum_squares(samples, count);
+        if (weight_[ch] == 0) {
+            continue;
+        }
+
+        // Both biquads in direct form I, state kept across blocks
+        const Biquad s = shelf_;
+        const Biquad h = highpass_;
+        FilterState fs = shelf_state_[ch];
+        FilterState hs = highpass_state_[ch];
+        for (uint32_t i = 0; i < count; ++i) {
+            double x = samples[i];
+            double y = s.b0 * x + s.b1 * fs.x1 + s.b2 * fs.x2 - s.a1 * fs.y1 - s.a2 * fs.y2;
+            fs.x2 = fs.x1;
+            fs.x1 = x;
+            fs.y2 = fs.y1;
+            fs.y1 = y;
+            double z = h.b0 * y + h.b1 * hs.x1 + h.b2 * hs.x2 - h.a1 * hs.y1 - h.a2 * hs.y2;
+            hs.x2 = hs.x1;
+            hs.x1 = y;
+            hs.y2 = hs.y1;
+            hs.y1 = z;
+            filtered[i] = static_cast<float>(z);
+        }
+        shelf_state_[ch] = fs;
+        highpass_state_[ch] = hs;
+        block_weighted_[ch] += kernels_->sum_squares(filtered, count);
+    }
+}
+
+void AudioMeter::finishBlock() {
+    AudioLevels levels;
+    levels.channels = channels_;
+    levels.sample_rate = sample_rate_;
+
+    double weighted = 0;
+    for (uint32_t ch = 0; ch < channels_; ++ch) {
+        levels.peak[ch] = block_peak_[ch];
+        levels.rms[ch] = static_cast<float>(std::sqrt(block_squares_[ch] / block_frames_));
+        weighted += weight_[ch] * block_weighted_[ch] / block_frames_;
+        block_peak_[ch] = 0;
+        block_squares_[ch] = 0;
+        block_weighted_[ch] = 0;
+    }
+    history_[blocks_ % kHistory] = weighted;
+    blocks_++;
+    block_filled_ = 0;
+
+    auto window = [this](uint64_t blocks) {
+        if (blocks_ < blocks) {
+            return -std::numeric_limits<double>::infinity();
+        }
+        double sum = 0;
+        for (uint64_t i = 0; i < blocks; ++i) {
+            sum += history_[(blocks_ - 1 - i) % kHistory];
+        }
+        return Loudness(sum / blocks);
+    };
+    levels.momentary_lufs = window(4);
+    levels.short_term_lufs = window(kHistory);
+    levels.blocks = blocks_;
+    publish(levels);
+}
+
+void AudioMeter::publish(const AudioLevels& levels) {
+    uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    published_channels_.store(levels.channels, std::memory_order_relaxed);
+    published_rate_.store(levels.sample_rate, std::memory_order_relaxed);
+    for (int ch = 0; ch < kMaxAudioChannels; ++ch) {
+        published_peak_[ch].store(levels.peak[ch], std::memory_order_relaxed);
+        published_rms_[ch].store(levels.rms[ch], std::memory_order_relaxed);
+    }
+    published_momentary_.store(levels.momentary_lufs, std::memory_order_relaxed);
+    published_short_term_.store(levels.short_term_lufs, std::memory_order_relaxed);
+    published_blocks_.store(levels.blocks, std::memory_order_relaxed);
+
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+AudioLevels AudioMeter::levels() const {
+    AudioLevels levels;
+    for (;;) {
+        uint32_t before = sequence_.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        levels.channels = published_channels_.load(std::memory_order_relaxed);
+        levels.sample_rate = published_rate_.load(std::memory_order_relaxed);
+        for (int ch = 0; ch < kMaxAudioChannels; ++ch) {
+            levels.peak[ch] = published_peak_[ch].load(std::memory_order_relaxed);
+            levels.rms[ch] = published_rms_[ch].load(std::memory_order_relaxed);
+        }
+        levels.momentary_lufs = published_momentary_.load(std::memory_order_relaxed);
+        levels.short_term_lufs = published_short_term_.load(std::memory_order_relaxed);
+        levels.blocks = published_blocks_.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) == before) {
+            return levels;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "audio_frame.h"
+
+// Level meter for the audio mix, run on the OBS audio thread so PCM never
+// has to leave it. Every 100 ms it publishes per-channel peak and RMS plus
+// ITU-R BS.1770 loudness (K-weighted, channel-weighted mean square) over the
+// last 400 ms (momentary) and 3 s (short-term). No gating is applied, so
+// these match the EBU R128 momentary/short-term meters, not integrated
+// loudness.
+//
+// Peak and sum-of-squares have scalar, SSE2 and NEON kernels; the K-weighting
+// biquads are recursive and stay scalar. At 48 kHz stereo the meter costs
+// well under 1% of one core (see test/native/audio_meter_test.cpp).
+
+// One implementation of the block kernels. Exposed for tests; the meter uses
+// BestMeterKernels().
+struct MeterKernels {
+    const char* name; // "scalar", "sse2" or "neon"
+    float (*peak)(const float* samples, size_t count);         // max |x|
+    double (*sum_squares)(const float* samples, size_t count); // sum of x^2
+};
+
+const MeterKernels& BestMeterKernels();
+std::vector<const MeterKernels*> AvailableMeterKernels();
+
+struct AudioLevels {
+    uint32_t channels = 0;
+    uint32_t sample_rate = 0;
+    float peak[kMaxAudioChannels] = {}; // linear, last 100 ms
+    float rms[kMaxAudioChannels] = {};  // linear, last 100 ms
+    // -inf until the window has filled, and for digital silence
+    double momentary_lufs = -std::numeric_limits<double>::infinity();
+    double short_term_lufs = -std::numeric_limits<double>::infinity();
+    uint64_t blocks = 0;                // 100 ms blocks measured so far
+};
+
+class AudioMeter {
+public:
+    AudioMeter() = default;
+
+    AudioMeter(const AudioMeter&) = delete;
+    AudioMeter& operator=(const AudioMeter&) = delete;
+
+    // Audio thread. Starts over when the rate or channel count changes.
+    void process(const AudioFrame& frame);
+
+    // Any thread; a consistent snapshot of the last published block
+    AudioLevels levels() const;
+
+private:
+    struct Biquad {
+        double b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+    };
+    struct FilterState {
+        double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+    };
+
+    void configure(uint32_t channels, uint32_t sample_rate);
+    void processSpan(const AudioFrame& frame, uint32_t offset, uint32_t count);
+    void finishBlock();
+    void publish(const AudioLevels& levels);
+
+    const MeterKernels* kernels_ = nullptr;
+    uint32_t channels_ = 0;
+    uint32_t sample_rate_ = 0;
+    uint32_t block_frames_ = 0;   // frames per 100 ms block
+    uint32_t block_filled_ = 0;
+    Biquad shelf_;
+    Biquad highpass_;
+    FilterState shelf_state_[kMaxAudioChannels];
+    FilterState highpass_state_[kMaxAudioChannels];
+    double weight_[kMaxAudioChannels] = {};
+    float block_peak_[kMaxAudioChannels] = {};
+    double block_squares_[kMaxAudioChannels] = {};
+    double block_weighted_[kMaxAudioChannels] = {};
+    std::vector<float> filtered_;
+
+    // Weighted mean square of the last 30 blocks, for the 400 ms and 3 s windows
+    static constexpr int kHistory = 30;
+    double history_[kHistory] = {};
+    uint64_t blocks_ = 0;
+
+    // Seqlock: odd while the audio thread is writing
+    std::atomic<uint32_t> sequence_{0};
+    std::atomic<uint32_t> published_channels_{0};
+    std::atomic<uint32_t> published_rate_{0};
+    std::atomic<float> published_peak_[kMaxAudioChannels] = {};
+    std::atomic<float> published_rms_[kMaxAudioChannels] = {};
+    std::atomic<double> published_momentary_{-std::numeric_limits<double>::infinity()};
+    std::atomic<double> published_short_term_{-std::numeric_limits<double>::infinity()};
+    std::atomic<uint64_t> published_blocks_{0};
+};
@@ -0,0 +1,279 @@
+#include "audio_tap.h"
+#include "addon_env.h"
+#include "frame_tap.h"
+#include "memory_stats.h"
+#include "spsc_ring.h"
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace {
+
+// One queued block, planar: channel c starts at samples[c * frames]
+struct PendingBlock {
+    std::vector<float> samples;
+    uint32_t frames = 0;
+    uint32_t channels = 0;
+    uint32_t sample_rate = 0;
+    uint64_t timestamp = 0;
+};
+
+// OBS mixes in blocks of 1024 frames (AUDIO_OUTPUT_FRAMES)
+constexpr size_t kBlockFrames = 1024;
+
+} // namespace
+
+static void DeliverAudio(Napi::Env env, Napi::Function callback, JsAudioTap* tap, JsAudioTap*);
+static void CloseAudioTap(JsAudioTap* tap);
+using AudioTsfn = Napi::TypedThreadSafeFunction<JsAudioTap, JsAudioTap, DeliverAudio>;
+
+// Bridges the OBS audio mix to a JS callback. The audio thread copies each
+// block into a preallocated slot of a lock-free SPSC ring and never waits;
+// when JS falls behind and the ring is full, new blocks are dropped.
+class JsAudioTap {
+public:
+    explicit JsAudioTap(size_t queue_size) : ring_(queue_size) {
+        // Stereo slots up front; a wider mix grows them once, on first use
+        for (size_t i = 0; i < ring_.capacity(); ++i) {
+            ring_.writeSlot()->samples.resize(2 * kBlockFrames);
+            ring_.publish();
+        }
+        while (ring_.readSlot()) {
+            ring_.release();
+        }
+        charge_.set(ring_.capacity() * 2 * kBlockFrames * sizeof(float));
+    }
+
+    // Audio thread
+    void push(const AudioFrame& frame) {
+        PendingBlock* block = ring_.writeSlot();
+        if (!block) {
+            return;
+        }
+
+        size_t needed = static_cast<size_t>(frame.channels) * frame.frames;
+        if (block->samples.size() < needed) {
+            charge_.set(charge_.bytes() + (needed - block->samples.size()) * sizeof(float));
+            block->samples.resize(needed);
+        }
+        for (uint32_t ch = 0; ch < frame.channels; ++ch) {
+            std::memcpy(block->samples.data() + static_cast<size_t>(ch) * frame.frames, frame.data[ch],
+                        frame.frames * sizeof(float));
+        }
+        block->frames = frame.frames;
+        block->channels = frame.channels;
+        block->sample_rate = frame.sample_rate;
+        block->timestamp = frame.timestamp;
+        ring_.publish();
+
+        // At most one delivery is queued on the TSFN at a time
+        if (!delivery_scheduled_.exchange(true)) {
+            if (tsfn.NonBlockingCall(this) != napi_ok) {
+                delivery_scheduled_ = false;
+            }
+        }
+    }
+
+    // JS thread
+    void deliver(Napi::Env env, Napi::Function callback) {
+        delivery_scheduled_ = false;
+
+        while (PendingBlock* block = ring_.readSlot()) {
+            if (env == nullptr || callback.IsEmpty()) {
+                ring_.release();
+                continue;
+            }
+
+            // One buffer per block with a Float32Array view per channel
+            size_t count = static_cast<size_t>(block->channels) * block->frames;
+            Napi::ArrayBuffer data = Napi::ArrayBuffer::New(env, count * sizeof(float));
+            std::memcpy(data.Data(), block->samples.data(), count * sizeof(float));
+
+            Napi::Array channels = Napi::Array::New(env, block->channels);
+            for (uint32_t ch = 0; ch < block->channels; ++ch) {
+                channels.Set(ch, Napi::Float32Array::New(env, block->frames, data,
+                                                         static_cast<size_t>(ch) * block->frames * sizeof(float)));
+            }
+
+            Napi::Object obj = Napi::Object::New(env);
+            obj.Set("channels", channels);
+            obj.Set("frames", block->frames);
+            obj.Set("sampleRate", block->sample_rate);
+            obj.Set("timestamp", Napi::Number::New(env, static_cast<double>(block->timestamp)));
+            obj.Set("dropped", Napi::Number::New(env, static_cast<double>(dropped())));
+            ring_.release();
+
+            delivered_.fetch_add(1, std::memory_order_relaxed);
+            callback.Call({obj});
+        }
+    }
+
+    uint64_t delivered() const { return delivered_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return ring_.dropped(); }
+
+    AudioTsfn tsfn;
+    int obs_tap_id = -1;
+    AddonEnv* owner = nullptr;
+    // Closes the tap if its environment exits first
+    Napi::Env::CleanupHook<void (*)(JsAudioTap*), JsAudioTap> cleanup;
+
+private:
+    SpscRing<PendingBlock> ring_;
+    MemoryCharge charge_{MemoryStage::AudioTaps}; // audio thread after construction
+    std::atomic<bool> delivery_scheduled_{false};
+    std::atomic<uint64_t> delivered_{0};
+};
+
+static void DeliverAudio(Napi::Env env, Napi::Function callback, JsAudioTap* tap, JsAudioTap*) {
+    tap->deliver(env, callback);
+}
+
+// Stops the audio thread first; the TSFN finalizer then frees the tap after
+// any delivery already queued has run
+static void CloseAudioTap(JsAudioTap* tap) {
+    OBSManager::getInstance().removeAudioTap(tap->obs_tap_id);
+    tap->owner->audio_taps.erase(tap->obs_tap_id);
+    tap->tsfn.Release();
+}
+
+namespace {
+
+double Decibels(float level) {
+    return 20.0 * std::log10(static_cast<double>(level));
+}
+
+} // namespace
+
+Napi::Value OnAudio(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsFunction()) {
+        Napi::TypeError::New(env, "Audio callback required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    int queue_size = 16;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        queue_size = GetIntOption(info[1].As<Napi::Object>(), "queueSize", queue_size);
+    }
+    if (queue_size < 1 || queue_size > 1024) {
+        Napi::RangeError::New(env, "queueSize must be between 1 and 1024").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    auto* tap = new JsAudioTap(queue_size);
+    tap->tsfn = AudioTsfn::New(env, info[0].As<Napi::Function>(), "obs_audio_tap", 0, 1, tap,
+        [](Napi::Env, JsAudioTap* tap) { delete tap; });
+    // A listener should not keep the process alive on its own
+    tap->tsfn.Unref(env);
+
+    tap->obs_tap_id = OBSManager::getInstance().addAudioTap(
+        [tap](const AudioFrame& frame) { tap->push(frame); });
+
+    if (tap->obs_tap_id < 0) {
+        tap->tsfn.Release();
+        Napi::Error::New(env, "Audio taps require an initialized OBS core").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    // Registered after the TSFN, so it runs before the TSFN is torn down
+    tap->owner = &GetAddonEnv(env);
+    tap->owner->audio_taps[tap->obs_tap_id] = tap;
+    tap->cleanup = env.AddCleanupHook(CloseAudioTap, tap);
+    return Napi::Number::New(env, tap->obs_tap_id);
+}
+
+Napi::Value OffAudio(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Audio tap id required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    // Only this environment's taps
+    std::map<int, JsAudioTap*>& taps = GetAddonEnv(env).audio_taps;
+    auto it = taps.find(info[0].As<Napi::Number>().Int32Value());
+    if (it == taps.end()) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    JsAudioTap* tap = it->second;
+    tap->cleanup.Remove(env);
+    CloseAudioTap(tap);
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value GetAudioTapStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Audio tap id required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::map<int, JsAudioTap*>& taps = GetAddonEnv(env).audio_taps;
+    auto it = taps.find(info[0].As<Napi::Number>().Int32Value());
+    if (it == taps.end()) {
+        return env.Undefined();
+    }
+
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("delivered", Napi::Number::New(env, static_cast<double>(it->second->delivered())));
+    stats.Set("dropped", Napi::Number::New(env, static_cast<double>(it->second->dropped())));
+    return stats;
+}
+
+Napi::Value StartAudioMeter(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!OBSManager::getInstance().startAudioMeter()) {
+        Napi::Error::New(env, "The audio meter requires an initialized OBS core").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value StopAudioMeter(const Napi::CallbackInfo& info) {
+    OBSManager::getInstance().stopAudioMeter();
+    return info.Env().Undefined();
+}
+
+Napi::Value GetAudioLevels(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    AudioLevels levels;
+    if (!OBSManager::getInstance().getAudioLevels(levels)) {
+        return env.Null();
+    }
+
+    Napi::Array channels = Napi::Array::New(env, levels.channels);
+    for (uint32_t ch = 0; ch < levels.channels; ++ch) {
+        Napi::Object channel = Napi::Object::New(env);
+        channel.Set("peak", Napi::Number::New(env, levels.peak[ch]));
+        channel.Set("rms", Napi::Number::New(env, levels.rms[ch]));
+        channel.Set("peakDb", Napi::Number::New(env, Decibels(levels.peak[ch])));
+        channel.Set("rmsDb", Napi::Number::New(env, Decibels(levels.rms[ch])));
+        channels.Set(ch, channel);
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("sampleRate", levels.sample_rate);
+    result.Set("channels", channels);
+    result.Set("momentaryLufs", Napi::Number::New(env, levels.momentary_lufs));
+    result.Set("shortTermLufs", Napi::Number::New(env, levels.short_term_lufs));
+    result.Set("blocks", Napi::Number::New(env, static_cast<double>(levels.blocks)));
+    return result;
+}
+
+Napi::Value SetSystemAudioEnabled(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBoolean()) {
+        Napi::TypeError::New(env, "Boolean expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    bool enabled = info[0].As<Napi::Boolean>().Value();
+    return Napi::Boolean::New(env, OBSManager::getInstance().setSystemAudioEnabled(enabled));
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <napi.h>
+#include "obs_wrapper.h"
+
+// JS bindings for the audio mix:
+//   onAudio(callback, { queueSize }) -> id
+//   offAudio(id)
+//   getAudioTapStats(id) -> { delivered, dropped }
+//   startAudioMeter() / stopAudioMeter()
+//   getAudioLevels() -> { sampleRate, channels: [{ peak, rms, peakDb, rmsDb }],
+//                         momentaryLufs, shortTermLufs, blocks } | null
+//   setSystemAudioEnabled(enabled)
+Napi::Value OnAudio(const Napi::CallbackInfo& info);
+Napi::Value OffAudio(const Napi::CallbackInfo& info);
+Napi::Value GetAudioTapStats(const Napi::CallbackInfo& info);
+Napi::Value StartAudioMeter(const Napi::CallbackInfo& info);
+Napi::Value StopAudioMeter(const Napi::CallbackInfo& info);
+Napi::Value GetAudioLevels(const Napi::CallbackInfo& info);
+Napi::Value SetSystemAudioEnabled(const Napi::CallbackInfo& info);
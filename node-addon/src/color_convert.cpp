@@ -0,0 +1,460 @@
+#include "color_convert.h"
+#include "color_kernels.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define COLOR_CONVERT_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#define COLOR_CONVERT_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+inline uint8_t Luma(const uint8_t* p) {
+    return static_cast<uint8_t>((kYR * p[2] + kYG * p[1] + kYB * p[0] + kYBias) >> 8);
+}
+
+// p/q are the two rows of a 2x2 block, step the offset of its second column
+inline void Chroma(const uint8_t* p, const uint8_t* q, int step, uint8_t& u, uint8_t& v) {
+    int b = (p[0] + p[step] + q[0] + q[step] + 2) >> 2;
+    int g = (p[1] + p[step + 1] + q[1] + q[step + 1] + 2) >> 2;
+    int r = (p[2] + p[step + 2] + q[2] + q[step + 2] + 2) >> 2;
+    u = static_cast<uint8_t>((kUB * b - kUG * g - kUR * r + kUVBias) >> 8);
+    v = static_cast<uint8_t>((kVR * r - kVG * g - kVB * b + kUVBias) >> 8);
+}
+
+} // namespace
+
+void ScalarRowsToI420(const uint8_t* row0, const uint8_t* row1, int width,
+                      uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v) {
+    for (int x = 0; x < width; x += 2) {
+        const uint8_t* p = row0 + x * 4;
+        const uint8_t* q = row1 + x * 4;
+        // The last column of an odd width pairs with itself
+        int step = x + 1 < width ? 4 : 0;
+        y0[x] = Luma(p);
+        y1[x] = Luma(q);
+        if (step) {
+            y0[x + 1] = Luma(p + 4);
+            y1[x + 1] = Luma(q + 4);
+        }
+        Chroma(p, q, step, u[x / 2], v[x / 2]);
+    }
+}
+
+void ScalarRowsToNv12(const uint8_t* row0, const uint8_t* row1, int width,
+                      uint8_t* y0, uint8_t* y1, uint8_t* uv) {
+    for (int x = 0; x < width; x += 2) {
+        const uint8_t* p = row0 + x * 4;
+        const uint8_t* q = row1 + x * 4;
+        int step = x + 1 < width ? 4 : 0;
+        y0[x] = Luma(p);
+        y1[x] = Luma(q);
+        if (step) {
+            y0[x + 1] = Luma(p + 4);
+            y1[x + 1] = Luma(q + 4);
+        }
+        Chroma(p, q, step, uv[x], uv[x + 1]);
+    }
+}
+
+void ScalarBox2xRow(const uint8_t* row0, const uint8_t* row1, int dst_width, uint8_t* dst) {
+    for (int i = 0; i < dst_width * 4; ++i) {
+        // Same channel of the next pixel is 4 bytes on
+        int j = (i & ~3) * 2 + (i & 3);
+        dst[i] = static_cast<uint8_t>((row0[j] + row0[j + 4] + row1[j] + row1[j + 4] + 2) >> 2);
+    }
+}
+
+void ScalarLerpRow(const uint8_t* row0, const uint8_t* row1, int bytes, int weight, uint8_t* dst) {
+    for (int i = 0; i < bytes; ++i) {
+        dst[i] = static_cast<uint8_t>((row0[i] * (256 - weight) + row1[i] * weight + 128) >> 8);
+    }
+}
+
+namespace {
+
+const ColorKernels kScalarKernels = {
+    "scalar", ScalarRowsToI420, ScalarRowsToNv12, ScalarBox2xRow, ScalarLerpRow
+};
+
+#ifdef COLOR_CONVERT_SSE2
+// Splits 8 BGRA pixels into 16-bit B, G and R lanes
+inline void Sse2Channels(const uint8_t* p, __m128i& b, __m128i& g, __m128i& r) {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+    b = _mm_packs_epi32(_mm_and_si128(lo, mask), _mm_and_si128(hi, mask));
+    g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 8), mask), _mm_and_si128(_mm_srli_epi32(hi, 8), mask));
+    r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 16), mask), _mm_and_si128(_mm_srli_epi32(hi, 16), mask));
+}
+
+inline __m128i Sse2Luma(__m128i b, __m128i g, __m128i r) {
+    __m128i y = _mm_mullo_epi16(r, _mm_set1_epi16(kYR));
+    y = _mm_add_epi16(y, _mm_mullo_epi16(g, _mm_set1_epi16(kYG)));
+    y = _mm_add_epi16(y, _mm_mullo_epi16(b, _mm_set1_epi16(kYB)));
+    y = _mm_add_epi16(y, _mm_set1_epi16(kYBias));
+    return _mm_srli_epi16(y, 8);
+}
+
+// Mean of each horizontal pair of the row sums, as 4 values in 16-bit lanes
+inline __m128i Sse2PairMean(__m128i sum) {
+    __m128i pairs = _mm_madd_epi16(sum, _mm_set1_epi16(1));
+    pairs = _mm_srli_epi32(_mm_add_epi32(pairs, _mm_set1_epi32(2)), 2);
+    return _mm_packs_epi32(pairs, pairs);
+}
+
+// 8 pixels of two rows: stores 8+8 luma and returns 4 u and 4 v bytes
+inline void Sse2Block(const uint8_t* row0, const uint8_t* row1, uint8_t* y0, uint8_t* y1,
+                      __m128i& u, __m128i& v) {
+    __m128i b0, g0, r0, b1, g1, r1;
+    Sse2Channels(row0, b0, g0, r0);
+    Sse2Channels(row1, b1, g1, r1);
+    __m128i luma0 = Sse2Luma(b0, g0, r0);
+    __m128i luma1 = Sse2Luma(b1, g1, r1);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(y0), _mm_packus_epi16(luma0, luma0));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(y1), _mm_packus_epi16(luma1, luma1));
+
+    __m128i b = Sse2PairMean(_mm_add_epi16(b0, b1));
+    __m128i g = Sse2PairMean(_mm_add_epi16(g0, g1));
+    __m128i r = Sse2PairMean(_mm_add_epi16(r0, r1));
+    const __m128i bias = _mm_set1_epi16(static_cast<short>(kUVBias));
+    // Wraps in 16 bits on the way; the final value is always in range
+    u = _mm_mullo_epi16(b, _mm_set1_epi16(kUB));
+    u = _mm_sub_epi16(u, _mm_mullo_epi16(g, _mm_set1_epi16(kUG)));
+    u = _mm_sub_epi16(u, _mm_mullo_epi16(r, _mm_set1_epi16(kUR)));
+    u = _mm_srli_epi16(_mm_add_epi16(u, bias), 8);
+    v = _mm_mullo_epi16(r, _mm_set1_epi16(kVR));
+    v = _mm_sub_epi16(v, _mm_mullo_epi16(g, _mm_set1_epi16(kVG)));
+    v = _mm_sub_epi16(v, _mm_mullo_epi16(b, _mm_set1_epi16(kVB)));
+    v = _mm_srli_epi16(_mm_add_epi16(v, bias), 8);
+    u = _mm_packus_epi16(u, u);
+    v = _mm_packus_epi16(v, v);
+}
+
+void Sse2RowsToI420(const uint8_t* row0, const uint8_t* row1, int width,
+                    uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v) {
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i cu, cv;
+        Sse2Block(row0 + x * 4, row1 + x * 4, y0 + x, y1 + x, cu, cv);
+        int32_t packed = _mm_cvtsi128_si32(cu);
+        std::memcpy(u + x / 2, &packed, 4);
+        packed = _mm_cvtsi128_si32(cv);
+        std::memcpy(v + x / 2, &packed, 4);
+    }
+    ScalarRowsToI420(row0 + x * 4, row1 + x * 4, width - x, y0 + x, y1 + x, u + x / 2, v + x / 2);
+}
+
+void Sse2RowsToNv12(const uint8_t* row0, const uint8_t* row1, int width,
+                    uint8_t* y0, uint8_t* y1, uint8_t* uv) {
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i cu, cv;
+        Sse2Block(row0 + x * 4, row1 + x * 4, y0 + x, y1 + x, cu, cv);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(uv + x), _mm_unpacklo_epi8(cu, cv));
+    }
+    ScalarRowsToNv12(row0 + x * 4, row1 + x * 4, width - x, y0 + x, y1 + x, uv + x);
+}
+
+void Sse2Box2xRow(const uint8_t* row0, const uint8_t* row1, int dst_width, uint8_t* dst) {
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 2 <= dst_width; x += 2) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+        __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(c, zero));
+        __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(c, zero));
+        lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+        hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+        __m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_set1_epi16(2)), 2);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(sum, sum));
+    }
+    ScalarBox2xRow(row0 + x * 8, row1 + x * 8, dst_width - x, dst + x * 4);
+}
+
+void Sse2LerpRow(const uint8_t* row0, const uint8_t* row1, int bytes, int weight, uint8_t* dst) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w0 = _mm_set1_epi16(static_cast<short>(256 - weight));
+    const __m128i w1 = _mm_set1_epi16(static_cast<short>(weight));
+    const __m128i round = _mm_set1_epi16(128);
+    int i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), w0),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w1));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), w0),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w1));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    ScalarLerpRow(row0 + i, row1 + i, bytes - i, weight, dst + i);
+}
+
+const ColorKernels kSse2Kernels = {
+    "sse2", Sse2RowsToI420, Sse2RowsToNv12, Sse2Box2xRow, Sse2LerpRow
+};
+
+#ifdef COLOR_CONVERT_AVX2
+bool CpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    // The OS must save the YMM registers too
+    bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return os_avx && (info[1] & (1 << 5));
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+#endif // COLOR_CONVERT_SSE2
+
+#ifdef COLOR_CONVERT_NEON
+inline uint8x8_t NeonLuma(uint8x8_t b, uint8x8_t g, uint8x8_t r) {
+    uint16x8_t y = vmull_u8(r, vdup_n_u8(kYR));
+    y = vmlal_u8(y, g, vdup_n_u8(kYG));
+    y = vmlal_u8(y, b, vdup_n_u8(kYB));
+    return vshrn_n_u16(vaddq_u16(y, vdupq_n_u16(kYBias)), 8);
+}
+
+// 16 pixels of two rows: stores 16+16 luma and returns 8 u and 8 v bytes
+inline void NeonBlock(const uint8_t* row0, const uint8_t* row1, uint8_t* y0, uint8_t* y1,
+                      uint8x8_t& u, uint8x8_t& v) {
+    uint8x16x4_t p = vld4q_u8(row0);
+    uint8x16x4_t q = vld4q_u8(row1);
+    vst1q_u8(y0, vcombine_u8(NeonLuma(vget_low_u8(p.val[0]), vget_low_u8(p.val[1]), vget_low_u8(p.val[2])),
+                             NeonLuma(vget_high_u8(p.val[0]), vget_high_u8(p.val[1]), vget_high_u8(p.val[2]))));
+    vst1q_u8(y1, vcombine_u8(NeonLuma(vget_low_u8(q.val[0]), vget_low_u8(q.val[1]), vget_low_u8(q.val[2])),
+                             NeonLuma(vget_high_u8(q.val[0]), vget_high_u8(q.val[1]), vget_high_u8(q.val[2]))));
+
+    // Sum of each 2x2 block, then the rounded mean
+    uint16x8_t b = vrshrq_n_u16(vpadalq_u8(vpaddlq_u8(p.val[0]), q.val[0]), 2);
+    uint16x8_t g = vrshrq_n_u16(vpadalq_u8(vpaddlq_u8(p.val[1]), q.val[1]), 2);
+    uint16x8_t r = vrshrq_n_u16(vpadalq_u8(vpaddlq_u8(p.val[2]), q.val[2]), 2);
+    const uint16x8_t bias = vdupq_n_u16(kUVBias);
+    uint16x8_t cu = vmlsq_n_u16(vmlsq_n_u16(vmulq_n_u16(b, kUB), g, kUG), r, kUR);
+    uint16x8_t cv = vmlsq_n_u16(vmlsq_n_u16(vmulq_n_u16(r, kVR), g, kVG), b, kVB);
+    u = vshrn_n_u16(vaddq_u16(cu, bias), 8);
+    v = vshrn_n_u16(vaddq_u16(cv, bias), 8);
+}
+
+void NeonRowsToI420(const uint8_t* row0, const uint8_t* row1, int width,
+                    uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x8_t cu, cv;
+        NeonBlock(row0 + x * 4, row1 + x * 4, y0 + x, y1 + x, cu, cv);
+        vst1_u8(u + x / 2, cu);
+        vst1_u8(v + x / 2, cv);
+    }
+    ScalarRowsToI420(row0 + x * 4, row1 + x * 4, width - x, y0 + x, y1 + x, u + x / 2, v + x / 2);
+}
+
+void NeonRowsToNv12(const uint8_t* row0, const uint8_t* row1, int width,
+                    uint8_t* y0, uint8_t* y1, uint8_t* uv) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x8x2_t chroma;
+        NeonBlock(row0 + x * 4, row1 + x * 4, y0 + x, y1 + x, chroma.val[0], chroma.val[1]);
+        vst2_u8(uv + x, chroma);
+    }
+    ScalarRowsToNv12(row0 + x * 4, row1 + x * 4, width - x, y0 + x, y1 + x, uv + x);
+}
+
+void NeonBox2xRow(const uint8_t* row0, const uint8_t* row1, int dst_width, uint8_t* dst) {
+    int x = 0;
+    for (; x + 8 <= dst_width; x += 8) {
+        uint8x16x4_t a = vld4q_u8(row0 + x * 8);
+        uint8x16x4_t c = vld4q_u8(row1 + x * 8);
+        uint8x8x4_t out;
+        for (int i = 0; i < 4; ++i) {
+            out.val[i] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(a.val[i]), c.val[i]), 2);
+        }
+        vst4_u8(dst + x * 4, out);
+    }
+    ScalarBox2xRow(row0 + x * 8, row1 + x * 8, dst_width - x, dst + x * 4);
+}
+
+void NeonLerpRow(const uint8_t* row0, const uint8_t* row1, int bytes, int weight, uint8_t* dst) {
+    const uint8x8_t w = vdup_n_u8(static_cast<uint8_t>(weight));
+    int i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        uint8x16_t a = vld1q_u8(row0 + i);
+        uint8x16_t b = vld1q_u8(row1 + i);
+        // a * 256 - a * w + b * w
+        uint16x8_t lo = vmlal_u8(vmlsl_u8(vshll_n_u8(vget_low_u8(a), 8), vget_low_u8(a), w), vget_low_u8(b), w);
+        uint16x8_t hi = vmlal_u8(vmlsl_u8(vshll_n_u8(vget_high_u8(a), 8), vget_high_u8(a), w), vget_high_u8(b), w);
+        vst1q_u8(dst + i, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+    }
+    ScalarLerpRow(row0 + i, row1 + i, bytes - i, weight, dst + i);
+}
+
+const ColorKernels kNeonKernels = {
+    "neon", NeonRowsToI420, NeonRowsToNv12, NeonBox2xRow, NeonLerpRow
+};
+#endif // COLOR_CONVERT_NEON
+
+// Source coordinate of output pixel i in 8.8 fixed point, centres aligned
+int SourcePosition(int i, int src_size, int dst_size) {
+    int64_t position = (static_cast<int64_t>(2 * i + 1) * src_size * 256) / (2 * dst_size) - 128;
+    return static_cast<int>(std::min<int64_t>(std::max<int64_t>(position, 0), (src_size - 1) * 256));
+}
+
+void CopyRows(const uint8_t* src, int src_stride, int bytes, int rows, uint8_t* dst, int dst_stride) {
+    for (int row = 0; row < rows; ++row) {
+        std::memcpy(dst + static_cast<size_t>(row) * dst_stride, src + static_cast<size_t>(row) * src_stride, bytes);
+    }
+}
+
+} // namespace
+
+std::vector<const ColorKernels*> AvailableColorKernels() {
+    std::vector<const ColorKernels*> kernels = {&kScalarKernels};
+#ifdef COLOR_CONVERT_SSE2
+    kernels.push_back(&kSse2Kernels);
+#ifdef COLOR_CONVERT_AVX2
+    if (CpuHasAvx2()) {
+        kernels.push_back(&kAvx2ColorKernels);
+    }
+#endif
+#endif
+#ifdef COLOR_CONVERT_NEON
+    kernels.push_back(&kNeonKernels);
+#endif
+    return kernels;
+}
+
+const ColorKernels& BestColorKernels() {
+    // Ordered slowest to fastest
+    static const ColorKernels* best = AvailableColorKernels().back();
+    return *best;
+}
+
+void BgraToI420(const uint8_t* src, int src_stride, int width, int height,
+                uint8_t* y, int y_stride, uint8_t* u, int u_stride, uint8_t* v, int v_stride,
+                const ColorKernels* kernels) {
+    const ColorKernels& k = kernels ? *kernels : BestColorKernels();
+    for (int row = 0; row < height; row += 2) {
+        // The last row of an odd height pairs with itself
+        int next = row + 1 < height ? row + 1 : row;
+        k.rows_to_i420(src + static_cast<size_t>(row) * src_stride, src + static_cast<size_t>(next) * src_stride,
+                       width, y + static_cast<size_t>(row) * y_stride, y + static_cast<size_t>(next) * y_stride,
+                       u + static_cast<size_t>(row / 2) * u_stride, v + static_cast<size_t>(row / 2) * v_stride);
+    }
+}
+
+void BgraToNv12(const uint8_t* src, int src_stride, int width, int height,
+                uint8_t* y, int y_stride, uint8_t* uv, int uv_stride,
+                const ColorKernels* kernels) {
+    const ColorKernels& k = kernels ? *kernels : BestColorKernels();
+    for (int row = 0; row < height; row += 2) {
+        int next = row + 1 < height ? row + 1 : row;
+        k.rows_to_nv12(src + static_cast<size_t>(row) * src_stride, src + static_cast<size_t>(next) * src_stride,
+                       width, y + static_cast<size_t>(row) * y_stride, y + static_cast<size_t>(next) * y_stride,
+                       uv + static_cast<size_t>(row / 2) * uv_stride);
+    }
+}
+
+void DownscaleBgraBox2x(const uint8_t* src, int src_stride, int src_width, int src_height,
+                        uint8_t* dst, int dst_stride, const ColorKernels* kernels) {
+    const ColorKernels& k = kernels ? *kernels : BestColorKernels();
+    for (int row = 0; row < src_height / 2; ++row) {
+        const uint8_t* row0 = src + static_cast<size_t>(row) * 2 * src_stride;
+        k.box2x_row(row0, row0 + src_stride, src_width / 2, dst + static_cast<size_t>(row) * dst_stride);
+    }
+}
+
+void ScaleBgraBilinear(const uint8_t* src, int src_stride, int src_width, int src_height,
+                       uint8_t* dst, int dst_stride, int dst_width, int dst_height,
+                       const ColorKernels* kernels) {
+    if (src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0) {
+        return;
+    }
+    const ColorKernels& k = kernels ? *kernels : BestColorKernels();
+
+    std::vector<int> columns(dst_width);
+    for (int x = 0; x < dst_width; ++x) {
+        columns[x] = SourcePosition(x, src_width, dst_width);
+    }
+
+    std::vector<uint8_t> blended(static_cast<size_t>(src_width) * 4);
+    for (int y = 0; y < dst_height; ++y) {
+        int position = SourcePosition(y, src_height, dst_height);
+        int top = position >> 8;
+        int bottom = std::min(top + 1, src_height - 1);
+        k.lerp_row(src + static_cast<size_t>(top) * src_stride, src + static_cast<size_t>(bottom) * src_stride,
+                   src_width * 4, position & 0xFF, blended.data());
+
+        uint8_t* out = dst + static_cast<size_t>(y) * dst_stride;
+        for (int x = 0; x < dst_width; ++x) {
+            int left = columns[x] >> 8;
+            uint32_t weight = columns[x] & 0xFF;
+            uint32_t a, b;
+            std::memcpy(&a, blended.data() + left * 4, 4);
+            std::memcpy(&b, blended.data() + std::min(left + 1, src_width - 1) * 4, 4);
+            // Two channels per multiply: each 16-bit half holds at most
+            // 255 * 256 + 128, so nothing carries into its neighbour
+            uint32_t even = ((a & 0x00FF00FF) * (256 - weight) + (b & 0x00FF00FF) * weight + 0x00800080) >> 8;
+            uint32_t odd = ((a >> 8 & 0x00FF00FF) * (256 - weight) + (b >> 8 & 0x00FF00FF) * weight + 0x00800080);
+            uint32_t pixel = (even & 0x00FF00FF) | (odd & 0xFF00FF00);
+            std::memcpy(out + x * 4, &pixel, 4);
+        }
+    }
+}
+
+void ScaleBgra(const uint8_t* src, int src_stride, int src_width, int src_height,
+               uint8_t* dst, int dst_stride, int dst_width, int dst_height,
+               std::vector<uint8_t>& scratch) {
+    if (src_width == dst_width && src_height == dst_height) {
+        CopyRows(src, src_stride, src_width * 4, src_height, dst, dst_stride);
+        return;
+    }
+
+    int steps = 0;
+    for (int w = src_width, h = src_height; w >= 2 * dst_width && h >= 2 * dst_height; w /= 2, h /= 2) {
+        steps++;
+    }
+
+    // Box steps alternate between two buffers; each later step is smaller
+    // than the one two before it
+    size_t first = static_cast<size_t>(src_width / 2) * (src_height / 2) * 4;
+    size_t second = steps > 1 ? static_cast<size_t>(src_width / 4) * (src_height / 4) * 4 : 0;
+    if (steps > 0 && scratch.size() < first + second) {
+        scratch.resize(first + second);
+    }
+
+    const uint8_t* current = src;
+    int stride = src_stride;
+    int width = src_width;
+    int height = src_height;
+    for (int i = 0; i < steps; ++i) {
+        bool last = i == steps - 1 && width / 2 == dst_width && height / 2 == dst_height;
+        uint8_t* out = last ? dst : scratch.data() + (i % 2 ? first : 0);
+        int out_stride = last ? dst_stride : (width / 2) * 4;
+        DownscaleBgraBox2x(current, stride, width, height, out, out_stride);
+        current = out;
+        stride = out_stride;
+        width /= 2;
+        height /= 2;
+    }
+
+    if (width != dst_width || height != dst_height) {
+        ScaleBgraBilinear(current, stride, width, height, dst, dst_stride, dst_width, dst_height);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// CPU colour conversion and scaling for frames the addon produces itself
+// (screenshots, the built-in capture backend). Input is BGRA; YUV output is
+// BT.709 limited range 4:2:0, the same as the recording pipeline, with each
+// chroma sample taken from the rounded mean of its 2x2 block.
+//
+// Every kernel has a scalar reference and SIMD versions (SSE2, AVX2, NEON)
+// that are bit-exact with it; the fastest one the CPU supports is picked on
+// first use. Odd widths and heights are handled (edge pixels repeat).
+
+// One implementation of the row kernels. Exposed for tests and benchmarks;
+// everything else uses the dispatched one.
+struct ColorKernels {
+    const char* name; // "scalar", "sse2", "avx2" or "neon"
+
+    // Two BGRA rows to two luma rows and one row of chroma (planar u/v or
+    // interleaved uv). row1 may equal row0 (and y1 equal y0) for the last
+    // row of an odd height.
+    void (*rows_to_i420)(const uint8_t* row0, const uint8_t* row1, int width,
+                         uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v);
+    void (*rows_to_nv12)(const uint8_t* row0, const uint8_t* row1, int width,
+                         uint8_t* y0, uint8_t* y1, uint8_t* uv);
+    // dst_width output pixels, each the rounded mean of a 2x2 source block
+    void (*box2x_row)(const uint8_t* row0, const uint8_t* row1, int dst_width, uint8_t* dst);
+    // dst = (row0 * (256 - weight) + row1 * weight + 128) >> 8, byte-wise
+    void (*lerp_row)(const uint8_t* row0, const uint8_t* row1, int bytes, int weight, uint8_t* dst);
+};
+
+// The implementation in use and every one this CPU can run (scalar first)
+const ColorKernels& BestColorKernels();
+std::vector<const ColorKernels*> AvailableColorKernels();
+
+// Conversions take explicit strides; kernels == nullptr uses BestColorKernels()
+void BgraToI420(const uint8_t* src, int src_stride, int width, int height,
+                uint8_t* y, int y_stride, uint8_t* u, int u_stride, uint8_t* v, int v_stride,
+                const ColorKernels* kernels = nullptr);
+void BgraToNv12(const uint8_t* src, int src_stride, int width, int height,
+                uint8_t* y, int y_stride, uint8_t* uv, int uv_stride,
+                const ColorKernels* kernels = nullptr);
+
+// Halves both dimensions (rounding down). Works on any 4-byte pixel format.
+void DownscaleBgraBox2x(const uint8_t* src, int src_stride, int src_width, int src_height,
+                        uint8_t* dst, int dst_stride, const ColorKernels* kernels = nullptr);
+
+// Bilinear resize to any size with pixel centres aligned and edges clamped.
+// The vertical pass is vectorized; the horizontal pass is shared scalar code.
+void ScaleBgraBilinear(const uint8_t* src, int src_stride, int src_width, int src_height,
+                       uint8_t* dst, int dst_stride, int dst_width, int dst_height,
+                       const ColorKernels* kernels = nullptr);
+
+// General resize: 2x box steps while the source is at least twice the
+// target in both dimensions (so large reductions do not alias), then
+// bilinear for the rest. `scratch` holds the intermediate images and can be
+// reused across calls to avoid allocating per frame.
+void ScaleBgra(const uint8_t* src, int src_stride, int src_width, int src_height,
+               uint8_t* dst, int dst_stride, int dst_width, int dst_height,
+               std::vector<uint8_t>& scratch);
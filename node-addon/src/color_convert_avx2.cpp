@@ -0,0 +1,133 @@
+// Built with AVX2 code generation enabled (see CMakeLists.txt). Nothing here
+// may run before BestColorKernels() has checked the CPU.
+#include "color_kernels.h"
+#include <immintrin.h>
+
+namespace {
+
+// Packs keep 128-bit lanes apart; this restores element order
+inline __m256i Avx2InOrder(__m256i packed) {
+    return _mm256_permute4x64_epi64(packed, 0xD8);
+}
+
+// Splits 16 BGRA pixels into 16-bit B, G and R lanes, in pixel order
+inline void Avx2Channels(const uint8_t* p, __m256i& b, __m256i& g, __m256i& r) {
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    b = Avx2InOrder(_mm256_packs_epi32(_mm256_and_si256(lo, mask), _mm256_and_si256(hi, mask)));
+    g = Avx2InOrder(_mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(lo, 8), mask),
+                                       _mm256_and_si256(_mm256_srli_epi32(hi, 8), mask)));
+    r = Avx2InOrder(_mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(lo, 16), mask),
+                                       _mm256_and_si256(_mm256_srli_epi32(hi, 16), mask)));
+}
+
+// 16 luma bytes
+inline __m128i Avx2Luma(__m256i b, __m256i g, __m256i r) {
+    __m256i y = _mm256_mullo_epi16(r, _mm256_set1_epi16(kYR));
+    y = _mm256_add_epi16(y, _mm256_mullo_epi16(g, _mm256_set1_epi16(kYG)));
+    y = _mm256_add_epi16(y, _mm256_mullo_epi16(b, _mm256_set1_epi16(kYB)));
+    y = _mm256_srli_epi16(_mm256_add_epi16(y, _mm256_set1_epi16(kYBias)), 8);
+    return _mm_packus_epi16(_mm256_castsi256_si128(y), _mm256_extracti128_si256(y, 1));
+}
+
+// Mean of each horizontal pair of the row sums, as 8 values in 16-bit lanes
+inline __m128i Avx2PairMean(__m256i sum) {
+    __m256i pairs = _mm256_madd_epi16(sum, _mm256_set1_epi16(1));
+    pairs = _mm256_srli_epi32(_mm256_add_epi32(pairs, _mm256_set1_epi32(2)), 2);
+    return _mm_packs_epi32(_mm256_castsi256_si128(pairs), _mm256_extracti128_si256(pairs, 1));
+}
+
+// 16 pixels of two rows: stores 16+16 luma and returns 8 u and 8 v bytes
+inline void Avx2Block(const uint8_t* row0, const uint8_t* row1, uint8_t* y0, uint8_t* y1,
+                      __m128i& u, __m128i& v) {
+    __m256i b0, g0, r0, b1, g1, r1;
+    Avx2Channels(row0, b0, g0, r0);
+    Avx2Channels(row1, b1, g1, r1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(y0), Avx2Luma(b0, g0, r0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(y1), Avx2Luma(b1, g1, r1));
+
+    __m128i b = Avx2PairMean(_mm256_add_epi16(b0, b1));
+    __m128i g = Avx2PairMean(_mm256_add_epi16(g0, g1));
+    __m128i r = Avx2PairMean(_mm256_add_epi16(r0, r1));
+    const __m128i bias = _mm_set1_epi16(static_cast<short>(kUVBias));
+    u = _mm_mullo_epi16(b, _mm_set1_epi16(kUB));
+    u = _mm_sub_epi16(u, _mm_mullo_epi16(g, _mm_set1_epi16(kUG)));
+    u = _mm_sub_epi16(u, _mm_mullo_epi16(r, _mm_set1_epi16(kUR)));
+    u = _mm_srli_epi16(_mm_add_epi16(u, bias), 8);
+    v = _mm_mullo_epi16(r, _mm_set1_epi16(kVR));
+    v = _mm_sub_epi16(v, _mm_mullo_epi16(g, _mm_set1_epi16(kVG)));
+    v = _mm_sub_epi16(v, _mm_mullo_epi16(b, _mm_set1_epi16(kVB)));
+    v = _mm_srli_epi16(_mm_add_epi16(v, bias), 8);
+    u = _mm_packus_epi16(u, u);
+    v = _mm_packus_epi16(v, v);
+}
+
+void Avx2RowsToI420(const uint8_t* row0, const uint8_t* row1, int width,
+                    uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i cu, cv;
+        Avx2Block(row0 + x * 4, row1 + x * 4, y0 + x, y1 + x, cu, cv);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(u + x / 2), cu);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(v + x / 2), cv);
+    }
+    ScalarRowsToI420(row0 + x * 4, row1 + x * 4, width - x, y0 + x, y1 + x, u + x / 2, v + x / 2);
+}
+
+void Avx2RowsToNv12(const uint8_t* row0, const uint8_t* row1, int width,
+                    uint8_t* y0, uint8_t* y1, uint8_t* uv) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i cu, cv;
+        Avx2Block(row0 + x * 4, row1 + x * 4, y0 + x, y1 + x, cu, cv);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(uv + x), _mm_unpacklo_epi8(cu, cv));
+    }
+    ScalarRowsToNv12(row0 + x * 4, row1 + x * 4, width - x, y0 + x, y1 + x, uv + x);
+}
+
+void Avx2Box2xRow(const uint8_t* row0, const uint8_t* row1, int dst_width, uint8_t* dst) {
+    const __m256i zero = _mm256_setzero_si256();
+    int x = 0;
+    for (; x + 4 <= dst_width; x += 4) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x * 8));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x * 8));
+        // Per lane: lo holds pixels 0,1 (4,5), hi pixels 2,3 (6,7)
+        __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(c, zero));
+        __m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(c, zero));
+        lo = _mm256_add_epi16(lo, _mm256_srli_si256(lo, 8));
+        hi = _mm256_add_epi16(hi, _mm256_srli_si256(hi, 8));
+        __m256i sum = _mm256_unpacklo_epi64(lo, hi);
+        sum = _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(2)), 2);
+        __m256i packed = Avx2InOrder(_mm256_packus_epi16(sum, sum));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm256_castsi256_si128(packed));
+    }
+    ScalarBox2xRow(row0 + x * 8, row1 + x * 8, dst_width - x, dst + x * 4);
+}
+
+void Avx2LerpRow(const uint8_t* row0, const uint8_t* row1, int bytes, int weight, uint8_t* dst) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i w0 = _mm256_set1_epi16(static_cast<short>(256 - weight));
+    const __m256i w1 = _mm256_set1_epi16(static_cast<short>(weight));
+    const __m256i round = _mm256_set1_epi16(128);
+    int i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + i));
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(a, zero), w0),
+                                      _mm256_mullo_epi16(_mm256_unpacklo_epi8(b, zero), w1));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(a, zero), w0),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(b, zero), w1));
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, round), 8);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, round), 8);
+        // Unpack and pack are both per lane, so the order comes back as loaded
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    ScalarLerpRow(row0 + i, row1 + i, bytes - i, weight, dst + i);
+}
+
+} // namespace
+
+const ColorKernels kAvx2ColorKernels = {
+    "avx2", Avx2RowsToI420, Avx2RowsToNv12, Avx2Box2xRow, Avx2LerpRow
+};
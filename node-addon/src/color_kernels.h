@@ -0,0 +1,33 @@
+#pragma once
+#include "color_convert.h"
+
+// Internal to color_convert*.cpp: the fixed-point coefficients every
+// implementation shares, and the scalar kernels the SIMD ones fall back to
+// for the last few pixels of a row.
+//
+// BT.709 limited range in 8-bit fixed point. The bias terms fold in the
+// +16 / +128 offsets and the rounding, which keeps every intermediate
+// within 0..65535 so 16-bit lanes compute exactly what the scalar code does.
+constexpr int kYR = 47;
+constexpr int kYG = 157;
+constexpr int kYB = 16;
+constexpr int kYBias = 16 * 256 + 128;
+constexpr int kUB = 112;
+constexpr int kUG = 86;
+constexpr int kUR = 26;
+constexpr int kVR = 112;
+constexpr int kVG = 102;
+constexpr int kVB = 10;
+constexpr int kUVBias = 128 * 256 + 128;
+
+void ScalarRowsToI420(const uint8_t* row0, const uint8_t* row1, int width,
+                      uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v);
+void ScalarRowsToNv12(const uint8_t* row0, const uint8_t* row1, int width,
+                      uint8_t* y0, uint8_t* y1, uint8_t* uv);
+void ScalarBox2xRow(const uint8_t* row0, const uint8_t* row1, int dst_width, uint8_t* dst);
+void ScalarLerpRow(const uint8_t* row0, const uint8_t* row1, int bytes, int weight, uint8_t* dst);
+
+#ifdef COLOR_CONVERT_AVX2
+// color_convert_avx2.cpp, built with AVX2 enabled; only used after a CPU check
+extern const ColorKernels kAvx2ColorKernels;
+#endif
@@ -0,0 +1,171 @@
+#include "damage_tracker.h"
+#include <X11/Xlib.h>
+#include <X11/extensions/Xdamage.h>
+#include <algorithm>
+#include <cerrno>
+#include <mutex>
+#include <poll.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// The watched window can be destroyed at any time; errors on tracker
+// connections are ignored and everything else goes to the previous handler
+// (see x11_topology.cpp, which chains the same way)
+std::mutex g_displays_mutex;
+std::vector<Display*> g_tracker_displays;
+XErrorHandler g_previous_handler = nullptr;
+
+int IgnoreTrackerErrors(Display* display, XErrorEvent* event) {
+    {
+        std::lock_guard<std::mutex> lock(g_displays_mutex);
+        if (std::find(g_tracker_displays.begin(), g_tracker_displays.end(), display) != g_tracker_displays.end()) {
+            return 0;
+        }
+    }
+    return g_previous_handler ? g_previous_handler(display, event) : 0;
+}
+
+// Pointer polling interval; damage itself is delivered as events
+const int kPointerPollMs = 20;
+
+} // namespace
+
+DamageTracker::~DamageTracker() {
+    stop();
+}
+
+bool DamageTracker::start(uint64_t window, int x, int y, int width, int height) {
+    if (display_) {
+        return true;
+    }
+
+    display_ = XOpenDisplay(nullptr);
+    if (!display_) {
+        return false;
+    }
+
+    int error_base = 0;
+    if (!XDamageQueryExtension(display_, &event_base_, &error_base)) {
+        XCloseDisplay(display_);
+        display_ = nullptr;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_displays_mutex);
+        g_tracker_displays.push_back(display_);
+    }
+    // Installed once: reinstalling over a handler chained after ours would
+    // make the chain loop
+    static std::once_flag install;
+    std::call_once(install, [] { g_previous_handler = XSetErrorHandler(IgnoreTrackerErrors); });
+
+    window_ = window ? static_cast<Window>(window) : DefaultRootWindow(display_);
+    x_ = x;
+    y_ = y;
+    width_ = width;
+    height_ = height;
+
+    // Raw rectangles let us ignore damage outside the watched region, e.g.
+    // other monitors when capturing one display
+    damage_ = XDamageCreate(display_, window_, XDamageReportRawRectangles);
+    XFlush(display_);
+
+    if (pipe(wake_fds_) != 0) {
+        stop();
+        return false;
+    }
+
+    changed_ = true;
+    event_thread_ = std::thread([this] { eventLoop(); });
+    return true;
+}
+
+void DamageTracker::stop() {
+    if (event_thread_.joinable()) {
+        char byte = 0;
+        ssize_t written = write(wake_fds_[1], &byte, 1);
+        (void)written;
+        event_thread_.join();
+    }
+
+    for (int& fd : wake_fds_) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    if (display_) {
+        if (damage_) {
+            XDamageDestroy(display_, damage_);
+            damage_ = 0;
+        }
+        XCloseDisplay(display_);
+        std::lock_guard<std::mutex> lock(g_displays_mutex);
+        g_tracker_displays.erase(std::remove(g_tracker_displays.begin(), g_tracker_displays.end(), display_),
+                                 g_tracker_displays.end());
+        display_ = nullptr;
+    }
+}
+
+bool DamageTracker::intersects(int x, int y, int width, int height) const {
+    if (width_ <= 0 || height_ <= 0) {
+        return true;
+    }
+    return x < x_ + width_ && x + width > x_ && y < y_ + height_ && y + height > y_;
+}
+
+void DamageTracker::eventLoop() {
+    int last_x = -1;
+    int last_y = -1;
+    struct pollfd fds[2] = {
+        {ConnectionNumber(display_), POLLIN, 0},
+        {wake_fds_[0], POLLIN, 0},
+    };
+
+    for (;;) {
+        bool damaged = false;
+        while (XPending(display_)) {
+            XEvent event;
+            XNextEvent(display_, &event);
+            if (event.type == event_base_ + XDamageNotify) {
+                const XDamageNotifyEvent* notify = reinterpret_cast<XDamageNotifyEvent*>(&event);
+                if (intersects(notify->area.x, notify->area.y, notify->area.width, notify->area.height)) {
+                    damaged = true;
+                }
+            }
+        }
+        if (damaged) {
+            // Reported rectangles also accumulate in the damage region; keep it empty
+            XDamageSubtract(display_, damage_, None, None);
+            changed_.store(true, std::memory_order_release);
+        }
+
+        Window root_return = 0;
+        Window child_return = 0;
+        int root_x = 0;
+        int root_y = 0;
+        int window_x = 0;
+        int window_y = 0;
+        unsigned int mask = 0;
+        if (XQueryPointer(display_, window_, &root_return, &child_return, &root_x, &root_y,
+                          &window_x, &window_y, &mask) &&
+            (window_x != last_x || window_y != last_y)) {
+            if (intersects(window_x, window_y, 1, 1) || intersects(last_x, last_y, 1, 1)) {
+                changed_.store(true, std::memory_order_release);
+            }
+            last_x = window_x;
+            last_y = window_y;
+        }
+
+        if (poll(fds, 2, kPointerPollMs) < 0 && errno != EINTR) {
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+    }
+}
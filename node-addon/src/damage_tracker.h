@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+typedef struct _XDisplay Display;
+
+// Reports whether a rectangle of an X11 window (the root window for display
+// capture) changed, using XDamage instead of looking at pixels. The pointer
+// is not part of the damage, so its position is polled as well.
+class DamageTracker {
+public:
+    DamageTracker() = default;
+    ~DamageTracker();
+
+    DamageTracker(const DamageTracker&) = delete;
+    DamageTracker& operator=(const DamageTracker&) = delete;
+
+    // `window` 0 means the root window; a zero width/height watches all of
+    // it. Returns false without an X server or the DAMAGE extension.
+    bool start(uint64_t window, int x, int y, int width, int height);
+    void stop();
+
+    // True when something changed since the previous call. Starts out true.
+    bool consume() { return changed_.exchange(false, std::memory_order_acq_rel); }
+
+private:
+    void eventLoop();
+    bool intersects(int x, int y, int width, int height) const;
+
+    Display* display_ = nullptr;
+    unsigned long window_ = 0;
+    unsigned long damage_ = 0;
+    int event_base_ = 0;
+    int x_ = 0;
+    int y_ = 0;
+    int width_ = 0;
+    int height_ = 0;
+
+    std::atomic<bool> changed_{true};
+    int wake_fds_[2] = {-1, -1};
+    std::thread event_thread_;
+};
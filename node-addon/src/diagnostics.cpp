@@ -0,0 +1,178 @@
+#include "diagnostics.h"
+#include "env_listeners.h"
+#include "frame_tap.h"
+#include "log_sink.h"
+#include "trace.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+Napi::Object TraceStatsObject(Napi::Env env, const TraceStats& stats) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("events", Napi::Number::New(env, static_cast<double>(stats.events)));
+    obj.Set("dropped", Napi::Number::New(env, static_cast<double>(stats.dropped)));
+    obj.Set("threads", stats.threads);
+    return obj;
+}
+
+bool ParseLogLevel(const std::string& name, LogLevel& level) {
+    if (name == "error") {
+        level = LogLevel::Error;
+    } else if (name == "warning") {
+        level = LogLevel::Warning;
+    } else if (name == "info") {
+        level = LogLevel::Info;
+    } else if (name == "debug") {
+        level = LogLevel::Debug;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+Napi::Value StartTraceJs(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    uint32_t categories = kTracePipeline;
+    int events_per_thread = 65536;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object opts = info[0].As<Napi::Object>();
+        if (opts.Has("frames") && opts.Get("frames").ToBoolean().Value()) {
+            categories |= kTraceFrames;
+        }
+        events_per_thread = GetIntOption(opts, "eventsPerThread", events_per_thread);
+    }
+    if (events_per_thread < 1 || events_per_thread > (1 << 24)) {
+        Napi::RangeError::New(env, "eventsPerThread must be between 1 and 16777216").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    StartTrace(categories, static_cast<size_t>(events_per_thread));
+    return env.Undefined();
+}
+
+Napi::Value StopTraceJs(const Napi::CallbackInfo& info) {
+    StopTrace();
+    return info.Env().Undefined();
+}
+
+Napi::Value GetTraceStatsJs(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    TraceStats stats = GetTraceStats();
+    Napi::Object obj = TraceStatsObject(env, stats);
+    obj.Set("active", Napi::Boolean::New(env, stats.active));
+    return obj;
+}
+
+Napi::Value WriteTraceJs(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Trace file path required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    TraceStats stats;
+    if (!WriteTrace(info[0].As<Napi::String>().Utf8Value(), &stats)) {
+        return Napi::Boolean::New(env, false);
+    }
+    return TraceStatsObject(env, stats);
+}
+
+Napi::Value SetLogOptions(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Log options object required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object opts = info[0].As<Napi::Object>();
+    LogSink& sink = LogSink::instance();
+
+    if (opts.Has("level")) {
+        LogLevel level;
+        Napi::Value value = opts.Get("level");
+        if (!value.IsString() || !ParseLogLevel(value.As<Napi::String>().Utf8Value(), level)) {
+            Napi::TypeError::New(env, "level must be 'error', 'warning', 'info' or 'debug'")
+                .ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        sink.setLevel(level);
+    }
+
+    if (opts.Has("console")) {
+        sink.setConsole(opts.Get("console").ToBoolean().Value());
+    }
+
+    if (opts.Has("file")) {
+        Napi::Value value = opts.Get("file");
+        std::string path = value.IsString() ? value.As<Napi::String>().Utf8Value() : "";
+        if (!sink.setFile(path)) {
+            Napi::Error::New(env, "Cannot open log file: " + path).ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+    }
+
+    return env.Undefined();
+}
+
+// One batch as the writer picked it up, shared by every environment's listener
+using LogBatch = std::shared_ptr<const std::vector<LogEntry>>;
+
+static void DeliverLogs(Napi::Env env, Napi::Function callback, const LogBatch& entries) {
+    Napi::Array array = Napi::Array::New(env, entries->size());
+    for (size_t i = 0; i < entries->size(); ++i) {
+        const LogEntry& entry = (*entries)[i];
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("level", LogLevelName(entry.level));
+        obj.Set("source", entry.from_obs ? "obs" : "addon");
+        obj.Set("time", Napi::Number::New(env, static_cast<double>(entry.time_ms)));
+        obj.Set("message", entry.message);
+        array.Set(static_cast<uint32_t>(i), obj);
+    }
+    callback.Call({array});
+}
+
+static EnvListeners<LogBatch>& LogListeners() {
+    static auto* listeners = new EnvListeners<LogBatch>("obs_log", DeliverLogs,
+        [](std::function<void(const LogBatch&)> emit) {
+            if (!emit) {
+                LogSink::instance().setHandler(nullptr);
+                return true;
+            }
+            LogSink::instance().setHandler([emit](const std::vector<LogEntry>& batch) {
+                emit(std::make_shared<const std::vector<LogEntry>>(batch));
+            });
+            return true;
+        });
+    return *listeners;
+}
+
+Napi::Value OnLog(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !(info[0].IsFunction() || info[0].IsNull() || info[0].IsUndefined())) {
+        Napi::TypeError::New(env, "Callback or null required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    // One listener per environment, each receiving every batch
+    if (info[0].IsFunction()) {
+        LogListeners().set(env, info[0].As<Napi::Function>());
+    } else {
+        LogListeners().remove(env);
+    }
+    return env.Undefined();
+}
+
+Napi::Value GetLogStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("dropped", Napi::Number::New(env, static_cast<double>(LogSink::instance().dropped())));
+    return obj;
+}
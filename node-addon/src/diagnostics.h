@@ -0,0 +1,18 @@
+#pragma once
+#include <napi.h>
+
+// JS bindings for tracing and logging:
+//   startTrace({ frames, eventsPerThread })
+//   stopTrace()
+//   getTraceStats() -> { active, events, dropped, threads }
+//   writeTrace(path) -> { events, dropped, threads } | false
+//   setLogOptions({ level, console, file })
+//   onLog(callback | null); callback receives [{ level, source, time, message }]
+//   getLogStats() -> { dropped }
+Napi::Value StartTraceJs(const Napi::CallbackInfo& info);
+Napi::Value StopTraceJs(const Napi::CallbackInfo& info);
+Napi::Value GetTraceStatsJs(const Napi::CallbackInfo& info);
+Napi::Value WriteTraceJs(const Napi::CallbackInfo& info);
+Napi::Value SetLogOptions(const Napi::CallbackInfo& info);
+Napi::Value OnLog(const Napi::CallbackInfo& info);
+Napi::Value GetLogStats(const Napi::CallbackInfo& info);
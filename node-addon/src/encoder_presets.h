@@ -0,0 +1,81 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+// x264 presets from fastest to slowest, with a rough single-core throughput
+// in megapixels per second for 8-bit 4:2:0 on a current x86 core. The figures
+// only need to be right relative to each other and to within a factor of
+// two; `npm run bench:presets` measures the real numbers for a machine.
+//
+// Each preset also carries x264's rc-lookahead, B-frame and reference frame
+// defaults, which decide how many pictures the encoder holds.
+struct X264PresetCost {
+    const char* name;
+    double megapixels_per_core;
+    int lookahead;
+    int b_frames;
+    int refs;
+};
+
+static const X264PresetCost kX264Presets[] = {
+    {"ultrafast", 100.0, 0, 0, 1},
+    {"superfast", 60.0, 0, 3, 1},
+    {"veryfast", 40.0, 10, 3, 1},
+    {"faster", 26.0, 20, 3, 2},
+    {"fast", 18.0, 30, 3, 2},
+    {"medium", 12.0, 40, 3, 3},
+    {"slow", 7.0, 50, 3, 5},
+    {"slower", 3.5, 60, 3, 8},
+    {"veryslow", 1.5, 60, 8, 16},
+};
+
+// Picks the slowest (best-compressing) preset whose estimated cost fits in
+// `cpu_budget` of `cores`, i.e. the fastest preset needed to hold `fps`.
+// Falls back to ultrafast when even that does not fit.
+inline std::string SelectX264Preset(int width, int height, int fps, unsigned cores, double cpu_budget) {
+    if (cores == 0) {
+        cores = 1;
+    }
+    // x264 frame threading does not scale perfectly; assume ~85% per added core
+    double usable_cores = 1.0 + (cores - 1) * 0.85;
+    double available = usable_cores * cpu_budget;
+    double megapixels_per_second = static_cast<double>(width) * height * fps / 1e6;
+
+    const char* choice = kX264Presets[0].name;
+    for (const X264PresetCost& preset : kX264Presets) {
+        if (megapixels_per_second / preset.megapixels_per_core > available) {
+            break;
+        }
+        choice = preset.name;
+    }
+    return choice;
+}
+
+// Rough bytes x264 holds for `width` x `height` 4:2:0 input: lookahead,
+// B-frame and reference pictures plus one in flight per frame thread, each
+// about twice the raw picture once padding, the half-resolution lookahead
+// copy and motion data are counted. Negative lookahead / b_frames and zero
+// threads mean the preset's (and x264's auto threads') defaults.
+inline uint64_t EstimateX264Bytes(int width, int height, const std::string& preset, int lookahead,
+                                  int b_frames, int threads) {
+    const X264PresetCost* defaults = &kX264Presets[2]; // veryfast, OBS's default
+    for (const X264PresetCost& entry : kX264Presets) {
+        if (preset == entry.name) {
+            defaults = &entry;
+        }
+    }
+    if (lookahead < 0) {
+        lookahead = defaults->lookahead;
+    }
+    if (b_frames < 0) {
+        b_frames = defaults->b_frames;
+    }
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency()) * 3 / 2;
+    }
+    uint64_t picture = static_cast<uint64_t>(width) * height * 3 / 2;
+    return picture * 2 * static_cast<uint64_t>(lookahead + b_frames + defaults->refs + threads);
+}
@@ -0,0 +1,119 @@
+#include "encoder_stream.h"
+#include "log_sink.h"
+#include <cstring>
+
+#include <obs/obs.h>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/mem.h>
+}
+
+namespace {
+
+AVCodecID CodecId(const char* codec) {
+    if (!codec) {
+        return AV_CODEC_ID_NONE;
+    }
+    if (std::strcmp(codec, "h264") == 0) return AV_CODEC_ID_H264;
+    if (std::strcmp(codec, "hevc") == 0) return AV_CODEC_ID_HEVC;
+    if (std::strcmp(codec, "av1") == 0) return AV_CODEC_ID_AV1;
+    if (std::strcmp(codec, "aac") == 0) return AV_CODEC_ID_AAC;
+    if (std::strcmp(codec, "opus") == 0) return AV_CODEC_ID_OPUS;
+    return AV_CODEC_ID_NONE;
+}
+
+} // namespace
+
+void QueuedPacket::assign(const encoder_packet* packet, int muxer_stream) {
+    bool video = packet->type == OBS_ENCODER_VIDEO;
+    data.assign(packet->data, packet->data + packet->size);
+    pts = packet->pts;
+    dts = packet->dts;
+    time_base = AVRational{packet->timebase_num, packet->timebase_den};
+    stream = muxer_stream;
+    keyframe = video ? packet->keyframe : true;
+    // libobs' system time of the frame (os_gettime_ns based), at its DTS
+    capture_ns = video && packet->sys_dts_usec > 0 ? static_cast<uint64_t>(packet->sys_dts_usec) * 1000 : 0;
+}
+
+void QueuedPacket::fill(AVFormatContext* format, AVPacket* out) const {
+    AVRational stream_time_base = format->streams[stream]->time_base;
+    out->data = const_cast<uint8_t*>(data.data());
+    out->size = static_cast<int>(data.size());
+    out->pts = av_rescale_q(pts, time_base, stream_time_base);
+    out->dts = av_rescale_q(dts, time_base, stream_time_base);
+    out->stream_index = stream;
+    out->flags = keyframe ? AV_PKT_FLAG_KEY : 0;
+}
+
+EncoderStream::~EncoderStream() {
+    reset();
+}
+
+void EncoderStream::reset() {
+    avcodec_parameters_free(&params_);
+}
+
+bool EncoderStream::describe(obs_encoder_t* encoder) {
+    reset();
+    AVCodecID codec = CodecId(obs_encoder_get_codec(encoder));
+    if (codec == AV_CODEC_ID_NONE) {
+        LogError() << "Unsupported codec for muxing: " << obs_encoder_get_codec(encoder);
+        return false;
+    }
+    params_ = avcodec_parameters_alloc();
+    if (!params_) {
+        return false;
+    }
+    params_->codec_id = codec;
+
+    if (obs_encoder_get_type(encoder) == OBS_ENCODER_VIDEO) {
+        const struct video_output_info* info = video_output_get_info(obs_encoder_video(encoder));
+        params_->codec_type = AVMEDIA_TYPE_VIDEO;
+        params_->width = static_cast<int>(obs_encoder_get_width(encoder));
+        params_->height = static_cast<int>(obs_encoder_get_height(encoder));
+        time_base_ = AVRational{static_cast<int>(info->fps_den), static_cast<int>(info->fps_num)};
+        frame_rate_ = AVRational{static_cast<int>(info->fps_num), static_cast<int>(info->fps_den)};
+    } else {
+        int channels = static_cast<int>(audio_output_get_channels(obs_encoder_audio(encoder)));
+        params_->codec_type = AVMEDIA_TYPE_AUDIO;
+        params_->sample_rate = static_cast<int>(obs_encoder_get_sample_rate(encoder));
+        params_->frame_size = static_cast<int>(obs_encoder_get_frame_size(encoder));
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 24, 100)
+        av_channel_layout_default(&params_->ch_layout, channels);
+#else
+        params_->channels = channels;
+#endif
+        time_base_ = AVRational{1, params_->sample_rate};
+    }
+
+    // SPS/PPS or AudioSpecificConfig; the muxers convert Annex B themselves
+    uint8_t* extra = nullptr;
+    size_t size = 0;
+    if (obs_encoder_get_extra_data(encoder, &extra, &size) && size > 0) {
+        params_->extradata = static_cast<uint8_t*>(av_mallocz(size + AV_INPUT_BUFFER_PADDING_SIZE));
+        if (params_->extradata) {
+            std::memcpy(params_->extradata, extra, size);
+            params_->extradata_size = static_cast<int>(size);
+        }
+    }
+    return true;
+}
+
+int EncoderStream::addTo(AVFormatContext* format) const {
+    if (!params_) {
+        return -1;
+    }
+    AVStream* stream = avformat_new_stream(format, nullptr);
+    if (!stream || avcodec_parameters_copy(stream->codecpar, params_) < 0) {
+        return -1;
+    }
+    stream->time_base = time_base_;
+    if (params_->codec_type == AVMEDIA_TYPE_VIDEO) {
+        stream->avg_frame_rate = frame_rate_;
+    }
+    return stream->index;
+}
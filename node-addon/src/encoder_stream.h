@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include <libavutil/rational.h>
+}
+
+struct AVCodecParameters;
+struct AVFormatContext;
+struct AVPacket;
+struct encoder_packet;
+struct obs_encoder;
+
+// Shared by the libobs outputs that mux with libavformat on a writer
+// thread of their own (stream_output.h, file_output.h). Only built with
+// libobs and libav.
+
+// One encoded packet on its way to a writer thread, in its encoder's time
+// base
+struct QueuedPacket {
+    std::vector<uint8_t> data;
+    int64_t pts = 0;
+    int64_t dts = 0;
+    AVRational time_base{1, 1};
+    int stream = 0;
+    bool keyframe = false;
+    uint64_t capture_ns = 0; // libobs system time of a video frame; 0 for audio
+
+    // Copies a packet of the encoder thread; audio counts as keyframes
+    void assign(const encoder_packet* packet, int muxer_stream);
+    // Points `out` at data, rescaled into the time base of the muxer stream
+    void fill(AVFormatContext* format, AVPacket* out) const;
+};
+
+// A libobs encoder described as a muxer stream. The description is taken
+// when the output starts, so a writer can add the stream to every file it
+// opens without touching the encoder again.
+class EncoderStream {
+public:
+    EncoderStream() = default;
+    ~EncoderStream();
+
+    EncoderStream(const EncoderStream&) = delete;
+    EncoderStream& operator=(const EncoderStream&) = delete;
+
+    // False when the encoder's codec cannot be muxed
+    bool describe(obs_encoder* encoder);
+    void reset();
+    bool valid() const { return params_ != nullptr; }
+
+    // Returns the new stream's index, or -1
+    int addTo(AVFormatContext* format) const;
+
+private:
+    AVCodecParameters* params_ = nullptr;
+    AVRational time_base_{1, 1};
+    AVRational frame_rate_{0, 1};
+};
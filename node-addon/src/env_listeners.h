@@ -0,0 +1,121 @@
+#pragma once
+#include <napi.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+// Fans out one of OBSManager's single-slot callbacks to a JS listener per
+// environment (the main thread and each worker_thread). Listeners are set
+// on their JS threads while events arrive on OBS threads; after remove()
+// returns, that listener is no longer called. A listener is removed
+// automatically when its environment exits.
+//
+// The OBSManager callback is connected with the first listener and
+// disconnected with the last, through `connect`. OBSManager emits while
+// holding its own locks, and its setters take the same locks, so `connect`
+// is only called under connect_mutex_, never under mutex_. Instances are
+// meant to be leaked, since OBS threads may still emit while statics are
+// destroyed.
+template <typename Event>
+class EnvListeners {
+public:
+    // Runs on the listener's JS thread
+    using Deliver = void (*)(Napi::Env env, Napi::Function callback, const Event& event);
+    // Sets (or, given nullptr, clears) the OBSManager callback; false if unsupported
+    using Connect = std::function<bool(std::function<void(const Event&)>)>;
+
+    EnvListeners(const char* name, Deliver deliver, Connect connect)
+        : name_(name), deliver_(deliver), connect_(std::move(connect)) {}
+
+    // Replaces `env`'s listener. Returns false when the callback is not
+    // supported on this platform.
+    bool set(Napi::Env env, Napi::Function callback) {
+        remove(env);
+
+        auto listener = std::make_unique<Listener>();
+        listener->owner = this;
+        listener->env = env;
+        listener->tsfn = Napi::ThreadSafeFunction::New(env, callback, name_, 0, 1);
+        // A listener should not keep the process alive on its own
+        listener->tsfn.Unref(env);
+        // Registered after the TSFN, so it runs before the TSFN is torn down
+        listener->cleanup = env.AddCleanupHook(RemoveAtExit, listener.get());
+
+        std::lock_guard<std::mutex> connect_lock(connect_mutex_);
+        if (!connected_) {
+            if (!connect_([this](const Event& event) { dispatch(event); })) {
+                listener->cleanup.Remove(env);
+                listener->tsfn.Release();
+                return false;
+            }
+            connected_ = true;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        listeners_[env] = std::move(listener);
+        return true;
+    }
+
+    void remove(Napi::Env env) {
+        std::unique_ptr<Listener> listener = take(env);
+        if (listener) {
+            listener->cleanup.Remove(env);
+            listener->tsfn.Release();
+        }
+    }
+
+private:
+    struct Listener {
+        EnvListeners* owner = nullptr;
+        napi_env env = nullptr;
+        Napi::ThreadSafeFunction tsfn;
+        Napi::Env::CleanupHook<void (*)(Listener*), Listener> cleanup;
+    };
+
+    static void RemoveAtExit(Listener* listener) {
+        std::unique_ptr<Listener> owned = listener->owner->take(listener->env);
+        if (owned) {
+            owned->tsfn.Release();
+        }
+    }
+
+    std::unique_ptr<Listener> take(napi_env env) {
+        std::lock_guard<std::mutex> connect_lock(connect_mutex_);
+        std::unique_ptr<Listener> listener;
+        bool empty = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = listeners_.find(env);
+            if (it == listeners_.end()) {
+                return nullptr;
+            }
+            listener = std::move(it->second);
+            listeners_.erase(it);
+            empty = listeners_.empty();
+        }
+        if (empty && connected_) {
+            connect_(nullptr);
+            connected_ = false;
+        }
+        return listener;
+    }
+
+    // Any thread; never blocks on JS
+    void dispatch(const Event& event) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : listeners_) {
+            Deliver deliver = deliver_;
+            entry.second->tsfn.NonBlockingCall([deliver, event](Napi::Env env, Napi::Function callback) {
+                deliver(env, callback, event);
+            });
+        }
+    }
+
+    const char* name_;
+    Deliver deliver_;
+    Connect connect_;
+    std::mutex connect_mutex_;
+    bool connected_ = false;
+    std::mutex mutex_;
+    std::map<napi_env, std::unique_ptr<Listener>> listeners_;
+};
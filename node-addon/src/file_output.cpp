@@ -0,0 +1,360 @@
+#include "file_output.h"
+#include "encoder_stream.h"
+#include "log_sink.h"
+#include "packet_queue.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <obs/obs.h>
+#include <obs/util/bmem.h>
+#include <obs/util/platform.h>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+const char* const kFileOutputId = "addon_file_output";
+
+namespace {
+
+constexpr int64_t kNoTime = INT64_MIN;
+
+std::string AvError(int error) {
+    char text[AV_ERROR_MAX_STRING_SIZE] = {};
+    av_strerror(error, text, sizeof(text));
+    return text;
+}
+
+// One file being written: opened on start and at each split
+struct MuxedFile {
+    AVFormatContext* format = nullptr;
+    bool header_written = false;
+    int64_t start_us = kNoTime; // media time of its first packet
+    int64_t offset_us = 0;      // subtracted from every timestamp
+};
+
+struct FileOutput {
+    obs_output_t* output = nullptr;
+    // Replaced only while no packets arrive (before begin_data_capture)
+    std::unique_ptr<PacketQueue<QueuedPacket>> queue;
+    std::thread thread;
+    std::atomic<bool> active{false};
+    std::atomic<int> dropped{0};
+    std::atomic<uint64_t> bytes{0};
+
+    // Set by Start, then owned by the writer thread
+    MuxedFile file;
+    EncoderStream video;
+    EncoderStream audio;
+    int video_stream = -1;
+    int audio_stream = -1;
+    bool split = false;
+    int64_t max_time_us = 0;
+    int64_t max_bytes = 0;
+    std::string directory;
+    std::string name_format;
+    std::string extension;
+    bool allow_spaces = true;
+};
+
+uint64_t FileSize(const MuxedFile& file) {
+    return file.format && file.format->pb ? static_cast<uint64_t>(std::max<int64_t>(0, avio_tell(file.format->pb))) : 0;
+}
+
+// Finishes the file; returns its size
+uint64_t CloseFile(MuxedFile& file) {
+    if (!file.format) {
+        return 0;
+    }
+    if (file.header_written) {
+        av_write_trailer(file.format);
+    }
+    uint64_t size = FileSize(file);
+    if (file.format->pb && !(file.format->oformat->flags & AVFMT_NOFILE)) {
+        avio_closep(&file.format->pb);
+    }
+    avformat_free_context(file.format);
+    file = MuxedFile();
+    return size;
+}
+
+// Creates `path` with the output's streams and writes its header
+bool OpenFile(FileOutput* out, const std::string& path, std::string& error) {
+    MuxedFile& file = out->file;
+    int ret = avformat_alloc_output_context2(&file.format, nullptr, nullptr, path.c_str());
+    if (ret < 0 || !file.format) {
+        // Unknown extension
+        ret = avformat_alloc_output_context2(&file.format, nullptr, "matroska", path.c_str());
+    }
+    if (ret < 0 || !file.format) {
+        error = "cannot create a muxer for " + path + ": " + AvError(ret);
+        file = MuxedFile();
+        return false;
+    }
+    // Same order as video_stream / audio_stream
+    if ((out->video.valid() && out->video.addTo(file.format) < 0) ||
+        (out->audio.valid() && out->audio.addTo(file.format) < 0)) {
+        error = "cannot add the streams of " + path;
+        CloseFile(file);
+        return false;
+    }
+    if (!(file.format->oformat->flags & AVFMT_NOFILE)) {
+        ret = avio_open(&file.format->pb, path.c_str(), AVIO_FLAG_WRITE);
+        if (ret < 0) {
+            error = "cannot open " + path + ": " + AvError(ret);
+            CloseFile(file);
+            return false;
+        }
+    }
+    ret = avformat_write_header(file.format, nullptr);
+    if (ret < 0) {
+        error = "cannot write the header of " + path + ": " + AvError(ret);
+        CloseFile(file);
+        return false;
+    }
+    file.header_written = true;
+    return true;
+}
+
+// Name of the next file of a split recording, as ffmpeg_muxer makes them
+std::string NextFilePath(const FileOutput* out) {
+    char* name = os_generate_formatted_filename(out->extension.c_str(), out->allow_spaces, out->name_format.c_str());
+    std::filesystem::path path = std::filesystem::path(out->directory) / name;
+    bfree(name);
+    // Two splits within the resolution of the name template
+    std::filesystem::path first = path;
+    std::error_code ec;
+    for (int i = 2; std::filesystem::exists(path, ec); ++i) {
+        path = first.parent_path() /
+            (first.stem().string() + " (" + std::to_string(i) + ")" + first.extension().string());
+    }
+    return path.string();
+}
+
+void SignalFileChanged(FileOutput* out, const std::string& next) {
+    calldata_t data = {};
+    calldata_set_ptr(&data, "output", out->output);
+    calldata_set_string(&data, "next_file", next.c_str());
+    signal_handler_signal(obs_output_get_signal_handler(out->output), "file_changed", &data);
+    calldata_free(&data);
+}
+
+// Writer thread failure: the disk is full or the file cannot be written
+void Fail(FileOutput* out, const std::string& error, int code) {
+    out->queue->close();
+    out->queue->clear();
+    if (out->active.exchange(false)) {
+        LogError() << "File output: " << error;
+        obs_output_set_last_error(out->output, error.c_str());
+        obs_output_signal_stop(out->output, code);
+    }
+}
+
+void WriteLoop(FileOutput* out) {
+    SetTraceThreadName("file writer");
+    AVPacket* packet = av_packet_alloc();
+    uint64_t closed_bytes = 0;
+    QueuedPacket queued;
+    while (out->queue->pop(queued)) {
+        TraceSpan span(kTraceFrames, "file_write");
+        int64_t time_us = av_rescale_q(queued.dts, queued.time_base, AV_TIME_BASE_Q);
+        if (out->file.start_us == kNoTime) {
+            out->file.start_us = time_us;
+        }
+
+        // Splits land on a video keyframe (any packet without video)
+        bool split_point = queued.keyframe && (queued.stream == out->video_stream || out->video_stream < 0);
+        if (out->split && split_point && time_us > out->file.start_us &&
+            ((out->max_time_us > 0 && time_us - out->file.start_us >= out->max_time_us) ||
+             (out->max_bytes > 0 && static_cast<int64_t>(FileSize(out->file)) >= out->max_bytes))) {
+            std::string next = NextFilePath(out);
+            closed_bytes += CloseFile(out->file);
+            std::string error;
+            if (!OpenFile(out, next, error)) {
+                Fail(out, error, OBS_OUTPUT_ERROR);
+                break;
+            }
+            out->file.start_us = time_us;
+            out->file.offset_us = time_us;
+            SignalFileChanged(out, next);
+        }
+
+        queued.fill(out->file.format, packet);
+        if (out->file.offset_us) {
+            int64_t offset = av_rescale_q(out->file.offset_us, AV_TIME_BASE_Q,
+                                          out->file.format->streams[queued.stream]->time_base);
+            packet->pts -= offset;
+            packet->dts -= offset;
+        }
+        // The packet is not reference counted, so the muxer copies the data
+        int ret = av_interleaved_write_frame(out->file.format, packet);
+        if (ret < 0) {
+            Fail(out, "write failed: " + AvError(ret), ret == AVERROR(ENOSPC) ? OBS_OUTPUT_NO_SPACE : OBS_OUTPUT_ERROR);
+            break;
+        }
+        out->bytes = closed_bytes + FileSize(out->file);
+    }
+    av_packet_free(&packet);
+    out->bytes = closed_bytes + CloseFile(out->file);
+}
+
+// Joins a writer thread that ended on its own or was stopped
+void JoinWriter(FileOutput* out) {
+    if (out->thread.joinable()) {
+        out->thread.join();
+    }
+    CloseFile(out->file);
+}
+
+const char* GetName(void*) {
+    return "File (queued writer)";
+}
+
+void* Create(obs_data_t*, obs_output_t* output) {
+    FileOutput* out = new FileOutput();
+    out->output = output;
+    signal_handler_add(obs_output_get_signal_handler(output), "void file_changed(ptr output, string next_file)");
+    return out;
+}
+
+void Destroy(void* data) {
+    FileOutput* out = static_cast<FileOutput*>(data);
+    if (out->queue) {
+        out->queue->close();
+    }
+    JoinWriter(out);
+    delete out;
+}
+
+void GetDefaults(obs_data_t* settings) {
+    obs_data_set_default_bool(settings, "allow_spaces", true);
+    obs_data_set_default_int(settings, "queue_packets", 1024);
+    obs_data_set_default_int(settings, "queue_mb", 64);
+}
+
+bool Start(void* data) {
+    FileOutput* out = static_cast<FileOutput*>(data);
+    obs_output_t* output = out->output;
+    JoinWriter(out);
+
+    if (!obs_output_can_begin_data_capture(output, 0) || !obs_output_initialize_encoders(output, 0)) {
+        return false;
+    }
+
+    obs_data_t* settings = obs_output_get_settings(output);
+    std::string path = obs_data_get_string(settings, "path");
+    out->split = obs_data_get_bool(settings, "split_file");
+    out->max_time_us = std::max<long long>(0, obs_data_get_int(settings, "max_time_sec")) * 1000000;
+    out->max_bytes = std::max<long long>(0, obs_data_get_int(settings, "max_size_mb")) * 1024 * 1024;
+    out->directory = obs_data_get_string(settings, "directory");
+    out->name_format = obs_data_get_string(settings, "format");
+    out->extension = obs_data_get_string(settings, "extension");
+    out->allow_spaces = obs_data_get_bool(settings, "allow_spaces");
+    size_t queue_packets = static_cast<size_t>(std::max<long long>(1, obs_data_get_int(settings, "queue_packets")));
+    size_t queue_bytes = static_cast<size_t>(std::max<long long>(1, obs_data_get_int(settings, "queue_mb"))) * 1024 * 1024;
+    obs_data_release(settings);
+    out->split = out->split && (out->max_time_us > 0 || out->max_bytes > 0);
+
+    obs_encoder_t* video = obs_output_get_video_encoder(output);
+    obs_encoder_t* audio = obs_output_get_audio_encoder(output, 0);
+    out->video.reset();
+    out->audio.reset();
+    if ((video && !out->video.describe(video)) || (audio && !out->audio.describe(audio))) {
+        obs_output_set_last_error(output, "unsupported codec for a file");
+        return false;
+    }
+    int next_stream = 0;
+    out->video_stream = video ? next_stream++ : -1;
+    out->audio_stream = audio ? next_stream++ : -1;
+
+    // The first file is opened here so a bad path fails the start
+    std::string error;
+    if (!OpenFile(out, path, error)) {
+        LogError() << "File output: " << error;
+        obs_output_set_last_error(output, error.c_str());
+        return false;
+    }
+
+    out->queue = std::make_unique<PacketQueue<QueuedPacket>>(queue_packets, queue_bytes);
+    out->dropped = 0;
+    out->bytes = 0;
+    out->active = true;
+    out->thread = std::thread([out] { WriteLoop(out); });
+    obs_output_begin_data_capture(output, 0);
+    return true;
+}
+
+void Stop(void* data, uint64_t) {
+    FileOutput* out = static_cast<FileOutput*>(data);
+    bool was_active = out->active.exchange(false);
+    if (out->queue) {
+        // The writer finishes what is queued, which the queue limits bound,
+        // and then the file
+        out->queue->close();
+    }
+    JoinWriter(out);
+    if (was_active) {
+        obs_output_end_data_capture(out->output);
+    }
+}
+
+void EncodedPacket(void* data, struct encoder_packet* packet) {
+    FileOutput* out = static_cast<FileOutput*>(data);
+    if (!packet) {
+        // The encoder failed
+        if (out->active.exchange(false)) {
+            out->queue->close();
+            obs_output_signal_stop(out->output, OBS_OUTPUT_ENCODE_ERROR);
+        }
+        return;
+    }
+    if (!out->active) {
+        return;
+    }
+
+    int index = packet->type == OBS_ENCODER_VIDEO ? out->video_stream : out->audio_stream;
+    if (index < 0) {
+        return;
+    }
+    QueuedPacket queued;
+    queued.assign(packet, index);
+    bool keyframe = queued.keyframe;
+    if (!out->queue->push(std::move(queued), packet->size, keyframe, index)) {
+        out->dropped++;
+    }
+}
+
+uint64_t GetTotalBytes(void* data) {
+    return static_cast<FileOutput*>(data)->bytes;
+}
+
+int GetDroppedFrames(void* data) {
+    return static_cast<FileOutput*>(data)->dropped;
+}
+
+} // namespace
+
+void RegisterFileOutput() {
+    struct obs_output_info info = {};
+    info.id = kFileOutputId;
+    info.flags = OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED;
+    info.encoded_video_codecs = "h264;hevc;av1";
+    info.encoded_audio_codecs = "aac;opus";
+    info.get_name = GetName;
+    info.create = Create;
+    info.destroy = Destroy;
+    info.start = Start;
+    info.stop = Stop;
+    info.encoded_packet = EncodedPacket;
+    info.get_defaults = GetDefaults;
+    info.get_total_bytes = GetTotalBytes;
+    info.get_dropped_frames = GetDroppedFrames;
+    obs_register_output(&info);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+// File output, registered with libobs as "addon_file_output". Takes the
+// place of ffmpeg_muxer for recordings, file and segment outputs.
+//
+// libobs hands packets to each output's encoded_packet in turn on the
+// encoder thread, and ffmpeg_muxer writes them into the ffmpeg-mux pipe
+// from there, so one slow disk would stall the shared encoders and every
+// other output. Here encoded_packet only copies each packet into a bounded
+// PacketQueue and a writer thread muxes with libavformat; a writer that
+// falls behind costs this output dropped packets (its dropped frames), up
+// to the next keyframe. A write error stops the output with OBS_OUTPUT_ERROR.
+// Stopping drains the queue and finishes the file.
+//
+// Takes ffmpeg_muxer's settings: path, and for file splitting split_file,
+// max_time_sec, max_size_mb, directory, format, extension and allow_spaces,
+// with the same "file_changed" signal as each file is closed (new files
+// start on a keyframe with zero-based timestamps). Plus:
+//
+//   queue_packets   writer queue limits
+//   queue_mb
+//
+// The container follows the file extension (Matroska when unknown). Only
+// built with libav (HAVE_STREAM_OUTPUT).
+extern const char* const kFileOutputId;
+
+// Call once after obs_startup
+void RegisterFileOutput();
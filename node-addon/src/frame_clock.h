@@ -0,0 +1,56 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Fixed-rate capture schedule on the monotonic clock. Deadlines are derived
+// from the start time and the tick number, not from the previous wake-up,
+// so sleep overshoot never accumulates into drift. After a stall, the most
+// recent due tick is captured at once and older ones are skipped instead of
+// being captured late in a burst. The tick is also the frame's pts in a
+// 1/fps timebase.
+class FrameClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FrameClock(int fps, Clock::time_point start) : fps_(fps > 0 ? fps : 1), start_(start) {}
+
+    int64_t tick() const { return tick_; }
+
+    Clock::time_point deadline() const { return deadlineOf(tick_); }
+
+    // Moves past the current tick; returns how many ticks were skipped
+    int64_t advance(Clock::time_point now) {
+        int64_t next = tick_ + 1;
+        int64_t due = dueTick(now);
+        int64_t skipped = 0;
+        if (due > next) {
+            skipped = due - next;
+            next = due;
+        }
+        tick_ = next;
+        return skipped;
+    }
+
+private:
+    Clock::time_point deadlineOf(int64_t tick) const {
+        return start_ + std::chrono::nanoseconds(tick * 1000000000LL / fps_);
+    }
+
+    // Latest tick whose deadline is not after `now`
+    int64_t dueTick(Clock::time_point now) const {
+        int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_).count();
+        if (elapsed < 0) {
+            return 0;
+        }
+        int64_t tick = elapsed * fps_ / 1000000000LL;
+        // Integer rounding in deadlineOf can put the deadline just past `now`
+        while (tick > 0 && deadlineOf(tick) > now) {
+            tick--;
+        }
+        return tick;
+    }
+
+    int64_t fps_;
+    Clock::time_point start_;
+    int64_t tick_ = 0;
+};
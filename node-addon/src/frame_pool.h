@@ -0,0 +1,118 @@
+#pragma once
+#include "memory_stats.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+class FramePool;
+
+inline uint8_t* AllocFrameMemory(size_t size) {
+    // 64-byte alignment keeps SIMD consumers on the fast path
+    size_t padded = (size + 63) & ~static_cast<size_t>(63);
+#ifdef _WIN32
+    return static_cast<uint8_t*>(_aligned_malloc(padded, 64));
+#else
+    return static_cast<uint8_t*>(std::aligned_alloc(64, padded));
+#endif
+}
+
+inline void FreeFrameMemory(uint8_t* data) {
+#ifdef _WIN32
+    _aligned_free(data);
+#else
+    std::free(data);
+#endif
+}
+
+// One fixed-size, refcounted frame buffer owned by a FramePool. A buffer is
+// handed out with a single reference; whoever drops the last reference
+// returns it to the pool.
+struct FrameBuffer {
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    std::atomic<int> refs{0};
+    std::shared_ptr<FramePool> pool; // keeps the pool alive while in use
+};
+
+// Preallocated pool of equally sized frame buffers. Acquire/release never
+// allocate, so the capture path stays malloc-free once the pool exists.
+class FramePool : public std::enable_shared_from_this<FramePool> {
+public:
+    static std::shared_ptr<FramePool> Create(size_t buffer_size, size_t count) {
+        return std::shared_ptr<FramePool>(new FramePool(buffer_size, count));
+    }
+
+    ~FramePool() {
+        for (auto& buffer : buffers_) {
+            FreeFrameMemory(buffer->data);
+        }
+    }
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // Returns nullptr when every buffer is in use
+    FrameBuffer* acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.empty()) {
+            return nullptr;
+        }
+        FrameBuffer* buffer = free_.back();
+        free_.pop_back();
+        buffer->refs.store(1, std::memory_order_relaxed);
+        buffer->pool = shared_from_this();
+        return buffer;
+    }
+
+    static void addRef(FrameBuffer* buffer) {
+        buffer->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void release(FrameBuffer* buffer) {
+        if (buffer->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        // Move the owner reference out first: it may be the last one
+        std::shared_ptr<FramePool> pool = std::move(buffer->pool);
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex_);
+            pool->free_.push_back(buffer);
+        }
+    }
+
+    size_t bufferSize() const { return buffer_size_; }
+    size_t capacity() const { return buffers_.size(); }
+    size_t bytesReserved() const { return buffer_size_ * buffers_.size(); }
+
+    size_t available() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return free_.size();
+    }
+
+private:
+    FramePool(size_t buffer_size, size_t count) : buffer_size_(buffer_size) {
+        buffers_.reserve(count);
+        free_.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto buffer = std::make_unique<FrameBuffer>();
+            buffer->data = AllocFrameMemory(buffer_size);
+            buffer->size = buffer_size;
+            free_.push_back(buffer.get());
+            buffers_.push_back(std::move(buffer));
+        }
+        charge_.set(bytesReserved());
+    }
+
+    size_t buffer_size_;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<FrameBuffer>> buffers_;
+    std::vector<FrameBuffer*> free_;
+    MemoryCharge charge_{MemoryStage::FrameTaps};
+};
@@ -0,0 +1,293 @@
+#include "frame_tap.h"
+#include "addon_env.h"
+#include "frame_pool.h"
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace {
+
+struct PendingFrame {
+    FrameBuffer* buffer = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    FrameFormat format = FrameFormat::BGRA;
+    uint64_t timestamp = 0;
+};
+
+} // namespace
+
+static void DeliverFrames(Napi::Env env, Napi::Function callback, JsFrameTap* tap, JsFrameTap*);
+static void CloseFrameTap(JsFrameTap* tap);
+using FrameTsfn = Napi::TypedThreadSafeFunction<JsFrameTap, JsFrameTap, DeliverFrames>;
+
+// Bridges OBS raw frames to a JS callback. Frames are copied once out of the
+// OBS staging surface into a pooled buffer, queued in a fixed ring, and handed
+// to JS as external ArrayBuffers that return the buffer to the pool when
+// collected. When JS falls behind, the oldest queued frame is dropped.
+class JsFrameTap {
+public:
+    JsFrameTap(size_t queue_size, size_t pool_size)
+        : ring_(queue_size), pool_size_(pool_size) {}
+
+    ~JsFrameTap() {
+        PendingFrame frame;
+        while (pop(frame)) {
+            FramePool::release(frame.buffer);
+        }
+    }
+
+    // Video thread
+    void push(const VideoFrame& frame) {
+        FrameLayout layout = GetFrameLayout(frame.format, frame.width, frame.height);
+        if (!pool_ || pool_->bufferSize() != layout.size) {
+            pool_ = FramePool::Create(layout.size, pool_size_);
+        }
+
+        FrameBuffer* buffer = pool_->acquire();
+        if (!buffer) {
+            // Every buffer is either queued or held by JS: recycle the oldest
+            // queued one, or drop this frame if JS holds them all
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (count_ == 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            buffer = ring_[head_].buffer;
+            head_ = (head_ + 1) % ring_.size();
+            count_--;
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        for (int i = 0; i < layout.planes; ++i) {
+            uint8_t* dst = buffer->data + layout.offset[i];
+            const uint8_t* src = frame.data[i];
+            if (frame.linesize[i] == layout.stride[i]) {
+                std::memcpy(dst, src, static_cast<size_t>(layout.stride[i]) * layout.rows[i]);
+            } else {
+                for (uint32_t row = 0; row < layout.rows[i]; ++row) {
+                    std::memcpy(dst + static_cast<size_t>(row) * layout.stride[i],
+                                src + static_cast<size_t>(row) * frame.linesize[i],
+                                layout.stride[i]);
+                }
+            }
+        }
+
+        PendingFrame pending;
+        pending.buffer = buffer;
+        pending.width = frame.width;
+        pending.height = frame.height;
+        pending.format = frame.format;
+        pending.timestamp = frame.timestamp;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (count_ == ring_.size()) {
+                FramePool::release(ring_[head_].buffer);
+                head_ = (head_ + 1) % ring_.size();
+                count_--;
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+            ring_[(head_ + count_) % ring_.size()] = pending;
+            count_++;
+        }
+
+        // At most one delivery is queued on the TSFN at a time
+        if (!delivery_scheduled_.exchange(true)) {
+            if (tsfn.NonBlockingCall(this) != napi_ok) {
+                delivery_scheduled_ = false;
+            }
+        }
+    }
+
+    // JS thread
+    void deliver(Napi::Env env, Napi::Function callback) {
+        delivery_scheduled_ = false;
+
+        PendingFrame frame;
+        while (pop(frame)) {
+            if (env == nullptr || callback.IsEmpty()) {
+                FramePool::release(frame.buffer);
+                continue;
+            }
+
+            Napi::ArrayBuffer data = Napi::ArrayBuffer::New(env, frame.buffer->data, frame.buffer->size,
+                [](Napi::Env, void*, FrameBuffer* buffer) { FramePool::release(buffer); },
+                frame.buffer);
+
+            FrameLayout layout = GetFrameLayout(frame.format, frame.width, frame.height);
+            Napi::Array offsets = Napi::Array::New(env, layout.planes);
+            Napi::Array strides = Napi::Array::New(env, layout.planes);
+            for (int i = 0; i < layout.planes; ++i) {
+                offsets.Set(static_cast<uint32_t>(i), Napi::Number::New(env, static_cast<double>(layout.offset[i])));
+                strides.Set(static_cast<uint32_t>(i), Napi::Number::New(env, layout.stride[i]));
+            }
+
+            Napi::Object obj = Napi::Object::New(env);
+            obj.Set("data", data);
+            obj.Set("width", frame.width);
+            obj.Set("height", frame.height);
+            obj.Set("format", FrameFormatName(frame.format));
+            obj.Set("timestamp", Napi::Number::New(env, static_cast<double>(frame.timestamp)));
+            obj.Set("offsets", offsets);
+            obj.Set("strides", strides);
+            obj.Set("dropped", Napi::Number::New(env, static_cast<double>(dropped())));
+
+            delivered_.fetch_add(1, std::memory_order_relaxed);
+            callback.Call({obj});
+        }
+    }
+
+    uint64_t delivered() const { return delivered_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    FrameTsfn tsfn;
+    int obs_tap_id = -1;
+    AddonEnv* owner = nullptr;
+    // Closes the tap if its environment exits first
+    Napi::Env::CleanupHook<void (*)(JsFrameTap*), JsFrameTap> cleanup;
+
+private:
+    bool pop(PendingFrame& frame) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (count_ == 0) {
+            return false;
+        }
+        frame = ring_[head_];
+        head_ = (head_ + 1) % ring_.size();
+        count_--;
+        return true;
+    }
+
+    std::shared_ptr<FramePool> pool_; // only touched on the video thread
+    std::mutex mutex_;
+    std::vector<PendingFrame> ring_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    size_t pool_size_;
+    std::atomic<bool> delivery_scheduled_{false};
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+static void DeliverFrames(Napi::Env env, Napi::Function callback, JsFrameTap* tap, JsFrameTap*) {
+    tap->deliver(env, callback);
+}
+
+// Stops the video thread first; the TSFN finalizer then frees the tap after
+// any delivery already queued has run
+static void CloseFrameTap(JsFrameTap* tap) {
+    OBSManager::getInstance().removeFrameTap(tap->obs_tap_id);
+    tap->owner->frame_taps.erase(tap->obs_tap_id);
+    tap->tsfn.Release();
+}
+
+int GetIntOption(const Napi::Object& opts, const char* key, int fallback) {
+    if (opts.Has(key) && opts.Get(key).IsNumber()) {
+        return opts.Get(key).As<Napi::Number>().Int32Value();
+    }
+    return fallback;
+}
+
+bool ParseFrameTapOptions(Napi::Env env, const Napi::Object& opts, FrameTapConfig& config) {
+    if (opts.Has("format")) {
+        std::string name = opts.Get("format").As<Napi::String>();
+        if (!ParseFrameFormat(name, config.format)) {
+            Napi::TypeError::New(env, "Unsupported frame format: " + name).ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    config.width = GetIntOption(opts, "width", 0);
+    config.height = GetIntOption(opts, "height", 0);
+    config.max_fps = GetIntOption(opts, "maxFps", 0);
+    return true;
+}
+
+Napi::Value OnFrame(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsFunction()) {
+        Napi::TypeError::New(env, "Frame callback required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    FrameTapConfig config;
+    int queue_size = 2;
+    int pool_size = 6;
+
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object opts = info[1].As<Napi::Object>();
+        if (!ParseFrameTapOptions(env, opts, config)) {
+            return env.Undefined();
+        }
+        queue_size = GetIntOption(opts, "queueSize", queue_size);
+        pool_size = GetIntOption(opts, "poolSize", pool_size);
+    }
+
+    if (queue_size < 1 || pool_size < queue_size + 1) {
+        Napi::RangeError::New(env, "poolSize must exceed queueSize").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    auto* tap = new JsFrameTap(queue_size, pool_size);
+    tap->tsfn = FrameTsfn::New(env, info[0].As<Napi::Function>(), "obs_frame_tap", 0, 1, tap,
+        [](Napi::Env, JsFrameTap* tap) { delete tap; });
+    // A listener should not keep the process alive on its own
+    tap->tsfn.Unref(env);
+
+    tap->obs_tap_id = OBSManager::getInstance().addFrameTap(config,
+        [tap](const VideoFrame& frame) { tap->push(frame); });
+
+    if (tap->obs_tap_id < 0) {
+        tap->tsfn.Release();
+        Napi::Error::New(env, "Frame taps require an initialized OBS core").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    // Registered after the TSFN, so it runs before the TSFN is torn down
+    tap->owner = &GetAddonEnv(env);
+    tap->owner->frame_taps[tap->obs_tap_id] = tap;
+    tap->cleanup = env.AddCleanupHook(CloseFrameTap, tap);
+    return Napi::Number::New(env, tap->obs_tap_id);
+}
+
+Napi::Value OffFrame(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Frame tap id required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    // Only this environment's taps
+    std::map<int, JsFrameTap*>& taps = GetAddonEnv(env).frame_taps;
+    auto it = taps.find(info[0].As<Napi::Number>().Int32Value());
+    if (it == taps.end()) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    JsFrameTap* tap = it->second;
+    tap->cleanup.Remove(env);
+    CloseFrameTap(tap);
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value GetFrameTapStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Frame tap id required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::map<int, JsFrameTap*>& taps = GetAddonEnv(env).frame_taps;
+    auto it = taps.find(info[0].As<Napi::Number>().Int32Value());
+    if (it == taps.end()) {
+        return env.Undefined();
+    }
+
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("delivered", Napi::Number::New(env, static_cast<double>(it->second->delivered())));
+    stats.Set("dropped", Napi::Number::New(env, static_cast<double>(it->second->dropped())));
+    return stats;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <napi.h>
+#include "obs_wrapper.h"
+
+// JS bindings for raw frame taps:
+//   onFrame(callback, { format, width, height, maxFps, queueSize, poolSize }) -> id
+//   offFrame(id)
+//   getFrameTapStats(id) -> { delivered, dropped }
+Napi::Value OnFrame(const Napi::CallbackInfo& info);
+Napi::Value OffFrame(const Napi::CallbackInfo& info);
+Napi::Value GetFrameTapStats(const Napi::CallbackInfo& info);
+
+// Reads { format, width, height, maxFps } into `config`. Throws a JS
+// exception and returns false on invalid input.
+bool ParseFrameTapOptions(Napi::Env env, const Napi::Object& opts, FrameTapConfig& config);
+
+// Reads an optional integer option
+int GetIntOption(const Napi::Object& opts, const char* key, int fallback);
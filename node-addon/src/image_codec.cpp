@@ -0,0 +1,157 @@
+#include "image_codec.h"
+#include "log_sink.h"
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef HAVE_PNG
+#include <png.h>
+#endif
+
+#ifdef HAVE_JPEG
+#include <jpeglib.h>
+#endif
+
+#ifdef HAVE_PNG
+namespace {
+
+void AppendPngData(png_structp png, png_bytep data, png_size_t length) {
+    auto* out = static_cast<std::vector<uint8_t>*>(png_get_io_ptr(png));
+    out->insert(out->end(), data, data + length);
+}
+
+void FlushPngData(png_structp) {}
+
+} // namespace
+#endif
+
+bool EncodePng(const uint8_t* pixels, int width, int height, FrameFormat format, std::vector<uint8_t>& out) {
+#ifdef HAVE_PNG
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png ? png_create_info_struct(png) : nullptr;
+    if (!info) {
+        png_destroy_write_struct(&png, nullptr);
+        return false;
+    }
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        return false;
+    }
+
+    out.clear();
+    png_set_write_fn(png, &out, AppendPngData, FlushPngData);
+    png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    // Screen content is mostly flat colour: the cheapest filter and zlib
+    // level give files close to the defaults in a fraction of the time
+    png_set_filter(png, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB);
+    png_set_compression_level(png, 1);
+    png_write_info(png, info);
+    if (format == FrameFormat::BGRA) {
+        png_set_bgr(png);
+    }
+
+    const size_t stride = static_cast<size_t>(width) * 4;
+    for (int row = 0; row < height; ++row) {
+        png_write_row(png, const_cast<png_bytep>(pixels + row * stride));
+    }
+    png_write_end(png, nullptr);
+    png_destroy_write_struct(&png, &info);
+    return true;
+#else
+    (void)pixels;
+    (void)width;
+    (void)height;
+    (void)format;
+    (void)out;
+    return false;
+#endif
+}
+
+#ifdef HAVE_JPEG
+namespace {
+
+// libjpeg's default error handler exits the process
+struct JpegError {
+    jpeg_error_mgr manager;
+    jmp_buf jump;
+};
+
+void JpegErrorExit(j_common_ptr cinfo) {
+    char message[JMSG_LENGTH_MAX];
+    cinfo->err->format_message(cinfo, message);
+    LogError() << "JPEG encode failed: " << message;
+    longjmp(reinterpret_cast<JpegError*>(cinfo->err)->jump, 1);
+}
+
+} // namespace
+#endif
+
+bool EncodeJpeg(const uint8_t* pixels, int width, int height, FrameFormat format, int quality,
+                std::vector<uint8_t>& out) {
+#ifdef HAVE_JPEG
+    jpeg_compress_struct cinfo;
+    JpegError error;
+    cinfo.err = jpeg_std_error(&error.manager);
+    error.manager.error_exit = JpegErrorExit;
+    unsigned char* buffer = nullptr;
+    unsigned long size = 0;
+#ifndef JCS_EXTENSIONS
+    // Declared before setjmp so an error does not skip its destructor
+    std::vector<uint8_t> rgb(static_cast<size_t>(width) * 3);
+#endif
+    if (setjmp(error.jump)) {
+        jpeg_destroy_compress(&cinfo);
+        free(buffer);
+        return false;
+    }
+
+    jpeg_create_compress(&cinfo);
+    jpeg_mem_dest(&cinfo, &buffer, &size);
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    // libjpeg-turbo reads 32-bit pixels directly; plain libjpeg needs RGB rows
+#ifdef JCS_EXTENSIONS
+    cinfo.input_components = 4;
+    cinfo.in_color_space = format == FrameFormat::BGRA ? JCS_EXT_BGRX : JCS_EXT_RGBX;
+#else
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+#endif
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, quality, TRUE);
+    cinfo.dct_method = JDCT_IFAST;
+    jpeg_start_compress(&cinfo, TRUE);
+
+    const size_t stride = static_cast<size_t>(width) * 4;
+    while (cinfo.next_scanline < cinfo.image_height) {
+        const uint8_t* src = pixels + cinfo.next_scanline * stride;
+#ifdef JCS_EXTENSIONS
+        JSAMPROW row = const_cast<JSAMPROW>(src);
+#else
+        const int red = format == FrameFormat::BGRA ? 2 : 0;
+        for (int x = 0; x < width; ++x) {
+            rgb[x * 3] = src[x * 4 + red];
+            rgb[x * 3 + 1] = src[x * 4 + 1];
+            rgb[x * 3 + 2] = src[x * 4 + 2 - red];
+        }
+        JSAMPROW row = rgb.data();
+#endif
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+
+    out.assign(buffer, buffer + size);
+    free(buffer);
+    return true;
+#else
+    (void)pixels;
+    (void)width;
+    (void)height;
+    (void)format;
+    (void)quality;
+    (void)out;
+    return false;
+#endif
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "video_frame.h"
+
+// Still-image compression for screenshots. Input is tightly packed BGRA or
+// RGBA; alpha is kept in PNG and dropped in JPEG. Each returns false when
+// the addon was built without the library (HAVE_PNG / HAVE_JPEG) or the
+// encoder fails. Safe to call from several threads at once.
+bool EncodePng(const uint8_t* pixels, int width, int height, FrameFormat format, std::vector<uint8_t>& out);
+bool EncodeJpeg(const uint8_t* pixels, int width, int height, FrameFormat format, int quality,
+                std::vector<uint8_t>& out);
@@ -0,0 +1,115 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Fixed-bucket latency histogram that can be recorded into from any thread
+// without locks. Values are microseconds: below 16 us buckets are exact,
+// above that each power of two is split into 8 buckets (worst case 12.5%
+// error). Recording is two relaxed atomic adds plus a rarely-taken CAS for
+// the maximum, so it is safe on the video and encoder threads.
+class LatencyHistogram {
+public:
+    static constexpr int kLinearBuckets = 16;
+    static constexpr int kSubBuckets = 8;
+    static constexpr int kBuckets = kLinearBuckets + (64 - 4) * kSubBuckets;
+
+    struct Summary {
+        uint64_t count = 0;
+        double mean_ms = 0;
+        double p50_ms = 0;
+        double p90_ms = 0;
+        double p99_ms = 0;
+        double max_ms = 0;
+    };
+
+    void record(uint64_t ns) {
+        uint64_t us = ns / 1000;
+        counts_[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+        total_us_.fetch_add(us, std::memory_order_relaxed);
+
+        uint64_t max = max_us_.load(std::memory_order_relaxed);
+        while (us > max && !max_us_.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Not atomic with respect to concurrent record() calls; a sample landing
+    // mid-reset is either kept or lost, which is fine for statistics
+    void reset() {
+        for (auto& count : counts_) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        total_us_.store(0, std::memory_order_relaxed);
+        max_us_.store(0, std::memory_order_relaxed);
+    }
+
+    Summary summarize() const {
+        uint64_t counts[kBuckets];
+        Summary summary;
+        for (int i = 0; i < kBuckets; ++i) {
+            counts[i] = counts_[i].load(std::memory_order_relaxed);
+            summary.count += counts[i];
+        }
+        if (summary.count == 0) {
+            return summary;
+        }
+
+        summary.mean_ms = static_cast<double>(total_us_.load(std::memory_order_relaxed)) / summary.count / 1000.0;
+        summary.max_ms = static_cast<double>(max_us_.load(std::memory_order_relaxed)) / 1000.0;
+        summary.p50_ms = percentile(counts, summary.count, 0.50);
+        summary.p90_ms = percentile(counts, summary.count, 0.90);
+        summary.p99_ms = percentile(counts, summary.count, 0.99);
+        return summary;
+    }
+
+    static int bucketFor(uint64_t us) {
+        if (us < kLinearBuckets) {
+            return static_cast<int>(us);
+        }
+        int msb = HighestBit(us);
+        int sub = static_cast<int>((us >> (msb - 3)) & (kSubBuckets - 1));
+        return kLinearBuckets + (msb - 4) * kSubBuckets + sub;
+    }
+
+    // Midpoint of a bucket's value range, in microseconds
+    static double bucketValue(int bucket) {
+        if (bucket < kLinearBuckets) {
+            return bucket;
+        }
+        int msb = 4 + (bucket - kLinearBuckets) / kSubBuckets;
+        int sub = (bucket - kLinearBuckets) % kSubBuckets;
+        double width = static_cast<double>(uint64_t(1) << (msb - 3));
+        double lower = (kSubBuckets + sub) * width;
+        return lower + (width - 1) / 2;
+    }
+
+private:
+    static int HighestBit(uint64_t value) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+
+    static double percentile(const uint64_t* counts, uint64_t total, double fraction) {
+        uint64_t rank = static_cast<uint64_t>(fraction * (total - 1)) + 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < kBuckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return bucketValue(i) / 1000.0;
+            }
+        }
+        return bucketValue(kBuckets - 1) / 1000.0;
+    }
+
+    std::atomic<uint64_t> counts_[kBuckets] = {};
+    std::atomic<uint64_t> total_us_{0};
+    std::atomic<uint64_t> max_us_{0};
+};
@@ -0,0 +1,200 @@
+#include "log_sink.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+uint64_t WallClockMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// libobs uses levels between the named ones for its own purposes; map them
+// down to the next named level
+LogLevel FromObsLevel(int level) {
+    if (level <= static_cast<int>(LogLevel::Error)) return LogLevel::Error;
+    if (level <= static_cast<int>(LogLevel::Warning)) return LogLevel::Warning;
+    if (level <= static_cast<int>(LogLevel::Info)) return LogLevel::Info;
+    return LogLevel::Debug;
+}
+
+} // namespace
+
+const char* LogLevelName(LogLevel level) {
+    switch (level) {
+    case LogLevel::Error: return "error";
+    case LogLevel::Warning: return "warning";
+    case LogLevel::Debug: return "debug";
+    case LogLevel::Info:
+    default: return "info";
+    }
+}
+
+LogSink& LogSink::instance() {
+    // Leaked on purpose: static destructors that run after it would be gone
+    // (OBSManager's shuts OBS down) still log
+    static LogSink* sink = new LogSink();
+    return *sink;
+}
+
+LogSink::LogSink() : slots_(new Slot[kCapacity]) {
+    for (size_t i = 0; i < kCapacity; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+LogSink::Slot* LogSink::claim() {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot* slot = &slots_[pos & (kCapacity - 1)];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                return slot;
+            }
+        } else if (diff < 0) {
+            // The writer has not freed this slot yet: the queue is full
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void LogSink::commit(Slot* slot) {
+    // The slot's turn number is its claimed position; publish it as ready
+    size_t pos = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    // Never blocks; a missed wake-up is picked up by the writer's timeout
+    wake_.notify_one();
+}
+
+void LogSink::write(LogLevel level, bool from_obs, const char* message) {
+    if (!enabled(level)) {
+        return;
+    }
+    Slot* slot = claim();
+    if (!slot) {
+        return;
+    }
+    slot->level = level;
+    slot->from_obs = from_obs;
+    slot->time_ms = WallClockMs();
+    std::strncpy(slot->message, message, kMessageSize - 1);
+    slot->message[kMessageSize - 1] = '\0';
+    commit(slot);
+}
+
+void LogSink::writeFormat(LogLevel level, bool from_obs, const char* format, va_list args) {
+    if (!enabled(level)) {
+        return;
+    }
+    Slot* slot = claim();
+    if (!slot) {
+        return;
+    }
+    slot->level = level;
+    slot->from_obs = from_obs;
+    slot->time_ms = WallClockMs();
+    std::vsnprintf(slot->message, kMessageSize, format, args);
+    commit(slot);
+}
+
+void LogSink::obsLogHandler(int level, const char* format, va_list args, void* param) {
+    (void)param;
+    LogSink::instance().writeFormat(FromObsLevel(level), true, format, args);
+}
+
+bool LogSink::setFile(const std::string& path) {
+    FILE* file = nullptr;
+    if (!path.empty()) {
+        file = std::fopen(path.c_str(), "a");
+        if (!file) {
+            return false;
+        }
+    }
+    flush();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_) {
+        std::fclose(file_);
+    }
+    file_ = file;
+    return true;
+}
+
+void LogSink::setHandler(LogHandler handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    handler_ = std::move(handler);
+}
+
+void LogSink::flush(int timeout_ms) {
+    size_t target = enqueue_pos_.load(std::memory_order_acquire);
+    wake_.notify_one();
+    std::unique_lock<std::mutex> lock(mutex_);
+    written_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this, target] {
+        return dequeue_pos_.load(std::memory_order_acquire) >= target;
+    });
+}
+
+void LogSink::run() {
+    std::vector<LogEntry> batch;
+    for (;;) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos & (kCapacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+            LogEntry entry;
+            entry.level = slot.level;
+            entry.from_obs = slot.from_obs;
+            entry.time_ms = slot.time_ms;
+            entry.message = slot.message;
+            batch.push_back(std::move(entry));
+            // Hand the slot back for the producer one lap ahead
+            slot.sequence.store(pos + kCapacity, std::memory_order_release);
+            pos++;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!batch.empty()) {
+            output(batch);
+            batch.clear();
+        }
+        dequeue_pos_.store(pos, std::memory_order_release);
+        written_.notify_all();
+
+        Slot& next = slots_[pos & (kCapacity - 1)];
+        wake_.wait_for(lock, std::chrono::milliseconds(50), [&next, pos] {
+            return next.sequence.load(std::memory_order_acquire) == pos + 1;
+        });
+    }
+}
+
+void LogSink::output(const std::vector<LogEntry>& batch) {
+    if (console_.load(std::memory_order_relaxed)) {
+        for (const LogEntry& entry : batch) {
+            std::ostream& out = entry.level <= LogLevel::Warning ? std::cerr : std::cout;
+            out << (entry.from_obs ? "[obs] " : "") << entry.message << '\n';
+        }
+        std::cout.flush();
+        std::cerr.flush();
+    }
+
+    if (file_) {
+        for (const LogEntry& entry : batch) {
+            std::fprintf(file_, "%llu %s %s %s\n", static_cast<unsigned long long>(entry.time_ms),
+                         LogLevelName(entry.level), entry.from_obs ? "obs" : "addon", entry.message.c_str());
+        }
+        std::fflush(file_);
+    }
+
+    if (handler_) {
+        handler_(batch);
+    }
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include "memory_stats.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Same values as libobs' LOG_ERROR ... LOG_DEBUG
+enum class LogLevel : int {
+    Error = 100,
+    Warning = 200,
+    Info = 300,
+    Debug = 400
+};
+
+struct LogEntry {
+    LogLevel level = LogLevel::Info;
+    bool from_obs = false; // libobs and its plugins, via base_set_log_handler
+    uint64_t time_ms = 0;  // wall clock, ms since the epoch
+    std::string message;
+};
+
+// Called on the log writer thread with each batch of messages
+using LogHandler = std::function<void(const std::vector<LogEntry>&)>;
+
+// Asynchronous, level-filtered log for the addon and libobs. write() formats
+// into a fixed slot of a bounded lock-free queue and returns; a writer thread
+// prints to the console, appends to a file and/or hands batches to a
+// handler. Capture threads therefore never wait on a terminal, disk or JS.
+// When the queue is full, messages are dropped and counted.
+//
+// The sink is never destroyed, so objects torn down at exit can still log;
+// call flush() before exiting to get their messages out.
+class LogSink {
+public:
+    static LogSink& instance();
+
+    // Any thread; never blocks
+    bool enabled(LogLevel level) const {
+        return static_cast<int>(level) <= level_.load(std::memory_order_relaxed);
+    }
+    void write(LogLevel level, bool from_obs, const char* message);
+    void writeFormat(LogLevel level, bool from_obs, const char* format, va_list args);
+
+    void setLevel(LogLevel level) { level_.store(static_cast<int>(level), std::memory_order_relaxed); }
+    void setConsole(bool enabled) { console_.store(enabled, std::memory_order_relaxed); }
+    bool setFile(const std::string& path); // empty closes the file
+    void setHandler(LogHandler handler);   // nullptr removes it
+
+    // Waits (up to timeout_ms) until everything queued so far is written
+    void flush(int timeout_ms = 1000);
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // libobs log handler (log_handler_t); pass to base_set_log_handler
+    static void obsLogHandler(int level, const char* format, va_list args, void* param);
+
+private:
+    LogSink();
+
+    // Longer messages are truncated
+    static constexpr size_t kMessageSize = 480;
+    static constexpr size_t kCapacity = 1024;
+
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        LogLevel level = LogLevel::Info;
+        bool from_obs = false;
+        uint64_t time_ms = 0;
+        char message[kMessageSize];
+    };
+
+    Slot* claim();
+    void commit(Slot* slot);
+    void run();
+    void output(const std::vector<LogEntry>& batch);
+
+    // Bounded MPSC queue (Vyukov): a slot's sequence says whose turn it is
+    std::unique_ptr<Slot[]> slots_;
+    MemoryCharge charge_{MemoryStage::Log, kCapacity * sizeof(Slot)};
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::atomic<int> level_{static_cast<int>(LogLevel::Info)};
+    std::atomic<bool> console_{true};
+
+    std::mutex mutex_; // file_, handler_, wake-ups
+    std::condition_variable wake_;
+    std::condition_variable written_;
+    FILE* file_ = nullptr;
+    LogHandler handler_;
+    std::thread thread_;
+};
+
+// Stream-style message, queued when the statement ends:
+//   LogInfo() << "Pipeline prepared in " << ms << " ms";
+class LogLine {
+public:
+    explicit LogLine(LogLevel level) : level_(level), enabled_(LogSink::instance().enabled(level)) {}
+    ~LogLine() {
+        if (enabled_) {
+            LogSink::instance().write(level_, false, stream_.str().c_str());
+        }
+    }
+
+    template <typename T>
+    LogLine& operator<<(const T& value) {
+        if (enabled_) {
+            stream_ << value;
+        }
+        return *this;
+    }
+
+private:
+    LogLevel level_;
+    bool enabled_;
+    std::ostringstream stream_;
+};
+
+const char* LogLevelName(LogLevel level); // "error", "warning", "info", "debug"
+
+inline LogLine LogError() { return LogLine(LogLevel::Error); }
+inline LogLine LogWarning() { return LogLine(LogLevel::Warning); }
+inline LogLine LogInfo() { return LogLine(LogLevel::Info); }
+inline LogLine LogDebug() { return LogLine(LogLevel::Debug); }
@@ -0,0 +1,62 @@
+#include "memory_stats.h"
+
+#if defined(__linux__)
+#include <cstdio>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+namespace {
+
+std::atomic<int64_t> g_stage_bytes[static_cast<int>(MemoryStage::Count)];
+
+} // namespace
+
+uint64_t MemoryStageBytes(MemoryStage stage) {
+    int64_t bytes = g_stage_bytes[static_cast<int>(stage)].load(std::memory_order_relaxed);
+    return bytes > 0 ? static_cast<uint64_t>(bytes) : 0;
+}
+
+void MemoryCharge::set(size_t bytes) {
+    if (bytes == bytes_) {
+        return;
+    }
+    int64_t delta = static_cast<int64_t>(bytes) - static_cast<int64_t>(bytes_);
+    g_stage_bytes[static_cast<int>(stage_)].fetch_add(delta, std::memory_order_relaxed);
+    bytes_ = bytes;
+}
+
+uint64_t ProcessResidentBytes() {
+#if defined(__linux__)
+    // Second field of statm: resident pages
+    FILE* file = std::fopen("/proc/self/statm", "r");
+    if (!file) {
+        return 0;
+    }
+    unsigned long long size = 0;
+    unsigned long long resident = 0;
+    int fields = std::fscanf(file, "%llu %llu", &size, &resident);
+    std::fclose(file);
+    return fields == 2 ? resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) : 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) !=
+        KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.WorkingSetSize;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Process-wide accounting of the memory the addon allocates itself, by
+// pipeline stage, for getMemoryStats(). Buffers charge their stage for as
+// long as they exist through a MemoryCharge member; what lives inside
+// libobs and the encoders is estimated by OBSManager instead.
+enum class MemoryStage {
+    Capture,     // built-in backend: grabbed and scaled frames
+    Packets,     // encoded packets queued for writers (PacketQueue)
+    FrameTaps,   // pooled frames handed to JS
+    AudioTaps,   // audio blocks queued for JS
+    FrameExport, // shared-memory rings
+    Log,         // log sink queue
+    Trace,       // per-thread span buffers
+    Count
+};
+
+uint64_t MemoryStageBytes(MemoryStage stage);
+
+// Resident set size of the process in bytes, 0 where unknown
+uint64_t ProcessResidentBytes();
+
+// Charges `bytes` to a stage until destroyed or set again. Move-only, so a
+// charge follows the buffer it accounts for.
+class MemoryCharge {
+public:
+    explicit MemoryCharge(MemoryStage stage, size_t bytes = 0) : stage_(stage) { set(bytes); }
+    ~MemoryCharge() { set(0); }
+
+    MemoryCharge(MemoryCharge&& other) noexcept : stage_(other.stage_), bytes_(other.bytes_) {
+        other.bytes_ = 0;
+    }
+    MemoryCharge& operator=(MemoryCharge&& other) noexcept {
+        if (this != &other) {
+            set(0);
+            stage_ = other.stage_;
+            bytes_ = other.bytes_;
+            other.bytes_ = 0;
+        }
+        return *this;
+    }
+    MemoryCharge(const MemoryCharge&) = delete;
+    MemoryCharge& operator=(const MemoryCharge&) = delete;
+
+    void set(size_t bytes);
+    size_t bytes() const { return bytes_; }
+
+private:
+    MemoryStage stage_;
+    size_t bytes_ = 0;
+};
@@ -0,0 +1,535 @@
+#include "native_recorder.h"
+#include "color_convert.h"
+#include "encoder_presets.h"
+#include "frame_clock.h"
+#include "log_sink.h"
+#include "trace.h"
+#include <algorithm>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/opt.h>
+}
+
+namespace {
+
+uint64_t NanosecondsBetween(FrameClock::Clock::time_point from, FrameClock::Clock::time_point to) {
+    return to > from ? std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count() : 0;
+}
+
+// Frames the encoder may hold before their packets come out
+constexpr size_t kMaxCaptureTimes = 256;
+
+std::string AvError(int error) {
+    char message[AV_ERROR_MAX_STRING_SIZE] = {};
+    av_strerror(error, message, sizeof(message));
+    return message;
+}
+
+// OBS encoder ids map to their libavcodec counterparts; other names are
+// tried as libavcodec encoder names. Falls back to any H.264 encoder.
+const AVCodec* FindVideoEncoder(const std::string& id) {
+    std::string name = id.empty() || id == "obs_x264" ? "libx264" : id;
+    const AVCodec* codec = avcodec_find_encoder_by_name(name.c_str());
+    if (!codec) {
+        LogWarning() << "Encoder " << id << " not available, using the default H.264 encoder";
+        codec = avcodec_find_encoder(AV_CODEC_ID_H264);
+    }
+    return codec;
+}
+
+} // namespace
+
+void NativeRecorder::PacketFree::operator()(AVPacket* packet) const {
+    av_packet_free(&packet);
+}
+
+NativeRecorder::~NativeRecorder() {
+    stop();
+}
+
+bool NativeRecorder::start(const std::string& path, const RecordingConfig& config, uint64_t window,
+                           int x, int y, int width, int height) {
+    if (active_) {
+        return false;
+    }
+    if (!grabber_.open()) {
+        LogError() << "Native capture: cannot connect to the X server";
+        return false;
+    }
+    if (window && !grabber_.redirect(window)) {
+        LogInfo() << "Native capture: XComposite unavailable, covered parts of the window are captured as shown";
+    }
+    if (config.capture_audio) {
+        LogInfo() << "Native capture records video only";
+    }
+
+    window_ = window;
+    x_ = x;
+    y_ = y;
+    width_ = width;
+    height_ = height;
+    fps_ = config.fps > 0 ? config.fps : 30;
+
+    if (!openEncoder(path, config)) {
+        closeEncoder();
+        return false;
+    }
+
+    // Frames in flight between the capture and encode threads: at least
+    // one being grabbed and one being encoded
+    int slot_count = std::max(2, limits_.capture_buffers);
+    slots_.clear();
+    slots_.resize(slot_count);
+    free_.clear();
+    ready_.clear();
+    for (int i = 0; i < slot_count; ++i) {
+        free_.push_back(i);
+    }
+    packets_ = std::make_unique<PacketQueue<MuxPacket>>(
+        std::max(1, limits_.packet_queue_packets),
+        static_cast<size_t>(std::max(1, limits_.packet_queue_mb)) * 1024 * 1024);
+    stopping_ = false;
+    failed_ = false;
+    jitter_.reset();
+    grab_latency_.reset();
+    encode_time_.reset();
+    stats_last_time_ = std::chrono::steady_clock::now();
+
+    active_ = true;
+    mux_thread_ = std::thread([this] { muxLoop(); });
+    encode_thread_ = std::thread([this] { encodeLoop(); });
+    capture_thread_ = std::thread([this] { captureLoop(); });
+    LogInfo() << "Native capture: " << encoder_name_ << " " << codec_->width << "x" << codec_->height
+              << " @ " << fps_ << " fps" << (grabber_.usesShm() ? " (MIT-SHM)" : "")
+              << ", " << BestColorKernels().name << " colour conversion";
+    return true;
+}
+
+void NativeRecorder::stop() {
+    if (!active_) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    capture_cv_.notify_all();
+    ready_cv_.notify_all();
+    if (stream_writer_) {
+        // A stalled reader must not hold up stop
+        stream_writer_->drainUntil(std::chrono::steady_clock::now() + std::chrono::seconds(1));
+    }
+    // Capture stops first; the encoder then drains what is queued, and the
+    // muxer what the encoder produced
+    capture_thread_.join();
+    encode_thread_.join();
+    mux_thread_.join();
+
+    closeEncoder();
+    slots_.clear();
+    active_ = false;
+    LogInfo() << "Native capture: " << ticks_ << " deadlines, " << missed_ << " missed, " << skipped_
+              << " skipped by the encoder, " << written_ << " packets, " << dropped_
+              << " dropped by the writer queue (peak " << packets_->peakBytes() / 1024 << " KB)";
+}
+
+bool NativeRecorder::openEncoder(const std::string& path, const RecordingConfig& config) {
+    if (config.segment_seconds > 0 || config.segment_mb > 0) {
+        LogError() << "Native capture does not support segmented recording";
+        return false;
+    }
+
+    int ret = 0;
+    capture_times_.clear();
+    if (IsStreamTarget(path)) {
+        std::string error;
+        stream_writer_ = std::make_unique<StreamWriter>();
+        if (!stream_writer_->open(path, config.stream, SteadyClockNs, error)) {
+            LogError() << "Native capture: " << error;
+            return false;
+        }
+        format_ = stream_writer_->format();
+    } else {
+        ret = avformat_alloc_output_context2(&format_, nullptr, nullptr, path.c_str());
+        if (ret < 0 || !format_) {
+            // Unknown extension
+            ret = avformat_alloc_output_context2(&format_, nullptr, "matroska", path.c_str());
+        }
+        if (ret < 0 || !format_) {
+            LogError() << "Native capture: cannot create muxer for " << path << ": " << AvError(ret);
+            return false;
+        }
+    }
+
+    const AVCodec* codec = FindVideoEncoder(config.video_encoder);
+    if (!codec) {
+        LogError() << "Native capture: no H.264 encoder in this libavcodec";
+        return false;
+    }
+    encoder_name_ = codec->name;
+
+    codec_ = avcodec_alloc_context3(codec);
+    codec_->width = config.width & ~1;
+    codec_->height = config.height & ~1;
+    if (!limits_.scale_up && width_ > 0 && height_ > 0 &&
+        (codec_->width > width_ || codec_->height > height_)) {
+        // Never encode more pixels than were captured
+        double scale = std::min(static_cast<double>(width_) / codec_->width,
+                                static_cast<double>(height_) / codec_->height);
+        codec_->width = std::max(2, static_cast<int>(codec_->width * scale) & ~1);
+        codec_->height = std::max(2, static_cast<int>(codec_->height * scale) & ~1);
+    }
+    codec_->pix_fmt = AV_PIX_FMT_YUV420P;
+    codec_->time_base = AVRational{1, fps_};
+    codec_->framerate = AVRational{fps_, 1};
+    codec_->gop_size = config.keyint_sec > 0 ? config.keyint_sec * fps_ : fps_ * 2;
+    int threads = config.encoder_threads;
+    if (limits_.max_encoder_threads > 0) {
+        threads = threads > 0 ? std::min(threads, limits_.max_encoder_threads) : limits_.max_encoder_threads;
+    }
+    codec_->thread_count = threads;
+    if (limits_.encoder_b_frames >= 0) {
+        codec_->max_b_frames = limits_.encoder_b_frames;
+    }
+    codec_->color_range = AVCOL_RANGE_MPEG;
+    codec_->colorspace = AVCOL_SPC_BT709;
+    codec_->color_primaries = AVCOL_PRI_BT709;
+    codec_->color_trc = AVCOL_TRC_BT709;
+
+    int64_t bitrate = static_cast<int64_t>(config.video_bitrate) * 1000;
+    if (config.rate_control == "CRF") {
+        av_opt_set_int(codec_->priv_data, "crf", config.crf, 0);
+    } else {
+        codec_->bit_rate = bitrate;
+        if (config.rate_control == "CBR") {
+            codec_->rc_min_rate = bitrate;
+            codec_->rc_max_rate = bitrate;
+            codec_->rc_buffer_size = static_cast<int>(bitrate);
+            av_opt_set(codec_->priv_data, "nal-hrd", "cbr", 0);
+        } else if (config.rate_control == "VBR") {
+            codec_->rc_max_rate = bitrate * 3 / 2;
+            codec_->rc_buffer_size = static_cast<int>(bitrate);
+        }
+    }
+
+    preset_ = config.preset;
+    if (preset_ == "auto") {
+        preset_ = SelectX264Preset(codec_->width, codec_->height, fps_, std::thread::hardware_concurrency(),
+                                   config.cpu_budget);
+    }
+    // Options the encoder does not know are ignored
+    av_opt_set(codec_->priv_data, "preset", preset_.c_str(), 0);
+    if (!config.tune.empty()) {
+        av_opt_set(codec_->priv_data, "tune", config.tune.c_str(), 0);
+    }
+    if (limits_.encoder_lookahead >= 0) {
+        av_opt_set_int(codec_->priv_data, "rc-lookahead", limits_.encoder_lookahead, 0);
+        av_opt_set(codec_->priv_data, "x264-params", "sync-lookahead=0", 0);
+    }
+    encoder_bytes_ = EstimateX264Bytes(codec_->width, codec_->height, preset_, limits_.encoder_lookahead,
+                                       limits_.encoder_b_frames, threads);
+
+    if (format_->oformat->flags & AVFMT_GLOBALHEADER) {
+        codec_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    ret = avcodec_open2(codec_, codec, nullptr);
+    if (ret < 0) {
+        LogError() << "Native capture: cannot open " << encoder_name_ << ": " << AvError(ret);
+        return false;
+    }
+
+    stream_ = avformat_new_stream(format_, nullptr);
+    if (!stream_) {
+        return false;
+    }
+    stream_->time_base = codec_->time_base;
+    stream_->avg_frame_rate = codec_->framerate;
+    avcodec_parameters_from_context(stream_->codecpar, codec_);
+
+    if (stream_writer_) {
+        // start() returns within a bounded time even when the reader
+        // never reads
+        std::string error;
+        stream_writer_->drainUntil(std::chrono::steady_clock::now() + std::chrono::seconds(1));
+        bool written = stream_writer_->writeHeader(error);
+        stream_writer_->drainUntil(std::chrono::steady_clock::time_point());
+        if (!written) {
+            LogError() << "Native capture: " << error;
+            return false;
+        }
+    } else {
+        if (!(format_->oformat->flags & AVFMT_NOFILE)) {
+            ret = avio_open(&format_->pb, path.c_str(), AVIO_FLAG_WRITE);
+            if (ret < 0) {
+                LogError() << "Native capture: cannot open " << path << ": " << AvError(ret);
+                return false;
+            }
+        }
+        ret = avformat_write_header(format_, nullptr);
+        if (ret < 0) {
+            LogError() << "Native capture: cannot write header: " << AvError(ret);
+            return false;
+        }
+        header_written_ = true;
+    }
+
+    frame_ = av_frame_alloc();
+    frame_->format = codec_->pix_fmt;
+    frame_->width = codec_->width;
+    frame_->height = codec_->height;
+    packet_ = av_packet_alloc();
+    return av_frame_get_buffer(frame_, 0) == 0 && packet_;
+}
+
+void NativeRecorder::closeEncoder() {
+    if (stream_writer_) {
+        // Owns format_; kept (closed) for getStats until the recorder goes
+        stream_writer_->close();
+        format_ = nullptr;
+    }
+    if (header_written_) {
+        av_write_trailer(format_);
+        header_written_ = false;
+    }
+    if (format_ && format_->pb && !(format_->oformat->flags & AVFMT_NOFILE)) {
+        avio_closep(&format_->pb);
+    }
+    avformat_free_context(format_);
+    format_ = nullptr;
+    capture_times_.clear();
+    stream_ = nullptr;
+    avcodec_free_context(&codec_);
+    av_frame_free(&frame_);
+    av_packet_free(&packet_);
+    scaled_.clear();
+    scaled_.shrink_to_fit();
+    scratch_.clear();
+    scratch_.shrink_to_fit();
+    scale_charge_.set(0);
+}
+
+void NativeRecorder::captureLoop() {
+    SetTraceThreadName("native capture");
+    FrameClock clock(fps_, FrameClock::Clock::now());
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (capture_cv_.wait_until(lock, clock.deadline(), [this] { return stopping_; })) {
+                return;
+            }
+        }
+
+        FrameClock::Clock::time_point woke = FrameClock::Clock::now();
+        uint64_t woke_ns = SteadyClockNs();
+        jitter_.record(NanosecondsBetween(clock.deadline(), woke));
+        ticks_++;
+
+        int index = -1;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!free_.empty()) {
+                index = free_.front();
+                free_.pop_front();
+            }
+        }
+
+        if (index < 0) {
+            skipped_++;
+        } else {
+            Slot& slot = slots_[index];
+            bool grabbed;
+            {
+                TraceSpan span(kTraceFrames, "capture");
+                grabbed = grabber_.grab(window_, x_, y_, width_, height_, FrameFormat::BGRA,
+                                        slot.pixels, slot.width, slot.height);
+            }
+            slot.charge.set(slot.pixels.capacity());
+            FrameClock::Clock::time_point done = FrameClock::Clock::now();
+            grab_ns_ += NanosecondsBetween(woke, done);
+            grab_latency_.record(NanosecondsBetween(clock.deadline(), done));
+            slot.pts = clock.tick();
+            slot.capture_ns = woke_ns;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                (grabbed ? ready_ : free_).push_back(index);
+            }
+            if (grabbed) {
+                queued_++;
+                ready_cv_.notify_one();
+            } else {
+                // Window gone or unmapped: a gap in the recording
+                missed_++;
+            }
+        }
+
+        missed_ += static_cast<uint32_t>(clock.advance(FrameClock::Clock::now()));
+    }
+}
+
+void NativeRecorder::encodeLoop() {
+    SetTraceThreadName("native encode");
+    for (;;) {
+        int index = -1;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_cv_.wait(lock, [this] { return stopping_ || !ready_.empty(); });
+            if (ready_.empty()) {
+                break;
+            }
+            index = ready_.front();
+            ready_.pop_front();
+        }
+
+        auto start = FrameClock::Clock::now();
+        bool ok = encodeSlot(slots_[index]);
+        encode_time_.record(NanosecondsBetween(start, FrameClock::Clock::now()));
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(index);
+        }
+        if (!ok) {
+            fail("encoding failed");
+            break;
+        }
+    }
+
+    encodeFrame(nullptr);
+    packets_->close();
+}
+
+void NativeRecorder::muxLoop() {
+    SetTraceThreadName("native mux");
+    MuxPacket packet;
+    while (packets_->pop(packet)) {
+        int size = packet.packet->size;
+        TraceSpan span(kTraceFrames, "mux");
+        // A single stream is already in order, so live streams skip the
+        // interleaving queue; the file muxer takes the packet's data
+        bool ok = stream_writer_ ? stream_writer_->write(packet.packet.get(), packet.capture_ns)
+                                 : av_interleaved_write_frame(format_, packet.packet.get()) >= 0;
+        if (!ok) {
+            fail(stream_writer_ ? "the stream failed: " + stream_writer_->error() : "writing the file failed");
+            packets_->close();
+            packets_->clear();
+            return;
+        }
+        bytes_ += size;
+        written_++;
+    }
+}
+
+// Stops capture; the threads then wind down as on stop()
+void NativeRecorder::fail(const std::string& error) {
+    if (failed_.exchange(true)) {
+        return;
+    }
+    LogError() << "Native capture: " << error << ", stopping";
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    capture_cv_.notify_all();
+    ready_cv_.notify_all();
+    if (failure_callback_) {
+        failure_callback_(error);
+    }
+}
+
+bool NativeRecorder::encodeSlot(const Slot& slot) {
+    if (av_frame_make_writable(frame_) < 0) {
+        return false;
+    }
+
+    // Grabs match the output size unless a window changed size or the
+    // config scales; then resize first (box steps, then bilinear)
+    TraceSpan span(kTraceFrames, "convert");
+    const uint8_t* pixels = slot.pixels.data();
+    int stride = slot.width * 4;
+    if (slot.width != codec_->width || slot.height != codec_->height) {
+        scaled_.resize(static_cast<size_t>(codec_->width) * codec_->height * 4);
+        ScaleBgra(pixels, stride, slot.width, slot.height, scaled_.data(), codec_->width * 4,
+                  codec_->width, codec_->height, scratch_);
+        scale_charge_.set(scaled_.capacity() + scratch_.capacity());
+        pixels = scaled_.data();
+        stride = codec_->width * 4;
+    }
+    BgraToI420(pixels, stride, codec_->width, codec_->height,
+               frame_->data[0], frame_->linesize[0], frame_->data[1], frame_->linesize[1],
+               frame_->data[2], frame_->linesize[2]);
+    span.end();
+    frame_->pts = slot.pts;
+    if (stream_writer_) {
+        capture_times_[slot.pts] = slot.capture_ns;
+    }
+    return encodeFrame(frame_);
+}
+
+bool NativeRecorder::encodeFrame(AVFrame* frame) {
+    TraceSpan span(kTraceFrames, "encode");
+    int ret = avcodec_send_frame(codec_, frame);
+    if (ret < 0 && ret != AVERROR_EOF) {
+        return false;
+    }
+
+    while ((ret = avcodec_receive_packet(codec_, packet_)) == 0) {
+        // Packets leave the encoder in decode order, so B-frames find their
+        // capture time after later frames' have been taken
+        uint64_t capture_ns = 0;
+        auto captured = capture_times_.find(packet_->pts);
+        if (captured != capture_times_.end()) {
+            capture_ns = captured->second;
+            capture_times_.erase(captured);
+        }
+        while (capture_times_.size() > kMaxCaptureTimes) {
+            capture_times_.erase(capture_times_.begin());
+        }
+        av_packet_rescale_ts(packet_, codec_->time_base, stream_->time_base);
+        packet_->stream_index = stream_->index;
+        PacketPtr queued(av_packet_alloc());
+        if (!queued) {
+            return false;
+        }
+        av_packet_move_ref(queued.get(), packet_);
+        size_t size = static_cast<size_t>(queued->size);
+        bool keyframe = (queued->flags & AV_PKT_FLAG_KEY) != 0;
+        if (!packets_->push(MuxPacket{std::move(queued), capture_ns}, size, keyframe)) {
+            dropped_++;
+        }
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF;
+}
+
+void NativeRecorder::getStats(PipelineStats& stats) {
+    stats.active = active_;
+    stats.total_frames = ticks_;
+    stats.lagged_frames = missed_;
+    stats.video_frames = queued_ + skipped_;
+    stats.skipped_frames = skipped_;
+    stats.output_frames = written_;
+    stats.dropped_frames = dropped_;
+    stats.bytes_written = bytes_;
+    stats.average_frame_time_ms = queued_ ? grab_ns_ / 1e6 / queued_ : 0.0;
+
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - stats_last_time_).count();
+    if (elapsed >= 0.25) {
+        stats_bitrate_kbps_ = (stats.bytes_written - stats_last_bytes_) * 8.0 / elapsed / 1000.0;
+        stats_last_bytes_ = stats.bytes_written;
+        stats_last_time_ = now;
+    }
+    stats.bitrate_kbps = stats_bitrate_kbps_;
+
+    stats.render_latency = grab_latency_.summarize();
+    stats.encode_time = encode_time_.summarize();
+    stats.capture_jitter = jitter_.summarize();
+    if (stream_writer_) {
+        stats.stream_latency = stream_writer_->latency().summarize();
+    }
+    stats.video_encoder = encoder_name_;
+    stats.preset = preset_;
+}
@@ -0,0 +1,163 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "latency_histogram.h"
+#include "memory_stats.h"
+#include "obs_wrapper.h"
+#include "packet_queue.h"
+#include "stream_writer.h"
+#include "x11_screenshot.h"
+
+struct AVCodecContext;
+struct AVFormatContext;
+struct AVFrame;
+struct AVPacket;
+struct AVStream;
+
+// Built-in Linux recording backend for builds without libobs
+// (HAVE_NATIVE_CAPTURE). A capture thread grabs the source through
+// X11Screenshot (MIT-SHM, XComposite for windows) on a FrameClock schedule
+// and hands frames to an encode thread through a small pool of buffers;
+// the encode thread scales and converts to I420 with the color_convert
+// kernels and encodes with libavcodec, and a mux thread writes the packets
+// with libavformat. When the encoder falls behind and the pool is empty,
+// the frame is skipped; when the writer falls behind, packets are dropped
+// by the PacketQueue policy. Nothing is queued without bound.
+//
+// A stream target path (see stream_sink.h) writes fragmented MP4 or
+// MPEG-TS live through a StreamWriter on the mux thread instead of a file;
+// a reader that falls behind then costs dropped packets the same way.
+//
+// Covers the video side of RecordingConfig: display, window and region,
+// output size, fps, encoder, preset/tune, rate control, keyframe interval
+// and threads. No audio, cursor, segments or VFR.
+class NativeRecorder {
+public:
+    NativeRecorder() = default;
+    ~NativeRecorder();
+
+    NativeRecorder(const NativeRecorder&) = delete;
+    NativeRecorder& operator=(const NativeRecorder&) = delete;
+
+    // The source rectangle is in root window coordinates (window == 0) or
+    // window coordinates; zero width/height means the whole window
+    bool start(const std::string& path, const RecordingConfig& config, uint64_t window,
+               int x, int y, int width, int height);
+    // Drains queued frames, flushes the encoder and finalizes the file. A
+    // live stream gets a second to take what is queued.
+    void stop();
+
+    // Called on the encode thread when encoding or muxing fails and the
+    // recorder stops on its own; set before start()
+    void setFailureCallback(std::function<void(const std::string& error)> callback) {
+        failure_callback_ = std::move(callback);
+    }
+
+    // Buffer counts, encoder settings and queue sizes; set before start()
+    void setLimits(const BufferLimits& limits) { limits_ = limits; }
+
+    // Fills the fields of PipelineStats this backend measures. Lagged frames
+    // are missed capture deadlines; render latency is deadline to grabbed.
+    void getStats(PipelineStats& stats);
+
+    // Estimated bytes the video encoder holds, 0 when stopped
+    uint64_t encoderBytes() const { return active_ ? encoder_bytes_.load() : 0; }
+
+private:
+    struct Slot {
+        std::vector<uint8_t> pixels; // BGRA
+        int width = 0;
+        int height = 0;
+        int64_t pts = 0;
+        uint64_t capture_ns = 0; // SteadyClockNs() when the grab started
+        MemoryCharge charge{MemoryStage::Capture};
+    };
+
+    struct PacketFree {
+        void operator()(AVPacket* packet) const;
+    };
+    using PacketPtr = std::unique_ptr<AVPacket, PacketFree>;
+
+    struct MuxPacket {
+        PacketPtr packet;
+        uint64_t capture_ns = 0;
+    };
+
+    bool openEncoder(const std::string& path, const RecordingConfig& config);
+    void closeEncoder();
+    void captureLoop();
+    void encodeLoop();
+    void muxLoop();
+    bool encodeSlot(const Slot& slot);
+    bool encodeFrame(AVFrame* frame); // nullptr flushes
+    void fail(const std::string& error);
+
+    X11Screenshot grabber_;
+    uint64_t window_ = 0;
+    int x_ = 0;
+    int y_ = 0;
+    int width_ = 0;
+    int height_ = 0;
+    int fps_ = 30;
+
+    // Capture -> encode handoff: slot indices move between free_ and ready_
+    std::mutex mutex_;
+    std::condition_variable capture_cv_; // stop requests
+    std::condition_variable ready_cv_;   // frames ready, or stop
+    std::vector<Slot> slots_;
+    std::deque<int> free_;
+    std::deque<int> ready_;
+    bool stopping_ = false;
+    std::function<void(const std::string&)> failure_callback_;
+    std::atomic<bool> failed_{false};
+    BufferLimits limits_;
+    std::thread capture_thread_;
+    std::thread encode_thread_;
+    std::thread mux_thread_;
+
+    // Encode -> mux handoff
+    std::unique_ptr<PacketQueue<MuxPacket>> packets_;
+
+    // Encode thread only, after start(); format_ is the mux thread's
+    AVFormatContext* format_ = nullptr;
+    AVCodecContext* codec_ = nullptr;
+    AVStream* stream_ = nullptr;
+    AVFrame* frame_ = nullptr;
+    AVPacket* packet_ = nullptr;
+    bool header_written_ = false;
+    std::unique_ptr<StreamWriter> stream_writer_; // live stream targets only
+    std::map<int64_t, uint64_t> capture_times_;   // frame pts -> capture time
+    std::string encoder_name_;
+    std::string preset_;
+    std::vector<uint8_t> scaled_;  // BGRA at the output size, when resizing
+    std::vector<uint8_t> scratch_; // ScaleBgra intermediates
+    MemoryCharge scale_charge_{MemoryStage::Capture};
+    std::atomic<uint64_t> encoder_bytes_{0};
+
+    std::atomic<uint32_t> ticks_{0};
+    std::atomic<uint32_t> missed_{0};     // deadlines passed without a grab
+    std::atomic<uint32_t> queued_{0};     // frames handed to the encoder
+    std::atomic<uint32_t> skipped_{0};    // no free buffer: encoder behind
+    std::atomic<int> written_{0};         // packets muxed
+    std::atomic<int> dropped_{0};         // packets the mux queue dropped
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> grab_ns_{0};
+    std::atomic<bool> active_{false};
+    LatencyHistogram jitter_;             // wake-up past the deadline
+    LatencyHistogram grab_latency_;       // deadline to frame grabbed
+    LatencyHistogram encode_time_;        // scale + encode + mux per frame
+
+    // Bitrate over the interval between getStats() calls
+    uint64_t stats_last_bytes_ = 0;
+    std::chrono::steady_clock::time_point stats_last_time_;
+    double stats_bitrate_kbps_ = 0;
+};
@@ -1,5 +1,15 @@
 #include <napi.h>
+#include <algorithm>
+#include <cstring>
+#include <exception>
 #include "obs_wrapper.h"
+#include "addon_env.h"
+#include "audio_tap.h"
+#include "control_queue.h"
+#include "diagnostics.h"
+#include "env_listeners.h"
+#include "frame_tap.h"
+#include "screenshot.h"
 
 // Add the missing permission functions
 Napi::Boolean CheckScreenPermission(const Napi::CallbackInfo& info) {
@@ -23,12 +33,8 @@ Napi::Boolean RequestScreenPermission(const Napi::CallbackInfo& info) {
 #endif
 }
 
-// Add the missing ListWindows function
-Napi::Value ListWindows(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    Napi::Array arr = Napi::Array::New(env);
-    
-    auto windows = OBSManager::getInstance().getWindows();
+static Napi::Array WindowsToArray(Napi::Env env, const std::vector<WindowInfo>& windows) {
+    Napi::Array arr = Napi::Array::New(env, windows.size());
     for (size_t i = 0; i < windows.size(); i++) {
         Napi::Object obj = Napi::Object::New(env);
         obj.Set("id", Napi::Number::New(env, windows[i].id));
@@ -43,17 +49,8 @@ Napi::Value ListWindows(const Napi::CallbackInfo& info) {
     return arr;
 }
 
-Napi::Boolean InitOBS(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    bool success = OBSManager::getInstance().initialize();
-    return Napi::Boolean::New(env, success);
-}
-
-Napi::Value ListDisplays(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    Napi::Array arr = Napi::Array::New(env);
-    
-    auto displays = OBSManager::getInstance().getDisplays();
+static Napi::Array DisplaysToArray(Napi::Env env, const std::vector<DisplayInfo>& displays) {
+    Napi::Array arr = Napi::Array::New(env, displays.size());
     for (size_t i = 0; i < displays.size(); i++) {
         Napi::Object obj = Napi::Object::New(env);
         obj.Set("id", displays[i].id);
@@ -67,19 +64,31 @@ Napi::Value ListDisplays(const Napi::CallbackInfo& info) {
     return arr;
 }
 
-Napi::Boolean StartRecording(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    
-    if (info.Length() < 1 || !info[0].IsString()) {
-        Napi::TypeError::New(env, "Output path required").ThrowAsJavaScriptException();
-        return Napi::Boolean::New(env, false);
+// Live stream options: { streamFormat: 'fmp4' | 'mpegts', fragmentMs }.
+// Any other streamFormat throws a TypeError (left pending for the caller).
+static StreamSettings ParseStreamSettings(const Napi::Object& opts) {
+    StreamSettings stream;
+    if (opts.Has("streamFormat") && !opts.Get("streamFormat").IsUndefined()) {
+        Napi::Value value = opts.Get("streamFormat");
+        std::string format = value.IsString() ? value.As<Napi::String>().Utf8Value() : "";
+        if (format == "mpegts") {
+            stream.format = StreamSettings::MPEGTS;
+        } else if (format != "fmp4") {
+            Napi::TypeError::New(opts.Env(), "streamFormat must be 'fmp4' or 'mpegts'").ThrowAsJavaScriptException();
+            return stream;
+        }
     }
-    
-    std::string path = info[0].As<Napi::String>();
+    stream.fragment_ms = std::max(1, GetIntOption(opts, "fragmentMs", stream.fragment_ms));
+    return stream;
+}
+
+// Reads the recording options object (second argument of startRecording).
+// Invalid options leave a TypeError pending.
+static RecordingConfig ParseRecordingConfig(const Napi::CallbackInfo& info, size_t index) {
     RecordingConfig config;
     
-    if (info.Length() > 1 && info[1].IsObject()) {
-        Napi::Object opts = info[1].As<Napi::Object>();
+    if (info.Length() > index && info[index].IsObject()) {
+        Napi::Object opts = info[index].As<Napi::Object>();
         if (opts.Has("width")) config.width = opts.Get("width").As<Napi::Number>().Int32Value();
         if (opts.Has("height")) config.height = opts.Get("height").As<Napi::Number>().Int32Value();
         if (opts.Has("fps")) config.fps = opts.Get("fps").As<Napi::Number>().Int32Value();
@@ -89,29 +98,977 @@ Napi::Boolean StartRecording(const Napi::CallbackInfo& info) {
             config.source_type = RecordingConfig::WINDOW;
         }
         if (opts.Has("capture_audio")) config.capture_audio = opts.Get("capture_audio").As<Napi::Boolean>();
+        if (opts.Has("video_bitrate")) config.video_bitrate = opts.Get("video_bitrate").As<Napi::Number>().Int32Value();
+        if (opts.Has("audio_bitrate")) config.audio_bitrate = opts.Get("audio_bitrate").As<Napi::Number>().Int32Value();
+        if (opts.Has("sampleRate")) config.sample_rate = opts.Get("sampleRate").As<Napi::Number>().Int32Value();
+        if (opts.Has("encoder")) config.video_encoder = opts.Get("encoder").As<Napi::String>();
+        if (opts.Has("preset")) config.preset = opts.Get("preset").As<Napi::String>();
+        if (opts.Has("tune")) config.tune = opts.Get("tune").As<Napi::String>();
+        if (opts.Has("rateControl")) config.rate_control = opts.Get("rateControl").As<Napi::String>();
+        if (opts.Has("crf")) config.crf = opts.Get("crf").As<Napi::Number>().Int32Value();
+        if (opts.Has("keyintSec")) config.keyint_sec = opts.Get("keyintSec").As<Napi::Number>().Int32Value();
+        if (opts.Has("threads")) config.encoder_threads = opts.Get("threads").As<Napi::Number>().Int32Value();
+        if (opts.Has("cpuBudget")) config.cpu_budget = opts.Get("cpuBudget").As<Napi::Number>().DoubleValue();
+        if (opts.Has("segmentSeconds")) config.segment_seconds = opts.Get("segmentSeconds").As<Napi::Number>().Int32Value();
+        if (opts.Has("segmentMb")) config.segment_mb = opts.Get("segmentMb").As<Napi::Number>().Int32Value();
+        if (opts.Has("segmentTemplate")) config.segment_template = opts.Get("segmentTemplate").As<Napi::String>();
+        config.stream = ParseStreamSettings(opts);
+        if (info.Env().IsExceptionPending()) {
+            return config;
+        }
+        if (opts.Has("vfr")) {
+            // vfr: true | { minFps }
+            Napi::Value vfr = opts.Get("vfr");
+            config.vfr = vfr.IsObject() || (vfr.IsBoolean() && vfr.As<Napi::Boolean>().Value());
+            if (vfr.IsObject()) {
+                config.vfr_min_fps = GetIntOption(vfr.As<Napi::Object>(), "minFps", config.vfr_min_fps);
+            }
+        }
+        if (opts.Has("region") && opts.Get("region").IsObject()) {
+            Napi::Object region = opts.Get("region").As<Napi::Object>();
+            int x = GetIntOption(region, "x", 0);
+            int y = GetIntOption(region, "y", 0);
+            int width = GetIntOption(region, "width", 0);
+            int height = GetIntOption(region, "height", 0);
+            if (x < 0 || y < 0 || width <= 0 || height <= 0) {
+                Napi::TypeError::New(info.Env(), "region needs x >= 0, y >= 0, width > 0 and height > 0")
+                    .ThrowAsJavaScriptException();
+                return config;
+            }
+            config.region_x = x;
+            config.region_y = y;
+            config.region_width = width;
+            config.region_height = height;
+            // Without an explicit output size, record the region 1:1
+            if (!opts.Has("width") && !opts.Has("height")) {
+                config.width = std::max(2, config.region_width & ~1);
+                config.height = std::max(2, config.region_height & ~1);
+            }
+        }
+    }
+    
+    return config;
+}
+
+// Reads init options: { modules: 'all' | 'required' | string[], captureAudio, sampleRate, lowMemory }
+static bool ParseInitOptions(const Napi::CallbackInfo& info, InitOptions& options) {
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        return true;
     }
     
+    Napi::Object opts = info[0].As<Napi::Object>();
+    if (opts.Has("captureAudio")) {
+        options.capture_audio = opts.Get("captureAudio").ToBoolean();
+    }
+    
+    if (opts.Has("sampleRate")) {
+        options.sample_rate = opts.Get("sampleRate").ToNumber().Int32Value();
+        if (!IsSupportedSampleRate(options.sample_rate)) {
+            Napi::RangeError::New(info.Env(), "sampleRate must be 44100 or 48000").ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    
+    if (opts.Has("modules")) {
+        Napi::Value modules = opts.Get("modules");
+        if (modules.IsArray()) {
+            Napi::Array list = modules.As<Napi::Array>();
+            for (uint32_t i = 0; i < list.Length(); i++) {
+                options.modules.push_back(list.Get(i).ToString());
+            }
+            options.load_all_modules = false;
+        } else if (modules.IsString() && modules.As<Napi::String>().Utf8Value() == "required") {
+            options.load_all_modules = false;
+        } else if (!(modules.IsString() && modules.As<Napi::String>().Utf8Value() == "all")) {
+            Napi::TypeError::New(info.Env(), "modules must be 'all', 'required' or an array of module names")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    
+    if (opts.Has("lowMemory")) {
+        options.low_memory = opts.Get("lowMemory").ToBoolean();
+    }
+    
+    return true;
+}
+
+// Every *Async export runs its work on one shared control thread, so calls
+// reach OBSManager in the order they were made and never block the event loop.
+static ControlQueue& GetControlQueue() {
+    static ControlQueue queue;
+    return queue;
+}
+
+// Struct-of-arrays form of an enumeration, built with a handful of N-API
+// calls however many entries there are. One ArrayBuffer holds, in order:
+//   ids       Float64Array[count]               (windows; empty for displays)
+//   geometry  Int32Array[count * 4]             x, y, width, height
+//   offsets   Uint32Array[count * fields + 1]   into text, per string field
+//   text      Uint8Array                        UTF-8 strings back to back
+// index.js wraps it in entry views that decode strings on access.
+struct PackedColumns {
+    size_t count = 0;
+    std::vector<double> ids;
+    std::vector<int32_t> geometry;
+    std::vector<const std::string*> strings;
+};
+
+static Napi::Object PackColumns(Napi::Env env, const PackedColumns& columns) {
+    size_t text_size = 0;
+    for (const std::string* text : columns.strings) {
+        text_size += text->size();
+    }
+    size_t ids_bytes = columns.ids.size() * sizeof(double);
+    size_t geometry_bytes = columns.geometry.size() * sizeof(int32_t);
+    size_t offset_count = columns.strings.size() + 1;
+    size_t text_start = ids_bytes + geometry_bytes + offset_count * sizeof(uint32_t);
+
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, text_start + text_size);
+    uint8_t* base = static_cast<uint8_t*>(buffer.Data());
+    if (ids_bytes) {
+        std::memcpy(base, columns.ids.data(), ids_bytes);
+    }
+    if (geometry_bytes) {
+        std::memcpy(base + ids_bytes, columns.geometry.data(), geometry_bytes);
+    }
+    // Sections are multiples of 4 bytes, so the offsets stay aligned
+    uint32_t* offsets = reinterpret_cast<uint32_t*>(base + ids_bytes + geometry_bytes);
+    uint32_t position = 0;
+    for (size_t i = 0; i < columns.strings.size(); i++) {
+        offsets[i] = position;
+        std::memcpy(base + text_start + position, columns.strings[i]->data(), columns.strings[i]->size());
+        position += static_cast<uint32_t>(columns.strings[i]->size());
+    }
+    offsets[columns.strings.size()] = position;
+
+    Napi::Object packed = Napi::Object::New(env);
+    packed.Set("count", Napi::Number::New(env, static_cast<double>(columns.count)));
+    packed.Set("ids", Napi::Float64Array::New(env, columns.ids.size(), buffer, 0));
+    packed.Set("geometry", Napi::Int32Array::New(env, columns.geometry.size(), buffer, ids_bytes));
+    packed.Set("offsets", Napi::Uint32Array::New(env, offset_count, buffer, ids_bytes + geometry_bytes));
+    packed.Set("text", Napi::Uint8Array::New(env, text_size, buffer, text_start));
+    return packed;
+}
+
+// String fields per window: name, owner
+static Napi::Object PackWindows(Napi::Env env, const std::vector<WindowInfo>& windows) {
+    PackedColumns columns;
+    columns.count = windows.size();
+    columns.ids.reserve(windows.size());
+    columns.geometry.reserve(windows.size() * 4);
+    columns.strings.reserve(windows.size() * 2);
+    for (const WindowInfo& window : windows) {
+        columns.ids.push_back(static_cast<double>(window.id));
+        columns.geometry.insert(columns.geometry.end(), {window.x, window.y, window.width, window.height});
+        columns.strings.push_back(&window.name);
+        columns.strings.push_back(&window.owner);
+    }
+    return PackColumns(env, columns);
+}
+
+// String fields per display: id, name
+static Napi::Object PackDisplays(Napi::Env env, const std::vector<DisplayInfo>& displays) {
+    PackedColumns columns;
+    columns.count = displays.size();
+    columns.geometry.reserve(displays.size() * 4);
+    columns.strings.reserve(displays.size() * 2);
+    for (const DisplayInfo& display : displays) {
+        columns.geometry.insert(columns.geometry.end(), {display.x, display.y, display.width, display.height});
+        columns.strings.push_back(&display.id);
+        columns.strings.push_back(&display.name);
+    }
+    return PackColumns(env, columns);
+}
+
+// Runs `work` on the control thread and settles the returned Promise with
+// `convert(result)` back on the JS thread. An exception thrown by `work`
+// rejects the Promise with its message.
+template <typename T>
+static Napi::Promise RunOnControlThread(Napi::Env env,
+                                        std::function<T()> work,
+                                        std::function<Napi::Value(Napi::Env, T&)> convert) {
+    struct Call {
+        Napi::Promise::Deferred deferred;
+        std::function<T()> work;
+        std::function<Napi::Value(Napi::Env, T&)> convert;
+        T result{};
+        std::string error;
+        bool failed = false;
+    };
+    
+    auto* call = new Call{Napi::Promise::Deferred::New(env), std::move(work), std::move(convert)};
+    Napi::Promise promise = call->deferred.Promise();
+    
+    Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
+        env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}), "obs_control", 0, 1);
+    
+    GetControlQueue().post([call, tsfn]() mutable {
+        // Nothing may escape the control thread: it would terminate the process
+        try {
+            call->result = call->work();
+        } catch (const std::exception& e) {
+            call->failed = true;
+            call->error = e.what();
+        } catch (...) {
+            call->failed = true;
+            call->error = "unknown error";
+        }
+        napi_status status = tsfn.BlockingCall(call, [](Napi::Env env, Napi::Function, Call* call) {
+            if (env != nullptr) {
+                if (call->failed) {
+                    call->deferred.Reject(Napi::Error::New(env, call->error).Value());
+                } else {
+                    call->deferred.Resolve(call->convert(env, call->result));
+                }
+            }
+            delete call;
+        });
+        // The environment exited (a worker terminated) while the work ran
+        if (status != napi_ok) {
+            delete call;
+        }
+        tsfn.Release();
+    });
+    
+    return promise;
+}
+
+static Napi::Value ToBoolean(Napi::Env env, bool& value) {
+    return Napi::Boolean::New(env, value);
+}
+
+static Napi::Value ToUndefined(Napi::Env env, bool&) {
+    return env.Undefined();
+}
+
+Napi::Value ListWindows(const Napi::CallbackInfo& info) {
+    return WindowsToArray(info.Env(), OBSManager::getInstance().getWindows());
+}
+
+Napi::Value InitOBS(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    InitOptions options;
+    if (!ParseInitOptions(info, options)) {
+        return env.Undefined();
+    }
+    bool success = InitCore(env, options);
+    return Napi::Boolean::New(env, success);
+}
+
+Napi::Value GetInitTiming(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    InitTiming timing = OBSManager::getInstance().getInitTiming();
+    
+    Napi::Array modules = Napi::Array::New(env, timing.modules.size());
+    for (size_t i = 0; i < timing.modules.size(); i++) {
+        Napi::Object module = Napi::Object::New(env);
+        module.Set("name", timing.modules[i].first);
+        module.Set("ms", Napi::Number::New(env, timing.modules[i].second));
+        modules.Set(static_cast<uint32_t>(i), module);
+    }
+    
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("startupMs", Napi::Number::New(env, timing.startup_ms));
+    obj.Set("modules", modules);
+    obj.Set("postLoadMs", Napi::Number::New(env, timing.post_load_ms));
+    obj.Set("audioResetMs", Napi::Number::New(env, timing.audio_reset_ms));
+    obj.Set("videoResetMs", Napi::Number::New(env, timing.video_reset_ms));
+    obj.Set("totalMs", Napi::Number::New(env, timing.total_ms));
+    return obj;
+}
+
+Napi::Value ListDisplays(const Napi::CallbackInfo& info) {
+    return DisplaysToArray(info.Env(), OBSManager::getInstance().getDisplays());
+}
+
+Napi::Value ListWindowsPacked(const Napi::CallbackInfo& info) {
+    return PackWindows(info.Env(), OBSManager::getInstance().getWindows());
+}
+
+Napi::Value ListDisplaysPacked(const Napi::CallbackInfo& info) {
+    return PackDisplays(info.Env(), OBSManager::getInstance().getDisplays());
+}
+
+#ifdef BENCHMARK_HOOKS
+// Marshals `count` synthetic windows through the per-object (packed =
+// false) or packed path, without enumerating: isolates the marshalling
+// cost for test/bench-enumeration.js. Only in BUILD_BENCHMARK_HOOKS builds.
+Napi::Value MarshalTestWindows(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Window count required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    uint32_t count = info[0].As<Napi::Number>().Uint32Value();
+    bool packed = info.Length() > 1 && info[1].ToBoolean();
+
+    std::vector<WindowInfo> windows(count);
+    for (uint32_t i = 0; i < count; i++) {
+        WindowInfo& window = windows[i];
+        window.id = 0x3a00001 + i;
+        window.name = "Document " + std::to_string(i) + " - Text Editor";
+        window.owner = "text-editor";
+        window.x = static_cast<int>(i % 40) * 24;
+        window.y = static_cast<int>(i % 30) * 24;
+        window.width = 1280;
+        window.height = 800;
+    }
+    return packed ? PackWindows(env, windows) : WindowsToArray(env, windows);
+}
+#endif
+
+Napi::Boolean StartRecording(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Output path required").ThrowAsJavaScriptException();
+        return Napi::Boolean::New(env, false);
+    }
+    
+    std::string path = info[0].As<Napi::String>();
+    
+    // Without options, record with the prepared pipeline (or the defaults)
+    if (info.Length() < 2 || !info[1].IsObject()) {
+        return Napi::Boolean::New(env, OBSManager::getInstance().startRecording(path));
+    }
+    
+    RecordingConfig config = ParseRecordingConfig(info, 1);
+    if (env.IsExceptionPending()) {
+        return Napi::Boolean::New(env, false);
+    }
     bool success = OBSManager::getInstance().startRecording(path, config);
     return Napi::Boolean::New(env, success);
 }
 
+Napi::Boolean Prepare(const Napi::CallbackInfo& info) {
+    RecordingConfig config = ParseRecordingConfig(info, 0);
+    if (info.Env().IsExceptionPending()) {
+        return Napi::Boolean::New(info.Env(), false);
+    }
+    return Napi::Boolean::New(info.Env(), OBSManager::getInstance().prepare(config));
+}
+
+Napi::Value Unprepare(const Napi::CallbackInfo& info) {
+    OBSManager::getInstance().unprepare();
+    return info.Env().Undefined();
+}
+
+Napi::Value GetStartTiming(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    StartTiming timing = OBSManager::getInstance().getStartTiming();
+    
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("warm", Napi::Boolean::New(env, timing.warm));
+    obj.Set("prepareMs", Napi::Number::New(env, timing.prepare_ms));
+    obj.Set("startMs", Napi::Number::New(env, timing.start_ms));
+    obj.Set("totalMs", Napi::Number::New(env, timing.prepare_ms + timing.start_ms));
+    return obj;
+}
+
 Napi::Value StopRecording(const Napi::CallbackInfo& info) {
     OBSManager::getInstance().stopRecording();
     return info.Env().Undefined();
 }
 
+Napi::Value IsRecording(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), OBSManager::getInstance().isRecording());
+}
+
+// Shuts the core down unless another environment still holds it
 Napi::Value Shutdown(const Napi::CallbackInfo& info) {
-    OBSManager::getInstance().shutdown();
+    ShutdownCore(info.Env());
     return info.Env().Undefined();
 }
 
+Napi::Value InitOBSAsync(const Napi::CallbackInfo& info) {
+    InitOptions options;
+    if (!ParseInitOptions(info, options)) {
+        return info.Env().Undefined();
+    }
+    napi_env env = info.Env();
+    return RunOnControlThread<bool>(env,
+        [env, options] { return InitCore(env, options); },
+        ToBoolean);
+}
+
+Napi::Value ShutdownAsync(const Napi::CallbackInfo& info) {
+    napi_env env = info.Env();
+    return RunOnControlThread<bool>(env,
+        [env] { ShutdownCore(env); return true; },
+        ToUndefined);
+}
+
+Napi::Value ListWindowsAsync(const Napi::CallbackInfo& info) {
+    return RunOnControlThread<std::vector<WindowInfo>>(info.Env(),
+        [] { return OBSManager::getInstance().getWindows(); },
+        [](Napi::Env env, std::vector<WindowInfo>& windows) -> Napi::Value {
+            return WindowsToArray(env, windows);
+        });
+}
+
+Napi::Value ListDisplaysAsync(const Napi::CallbackInfo& info) {
+    return RunOnControlThread<std::vector<DisplayInfo>>(info.Env(),
+        [] { return OBSManager::getInstance().getDisplays(); },
+        [](Napi::Env env, std::vector<DisplayInfo>& displays) -> Napi::Value {
+            return DisplaysToArray(env, displays);
+        });
+}
+
+Napi::Value ListWindowsPackedAsync(const Napi::CallbackInfo& info) {
+    return RunOnControlThread<std::vector<WindowInfo>>(info.Env(),
+        [] { return OBSManager::getInstance().getWindows(); },
+        [](Napi::Env env, std::vector<WindowInfo>& windows) -> Napi::Value {
+            return PackWindows(env, windows);
+        });
+}
+
+Napi::Value ListDisplaysPackedAsync(const Napi::CallbackInfo& info) {
+    return RunOnControlThread<std::vector<DisplayInfo>>(info.Env(),
+        [] { return OBSManager::getInstance().getDisplays(); },
+        [](Napi::Env env, std::vector<DisplayInfo>& displays) -> Napi::Value {
+            return PackDisplays(env, displays);
+        });
+}
+
+Napi::Value StartRecordingAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Output path required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    
+    std::string path = info[0].As<Napi::String>();
+    
+    if (info.Length() < 2 || !info[1].IsObject()) {
+        return RunOnControlThread<bool>(env,
+            [path] { return OBSManager::getInstance().startRecording(path); },
+            ToBoolean);
+    }
+    
+    RecordingConfig config = ParseRecordingConfig(info, 1);
+    if (env.IsExceptionPending()) {
+        return env.Undefined();
+    }
+    return RunOnControlThread<bool>(env,
+        [path, config] { return OBSManager::getInstance().startRecording(path, config); },
+        ToBoolean);
+}
+
+Napi::Value PrepareAsync(const Napi::CallbackInfo& info) {
+    RecordingConfig config = ParseRecordingConfig(info, 0);
+    if (info.Env().IsExceptionPending()) {
+        return info.Env().Undefined();
+    }
+    return RunOnControlThread<bool>(info.Env(),
+        [config] { return OBSManager::getInstance().prepare(config); },
+        ToBoolean);
+}
+
+Napi::Value StopRecordingAsync(const Napi::CallbackInfo& info) {
+    return RunOnControlThread<bool>(info.Env(),
+        [] { OBSManager::getInstance().stopRecording(); return true; },
+        ToUndefined);
+}
+
+Napi::Boolean StartReplayBuffer(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    RecordingConfig config = ParseRecordingConfig(info, 0);
+    if (env.IsExceptionPending()) {
+        return Napi::Boolean::New(env, false);
+    }
+    
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object opts = info[0].As<Napi::Object>();
+        config.replay_max_seconds = GetIntOption(opts, "maxSeconds", config.replay_max_seconds);
+        config.replay_max_mb = GetIntOption(opts, "maxSizeMb", config.replay_max_mb);
+    }
+    
+    return Napi::Boolean::New(env, OBSManager::getInstance().startReplayBuffer(config));
+}
+
+Napi::Value SaveReplay(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Output path required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    
+    std::string path = info[0].As<Napi::String>();
+    return Napi::Boolean::New(env, OBSManager::getInstance().saveReplay(path));
+}
+
+Napi::Value StopReplayBuffer(const Napi::CallbackInfo& info) {
+    OBSManager::getInstance().stopReplayBuffer();
+    return info.Env().Undefined();
+}
+
+static const char* kOutputTypes[] = {"file", "segments", "url", "stream"};
+
+// addOutput(name, { type: 'file' | 'segments' | 'url' | 'stream', path, segmentSeconds, segmentMb,
+//                   segmentTemplate, streamFormat, fragmentMs })
+Napi::Value AddOutput(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Output name and options required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    
+    std::string name = info[0].As<Napi::String>();
+    Napi::Object opts = info[1].As<Napi::Object>();
+    OutputConfig config;
+    
+    std::string type = opts.Has("type") ? opts.Get("type").As<Napi::String>().Utf8Value() : "file";
+    bool known = false;
+    for (int i = 0; i < 4; ++i) {
+        if (type == kOutputTypes[i]) {
+            config.type = static_cast<OutputConfig::Type>(i);
+            known = true;
+        }
+    }
+    if (!known) {
+        Napi::TypeError::New(env, "Output type must be 'file', 'segments', 'url' or 'stream'").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (!opts.Has("path") || !opts.Get("path").IsString()) {
+        Napi::TypeError::New(env, "Output path required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    
+    config.path = opts.Get("path").As<Napi::String>();
+    config.segment_seconds = GetIntOption(opts, "segmentSeconds", config.segment_seconds);
+    config.segment_mb = GetIntOption(opts, "segmentMb", config.segment_mb);
+    if (opts.Has("segmentTemplate")) config.segment_template = opts.Get("segmentTemplate").As<Napi::String>();
+    config.stream = ParseStreamSettings(opts);
+    if (env.IsExceptionPending()) {
+        return env.Undefined();
+    }
+    
+    return Napi::Boolean::New(env, OBSManager::getInstance().addOutput(name, config));
+}
+
+static bool RequireOutputName(const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(info.Env(), "Output name required").ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+Napi::Value StartOutput(const Napi::CallbackInfo& info) {
+    if (!RequireOutputName(info)) {
+        return info.Env().Undefined();
+    }
+    return Napi::Boolean::New(info.Env(), OBSManager::getInstance().startOutput(info[0].As<Napi::String>()));
+}
+
+Napi::Value StopOutput(const Napi::CallbackInfo& info) {
+    if (RequireOutputName(info)) {
+        OBSManager::getInstance().stopOutput(info[0].As<Napi::String>());
+    }
+    return info.Env().Undefined();
+}
+
+Napi::Value RemoveOutput(const Napi::CallbackInfo& info) {
+    if (RequireOutputName(info)) {
+        OBSManager::getInstance().removeOutput(info[0].As<Napi::String>());
+    }
+    return info.Env().Undefined();
+}
+
+static Napi::Object HistogramToObject(Napi::Env env, const LatencyHistogram::Summary& summary) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("count", Napi::Number::New(env, static_cast<double>(summary.count)));
+    obj.Set("mean", Napi::Number::New(env, summary.mean_ms));
+    obj.Set("p50", Napi::Number::New(env, summary.p50_ms));
+    obj.Set("p90", Napi::Number::New(env, summary.p90_ms));
+    obj.Set("p99", Napi::Number::New(env, summary.p99_ms));
+    obj.Set("max", Napi::Number::New(env, summary.max_ms));
+    return obj;
+}
+
+Napi::Value ListOutputs(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::vector<OutputStatus> outputs = OBSManager::getInstance().getOutputs();
+    
+    Napi::Array arr = Napi::Array::New(env, outputs.size());
+    for (size_t i = 0; i < outputs.size(); i++) {
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("name", outputs[i].name);
+        obj.Set("type", kOutputTypes[outputs[i].type]);
+        obj.Set("active", Napi::Boolean::New(env, outputs[i].active));
+        obj.Set("frames", Napi::Number::New(env, outputs[i].frames));
+        obj.Set("droppedFrames", Napi::Number::New(env, outputs[i].dropped_frames));
+        obj.Set("bytesWritten", Napi::Number::New(env, static_cast<double>(outputs[i].bytes_written)));
+        if (outputs[i].type == OutputConfig::STREAM) {
+            obj.Set("latencyMs", HistogramToObject(env, outputs[i].latency));
+        }
+        arr[i] = obj;
+    }
+    return arr;
+}
+
+static Napi::Object SessionStatsToObject(Napi::Env env, const SessionStats& stats) {
+    Napi::Object frames = Napi::Object::New(env);
+    frames.Set("encoderInput", Napi::Number::New(env, stats.encoded_frames));
+    frames.Set("skipped", Napi::Number::New(env, stats.skipped_frames));
+    frames.Set("output", Napi::Number::New(env, stats.output_frames));
+    frames.Set("dropped", Napi::Number::New(env, stats.dropped_frames));
+    
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("active", Napi::Boolean::New(env, stats.active));
+    obj.Set("frames", frames);
+    obj.Set("bytesWritten", Napi::Number::New(env, static_cast<double>(stats.bytes_written)));
+    obj.Set("encoderThreads", Napi::Number::New(env, stats.encoder_threads));
+    obj.Set("preset", stats.preset);
+    return obj;
+}
+
+// createSession(options) -> { id, start(path), stop(), getStats(), destroy() }
+Napi::Value CreateSession(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    RecordingConfig config = ParseRecordingConfig(info, 0);
+    if (env.IsExceptionPending()) {
+        return env.Undefined();
+    }
+    
+    int id = OBSManager::getInstance().createSession(config);
+    if (id < 0) {
+        return env.Null();
+    }
+    
+    Napi::Object session = Napi::Object::New(env);
+    session.Set("id", Napi::Number::New(env, id));
+    session.Set("start", Napi::Function::New(env, [id](const Napi::CallbackInfo& info) -> Napi::Value {
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(info.Env(), "Output path required").ThrowAsJavaScriptException();
+            return info.Env().Undefined();
+        }
+        return Napi::Boolean::New(info.Env(),
+            OBSManager::getInstance().startSession(id, info[0].As<Napi::String>()));
+    }, "start"));
+    session.Set("stop", Napi::Function::New(env, [id](const Napi::CallbackInfo& info) -> Napi::Value {
+        OBSManager::getInstance().stopSession(id);
+        return info.Env().Undefined();
+    }, "stop"));
+    session.Set("getStats", Napi::Function::New(env, [id](const Napi::CallbackInfo& info) -> Napi::Value {
+        return SessionStatsToObject(info.Env(), OBSManager::getInstance().getSessionStats(id));
+    }, "getStats"));
+    session.Set("destroy", Napi::Function::New(env, [id](const Napi::CallbackInfo& info) -> Napi::Value {
+        OBSManager::getInstance().destroySession(id);
+        return info.Env().Undefined();
+    }, "destroy"));
+    return session;
+}
+
+Napi::Value SetEncoderThreadBudget(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Thread count required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    
+    OBSManager::getInstance().setEncoderThreadBudget(info[0].As<Napi::Number>().Int32Value());
+    return env.Undefined();
+}
+
+Napi::Value StartFrameExport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Shared memory name required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    
+    std::string name = info[0].As<Napi::String>();
+    FrameTapConfig config;
+    int slots = 4;
+    
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object opts = info[1].As<Napi::Object>();
+        if (!ParseFrameTapOptions(env, opts, config)) {
+            return env.Undefined();
+        }
+        slots = GetIntOption(opts, "slots", slots);
+    }
+    
+    return Napi::Boolean::New(env, OBSManager::getInstance().startFrameExport(name, config, slots));
+}
+
+Napi::Value StopFrameExport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Shared memory name required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    
+    OBSManager::getInstance().stopFrameExport(info[0].As<Napi::String>());
+    return env.Undefined();
+}
+
+Napi::Value GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    PipelineStats stats = OBSManager::getInstance().getStats();
+    
+    Napi::Object frames = Napi::Object::New(env);
+    frames.Set("total", Napi::Number::New(env, stats.total_frames));
+    frames.Set("lagged", Napi::Number::New(env, stats.lagged_frames));
+    frames.Set("encoderInput", Napi::Number::New(env, stats.video_frames));
+    frames.Set("skipped", Napi::Number::New(env, stats.skipped_frames));
+    frames.Set("output", Napi::Number::New(env, stats.output_frames));
+    frames.Set("dropped", Napi::Number::New(env, stats.dropped_frames));
+    
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("active", Napi::Boolean::New(env, stats.active));
+    obj.Set("frames", frames);
+    obj.Set("averageFrameTimeMs", Napi::Number::New(env, stats.average_frame_time_ms));
+    obj.Set("renderLag", Napi::Number::New(env,
+        stats.total_frames ? static_cast<double>(stats.lagged_frames) / stats.total_frames : 0.0));
+    obj.Set("encoderLag", Napi::Number::New(env,
+        stats.video_frames ? static_cast<double>(stats.skipped_frames) / stats.video_frames : 0.0));
+    obj.Set("bytesWritten", Napi::Number::New(env, static_cast<double>(stats.bytes_written)));
+    obj.Set("bitrateKbps", Napi::Number::New(env, stats.bitrate_kbps));
+    obj.Set("congestion", Napi::Number::New(env, stats.congestion));
+    obj.Set("renderLatencyMs", HistogramToObject(env, stats.render_latency));
+    obj.Set("encodeTimeMs", HistogramToObject(env, stats.encode_time));
+    obj.Set("captureJitterMs", HistogramToObject(env, stats.capture_jitter));
+    obj.Set("streamLatencyMs", HistogramToObject(env, stats.stream_latency));
+    obj.Set("encoder", stats.video_encoder);
+    obj.Set("preset", stats.preset);
+    obj.Set("backend", stats.backend);
+    return obj;
+}
+
+// getMemoryStats() -> { lowMemory, rss, total, stages: { ... } }, in bytes.
+// `total` adds up the stages; canvas and encoder are estimates.
+Napi::Value GetMemoryStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    MemoryStats stats = OBSManager::getInstance().getMemoryStats();
+    
+    auto bytes = [env](uint64_t value) { return Napi::Number::New(env, static_cast<double>(value)); };
+    Napi::Object stages = Napi::Object::New(env);
+    stages.Set("canvas", bytes(stats.canvas));
+    stages.Set("encoder", bytes(stats.encoder));
+    stages.Set("capture", bytes(stats.capture));
+    stages.Set("packets", bytes(stats.packets));
+    stages.Set("replayBuffer", bytes(stats.replay_limit));
+    stages.Set("frameTaps", bytes(stats.frame_taps));
+    stages.Set("audioTaps", bytes(stats.audio_taps));
+    stages.Set("frameExport", bytes(stats.frame_export));
+    stages.Set("log", bytes(stats.log));
+    stages.Set("trace", bytes(stats.trace));
+    
+    uint64_t total = stats.canvas + stats.encoder + stats.capture + stats.packets + stats.replay_limit +
+                     stats.frame_taps + stats.audio_taps + stats.frame_export + stats.log + stats.trace;
+    
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("lowMemory", Napi::Boolean::New(env, stats.low_memory));
+    obj.Set("rss", bytes(stats.rss));
+    obj.Set("total", bytes(total));
+    obj.Set("stages", stages);
+    return obj;
+}
+
+// Each environment has its own onTopologyChange, onSegment and
+// onOutputEvent listener; OBSManager's callbacks fan out to all of them.
+struct TopologyEvent {
+    bool displays = false;
+    bool windows = false;
+};
+
+static void DeliverTopology(Napi::Env env, Napi::Function callback, const TopologyEvent& topology) {
+    Napi::Object event = Napi::Object::New(env);
+    event.Set("displays", Napi::Boolean::New(env, topology.displays));
+    event.Set("windows", Napi::Boolean::New(env, topology.windows));
+    callback.Call({event});
+}
+
+static EnvListeners<TopologyEvent>& TopologyListeners() {
+    static auto* listeners = new EnvListeners<TopologyEvent>("obs_topology", DeliverTopology,
+        [](std::function<void(const TopologyEvent&)> emit) {
+            if (!emit) {
+                return OBSManager::getInstance().setTopologyCallback(nullptr);
+            }
+            return OBSManager::getInstance().setTopologyCallback([emit](bool displays, bool windows) {
+                emit(TopologyEvent{displays, windows});
+            });
+        });
+    return *listeners;
+}
+
+Napi::Value OnTopologyChange(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !(info[0].IsFunction() || info[0].IsNull() || info[0].IsUndefined())) {
+        Napi::TypeError::New(env, "Callback or null required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    
+    if (!info[0].IsFunction()) {
+        TopologyListeners().remove(env);
+        return Napi::Boolean::New(env, true);
+    }
+    return Napi::Boolean::New(env, TopologyListeners().set(env, info[0].As<Napi::Function>()));
+}
+
+static void DeliverSegment(Napi::Env env, Napi::Function callback, const SegmentInfo& segment) {
+    Napi::Object event = Napi::Object::New(env);
+    event.Set("path", segment.path);
+    event.Set("index", segment.index);
+    event.Set("last", Napi::Boolean::New(env, segment.last));
+    callback.Call({event});
+}
+
+static EnvListeners<SegmentInfo>& SegmentListeners() {
+    static auto* listeners = new EnvListeners<SegmentInfo>("obs_segment", DeliverSegment,
+        [](std::function<void(const SegmentInfo&)> emit) {
+            OBSManager::getInstance().setSegmentCallback(std::move(emit));
+            return true;
+        });
+    return *listeners;
+}
+
+Napi::Value OnSegment(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !(info[0].IsFunction() || info[0].IsNull() || info[0].IsUndefined())) {
+        Napi::TypeError::New(env, "Callback or null required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    
+    if (info[0].IsFunction()) {
+        SegmentListeners().set(env, info[0].As<Napi::Function>());
+    } else {
+        SegmentListeners().remove(env);
+    }
+    return env.Undefined();
+}
+
+// OBS_OUTPUT_* stop codes by name
+static const char* StopReason(int code) {
+    switch (code) {
+    case 0: return "success";
+    case -1: return "bad_path";
+    case -2: return "connect_failed";
+    case -3: return "invalid_stream";
+    case -5: return "disconnected";
+    case -6: return "unsupported";
+    case -7: return "no_space";
+    case -8: return "encode_error";
+    case -4:
+    default: return "error";
+    }
+}
+
+static void DeliverOutputEvent(Napi::Env env, Napi::Function callback, const OutputEvent& output_event) {
+    Napi::Object event = Napi::Object::New(env);
+    event.Set("type", output_event.type);
+    event.Set("output", output_event.output);
+    if (output_event.type == "stop") {
+        event.Set("code", output_event.code);
+        event.Set("reason", StopReason(output_event.code));
+        if (!output_event.error.empty()) {
+            event.Set("error", output_event.error);
+        }
+    }
+    callback.Call({event});
+}
+
+static EnvListeners<OutputEvent>& OutputEventListeners() {
+    static auto* listeners = new EnvListeners<OutputEvent>("obs_output_event", DeliverOutputEvent,
+        [](std::function<void(const OutputEvent&)> emit) {
+            OBSManager::getInstance().setOutputEventCallback(std::move(emit));
+            return true;
+        });
+    return *listeners;
+}
+
+Napi::Value OnOutputEvent(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !(info[0].IsFunction() || info[0].IsNull() || info[0].IsUndefined())) {
+        Napi::TypeError::New(env, "Callback or null required").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    
+    if (info[0].IsFunction()) {
+        OutputEventListeners().set(env, info[0].As<Napi::Function>());
+    } else {
+        OutputEventListeners().remove(env);
+    }
+    return env.Undefined();
+}
+
+// Runs once in every environment that loads the addon. N-API modules are
+// context-aware, so workers get their own exports and instance data.
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    SetupAddonEnv(env);
     exports.Set("init", Napi::Function::New(env, InitOBS));
     exports.Set("shutdown", Napi::Function::New(env, Shutdown));
+    exports.Set("getInitTiming", Napi::Function::New(env, GetInitTiming));
     exports.Set("listDisplays", Napi::Function::New(env, ListDisplays));
     exports.Set("listWindows", Napi::Function::New(env, ListWindows));
+    exports.Set("listDisplaysPacked", Napi::Function::New(env, ListDisplaysPacked));
+    exports.Set("listWindowsPacked", Napi::Function::New(env, ListWindowsPacked));
+#ifdef BENCHMARK_HOOKS
+    exports.Set("marshalTestWindows", Napi::Function::New(env, MarshalTestWindows));
+#endif
+    exports.Set("onTopologyChange", Napi::Function::New(env, OnTopologyChange));
     exports.Set("startRecording", Napi::Function::New(env, StartRecording));
     exports.Set("stopRecording", Napi::Function::New(env, StopRecording));
+    exports.Set("isRecording", Napi::Function::New(env, IsRecording));
+    exports.Set("onOutputEvent", Napi::Function::New(env, OnOutputEvent));
+    exports.Set("prepare", Napi::Function::New(env, Prepare));
+    exports.Set("unprepare", Napi::Function::New(env, Unprepare));
+    exports.Set("getStartTiming", Napi::Function::New(env, GetStartTiming));
+    exports.Set("getStats", Napi::Function::New(env, GetStats));
+    exports.Set("getMemoryStats", Napi::Function::New(env, GetMemoryStats));
+    exports.Set("onSegment", Napi::Function::New(env, OnSegment));
+    exports.Set("addOutput", Napi::Function::New(env, AddOutput));
+    exports.Set("startOutput", Napi::Function::New(env, StartOutput));
+    exports.Set("stopOutput", Napi::Function::New(env, StopOutput));
+    exports.Set("removeOutput", Napi::Function::New(env, RemoveOutput));
+    exports.Set("listOutputs", Napi::Function::New(env, ListOutputs));
+    exports.Set("createSession", Napi::Function::New(env, CreateSession));
+    exports.Set("setEncoderThreadBudget", Napi::Function::New(env, SetEncoderThreadBudget));
+    exports.Set("startReplayBuffer", Napi::Function::New(env, StartReplayBuffer));
+    exports.Set("saveReplay", Napi::Function::New(env, SaveReplay));
+    exports.Set("stopReplayBuffer", Napi::Function::New(env, StopReplayBuffer));
+    exports.Set("initAsync", Napi::Function::New(env, InitOBSAsync));
+    exports.Set("shutdownAsync", Napi::Function::New(env, ShutdownAsync));
+    exports.Set("listDisplaysAsync", Napi::Function::New(env, ListDisplaysAsync));
+    exports.Set("listWindowsAsync", Napi::Function::New(env, ListWindowsAsync));
+    exports.Set("listDisplaysPackedAsync", Napi::Function::New(env, ListDisplaysPackedAsync));
+    exports.Set("listWindowsPackedAsync", Napi::Function::New(env, ListWindowsPackedAsync));
+    exports.Set("startRecordingAsync", Napi::Function::New(env, StartRecordingAsync));
+    exports.Set("stopRecordingAsync", Napi::Function::New(env, StopRecordingAsync));
+    exports.Set("prepareAsync", Napi::Function::New(env, PrepareAsync));
+    exports.Set("onFrame", Napi::Function::New(env, OnFrame));
+    exports.Set("offFrame", Napi::Function::New(env, OffFrame));
+    exports.Set("getFrameTapStats", Napi::Function::New(env, GetFrameTapStats));
+    exports.Set("onAudio", Napi::Function::New(env, OnAudio));
+    exports.Set("offAudio", Napi::Function::New(env, OffAudio));
+    exports.Set("getAudioTapStats", Napi::Function::New(env, GetAudioTapStats));
+    exports.Set("startAudioMeter", Napi::Function::New(env, StartAudioMeter));
+    exports.Set("stopAudioMeter", Napi::Function::New(env, StopAudioMeter));
+    exports.Set("getAudioLevels", Napi::Function::New(env, GetAudioLevels));
+    exports.Set("setSystemAudioEnabled", Napi::Function::New(env, SetSystemAudioEnabled));
+    exports.Set("startTrace", Napi::Function::New(env, StartTraceJs));
+    exports.Set("stopTrace", Napi::Function::New(env, StopTraceJs));
+    exports.Set("getTraceStats", Napi::Function::New(env, GetTraceStatsJs));
+    exports.Set("writeTrace", Napi::Function::New(env, WriteTraceJs));
+    exports.Set("setLogOptions", Napi::Function::New(env, SetLogOptions));
+    exports.Set("onLog", Napi::Function::New(env, OnLog));
+    exports.Set("getLogStats", Napi::Function::New(env, GetLogStats));
+    exports.Set("captureFrame", Napi::Function::New(env, CaptureFrame));
+    exports.Set("captureFrameAsync", Napi::Function::New(env, CaptureFrameAsync));
+    exports.Set("startFrameExport", Napi::Function::New(env, StartFrameExport));
+    exports.Set("stopFrameExport", Napi::Function::New(env, StopFrameExport));
     exports.Set("checkScreenPermission", Napi::Function::New(env, CheckScreenPermission));
     exports.Set("requestScreenPermission", Napi::Function::New(env, RequestScreenPermission));
     return exports;
@@ -1,10 +1,22 @@
 #include "obs_wrapper.h"
+#include "encoder_presets.h"
+#include "log_sink.h"
+#include "memory_stats.h"
+#include "stream_sink.h"
+#include "trace.h"
+#include "vfr_encoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
-#include <iostream>
+#include <thread>
 
 #ifdef HAVE_OBS
 #include <obs/obs.h>
 #include <obs/obs-module.h>
+#include <obs/util/platform.h>
 #endif
 
 #ifdef __APPLE__
@@ -15,8 +27,379 @@
 #elif defined(__linux__)
 #include <X11/Xlib.h>
 #include <X11/extensions/Xrandr.h>
+#include "x11_topology.h"
+#include "x11_windows.h"
 #endif
 
+#ifdef HAVE_NATIVE_CAPTURE
+#include "native_recorder.h"
+#endif
+#if defined(HAVE_OBS) && defined(HAVE_STREAM_OUTPUT)
+#include "file_output.h"
+#include "stream_output.h"
+#endif
+
+struct FrameTap {
+    int id = 0;
+    FrameTapConfig config;
+    FrameCallback callback;
+    uint64_t min_interval_ns = 0;
+    uint64_t last_timestamp = 0;
+    bool attached = false;
+};
+
+struct AudioTap {
+    int id = 0;
+    AudioCallback callback;
+    uint32_t channels = 0;
+    uint32_t sample_rate = 0;
+    bool attached = false;
+};
+
+// A capture session: its own source, render mix (view), encoders and output
+struct CaptureSession {
+    int id = 0;
+    RecordingConfig config;
+    void* view = nullptr;
+    void* video = nullptr;         // video_t of the view's mix
+    void* video_source = nullptr;
+    void* scene = nullptr;         // region of interest, when one is set
+    void* video_encoder = nullptr;
+    void* audio_encoder = nullptr;
+    void* output = nullptr;
+    bool active = false;
+    int encoder_threads = 0;
+    std::string preset;
+};
+
+#ifdef HAVE_OBS
+static enum video_format ToOBSFormat(FrameFormat format) {
+    switch (format) {
+    case FrameFormat::RGBA: return VIDEO_FORMAT_RGBA;
+    case FrameFormat::NV12: return VIDEO_FORMAT_NV12;
+    case FrameFormat::I420: return VIDEO_FORMAT_I420;
+    case FrameFormat::BGRA:
+    default: return VIDEO_FORMAT_BGRA;
+    }
+}
+
+static void RawVideoCallback(void* param, struct video_data* frame) {
+    FrameTap* tap = static_cast<FrameTap*>(param);
+    TraceSpan span(kTraceFrames, "frame_tap");
+    
+    if (tap->min_interval_ns && tap->last_timestamp &&
+        frame->timestamp - tap->last_timestamp < tap->min_interval_ns) {
+        return;
+    }
+    tap->last_timestamp = frame->timestamp;
+    
+    VideoFrame view;
+    for (int i = 0; i < 4; ++i) {
+        view.data[i] = frame->data[i];
+        view.linesize[i] = frame->linesize[i];
+    }
+    view.width = tap->config.width;
+    view.height = tap->config.height;
+    view.format = tap->config.format;
+    view.timestamp = frame->timestamp;
+    tap->callback(view);
+}
+
+static void RawAudioCallback(void* param, size_t mix_idx, struct audio_data* data) {
+    (void)mix_idx;
+    AudioTap* tap = static_cast<AudioTap*>(param);
+    TraceSpan span(kTraceFrames, "audio_tap");
+    
+    AudioFrame view;
+    for (uint32_t ch = 0; ch < tap->channels; ++ch) {
+        view.data[ch] = reinterpret_cast<const float*>(data->data[ch]);
+    }
+    view.frames = data->frames;
+    view.channels = tap->channels;
+    view.sample_rate = tap->sample_rate;
+    view.timestamp = data->timestamp;
+    tap->callback(view);
+}
+#endif
+
+bool IsSupportedSampleRate(int sample_rate) {
+    return sample_rate == 44100 || sample_rate == 48000;
+}
+
+#ifdef HAVE_OBS
+// Time from a frame's video clock timestamp until it is ready for encoders
+static void StatsVideoCallback(void* param, struct video_data* frame) {
+    static_cast<LatencyHistogram*>(param)->record(os_gettime_ns() - frame->timestamp);
+}
+
+#if LIBOBS_API_MAJOR_VER >= 31
+// fer/ferc bracket the encoder's work on the frame behind this packet
+static void StatsPacketCallback(obs_output_t*, struct encoder_packet* packet,
+                                struct encoder_packet_time* timing, void* param) {
+    if (packet->type == OBS_ENCODER_VIDEO && timing && timing->ferc > timing->fer) {
+        static_cast<LatencyHistogram*>(param)->record(timing->ferc - timing->fer);
+    }
+}
+#endif
+
+#ifndef __APPLE__
+// Monitor/screen index from a display id; an empty id means the first
+// display. -1 for anything that is not a non-negative number.
+static int DisplayIndex(const std::string& display_id) {
+    if (display_id.empty()) {
+        return 0;
+    }
+    char* end = nullptr;
+    long index = std::strtol(display_id.c_str(), &end, 10);
+    if (*end != '\0' || index < 0 || index > INT32_MAX) {
+        return -1;
+    }
+    return static_cast<int>(index);
+}
+#endif
+
+static obs_source_t* CreateVideoSource(const RecordingConfig& config, const char* name) {
+#ifndef __APPLE__
+    int display_index = DisplayIndex(config.display_id);
+    if (config.source_type != RecordingConfig::WINDOW && display_index < 0) {
+        LogError() << "Invalid display id: \"" << config.display_id << "\"";
+        return nullptr;
+    }
+#endif
+    std::string source_id;
+    obs_data_t* settings = obs_data_create();
+    
+#ifdef __APPLE__
+    // Use ScreenCaptureKit on macOS
+    if (config.source_type == RecordingConfig::WINDOW) {
+        source_id = "screen_capture";
+        obs_data_set_int(settings, "type", 1); // Window
+        obs_data_set_int(settings, "window", config.window_id);
+    } else {
+        source_id = "screen_capture";
+        obs_data_set_int(settings, "type", 0); // Display
+        obs_data_set_string(settings, "display_uuid", config.display_id.c_str());
+    }
+    obs_data_set_bool(settings, "show_cursor", config.capture_cursor);
+#elif defined(_WIN32)
+    // Use Graphics Capture API on Windows
+    if (config.source_type == RecordingConfig::WINDOW) {
+        source_id = "window_capture";
+    } else {
+        source_id = "monitor_capture";
+        obs_data_set_int(settings, "monitor", display_index);
+    }
+    obs_data_set_bool(settings, "cursor", config.capture_cursor);
+#else
+    // Use X11 on Linux
+    source_id = "xcomposite_input";
+    obs_data_set_int(settings, "screen", display_index < 0 ? 0 : display_index);
+    obs_data_set_bool(settings, "show_cursor", config.capture_cursor);
+#endif
+    
+    obs_source_t* source = obs_source_create(source_id.c_str(), name, settings, nullptr);
+    obs_data_release(settings);
+    
+    if (!source) {
+        LogError() << "Failed to create video source: " << source_id;
+        return nullptr;
+    }
+    return source;
+}
+
+static bool HasRegion(const RecordingConfig& config) {
+    return config.region_width > 0 && config.region_height > 0;
+}
+
+// Wraps `source` in a private scene that places the region's top-left
+// corner at the canvas origin. With the canvas sized to the region, only
+// the region is rasterized; unlike a crop this needs no source size, which
+// capture sources only report once frames arrive.
+static obs_scene_t* CreateRegionScene(obs_source_t* source, const RecordingConfig& config, const char* name) {
+    obs_scene_t* scene = obs_scene_create_private(name);
+    if (!scene) {
+        LogError() << "Failed to create region scene";
+        return nullptr;
+    }
+    
+    obs_sceneitem_t* item = obs_scene_add(scene, source);
+    struct vec2 pos;
+    vec2_set(&pos, -static_cast<float>(config.region_x), -static_cast<float>(config.region_y));
+    obs_sceneitem_set_pos(item, &pos);
+    return scene;
+}
+
+static obs_source_t* CreateAudioSource(const char* name) {
+    std::string source_id;
+    
+#ifdef __APPLE__
+    source_id = "coreaudio_output_capture"; // System audio
+#elif defined(_WIN32)
+    source_id = "wasapi_output_capture"; // WASAPI
+#else
+    source_id = "pulse_output_capture"; // PulseAudio
+#endif
+    
+    obs_data_t* settings = obs_data_create();
+    obs_source_t* source = obs_source_create(source_id.c_str(), name, settings, nullptr);
+    obs_data_release(settings);
+    
+    if (!source) {
+        LogError() << "Failed to create audio source: " << source_id;
+        return nullptr;
+    }
+    return source;
+}
+
+// Without scale_up the output is shrunk to fit the canvas, keeping its
+// aspect ratio: upscaling only adds pixels to every buffer downstream
+static void LimitOutputSize(struct obs_video_info& ovi, const BufferLimits& limits) {
+    if (limits.scale_up || (ovi.output_width <= ovi.base_width && ovi.output_height <= ovi.base_height)) {
+        return;
+    }
+    double scale = std::min(static_cast<double>(ovi.base_width) / ovi.output_width,
+                            static_cast<double>(ovi.base_height) / ovi.output_height);
+    ovi.output_width = std::max(2u, static_cast<uint32_t>(ovi.output_width * scale) & ~1u);
+    ovi.output_height = std::max(2u, static_cast<uint32_t>(ovi.output_height * scale) & ~1u);
+}
+
+// Encoder threads after the profile's cap; 0 leaves the encoder's default
+static int CapEncoderThreads(int threads, const BufferLimits& limits) {
+    if (limits.max_encoder_threads > 0) {
+        return threads > 0 ? std::min(threads, limits.max_encoder_threads) : limits.max_encoder_threads;
+    }
+    return threads;
+}
+
+static obs_data_t* VideoEncoderSettings(const RecordingConfig& config, const std::string& preset, int threads,
+                                        const BufferLimits& limits) {
+    obs_data_t* settings = obs_data_create();
+    obs_data_set_string(settings, "rate_control", config.rate_control.c_str());
+    obs_data_set_int(settings, "bitrate", config.video_bitrate);
+    obs_data_set_int(settings, "crf", config.crf);
+    obs_data_set_int(settings, "keyint_sec", config.keyint_sec);
+    
+    if (config.video_encoder == "obs_x264") {
+        obs_data_set_string(settings, "preset", preset.c_str());
+        if (!config.tune.empty()) {
+            obs_data_set_string(settings, "tune", config.tune.c_str());
+        }
+        // Pictures x264 holds: lookahead, B-frames and one per frame thread
+        std::string options;
+        threads = CapEncoderThreads(threads, limits);
+        if (threads > 0) {
+            options += "threads=" + std::to_string(threads);
+        }
+        if (limits.encoder_lookahead >= 0) {
+            options += " rc-lookahead=" + std::to_string(limits.encoder_lookahead);
+            options += " sync-lookahead=0";
+        }
+        if (limits.encoder_b_frames >= 0) {
+            options += " bframes=" + std::to_string(limits.encoder_b_frames);
+        }
+        if (!options.empty()) {
+            obs_data_set_string(settings, "x264opts", options.c_str() + (options[0] == ' ' ? 1 : 0));
+        }
+    }
+    return settings;
+}
+
+static obs_encoder_t* CreateAudioEncoder(const RecordingConfig& config, const char* name) {
+    obs_data_t* settings = obs_data_create();
+    obs_data_set_int(settings, "bitrate", config.audio_bitrate);
+    obs_encoder_t* encoder = obs_audio_encoder_create("ffmpeg_aac", name, settings, 0, nullptr);
+    obs_data_release(settings);
+    
+    if (!encoder) {
+        LogError() << "Failed to create audio encoder: ffmpeg_aac";
+        return nullptr;
+    }
+    obs_encoder_set_audio(encoder, obs_get_audio());
+    return encoder;
+}
+
+static const char* GetOutputError(obs_output_t* output) {
+    const char* error = obs_output_get_last_error(output);
+    return error ? error : "unknown error";
+}
+
+static bool IsStreamOutput(obs_output_t* output) {
+#ifdef HAVE_STREAM_OUTPUT
+    return std::strcmp(obs_output_get_id(output), kStreamOutputId) == 0;
+#else
+    (void)output;
+    return false;
+#endif
+}
+
+// A file output to a FIFO is written like a live stream: the reader can
+// stall, and only a stream output's writes can be abandoned on stop
+static bool UsesStreamOutput(const OutputConfig& config) {
+#ifdef HAVE_STREAM_OUTPUT
+    return config.type == OutputConfig::STREAM ||
+           (config.type == OutputConfig::FILE && IsStreamTarget(config.path));
+#else
+    return config.type == OutputConfig::STREAM;
+#endif
+}
+#endif
+
+#ifdef HAVE_NATIVE_CAPTURE
+// OBS_OUTPUT_ENCODE_ERROR, for the built-in backend's stop events
+static constexpr int kOutputEncodeError = -8;
+#endif
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint64_t PipelineKey(const RecordingConfig& config) {
+    // FNV-1a over every field that ends up in a source, the canvas or an
+    // encoder. Output-only settings (paths, replay limits) are left out.
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+    auto mix_int = [&mix](int64_t value) { mix(&value, sizeof(value)); };
+    auto mix_string = [&](const std::string& value) {
+        mix_int(static_cast<int64_t>(value.size()));
+        mix(value.data(), value.size());
+    };
+    
+    mix_int(config.source_type);
+    mix_string(config.display_id);
+    mix_int(static_cast<int64_t>(config.window_id));
+    mix_string(config.application_id);
+    mix_int(config.region_x);
+    mix_int(config.region_y);
+    mix_int(config.region_width);
+    mix_int(config.region_height);
+    mix_int(config.width);
+    mix_int(config.height);
+    mix_int(config.fps);
+    mix_int(config.video_bitrate);
+    mix_int(config.audio_bitrate);
+    mix_int(config.sample_rate);
+    mix_string(config.video_encoder);
+    mix_string(config.preset);
+    mix_string(config.tune);
+    mix_string(config.rate_control);
+    mix_int(config.crf);
+    mix_int(config.keyint_sec);
+    mix_int(config.encoder_threads);
+    mix_int(config.vfr);
+    mix_int(config.vfr_min_fps);
+    mix(&config.cpu_budget, sizeof(config.cpu_budget));
+    mix_int(config.capture_cursor);
+    mix_int(config.capture_audio);
+    mix_int(config.hide_obs);
+    return hash;
+}
+
 OBSManager& OBSManager::getInstance() {
     static OBSManager instance;
     return instance;
@@ -26,61 +409,121 @@ OBSManager::~OBSManager() {
     if (initialized_) {
         shutdown();
     }
+    LogSink::instance().flush();
 }
 
-bool OBSManager::initialize() {
+bool OBSManager::initialize(const InitOptions& options) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     if (initialized_) {
         return true;
     }
     
-    std::cout << "Initializing OBS core..." << std::endl;
+    LogInfo() << "Initializing OBS core..." << (options.low_memory ? " (low-memory profile)" : "");
+    TraceSpan span(kTracePipeline, "initialize");
+    limits_ = options.low_memory ? BufferLimits::LowMemory() : BufferLimits();
+    low_memory_ = options.low_memory;
+    
+    InitTiming timing;
+    auto init_start = std::chrono::steady_clock::now();
     
 #ifdef HAVE_OBS
+    // libobs and plugin messages go through the async sink with ours
+    base_set_log_handler(LogSink::obsLogHandler, nullptr);
+    
     // Initialize OBS core
-    if (!obs_startup("en-US", nullptr, nullptr)) {
-        std::cerr << "Failed to initialize OBS core" << std::endl;
+    auto phase_start = std::chrono::steady_clock::now();
+    bool started;
+    {
+        TraceSpan startup_span(kTracePipeline, "obs_startup");
+        started = obs_startup("en-US", nullptr, nullptr);
+    }
+    if (!started) {
+        LogError() << "Failed to initialize OBS core";
         return false;
     }
+    timing.startup_ms = MillisecondsSince(phase_start);
+    init_timing_ = timing;
     
     // Setup plugin paths
     setupPluginPaths();
     
     // Load required plugins
-    if (!loadRequiredPlugins()) {
-        std::cerr << "Failed to load required plugins" << std::endl;
+    if (!loadRequiredPlugins(options)) {
+        LogError() << "Failed to load required plugins";
         obs_shutdown();
         return false;
     }
+    timing = init_timing_;
+    
+#ifdef HAVE_X264
+    RegisterVfrEncoder();
+    vfr_encoder_registered_ = true;
+#endif
+#ifdef HAVE_STREAM_OUTPUT
+    RegisterFileOutput();
+    RegisterStreamOutput();
+#endif
     
     // Reset audio and video
-    struct obs_audio_info ai = {};
-    ai.samples_per_sec = 48000;
-    ai.speakers = SPEAKERS_STEREO;
-    obs_reset_audio(&ai);
+    phase_start = std::chrono::steady_clock::now();
+    if (!IsSupportedSampleRate(options.sample_rate)) {
+        LogWarning() << "Unsupported sample rate " << options.sample_rate << ", using 48000";
+    }
+    resetAudio(IsSupportedSampleRate(options.sample_rate) ? options.sample_rate : 48000);
+    timing.audio_reset_ms = MillisecondsSince(phase_start);
     
+    phase_start = std::chrono::steady_clock::now();
+    // Until a pipeline sizes the canvas to its source, match the first
+    // display rather than allocating for a fixed 1080p
     struct obs_video_info ovi = {};
     ovi.base_width = 1920;
     ovi.base_height = 1080;
-    ovi.output_width = 1920;
-    ovi.output_height = 1080;
+    std::vector<DisplayInfo> displays = getDisplays();
+    if (!displays.empty() && displays[0].width > 0 && displays[0].height > 0) {
+        ovi.base_width = std::max(2, displays[0].width & ~1);
+        ovi.base_height = std::max(2, displays[0].height & ~1);
+    }
+    ovi.output_width = ovi.base_width;
+    ovi.output_height = ovi.base_height;
     ovi.output_format = VIDEO_FORMAT_NV12;
     ovi.fps_num = 30;
     ovi.fps_den = 1;
     ovi.graphics_module = "libobs-opengl";
-    obs_reset_video(&ovi);
+    {
+        TraceSpan video_span(kTracePipeline, "reset_video");
+        obs_reset_video(&ovi);
+    }
+    timing.video_reset_ms = MillisecondsSince(phase_start);
     
-    std::cout << "OBS core initialized successfully" << std::endl;
+    LogInfo() << "OBS core initialized successfully";
+#elif defined(HAVE_NATIVE_CAPTURE)
+    (void)options;
+    LogInfo() << "Building without OBS - using the built-in X11 capture backend";
 #else
-    std::cout << "Building without OBS - foundation only" << std::endl;
+    (void)options;
+    LogInfo() << "Building without OBS - foundation only";
 #endif
     
+    timing.total_ms = MillisecondsSince(init_start);
+    init_timing_ = timing;
+    
+    LogInfo() << "Startup " << timing.startup_ms << " ms, " << timing.modules.size() << " module phase(s), "
+              << "audio reset " << timing.audio_reset_ms << " ms, video reset " << timing.video_reset_ms
+              << " ms, total " << timing.total_ms << " ms";
+    
     initialized_ = true;
     return true;
 }
 
+InitTiming OBSManager::getInitTiming() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    return init_timing_;
+}
+
 void OBSManager::setupPluginPaths() {
 #ifdef HAVE_OBS
-    std::cout << "Setting up OBS plugin paths..." << std::endl;
+    LogInfo() << "Setting up OBS plugin paths...";
     
 #ifdef OBS_PLUGINS_PATH
     // Add the plugins directory
@@ -103,22 +546,99 @@ void OBSManager::setupPluginPaths() {
 #endif
 }
 
-bool OBSManager::loadRequiredPlugins() {
+std::vector<std::string> RequiredModules(bool capture_audio) {
+#ifdef __APPLE__
+    // mac-capture provides both screen_capture and coreaudio_output_capture
+    (void)capture_audio;
+    return {"mac-capture", "obs-x264", "obs-ffmpeg"};
+#elif defined(_WIN32)
+    std::vector<std::string> modules = {"win-capture", "obs-x264", "obs-ffmpeg"};
+    if (capture_audio) {
+        modules.push_back("win-wasapi");
+    }
+    return modules;
+#else
+    std::vector<std::string> modules = {"linux-capture", "obs-x264", "obs-ffmpeg"};
+    if (capture_audio) {
+        modules.push_back("linux-pulseaudio");
+    }
+    return modules;
+#endif
+}
+
+#ifdef HAVE_OBS
+struct FoundModule {
+    std::string bin_path;
+    std::string data_path;
+};
+
+static void CollectModule(void* param, const struct obs_module_info* info) {
+    auto* found = static_cast<std::map<std::string, FoundModule>*>(param);
+    std::string name = std::filesystem::path(info->bin_path).stem().string();
+    // The first search path wins, matching obs_load_all_modules
+    found->emplace(name, FoundModule{info->bin_path, info->data_path ? info->data_path : ""});
+}
+#endif
+
+bool OBSManager::loadRequiredPlugins(const InitOptions& options) {
+    TraceSpan span(kTracePipeline, "load_modules");
 #ifdef HAVE_OBS
-    std::cout << "Loading required OBS plugins..." << std::endl;
+    LogInfo() << "Loading required OBS plugins...";
+    
+    auto phase_start = std::chrono::steady_clock::now();
     
-    // Load all available modules
-    obs_load_all_modules();
+    if (options.load_all_modules) {
+        // Load all available modules
+        obs_load_all_modules();
+        init_timing_.modules.emplace_back("*", MillisecondsSince(phase_start));
+    } else {
+        // Only dlopen what capture needs; scanning the search paths is cheap
+        // compared to loading and initializing every plugin
+        std::map<std::string, FoundModule> found;
+        obs_find_modules(CollectModule, &found);
+        
+        std::vector<std::string> wanted = options.modules.empty() ? RequiredModules(options.capture_audio)
+                                                                  : options.modules;
+        size_t loaded = 0;
+        
+        for (const std::string& name : wanted) {
+            auto it = found.find(name);
+            if (it == found.end()) {
+                LogError() << "OBS module not found: " << name;
+                continue;
+            }
+            
+            phase_start = std::chrono::steady_clock::now();
+            obs_module_t* module = nullptr;
+            int result = obs_open_module(&module, it->second.bin_path.c_str(), it->second.data_path.c_str());
+            if (result != MODULE_SUCCESS || !obs_init_module(module)) {
+                LogError() << "Failed to load OBS module: " << name << " (" << result << ")";
+                continue;
+            }
+            init_timing_.modules.emplace_back(name, MillisecondsSince(phase_start));
+            loaded++;
+        }
+        
+        if (loaded == 0) {
+            return false;
+        }
+    }
     
+    phase_start = std::chrono::steady_clock::now();
     obs_post_load_modules();
-    std::cout << "Plugins loaded successfully" << std::endl;
+    init_timing_.post_load_ms = MillisecondsSince(phase_start);
+    LogInfo() << "Plugins loaded successfully";
     return true;
 #else
+    (void)options;
     return true;
 #endif
 }
 
 void OBSManager::shutdown() {
+    TraceSpan span(kTracePipeline, "shutdown");
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     if (!initialized_) {
         return;
     }
@@ -127,14 +647,44 @@ void OBSManager::shutdown() {
         stopRecording();
     }
     
-    std::cout << "Shutting down OBS..." << std::endl;
+    if (replay_active_) {
+        stopReplayBuffer();
+    }
+    
+    while (!outputs_.empty()) {
+        removeOutput(outputs_.begin()->first);
+    }
+    
+    while (!sessions_.empty()) {
+        destroySession(sessions_.begin()->first);
+    }
+    
+    LogInfo() << "Shutting down OBS...";
+    
+    prepared_ = false;
     
 #ifdef HAVE_OBS
+    for (auto& entry : frame_taps_) {
+        detachFrameTap(*entry.second);
+    }
+    frame_taps_.clear();
+    frame_exports_.clear();
+    
+    stopAudioMeter();
+    for (auto& entry : audio_taps_) {
+        detachAudioTap(*entry.second);
+    }
+    audio_taps_.clear();
+    
     cleanupRecording();
-    obs_shutdown();
-#endif
     
+    // getStats() reads libobs globals under stats_mutex_
+    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+    obs_shutdown();
+    initialized_ = false;
+#else
     initialized_ = false;
+#endif
 }
 
 std::vector<DisplayInfo> OBSManager::getDisplays() {
@@ -188,38 +738,13 @@ std::vector<DisplayInfo> OBSManager::getDisplays() {
     }, reinterpret_cast<LPARAM>(&data));
     
 #else // Linux
+    if (X11Topology* topology = getTopology()) {
+        return topology->getDisplays();
+    }
+    
     Display* display = XOpenDisplay(nullptr);
     if (display) {
-        Window root = DefaultRootWindow(display);
-        XRRScreenResources* resources = XRRGetScreenResourcesCurrent(display, root);
-        
-        if (resources) {
-            for (int i = 0; i < resources->noutput; ++i) {
-                XRROutputInfo* output_info = XRRGetOutputInfo(display, resources, resources->outputs[i]);
-                
-                if (output_info && output_info->connection == RR_Connected && output_info->crtc) {
-                    XRRCrtcInfo* crtc_info = XRRGetCrtcInfo(display, resources, output_info->crtc);
-                    
-                    if (crtc_info) {
-                        DisplayInfo info;
-                        info.id = std::to_string(resources->outputs[i]);
-                        info.name = std::string(output_info->name);
-                        info.width = crtc_info->width;
-                        info.height = crtc_info->height;
-                        info.x = crtc_info->x;
-                        info.y = crtc_info->y;
-                        displays.push_back(info);
-                        
-                        XRRFreeCrtcInfo(crtc_info);
-                    }
-                }
-                
-                if (output_info) {
-                    XRRFreeOutputInfo(output_info);
-                }
-            }
-            XRRFreeScreenResources(resources);
-        }
+        displays = QueryX11Displays(display);
         XCloseDisplay(display);
     }
 #endif
@@ -299,104 +824,1606 @@ std::vector<WindowInfo> OBSManager::getWindows() {
         data->windows->push_back(info);
         return TRUE;
     }, reinterpret_cast<LPARAM>(&data));
+#else // Linux
+    if (X11Topology* topology = getTopology()) {
+        return topology->getWindows();
+    }
+    windows = EnumerateX11Windows();
 #endif
     
     return windows;
 }
 
-bool OBSManager::startRecording(const std::string& output_path, const RecordingConfig& config) {
-    if (!initialized_ || recording_) {
+bool OBSManager::setTopologyCallback(TopologyCallback callback) {
+#ifdef __linux__
+    X11Topology* topology = getTopology();
+    if (!topology) {
         return false;
     }
     
-    std::cout << "Starting OBS recording to: " << output_path << std::endl;
-    
-#ifdef HAVE_OBS
-    // Setup video
-    if (!setupVideoOutput(config)) {
-        std::cerr << "Failed to setup video output" << std::endl;
-        return false;
+    if (callback) {
+        topology->setChangeCallback([callback](int kinds) {
+            callback((kinds & X11Topology::DISPLAYS) != 0, (kinds & X11Topology::WINDOWS) != 0);
+        });
+    } else {
+        topology->setChangeCallback(nullptr);
     }
+    return true;
+#else
+    (void)callback;
+    return false;
+#endif
+}
+
+#ifdef __linux__
+X11Topology* OBSManager::getTopology() {
+    std::lock_guard<std::mutex> lock(topology_mutex_);
     
-    // Setup audio if requested
-    if (config.capture_audio) {
-        if (!setupAudioOutput(config)) {
-            std::cerr << "Failed to setup audio output" << std::endl;
-            return false;
+    if (!topology_ && !topology_unavailable_) {
+        topology_ = std::make_unique<X11Topology>();
+        if (!topology_->start()) {
+            LogWarning() << "X11 topology cache unavailable, falling back to per-call queries";
+            topology_.reset();
+            topology_unavailable_ = true;
         }
     }
+    return topology_.get();
+}
+#endif
+
+bool OBSManager::prepare(const RecordingConfig& config) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     
-    // Create sources
-    if (!createVideoSource(config)) {
-        std::cerr << "Failed to create video source" << std::endl;
+    if (!initialized_) {
         return false;
     }
     
-    if (config.capture_audio && !createAudioSource(config)) {
-        std::cerr << "Failed to create audio source" << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    bool warm = false;
+    if (!ensurePipeline(config, warm)) {
         return false;
     }
     
-    // Start recording
-    obs_output_t* output = obs_output_create("ffmpeg_muxer", "recording_output", nullptr, nullptr);
-    if (!output) {
-        std::cerr << "Failed to create output" << std::endl;
+#ifdef HAVE_OBS
+    if (!obs_output_ && !createRecordingOutput()) {
+        cleanupRecording();
         return false;
     }
+#endif
     
-    obs_data_t* settings = obs_data_create();
-    obs_data_set_string(settings, "path", output_path.c_str());
-    obs_output_update(output, settings);
-    obs_data_release(settings);
-    
-    if (!obs_output_start(output)) {
-        std::cerr << "Failed to start recording output" << std::endl;
-        obs_output_release(output);
-        return false;
+    prepared_ = true;
+    if (!warm) {
+        LogInfo() << "Pipeline prepared in " << MillisecondsSince(start) << " ms";
     }
-    
-    obs_output_ = output;
-    recording_ = true;
-    
-    std::cout << "Recording started successfully" << std::endl;
-    return true;
-#else
-    std::cout << "Mock recording started (no OBS integration)" << std::endl;
-    recording_ = true;
     return true;
-#endif
 }
 
-void OBSManager::stopRecording() {
-    if (!recording_) {
-        return;
-    }
-    
-    std::cout << "Stopping recording..." << std::endl;
+void OBSManager::unprepare() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     
-#ifdef HAVE_OBS
-    if (obs_output_) {
-        obs_output_stop(static_cast<obs_output_t*>(obs_output_));
-        obs_output_release(static_cast<obs_output_t*>(obs_output_));
-        obs_output_ = nullptr;
+    prepared_ = false;
+    if (!pipelineInUse()) {
+        cleanupRecording();
+    }
+}
+
+bool OBSManager::startRecording(const std::string& output_path) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    return startRecording(output_path, pipeline_ready_ ? pipeline_config_ : RecordingConfig());
+}
+
+bool OBSManager::startRecording(const std::string& output_path, const RecordingConfig& config) {
+    TraceSpan span(kTracePipeline, "start_recording");
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    // A recording whose output failed on its own is cleaned up here, so
+    // the caller can start again without calling stopRecording first
+    if (recording_ && recording_failed_) {
+        stopRecording();
+    }
+    if (!initialized_ || recording_) {
+        return false;
+    }
+    recording_failed_ = false;
+    
+    LogInfo() << "Starting OBS recording to: " << output_path;
+    
+    auto start = std::chrono::steady_clock::now();
+    bool warm = false;
+    if (!ensurePipeline(config, warm)) {
+        return false;
+    }
+    double prepare_ms = warm ? 0.0 : MillisecondsSince(start);
+    auto output_start = std::chrono::steady_clock::now();
+    
+#ifdef HAVE_OBS
+    // ffmpeg_muxer finalizes asynchronously after a stop; if the previous
+    // recording is still being written, leave that output to finish and
+    // start a fresh one on the same encoders. The same goes when switching
+    // between files and live streams, which are different output types.
+    bool stream = IsStreamTarget(output_path);
+    if (obs_output_ && (obs_output_active(static_cast<obs_output_t*>(obs_output_)) ||
+                        IsStreamOutput(static_cast<obs_output_t*>(obs_output_)) != stream)) {
+        unwatchOutput(obs_output_);
+        obs_output_release(static_cast<obs_output_t*>(obs_output_));
+        obs_output_ = nullptr;
+    }
+    
+    if (!obs_output_ && !createRecordingOutput(stream)) {
+        releasePipelineIfUnprepared();
+        return false;
+    }
+    obs_output_t* output = static_cast<obs_output_t*>(obs_output_);
+    if (stream) {
+        configureStreamOutput(output, output_path, config.stream);
+    } else {
+        configureMuxerOutput(output, output_path, config.segment_seconds, config.segment_mb,
+                             config.segment_template);
+    }
+    
+    if (!obs_output_start(output)) {
+        LogError() << "Failed to start recording output: " << GetOutputError(output);
+        releasePipelineIfUnprepared();
+        return false;
+    }
+    attachStats(output);
+#elif defined(HAVE_NATIVE_CAPTURE)
+    if (!startNativeRecording(output_path, config)) {
+        releasePipelineIfUnprepared();
+        return false;
+    }
+#else
+    LogInfo() << "Mock recording started (no OBS integration)";
+#endif
+    
+    start_timing_.warm = warm;
+    start_timing_.prepare_ms = prepare_ms;
+    start_timing_.start_ms = MillisecondsSince(output_start);
+    recording_ = true;
+#ifndef HAVE_OBS
+    // No output signals without libobs; the backend is running at this point
+    OutputEvent started;
+    started.type = "start";
+    started.output = "recording";
+    emitOutputEvent(started);
+#endif
+    
+    LogInfo() << "Recording started (" << (warm ? "warm" : "cold") << ", "
+              << start_timing_.prepare_ms + start_timing_.start_ms << " ms)";
+    return true;
+}
+
+#ifdef HAVE_NATIVE_CAPTURE
+bool OBSManager::startNativeRecording(const std::string& output_path, const RecordingConfig& config) {
+    // Same source semantics as the OBS pipeline: a display (the first one
+    // by default) or a window, optionally narrowed to a region of it
+    uint64_t window = 0;
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    if (config.source_type == RecordingConfig::WINDOW) {
+        window = config.window_id;
+    } else {
+        std::vector<DisplayInfo> displays = getDisplays();
+        auto display = std::find_if(displays.begin(), displays.end(), [&](const DisplayInfo& info) {
+            return config.display_id.empty() || info.id == config.display_id;
+        });
+        if (display == displays.end()) {
+            LogError() << "Unknown display: " << config.display_id;
+            return false;
+        }
+        x = display->x;
+        y = display->y;
+        width = display->width;
+        height = display->height;
+    }
+    if (config.region_width > 0 && config.region_height > 0) {
+        x += config.region_x;
+        y += config.region_y;
+        width = config.region_width;
+        height = config.region_height;
+    }
+    
+    auto recorder = std::make_unique<NativeRecorder>();
+    recorder->setFailureCallback([this](const std::string& error) {
+        OutputEvent event;
+        event.type = "stop";
+        event.output = "recording";
+        event.code = kOutputEncodeError;
+        event.error = error;
+        emitOutputEvent(event);
+    });
+    recorder->setLimits(limits_);
+    if (!recorder->start(output_path, config, window, x, y, width, height)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+    native_recorder_ = std::move(recorder);
+    return true;
+}
+#endif
+
+StartTiming OBSManager::getStartTiming() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    return start_timing_;
+}
+
+void OBSManager::stopRecording() {
+    TraceSpan span(kTracePipeline, "stop_recording");
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    if (!recording_) {
+        return;
+    }
+    
+    LogInfo() << "Stopping recording...";
+    
+#ifdef HAVE_OBS
+    detachStats(obs_output_);
+    if (obs_output_) {
+        obs_output_stop(static_cast<obs_output_t*>(obs_output_));
+    }
+#elif defined(HAVE_NATIVE_CAPTURE)
+    if (native_recorder_) {
+        native_recorder_->stop();
+        std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+        native_recorder_.reset();
+    }
+#endif
+#ifndef HAVE_OBS
+    // The file is finalized; a recorder that failed has reported its stop
+    if (recording_active_) {
+        OutputEvent stopped;
+        stopped.type = "stop";
+        stopped.output = "recording";
+        emitOutputEvent(stopped);
+    }
+#endif
+    
+    // A prepared pipeline (and its output) stays up for the next recording
+    recording_ = false;
+    releasePipelineIfUnprepared();
+    LogInfo() << "Recording stopped";
+}
+
+bool OBSManager::startReplayBuffer(const RecordingConfig& config) {
+    TraceSpan span(kTracePipeline, "start_replay_buffer");
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    if (!initialized_ || replay_active_) {
+        return false;
+    }
+    
+    int replay_max_mb = config.replay_max_mb;
+    if (limits_.max_replay_mb > 0 && (replay_max_mb <= 0 || replay_max_mb > limits_.max_replay_mb)) {
+        replay_max_mb = limits_.max_replay_mb;
+    }
+    LogInfo() << "Starting replay buffer (" << config.replay_max_seconds << "s / "
+              << replay_max_mb << " MB)";
+    
+    bool warm = false;
+    if (!ensurePipeline(config, warm)) {
+        return false;
+    }
+    
+#ifdef HAVE_OBS
+    
+    // The replay_buffer output from obs-ffmpeg keeps encoded packets in a
+    // circular buffer trimmed by both limits, and always cuts saves on a
+    // keyframe. Saving hands the packets to a separate muxer thread.
+    obs_data_t* settings = obs_data_create();
+    obs_data_set_int(settings, "max_time_sec", config.replay_max_seconds);
+    obs_data_set_int(settings, "max_size_mb", replay_max_mb);
+    obs_data_set_bool(settings, "allow_spaces", true);
+    obs_output_t* output = obs_output_create("replay_buffer", "replay_output", settings, nullptr);
+    obs_data_release(settings);
+    
+    if (!output) {
+        LogError() << "Failed to create replay buffer output";
+        releasePipelineIfUnprepared();
+        return false;
+    }
+    
+    attachEncoders(output);
+    watchOutput(output, "replay");
+    
+    if (!obs_output_start(output)) {
+        LogError() << "Failed to start replay buffer: " << GetOutputError(output);
+        obs_output_release(output);
+        unwatchOutput(output);
+        releasePipelineIfUnprepared();
+        return false;
+    }
+    
+    replay_output_ = output;
+    replay_active_ = true;
+    attachStats(output);
+    // Whichever limit trims first: the size cap, or the duration at the bitrate
+    replay_limit_bytes_ = std::min<uint64_t>(static_cast<uint64_t>(replay_max_mb) * 1024 * 1024,
+        static_cast<uint64_t>(config.video_bitrate + config.audio_bitrate) * 125 * config.replay_max_seconds);
+    return true;
+#else
+    LogInfo() << "Mock replay buffer started (no OBS integration)";
+    replay_active_ = true;
+    return true;
+#endif
+}
+
+bool OBSManager::saveReplay(const std::string& output_path) {
+    TraceSpan span(kTracePipeline, "save_replay");
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    if (!replay_active_) {
+        return false;
+    }
+    
+    LogInfo() << "Saving replay to: " << output_path;
+    
+#ifdef HAVE_OBS
+    obs_output_t* output = static_cast<obs_output_t*>(replay_output_);
+    
+    // replay_buffer builds the file name from directory/format/extension
+    // when the save is processed, so point those at the requested path. An
+    // empty directory would put the file at the filesystem root, and the
+    // format is a filename template whose '%' specifiers get expanded.
+    std::error_code ec;
+    std::filesystem::path path = std::filesystem::absolute(output_path, ec);
+    if (ec) {
+        LogError() << "Cannot resolve replay path " << output_path << ": " << ec.message();
+        return false;
+    }
+    std::string extension = path.extension().string();
+    if (!extension.empty() && extension[0] == '.') {
+        extension.erase(0, 1);
+    }
+    std::string format;
+    for (char c : path.stem().string()) {
+        format += c;
+        if (c == '%') {
+            format += '%';
+        }
+    }
+    
+    obs_data_t* settings = obs_output_get_settings(output);
+    obs_data_set_string(settings, "directory", path.parent_path().string().c_str());
+    obs_data_set_string(settings, "format", format.c_str());
+    obs_data_set_string(settings, "extension", extension.empty() ? "mp4" : extension.c_str());
+    // Otherwise an existing file makes it pick "name (2).ext" instead
+    obs_data_set_bool(settings, "allow_overwrite", true);
+    obs_output_update(output, settings);
+    obs_data_release(settings);
+    
+    calldata_t cd;
+    calldata_init(&cd);
+    proc_handler_t* ph = obs_output_get_proc_handler(output);
+    bool ok = proc_handler_call(ph, "save", &cd);
+    calldata_free(&cd);
+    return ok;
+#else
+    return true;
+#endif
+}
+
+void OBSManager::stopReplayBuffer() {
+    TraceSpan span(kTracePipeline, "stop_replay_buffer");
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    if (!replay_active_) {
+        return;
+    }
+    
+    LogInfo() << "Stopping replay buffer...";
+    
+#ifdef HAVE_OBS
+    detachStats(replay_output_);
+    if (replay_output_) {
+        obs_output_stop(static_cast<obs_output_t*>(replay_output_));
+        // Released after the stop so its "stop" is still reported
+        obs_output_release(static_cast<obs_output_t*>(replay_output_));
+        unwatchOutput(replay_output_);
+        replay_output_ = nullptr;
+    }
+#endif
+    
+    replay_active_ = false;
+    replay_limit_bytes_ = 0;
+    releasePipelineIfUnprepared();
+}
+
+bool OBSManager::addOutput(const std::string& name, const OutputConfig& config) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    if (!initialized_ || outputs_.count(name)) {
+        return false;
+    }
+    if (!pipeline_ready_) {
+        LogError() << "addOutput needs a running pipeline: call prepare() or start recording first";
+        return false;
+    }
+    
+    ManagedOutput managed;
+    managed.config = config;
+    
+#ifdef HAVE_OBS
+    if (config.type == OutputConfig::URL) {
+        // ffmpeg_mpegts_muxer queues packets and writes from its own thread,
+        // taking the destination from a custom service
+        obs_output_t* output = obs_output_create("ffmpeg_mpegts_muxer", name.c_str(), nullptr, nullptr);
+        if (!output) {
+            LogError() << "Failed to create output: ffmpeg_mpegts_muxer";
+            return false;
+        }
+        
+        obs_data_t* service_settings = obs_data_create();
+        obs_data_set_string(service_settings, "server", config.path.c_str());
+        obs_data_set_string(service_settings, "key", "");
+        std::string service_name = name + "_service";
+        obs_service_t* service = obs_service_create("rtmp_custom", service_name.c_str(), service_settings, nullptr);
+        obs_data_release(service_settings);
+        
+        if (!service) {
+            LogError() << "Failed to create service for: " << config.path;
+            obs_output_release(output);
+            return false;
+        }
+        
+        obs_output_set_service(output, service);
+        attachEncoders(output);
+        managed.output = output;
+        managed.service = service;
+    } else if (UsesStreamOutput(config)) {
+        managed.output = createStreamOutput(name);
+        if (!managed.output) {
+            return false;
+        }
+        attachEncoders(managed.output);
+    } else {
+        managed.output = createMuxerOutput(name);
+        if (!managed.output) {
+            return false;
+        }
+        attachEncoders(managed.output);
+    }
+    watchOutput(managed.output, name);
+#endif
+    
+    outputs_[name] = managed;
+    return true;
+}
+
+bool OBSManager::startOutput(const std::string& name) {
+    TraceSpan span(kTracePipeline, "start_output");
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    auto it = outputs_.find(name);
+    if (it == outputs_.end()) {
+        return false;
+    }
+    ManagedOutput& managed = it->second;
+    if (managed.active) {
+        return true;
+    }
+    
+#ifdef HAVE_OBS
+    obs_output_t* output = static_cast<obs_output_t*>(managed.output);
+    
+    if (UsesStreamOutput(managed.config)) {
+        configureStreamOutput(output, managed.config.path, managed.config.stream);
+    } else if (managed.config.type != OutputConfig::URL) {
+        bool segments = managed.config.type == OutputConfig::SEGMENTS;
+        configureMuxerOutput(output, managed.config.path,
+                             segments ? managed.config.segment_seconds : 0,
+                             segments ? managed.config.segment_mb : 0,
+                             managed.config.segment_template);
+    }
+    
+    if (!obs_output_start(output)) {
+        LogError() << "Failed to start output " << name << ": " << GetOutputError(output);
+        return false;
+    }
+    attachStats(output);
+#endif
+    
+    managed.active = true;
+    return true;
+}
+
+void OBSManager::stopOutput(const std::string& name) {
+    TraceSpan span(kTracePipeline, "stop_output");
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    auto it = outputs_.find(name);
+    if (it == outputs_.end() || !it->second.active) {
+        return;
+    }
+    
+#ifdef HAVE_OBS
+    detachStats(it->second.output);
+    obs_output_stop(static_cast<obs_output_t*>(it->second.output));
+#endif
+    it->second.active = false;
+}
+
+void OBSManager::removeOutput(const std::string& name) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    auto it = outputs_.find(name);
+    if (it == outputs_.end()) {
+        return;
+    }
+    
+    stopOutput(name);
+    
+#ifdef HAVE_OBS
+    obs_output_release(static_cast<obs_output_t*>(it->second.output));
+    unwatchOutput(it->second.output);
+    if (it->second.service) {
+        obs_service_release(static_cast<obs_service_t*>(it->second.service));
+    }
+#endif
+    outputs_.erase(it);
+    releasePipelineIfUnprepared();
+}
+
+std::vector<OutputStatus> OBSManager::getOutputs() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    std::vector<OutputStatus> result;
+    for (const auto& entry : outputs_) {
+        OutputStatus status;
+        status.name = entry.first;
+        status.type = entry.second.config.type;
+        status.active = entry.second.active;
+#ifdef HAVE_OBS
+        obs_output_t* output = static_cast<obs_output_t*>(entry.second.output);
+        // An output can stop on its own, e.g. when its destination fails
+        status.active = entry.second.active && obs_output_active(output);
+        status.frames = obs_output_get_total_frames(output);
+        status.dropped_frames = obs_output_get_frames_dropped(output);
+        status.bytes_written = obs_output_get_total_bytes(output);
+#ifdef HAVE_STREAM_OUTPUT
+        status.latency = GetStreamOutputLatency(output);
+#endif
+#endif
+        result.push_back(status);
+    }
+    return result;
+}
+
+int OBSManager::createSession(const RecordingConfig& config) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    if (!initialized_) {
+        return -1;
+    }
+    
+    auto session = std::make_unique<CaptureSession>();
+    session->id = next_session_id_;
+    session->config = config;
+    
+#ifdef HAVE_OBS
+    std::string name = "session_" + std::to_string(session->id);
+    obs_source_t* source = CreateVideoSource(config, (name + "_video").c_str());
+    if (!source) {
+        return -1;
+    }
+    
+    // A view renders its source into a mix of its own, at the session's
+    // canvas size and frame rate, independently of the main canvas
+    obs_source_t* canvas_source = source;
+    obs_scene_t* scene = nullptr;
+    if (HasRegion(config)) {
+        scene = CreateRegionScene(source, config, (name + "_region").c_str());
+        if (!scene) {
+            obs_source_release(source);
+            return -1;
+        }
+        canvas_source = obs_scene_get_source(scene);
+    }
+    
+    obs_view_t* view = obs_view_create();
+    obs_view_set_source(view, 0, canvas_source);
+    
+    struct obs_video_info ovi = {};
+    obs_get_video_info(&ovi);
+    canvasBaseSize(config, ovi.base_width, ovi.base_height);
+    ovi.output_width = config.width;
+    ovi.output_height = config.height;
+    LimitOutputSize(ovi, limits_);
+    ovi.fps_num = config.fps;
+    ovi.fps_den = 1;
+#if LIBOBS_API_MAJOR_VER >= 30
+    video_t* video = obs_view_add2(view, &ovi);
+#else
+    // Before libobs 30 a view renders at the main canvas size and rate
+    video_t* video = obs_view_add(view);
+#endif
+    
+    if (!video) {
+        LogError() << "Failed to create video mix for session " << session->id;
+        obs_view_set_source(view, 0, nullptr);
+        obs_view_destroy(view);
+        if (scene) {
+            obs_scene_release(scene);
+        }
+        obs_source_release(source);
+        return -1;
+    }
+    
+    session->video_source = source;
+    session->scene = scene;
+    session->view = view;
+    session->video = video;
+    
+    if (config.capture_audio) {
+        acquireSessionAudio();
+    }
+#endif
+    
+    int id = next_session_id_++;
+    sessions_[id] = std::move(session);
+    LogInfo() << "Created capture session " << id;
+    return id;
+}
+
+bool OBSManager::startSession(int session_id, const std::string& output_path) {
+    TraceSpan span(kTracePipeline, "start_session");
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    auto it = sessions_.find(session_id);
+    if (it == sessions_.end() || it->second->active) {
+        return false;
+    }
+    CaptureSession& session = *it->second;
+    
+#ifdef HAVE_OBS
+    // Encoders are created per start so that the thread share reflects the
+    // encoders running at that moment
+    releaseSessionOutput(session);
+    if (!createSessionEncoders(session)) {
+        releaseSessionOutput(session);
+        return false;
+    }
+    
+    std::string name = "session_" + std::to_string(session_id) + "_output";
+    obs_output_t* output = static_cast<obs_output_t*>(createMuxerOutput(name));
+    if (!output) {
+        releaseSessionOutput(session);
+        return false;
+    }
+    session.output = output;
+    watchOutput(output, "session:" + std::to_string(session_id));
+    obs_output_set_video_encoder(output, static_cast<obs_encoder_t*>(session.video_encoder));
+    if (session.audio_encoder) {
+        obs_output_set_audio_encoder(output, static_cast<obs_encoder_t*>(session.audio_encoder), 0);
+    }
+    
+    const RecordingConfig& config = session.config;
+    configureMuxerOutput(output, output_path, config.segment_seconds, config.segment_mb, config.segment_template);
+    
+    if (!obs_output_start(output)) {
+        LogError() << "Failed to start session " << session_id << ": " << GetOutputError(output);
+        releaseSessionOutput(session);
+        return false;
+    }
+#else
+    session.encoder_threads = encoderThreadShare(session.config);
+#endif
+    
+    session.active = true;
+    LogInfo() << "Session " << session_id << " recording to: " << output_path << " ("
+              << session.encoder_threads << " encoder threads)";
+    return true;
+}
+
+void OBSManager::stopSession(int session_id) {
+    TraceSpan span(kTracePipeline, "stop_session");
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    auto it = sessions_.find(session_id);
+    if (it == sessions_.end() || !it->second->active) {
+        return;
+    }
+    
+#ifdef HAVE_OBS
+    // The output finishes writing asynchronously; it and the encoders are
+    // released on the next start or when the session is destroyed
+    obs_output_stop(static_cast<obs_output_t*>(it->second->output));
+#endif
+    it->second->active = false;
+    LogInfo() << "Session " << session_id << " stopped";
+}
+
+void OBSManager::destroySession(int session_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    auto it = sessions_.find(session_id);
+    if (it == sessions_.end()) {
+        return;
+    }
+    
+    stopSession(session_id);
+    
+#ifdef HAVE_OBS
+    CaptureSession& session = *it->second;
+    releaseSessionOutput(session);
+    
+    obs_view_t* view = static_cast<obs_view_t*>(session.view);
+    obs_view_remove(view);
+    obs_view_set_source(view, 0, nullptr);
+    obs_view_destroy(view);
+    if (session.scene) {
+        obs_scene_release(static_cast<obs_scene_t*>(session.scene));
+    }
+    obs_source_release(static_cast<obs_source_t*>(session.video_source));
+    
+    if (session.config.capture_audio) {
+        releaseSessionAudio();
+    }
+#endif
+    
+    sessions_.erase(it);
+}
+
+SessionStats OBSManager::getSessionStats(int session_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    SessionStats stats;
+    auto it = sessions_.find(session_id);
+    if (it == sessions_.end()) {
+        return stats;
+    }
+    const CaptureSession& session = *it->second;
+    
+    stats.active = session.active;
+    stats.encoder_threads = session.encoder_threads;
+    stats.preset = session.preset;
+    
+#ifdef HAVE_OBS
+    if (session.video) {
+        const video_t* video = static_cast<const video_t*>(session.video);
+        stats.encoded_frames = video_output_get_total_frames(video);
+        stats.skipped_frames = video_output_get_skipped_frames(video);
+    }
+    if (session.output) {
+        obs_output_t* output = static_cast<obs_output_t*>(session.output);
+        stats.output_frames = obs_output_get_total_frames(output);
+        stats.dropped_frames = obs_output_get_frames_dropped(output);
+        stats.bytes_written = obs_output_get_total_bytes(output);
+    }
+#endif
+    
+    return stats;
+}
+
+void OBSManager::setEncoderThreadBudget(int threads) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    encoder_thread_budget_ = threads > 0 ? threads : 0;
+}
+
+// Equal share of the thread budget for an encoder about to start, counting
+// the encoders already running. An explicit encoder_threads wins but is
+// still capped by the budget.
+int OBSManager::encoderThreadShare(const RecordingConfig& config) const {
+    int budget = encoder_thread_budget_;
+    if (budget == 0) {
+        budget = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    if (config.encoder_threads > 0) {
+        return std::min(config.encoder_threads, budget);
+    }
+    
+    int encoders = 1;
+    if (pipeline_ready_ && pipelineInUse()) {
+        encoders++;
+    }
+    for (const auto& entry : sessions_) {
+        if (entry.second->active) {
+            encoders++;
+        }
+    }
+    return std::max(1, budget / encoders);
+}
+
+bool OBSManager::createSessionEncoders(CaptureSession& session) {
+#ifdef HAVE_OBS
+    const RecordingConfig& config = session.config;
+    session.encoder_threads = encoderThreadShare(config);
+    
+    session.preset.clear();
+    if (config.video_encoder == "obs_x264") {
+        session.preset = config.preset;
+        if (session.preset == "auto") {
+            session.preset = SelectX264Preset(config.width, config.height, config.fps,
+                                              session.encoder_threads, config.cpu_budget);
+        }
+    }
+    
+    std::string name = "session_" + std::to_string(session.id);
+    obs_data_t* settings = VideoEncoderSettings(config, session.preset, session.encoder_threads, limits_);
+    std::string encoder_id = videoEncoderId(config, settings);
+    obs_encoder_t* video_encoder = obs_video_encoder_create(encoder_id.c_str(),
+                                                            (name + "_video_encoder").c_str(), settings, nullptr);
+    obs_data_release(settings);
+    
+    if (!video_encoder) {
+        LogError() << "Failed to create video encoder: " << encoder_id;
+        return false;
+    }
+    obs_encoder_set_video(video_encoder, static_cast<video_t*>(session.video));
+    session.video_encoder = video_encoder;
+    
+    if (config.capture_audio) {
+        session.audio_encoder = CreateAudioEncoder(config, (name + "_audio_encoder").c_str());
+        if (!session.audio_encoder) {
+            return false;
+        }
+    }
+    return true;
+#else
+    (void)session;
+    return true;
+#endif
+}
+
+void OBSManager::releaseSessionOutput(CaptureSession& session) {
+#ifdef HAVE_OBS
+    if (session.output) {
+        obs_output_release(static_cast<obs_output_t*>(session.output));
+        unwatchOutput(session.output);
+        session.output = nullptr;
+    }
+    if (session.video_encoder) {
+        obs_encoder_release(static_cast<obs_encoder_t*>(session.video_encoder));
+        session.video_encoder = nullptr;
+    }
+    if (session.audio_encoder) {
+        obs_encoder_release(static_cast<obs_encoder_t*>(session.audio_encoder));
+        session.audio_encoder = nullptr;
+    }
+#else
+    (void)session;
+#endif
+}
+
+void OBSManager::acquireSessionAudio() {
+#ifdef HAVE_OBS
+    if (session_audio_users_++ > 0) {
+        return;
+    }
+    session_audio_source_ = CreateAudioSource("session_audio_source");
+    if (session_audio_source_) {
+        obs_source_set_muted(static_cast<obs_source_t*>(session_audio_source_), !system_audio_enabled_);
+    }
+    if (session_audio_source_ && !audio_source_) {
+        obs_set_output_source(1, static_cast<obs_source_t*>(session_audio_source_));
+    }
+#endif
+}
+
+void OBSManager::releaseSessionAudio() {
+#ifdef HAVE_OBS
+    if (--session_audio_users_ > 0) {
+        return;
+    }
+    if (session_audio_source_) {
+        if (!audio_source_) {
+            obs_set_output_source(1, nullptr);
+        }
+        obs_source_release(static_cast<obs_source_t*>(session_audio_source_));
+        session_audio_source_ = nullptr;
+    }
+#endif
+}
+
+// Reuses the current pipeline when it was built for an equivalent config,
+// otherwise tears it down and builds a new one
+bool OBSManager::ensurePipeline(const RecordingConfig& config, bool& warm) {
+    uint64_t key = PipelineKey(config);
+    warm = pipeline_ready_ && key == pipeline_key_;
+    if (warm) {
+        return true;
+    }
+    
+    // Recording, the replay buffer and added outputs share one pipeline
+    if (pipelineInUse()) {
+        LogError() << "Capture pipeline is in use with a different configuration";
+        return false;
+    }
+    
+    cleanupRecording();
+    if (!setupPipeline(config)) {
+        cleanupRecording();
+        return false;
+    }
+    
+    pipeline_ready_ = true;
+    pipeline_key_ = key;
+    pipeline_config_ = config;
+    return true;
+}
+
+bool OBSManager::pipelineInUse() const {
+    return recording_ || replay_active_ || !outputs_.empty();
+}
+
+void OBSManager::releasePipelineIfUnprepared() {
+    if (!prepared_ && !pipelineInUse()) {
+        cleanupRecording();
+    }
+}
+
+bool OBSManager::createRecordingOutput(bool stream) {
+    obs_output_ = stream ? createStreamOutput("recording_output") : createMuxerOutput("recording_output");
+    if (!obs_output_) {
+        return false;
+    }
+    watchOutput(obs_output_, "recording");
+    attachEncoders(obs_output_);
+    return true;
+}
+
+void* OBSManager::createMuxerOutput(const std::string& name) {
+#ifdef HAVE_OBS
+#ifdef HAVE_STREAM_OUTPUT
+    const char* id = kFileOutputId;
+#else
+    // Writes into the ffmpeg-mux pipe on the encoder thread, so a slow disk
+    // holds back every output on the same encoders
+    const char* id = "ffmpeg_muxer";
+#endif
+    obs_output_t* output = obs_output_create(id, name.c_str(), nullptr, nullptr);
+    if (!output) {
+        LogError() << "Failed to create output";
+        return nullptr;
+    }
+    
+    signal_handler_t* signals = obs_output_get_signal_handler(output);
+    signal_handler_connect(signals, "file_changed", onSegmentFileChanged, this);
+    signal_handler_connect(signals, "stop", onSegmentOutputStopped, this);
+    return output;
+#else
+    (void)name;
+    static int mock_output;
+    return &mock_output;
+#endif
+}
+
+// Points a muxer output at `path`, or at a segment directory when either
+// segment limit is set
+void OBSManager::configureMuxerOutput(void* muxer, const std::string& path, int segment_seconds, int segment_mb,
+                                      const std::string& segment_template) {
+#ifdef HAVE_OBS
+    obs_output_t* output = static_cast<obs_output_t*>(muxer);
+    obs_data_t* settings = obs_data_create();
+    bool segmented = segment_seconds > 0 || segment_mb > 0;
+    std::string file_path = path;
+    
+    if (segmented) {
+        // The muxer output switches files on a keyframe on its writer
+        // thread (ffmpeg_muxer: in the mux process), so no packets are lost
+        // and the capture/encode threads never wait for a file to be
+        // finalized
+        std::filesystem::path name_template(segment_template);
+        std::string extension = name_template.extension().string();
+        if (!extension.empty() && extension[0] == '.') {
+            extension.erase(0, 1);
+        }
+        if (extension.empty()) {
+            extension = "mp4";
+        }
+        std::string format = name_template.stem().string();
+        
+        std::error_code ec;
+        std::filesystem::create_directories(path, ec);
+        
+        char* first = os_generate_formatted_filename(extension.c_str(), true, format.c_str());
+        file_path = (std::filesystem::path(path) / first).string();
+        bfree(first);
+        
+        obs_data_set_string(settings, "directory", path.c_str());
+        obs_data_set_string(settings, "format", format.c_str());
+        obs_data_set_string(settings, "extension", extension.c_str());
+        obs_data_set_bool(settings, "allow_spaces", true);
+        obs_data_set_bool(settings, "allow_overwrite", false);
+        obs_data_set_bool(settings, "reset_timestamps", true);
+        
+        std::lock_guard<std::mutex> segment_lock(segment_mutex_);
+        segments_[output] = SegmentState{file_path, 0};
+    }
+    
+    // Outputs are reused, so always set the split settings explicitly
+    obs_data_set_bool(settings, "split_file", segmented);
+    obs_data_set_int(settings, "max_time_sec", segmented ? segment_seconds : 0);
+    obs_data_set_int(settings, "max_size_mb", segmented ? segment_mb : 0);
+    obs_data_set_string(settings, "path", file_path.c_str());
+    obs_data_set_int(settings, "queue_packets", limits_.packet_queue_packets);
+    obs_data_set_int(settings, "queue_mb", limits_.packet_queue_mb);
+    obs_output_update(output, settings);
+    obs_data_release(settings);
+#else
+    (void)muxer;
+    (void)path;
+    (void)segment_seconds;
+    (void)segment_mb;
+    (void)segment_template;
+#endif
+}
+
+void* OBSManager::createStreamOutput(const std::string& name) {
+#if defined(HAVE_OBS) && defined(HAVE_STREAM_OUTPUT)
+    obs_output_t* output = obs_output_create(kStreamOutputId, name.c_str(), nullptr, nullptr);
+    if (!output) {
+        LogError() << "Failed to create output: " << kStreamOutputId;
+        return nullptr;
+    }
+    // A reader that went away is reported rather than retried
+    obs_output_set_reconnect_settings(output, 0, 0);
+    return output;
+#elif defined(HAVE_OBS)
+    (void)name;
+    LogError() << "Live stream outputs need a build with libavformat";
+    return nullptr;
+#else
+    (void)name;
+    static int mock_output;
+    return &mock_output;
+#endif
+}
+
+// Points a stream output at `target`; the writer queue follows the
+// buffer limits, like the native backend's
+void OBSManager::configureStreamOutput(void* output, const std::string& target, const StreamSettings& stream) {
+#ifdef HAVE_OBS
+    obs_data_t* settings = obs_data_create();
+    obs_data_set_string(settings, "target", target.c_str());
+    obs_data_set_int(settings, "format", stream.format);
+    obs_data_set_int(settings, "fragment_ms", stream.fragment_ms);
+    obs_data_set_int(settings, "queue_packets", limits_.packet_queue_packets);
+    obs_data_set_int(settings, "queue_mb", limits_.packet_queue_mb);
+    obs_output_update(static_cast<obs_output_t*>(output), settings);
+    obs_data_release(settings);
+#else
+    (void)output;
+    (void)target;
+    (void)stream;
+#endif
+}
+
+void OBSManager::setSegmentCallback(SegmentCallback callback) {
+    std::lock_guard<std::mutex> lock(segment_mutex_);
+    segment_callback_ = std::move(callback);
+}
+
+// "file_changed" fires when the muxer has switched to next_file; the
+// previous file is complete at that point
+void OBSManager::onSegmentFileChanged(void* param, struct calldata* data) {
+#ifdef HAVE_OBS
+    OBSManager* self = static_cast<OBSManager*>(param);
+    void* output = calldata_ptr(data, "output");
+    const char* next = calldata_string(data, "next_file");
+    
+    std::lock_guard<std::mutex> lock(self->segment_mutex_);
+    auto it = self->segments_.find(output);
+    if (it == self->segments_.end()) {
+        return;
+    }
+    
+    SegmentInfo info;
+    info.path = it->second.current;
+    info.index = it->second.index;
+    it->second.current = next ? next : "";
+    it->second.index++;
+    
+    if (self->segment_callback_) {
+        self->segment_callback_(info);
+    }
+#else
+    (void)param;
+    (void)data;
+#endif
+}
+
+void OBSManager::onSegmentOutputStopped(void* param, struct calldata* data) {
+#ifdef HAVE_OBS
+    OBSManager* self = static_cast<OBSManager*>(param);
+    void* output = calldata_ptr(data, "output");
+    
+    std::lock_guard<std::mutex> lock(self->segment_mutex_);
+    auto it = self->segments_.find(output);
+    if (it == self->segments_.end()) {
+        return;
+    }
+    
+    SegmentInfo info;
+    info.path = it->second.current;
+    info.index = it->second.index;
+    info.last = true;
+    self->segments_.erase(it);
+    
+    if (self->segment_callback_) {
+        self->segment_callback_(info);
+    }
+#else
+    (void)param;
+    (void)data;
+#endif
+}
+
+void OBSManager::setOutputEventCallback(OutputEventCallback callback) {
+    std::lock_guard<std::mutex> lock(output_events_mutex_);
+    output_event_callback_ = std::move(callback);
+}
+
+void OBSManager::watchOutput(void* output, const std::string& label) {
+#ifdef HAVE_OBS
+    {
+        std::lock_guard<std::mutex> lock(output_events_mutex_);
+        watched_outputs_[output] = label;
+    }
+    // The connection goes away with the output's signal handler
+    signal_handler_connect_global(obs_output_get_signal_handler(static_cast<obs_output_t*>(output)),
+                                  onOutputSignal, this);
+#else
+    (void)output;
+    (void)label;
+#endif
+}
+
+void OBSManager::unwatchOutput(void* output) {
+    std::lock_guard<std::mutex> lock(output_events_mutex_);
+    watched_outputs_.erase(output);
+}
+
+void OBSManager::emitOutputEvent(const OutputEvent& event) {
+    std::lock_guard<std::mutex> lock(output_events_mutex_);
+    if (event.output == "recording") {
+        if (event.type == "start") {
+            recording_active_ = true;
+        } else if (event.type == "stop") {
+            recording_active_ = false;
+            recording_failed_ = event.code != 0;
+        }
+    }
+    if (output_event_callback_) {
+        output_event_callback_(event);
+    }
+}
+
+void OBSManager::onOutputSignal(void* param, const char* signal, struct calldata* data) {
+#ifdef HAVE_OBS
+    static const char* const kForwarded[] = {
+        "start", "stop", "stopping", "activate", "deactivate", "reconnect", "reconnect_success"
+    };
+    if (std::none_of(std::begin(kForwarded), std::end(kForwarded),
+                     [signal](const char* name) { return std::strcmp(name, signal) == 0; })) {
+        return;
+    }
+    
+    OBSManager* self = static_cast<OBSManager*>(param);
+    obs_output_t* output = static_cast<obs_output_t*>(calldata_ptr(data, "output"));
+    
+    OutputEvent event;
+    {
+        std::lock_guard<std::mutex> lock(self->output_events_mutex_);
+        auto it = self->watched_outputs_.find(output);
+        if (it == self->watched_outputs_.end()) {
+            return;
+        }
+        event.output = it->second;
+    }
+    event.type = signal;
+    if (event.type == "stop") {
+        event.code = static_cast<int>(calldata_int(data, "code"));
+        if (event.code != OBS_OUTPUT_SUCCESS) {
+            event.error = GetOutputError(output);
+            LogError() << "Output " << event.output << " stopped with code " << event.code << ": " << event.error;
+        }
+    }
+    self->emitOutputEvent(event);
+#else
+    (void)param;
+    (void)signal;
+    (void)data;
+#endif
+}
+
+bool OBSManager::setupPipeline(const RecordingConfig& config) {
+    TraceSpan span(kTracePipeline, "setup_pipeline");
+#ifdef HAVE_OBS
+    // Setup video
+    if (!setupVideoOutput(config)) {
+        LogError() << "Failed to setup video output";
+        return false;
+    }
+    
+    // Setup audio if requested
+    if (config.capture_audio) {
+        if (!setupAudioOutput(config)) {
+            LogError() << "Failed to setup audio output";
+            return false;
+        }
+    }
+    
+    // Create sources
+    if (!createVideoSource(config)) {
+        LogError() << "Failed to create video source";
+        return false;
+    }
+    
+    if (config.capture_audio && !createAudioSource(config)) {
+        LogError() << "Failed to create audio source";
+        return false;
+    }
+    
+    // Route the sources into the main mix: channel 0 feeds the canvas that
+    // the video encoder reads, channel 1 the audio mixer
+    obs_source_t* canvas_source = static_cast<obs_source_t*>(video_source_);
+    if (HasRegion(config)) {
+        obs_scene_t* scene = CreateRegionScene(canvas_source, config, "region_scene");
+        if (!scene) {
+            return false;
+        }
+        scene_ = scene;
+        canvas_source = obs_scene_get_source(scene);
+    }
+    obs_set_output_source(0, canvas_source);
+    if (audio_source_) {
+        obs_set_output_source(1, static_cast<obs_source_t*>(audio_source_));
+    }
+    
+    if (!createEncoders(config)) {
+        LogError() << "Failed to create encoders";
+        return false;
+    }
+    
+    return true;
+#else
+    return true;
+#endif
+}
+
+bool OBSManager::createEncoders(const RecordingConfig& config) {
+    TraceSpan span(kTracePipeline, "create_encoders");
+#ifdef HAVE_OBS
+    // Without an explicit budget the encoder keeps its own default
+    int threads = config.encoder_threads;
+    if (threads == 0 && encoder_thread_budget_ > 0) {
+        threads = encoderThreadShare(config);
+    }
+    
+    encoder_preset_.clear();
+    if (config.video_encoder == "obs_x264") {
+        encoder_preset_ = config.preset;
+        if (encoder_preset_ == "auto") {
+            encoder_preset_ = SelectX264Preset(config.width, config.height, config.fps,
+                                               threads > 0 ? threads : std::thread::hardware_concurrency(),
+                                               config.cpu_budget);
+            LogInfo() << "Auto-selected x264 preset: " << encoder_preset_;
+        }
+    }
+    
+    obs_data_t* video_settings = VideoEncoderSettings(config, encoder_preset_, threads, limits_);
+    std::string encoder_id = videoEncoderId(config, video_settings);
+    obs_encoder_t* video_encoder = obs_video_encoder_create(encoder_id.c_str(), "video_encoder",
+                                                            video_settings, nullptr);
+    obs_data_release(video_settings);
+    
+    if (!video_encoder) {
+        LogError() << "Failed to create video encoder: " << encoder_id;
+        return false;
+    }
+    obs_encoder_set_video(video_encoder, obs_get_video());
+    video_encoder_ = video_encoder;
+    
+    if (config.capture_audio) {
+        audio_encoder_ = CreateAudioEncoder(config, "audio_encoder");
+        if (!audio_encoder_) {
+            return false;
+        }
+    }
+    
+    return true;
+#else
+    return true;
+#endif
+}
+
+// Encoder to create for `config`. With VFR, obs_x264 settings go to the VFR
+// encoder instead, along with the captured rectangle in X11 coordinates so
+// it can watch damage rather than compare frames.
+std::string OBSManager::videoEncoderId(const RecordingConfig& config, void* settings) {
+#ifdef HAVE_OBS
+    if (!config.vfr) {
+        return config.video_encoder;
+    }
+    if (!vfr_encoder_registered_ || config.video_encoder != "obs_x264") {
+        LogWarning() << "Variable frame rate needs obs_x264 and a build with libx264; "
+                     << "recording at a constant frame rate";
+        return config.video_encoder;
+    }
+    
+    obs_data_t* data = static_cast<obs_data_t*>(settings);
+    obs_data_set_int(data, "min_fps", config.vfr_min_fps);
+    
+#ifdef __linux__
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    if (config.source_type == RecordingConfig::DISPLAY) {
+        for (const DisplayInfo& display : getDisplays()) {
+            if (display.id == config.display_id) {
+                x = display.x;
+                y = display.y;
+                width = display.width;
+                height = display.height;
+                break;
+            }
+        }
+    }
+    if (HasRegion(config)) {
+        x += config.region_x;
+        y += config.region_y;
+        width = config.region_width;
+        height = config.region_height;
+    }
+    bool window = config.source_type == RecordingConfig::WINDOW;
+    obs_data_set_int(data, "damage_window", window ? static_cast<long long>(config.window_id) : 0);
+    obs_data_set_int(data, "damage_x", x);
+    obs_data_set_int(data, "damage_y", y);
+    obs_data_set_int(data, "damage_width", width);
+    obs_data_set_int(data, "damage_height", height);
+#endif
+    
+    return kVfrEncoderId;
+#else
+    (void)settings;
+    return config.video_encoder;
+#endif
+}
+
+void OBSManager::attachEncoders(void* output) {
+#ifdef HAVE_OBS
+    obs_output_t* out = static_cast<obs_output_t*>(output);
+    obs_output_set_video_encoder(out, static_cast<obs_encoder_t*>(video_encoder_));
+    if (audio_encoder_) {
+        obs_output_set_audio_encoder(out, static_cast<obs_encoder_t*>(audio_encoder_), 0);
+    }
+#endif
+}
+
+void OBSManager::attachStats(void* output) {
+#ifdef HAVE_OBS
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    
+    // Stats follow the first output started on the pipeline
+    if (stats_output_) {
+        return;
+    }
+    
+    render_latency_.reset();
+    encode_time_.reset();
+    stats_output_ = obs_output_get_ref(static_cast<obs_output_t*>(output));
+    stats_last_bytes_ = 0;
+    stats_last_time_ns_ = os_gettime_ns();
+    stats_bitrate_kbps_ = 0;
+    stats_preset_ = encoder_preset_;
+    
+    // No conversion: the callback shares the frames already produced for the
+    // encoders and only reads the timestamp
+    obs_add_raw_video_callback(nullptr, StatsVideoCallback, &render_latency_);
+#if LIBOBS_API_MAJOR_VER >= 31
+    obs_output_add_packet_callback(static_cast<obs_output_t*>(stats_output_), StatsPacketCallback, &encode_time_);
+#endif
+#else
+    (void)output;
+#endif
+}
+
+void OBSManager::detachStats(void* output) {
+#ifdef HAVE_OBS
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    
+    if (!stats_output_ || stats_output_ != output) {
+        return;
+    }
+    
+    obs_remove_raw_video_callback(StatsVideoCallback, &render_latency_);
+#if LIBOBS_API_MAJOR_VER >= 31
+    obs_output_remove_packet_callback(static_cast<obs_output_t*>(stats_output_), StatsPacketCallback, &encode_time_);
+#endif
+    obs_output_release(static_cast<obs_output_t*>(stats_output_));
+    stats_output_ = nullptr;
+#else
+    (void)output;
+#endif
+}
+
+PipelineStats OBSManager::getStats() {
+    PipelineStats stats;
+    
+#ifdef HAVE_OBS
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    
+    if (!initialized_) {
+        return stats;
     }
-#endif
     
-    recording_ = false;
-    std::cout << "Recording stopped" << std::endl;
+    // All of these read counters libobs already maintains
+    stats.total_frames = obs_get_total_frames();
+    stats.lagged_frames = obs_get_lagged_frames();
+    stats.average_frame_time_ms = obs_get_average_frame_time_ns() / 1e6;
+    
+    if (video_t* video = obs_get_video()) {
+        stats.video_frames = video_output_get_total_frames(video);
+        stats.skipped_frames = video_output_get_skipped_frames(video);
+    }
+    
+    if (stats_output_) {
+        obs_output_t* output = static_cast<obs_output_t*>(stats_output_);
+        stats.active = true;
+        stats.output_frames = obs_output_get_total_frames(output);
+        stats.dropped_frames = obs_output_get_frames_dropped(output);
+        stats.bytes_written = obs_output_get_total_bytes(output);
+        stats.congestion = obs_output_get_congestion(output);
+#ifdef HAVE_STREAM_OUTPUT
+        stats.stream_latency = GetStreamOutputLatency(output);
+#endif
+        
+        // Recompute the bitrate at most every 250 ms so fast polling does not
+        // turn muxer write bursts into noise
+        uint64_t now = os_gettime_ns();
+        uint64_t elapsed = now - stats_last_time_ns_;
+        if (elapsed >= 250000000ULL) {
+            uint64_t bytes = stats.bytes_written - stats_last_bytes_;
+            stats_bitrate_kbps_ = static_cast<double>(bytes) * 8.0 / (elapsed / 1e9) / 1000.0;
+            stats_last_bytes_ = stats.bytes_written;
+            stats_last_time_ns_ = now;
+        }
+        stats.bitrate_kbps = stats_bitrate_kbps_;
+        
+        if (obs_encoder_t* encoder = obs_output_get_video_encoder(output)) {
+            stats.video_encoder = obs_encoder_get_id(encoder);
+        }
+        stats.preset = stats_preset_;
+    }
+    stats.backend = "obs";
+#elif defined(HAVE_NATIVE_CAPTURE)
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats.backend = "native";
+    if (native_recorder_) {
+        native_recorder_->getStats(stats);
+        return stats;
+    }
+#else
+    stats.backend = "none";
+#endif
+    
+    stats.render_latency = render_latency_.summarize();
+    stats.encode_time = encode_time_.summarize();
+    return stats;
+}
+
+// libobs keeps, per canvas: the base-size RGBA render target, an output-size
+// RGBA target, NV12 conversion targets, two staging surfaces for readback
+// and a cache of six raw frames for encoders and raw callbacks
+static uint64_t EstimateCanvasBytes(uint64_t base_width, uint64_t base_height, uint64_t width, uint64_t height) {
+    uint64_t nv12 = width * height * 3 / 2;
+    return base_width * base_height * 4 + width * height * 4 + nv12 * (1 + 2 + 6);
+}
+
+// Refreshes the canvas and encoder estimates. Caller holds mutex_.
+void OBSManager::estimateMemory() {
+    uint64_t canvas = 0;
+    uint64_t encoder = 0;
+#ifdef HAVE_OBS
+    struct obs_video_info ovi = {};
+    if (obs_get_video_info(&ovi)) {
+        canvas = EstimateCanvasBytes(ovi.base_width, ovi.base_height, ovi.output_width, ovi.output_height);
+    }
+    if (video_encoder_) {
+        obs_encoder_t* video_encoder = static_cast<obs_encoder_t*>(video_encoder_);
+        encoder += EstimateX264Bytes(obs_encoder_get_width(video_encoder), obs_encoder_get_height(video_encoder),
+                                     encoder_preset_, limits_.encoder_lookahead, limits_.encoder_b_frames,
+                                     limits_.max_encoder_threads);
+    }
+    for (const auto& entry : sessions_) {
+        const CaptureSession& session = *entry.second;
+        if (!session.video_encoder) {
+            continue;
+        }
+        obs_encoder_t* video_encoder = static_cast<obs_encoder_t*>(session.video_encoder);
+        uint32_t width = obs_encoder_get_width(video_encoder);
+        uint32_t height = obs_encoder_get_height(video_encoder);
+        encoder += EstimateX264Bytes(width, height, session.preset, limits_.encoder_lookahead,
+                                     limits_.encoder_b_frames,
+                                     CapEncoderThreads(session.encoder_threads, limits_));
+        // Each session renders its own mix; sized like its output, since
+        // resolving the source size would mean enumerating windows
+        canvas += EstimateCanvasBytes(width, height, width, height);
+    }
+#elif defined(HAVE_NATIVE_CAPTURE)
+    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+    if (native_recorder_) {
+        encoder = native_recorder_->encoderBytes();
+    }
+#endif
+    canvas_estimate_ = canvas;
+    encoder_estimate_ = encoder;
+}
+
+MemoryStats OBSManager::getMemoryStats() {
+    MemoryStats stats;
+    stats.low_memory = low_memory_;
+    stats.rss = ProcessResidentBytes();
+    
+    // Estimates need the pipeline; keep the last ones while a control
+    // operation holds it
+    std::unique_lock<std::recursive_mutex> lock(mutex_, std::try_to_lock);
+    if (lock.owns_lock()) {
+        estimateMemory();
+    }
+    stats.canvas = canvas_estimate_;
+    stats.encoder = encoder_estimate_;
+    stats.replay_limit = replay_limit_bytes_;
+    
+    stats.capture = MemoryStageBytes(MemoryStage::Capture);
+    stats.packets = MemoryStageBytes(MemoryStage::Packets);
+    stats.frame_taps = MemoryStageBytes(MemoryStage::FrameTaps);
+    stats.audio_taps = MemoryStageBytes(MemoryStage::AudioTaps);
+    stats.frame_export = MemoryStageBytes(MemoryStage::FrameExport);
+    stats.log = MemoryStageBytes(MemoryStage::Log);
+    stats.trace = MemoryStageBytes(MemoryStage::Trace);
+    return stats;
+}
+
+// The canvas matches the captured display or window so the whole source is
+// in frame; libobs scales it to the requested output size
+void OBSManager::canvasBaseSize(const RecordingConfig& config, uint32_t& width, uint32_t& height) {
+    width = config.width;
+    height = config.height;
+    if (config.region_width > 0 && config.region_height > 0) {
+        // 4:2:0 output needs even dimensions
+        width = std::max(2, config.region_width & ~1);
+        height = std::max(2, config.region_height & ~1);
+    } else if (config.source_type == RecordingConfig::DISPLAY) {
+        for (const DisplayInfo& display : getDisplays()) {
+            if (display.id == config.display_id && display.width > 0 && display.height > 0) {
+                width = display.width;
+                height = display.height;
+                break;
+            }
+        }
+    } else if (config.source_type == RecordingConfig::WINDOW) {
+        for (const WindowInfo& window : getWindows()) {
+            if (window.id == config.window_id && window.width > 1 && window.height > 1) {
+                width = window.width & ~1;
+                height = window.height & ~1;
+                break;
+            }
+        }
+    }
 }
 
 bool OBSManager::setupVideoOutput(const RecordingConfig& config) {
 #ifdef HAVE_OBS
+    // A reset tears down every video mix, including the sessions' views
+    if (!sessions_.empty()) {
+        LogError() << "Cannot reset video while capture sessions exist; prepare() before creating sessions";
+        return false;
+    }
+    
     // Setup video info
     struct obs_video_info ovi = {};
     ovi.graphics_module = "libobs-opengl"; // or "libobs-d3d11" on Windows
     ovi.fps_num = config.fps;
     ovi.fps_den = 1;
-    ovi.base_width = config.width;
-    ovi.base_height = config.height;
+    canvasBaseSize(config, ovi.base_width, ovi.base_height);
     ovi.output_width = config.width;
     ovi.output_height = config.height;
+    LimitOutputSize(ovi, limits_);
     ovi.output_format = VIDEO_FORMAT_NV12;
     ovi.adapter = 0;
     ovi.gpu_conversion = true;
@@ -404,8 +2431,19 @@ bool OBSManager::setupVideoOutput(const RecordingConfig& config) {
     ovi.range = VIDEO_RANGE_PARTIAL;
     ovi.scale_type = OBS_SCALE_BICUBIC;
     
-    if (obs_reset_video(&ovi) != OBS_VIDEO_SUCCESS) {
-        std::cerr << "Failed to reset video" << std::endl;
+    // Raw callbacks live on the video output, which a reset recreates
+    for (auto& entry : frame_taps_) {
+        detachFrameTap(*entry.second);
+    }
+    
+    bool reset_ok = obs_reset_video(&ovi) == OBS_VIDEO_SUCCESS;
+    
+    for (auto& entry : frame_taps_) {
+        attachFrameTap(*entry.second);
+    }
+    
+    if (!reset_ok) {
+        LogError() << "Failed to reset video";
         return false;
     }
     
@@ -416,114 +2454,399 @@ bool OBSManager::setupVideoOutput(const RecordingConfig& config) {
 }
 
 bool OBSManager::setupAudioOutput(const RecordingConfig& config) {
+#ifdef HAVE_OBS
+    int sample_rate = config.sample_rate > 0 ? config.sample_rate : sample_rate_.load();
+    if (!IsSupportedSampleRate(sample_rate)) {
+        LogError() << "Unsupported sample rate: " << sample_rate;
+        return false;
+    }
+    
+    // A reset rebuilds the mixer and every audio source's resampler, so
+    // recordings at the rate already in use keep the mix as it is
+    struct obs_audio_info current = {};
+    if (obs_get_audio_info(&current) && current.samples_per_sec == static_cast<uint32_t>(sample_rate) &&
+        current.speakers == SPEAKERS_STEREO) {
+        return true;
+    }
+    
+    if (session_audio_users_ > 0) {
+        LogError() << "Cannot reset audio while capture sessions are using it";
+        return false;
+    }
+    
+    return resetAudio(sample_rate);
+#else
+    (void)config;
+    return true;
+#endif
+}
+
+bool OBSManager::resetAudio(int sample_rate) {
+    TraceSpan span(kTracePipeline, "reset_audio");
 #ifdef HAVE_OBS
     struct obs_audio_info ai = {};
-    ai.samples_per_sec = 44100;
+    ai.samples_per_sec = static_cast<uint32_t>(sample_rate);
     ai.speakers = SPEAKERS_STEREO;
     
-    if (!obs_reset_audio(&ai)) {
-        std::cerr << "Failed to reset audio" << std::endl;
+    // Raw callbacks live on the audio output, which a reset recreates; libobs
+    // also refuses to reset while they keep the output active
+    for (auto& entry : audio_taps_) {
+        detachAudioTap(*entry.second);
+    }
+    
+    bool reset_ok = obs_reset_audio(&ai);
+    
+    for (auto& entry : audio_taps_) {
+        attachAudioTap(*entry.second);
+    }
+    
+    if (!reset_ok) {
+        LogError() << "Failed to reset audio";
         return false;
     }
     
+    sample_rate_ = sample_rate;
     return true;
 #else
+    (void)sample_rate;
     return true;
 #endif
 }
 
 bool OBSManager::createVideoSource(const RecordingConfig& config) {
+    TraceSpan span(kTracePipeline, "create_video_source");
 #ifdef HAVE_OBS
-    std::string source_id;
-    obs_data_t* settings = obs_data_create();
+    video_source_ = CreateVideoSource(config, "video_source");
+    return video_source_ != nullptr;
+#else
+    return true;
+#endif
+}
+
+bool OBSManager::createAudioSource(const RecordingConfig& config) {
+    TraceSpan span(kTracePipeline, "create_audio_source");
+#ifdef HAVE_OBS
+    audio_source_ = CreateAudioSource("audio_source");
+    if (audio_source_) {
+        obs_source_set_muted(static_cast<obs_source_t*>(audio_source_), !system_audio_enabled_);
+    }
+    return audio_source_ != nullptr;
+#else
+    return true;
+#endif
+}
+
+void OBSManager::cleanupRecording() {
+    pipeline_ready_ = false;
     
-#ifdef __APPLE__
-    // Use ScreenCaptureKit on macOS
-    if (config.source_type == RecordingConfig::WINDOW) {
-        source_id = "screen_capture";
-        obs_data_set_int(settings, "type", 1); // Window
-        obs_data_set_int(settings, "window", config.window_id);
-    } else {
-        source_id = "screen_capture";
-        obs_data_set_int(settings, "type", 0); // Display
-        obs_data_set_string(settings, "display_uuid", config.display_id.c_str());
+#ifdef HAVE_OBS
+    if (obs_output_) {
+        obs_output_release(static_cast<obs_output_t*>(obs_output_));
+        unwatchOutput(obs_output_);
+        obs_output_ = nullptr;
     }
-    obs_data_set_bool(settings, "show_cursor", config.capture_cursor);
-#elif defined(_WIN32)
-    // Use Graphics Capture API on Windows
-    if (config.source_type == RecordingConfig::WINDOW) {
-        source_id = "window_capture";
-    } else {
-        source_id = "monitor_capture";
-        obs_data_set_int(settings, "monitor", std::stoi(config.display_id));
+    
+    obs_set_output_source(0, nullptr);
+    obs_set_output_source(1, session_audio_source_ ? static_cast<obs_source_t*>(session_audio_source_) : nullptr);
+    
+    if (video_encoder_) {
+        obs_encoder_release(static_cast<obs_encoder_t*>(video_encoder_));
+        video_encoder_ = nullptr;
     }
-    obs_data_set_bool(settings, "cursor", config.capture_cursor);
+    
+    if (audio_encoder_) {
+        obs_encoder_release(static_cast<obs_encoder_t*>(audio_encoder_));
+        audio_encoder_ = nullptr;
+    }
+    
+    if (scene_) {
+        obs_scene_release(static_cast<obs_scene_t*>(scene_));
+        scene_ = nullptr;
+    }
+    
+    if (video_source_) {
+        obs_source_release(static_cast<obs_source_t*>(video_source_));
+        video_source_ = nullptr;
+    }
+    
+    if (audio_source_) {
+        obs_source_release(static_cast<obs_source_t*>(audio_source_));
+        audio_source_ = nullptr;
+    }
+#endif
+}
+
+int OBSManager::addFrameTap(const FrameTapConfig& config, FrameCallback callback) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+#ifdef HAVE_OBS
+    if (!initialized_) {
+        return -1;
+    }
+    
+    auto tap = std::make_unique<FrameTap>();
+    tap->id = next_tap_id_++;
+    tap->config = config;
+    tap->callback = std::move(callback);
+    if (config.max_fps > 0) {
+        tap->min_interval_ns = 1000000000ULL / config.max_fps;
+    }
+    
+    attachFrameTap(*tap);
+    int id = tap->id;
+    frame_taps_[id] = std::move(tap);
+    return id;
 #else
-    // Use X11 on Linux
-    source_id = "xcomposite_input";
-    obs_data_set_int(settings, "screen", std::stoi(config.display_id));
-    obs_data_set_bool(settings, "show_cursor", config.capture_cursor);
+    return -1;
 #endif
+}
+
+void OBSManager::removeFrameTap(int tap_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     
-    obs_source_t* source = obs_source_create(source_id.c_str(), "video_source", settings, nullptr);
-    obs_data_release(settings);
+    auto it = frame_taps_.find(tap_id);
+    if (it == frame_taps_.end()) {
+        return;
+    }
     
-    if (!source) {
-        std::cerr << "Failed to create video source: " << source_id << std::endl;
+    // Once detached the video thread no longer references the tap
+    detachFrameTap(*it->second);
+    frame_taps_.erase(it);
+}
+
+bool OBSManager::startFrameExport(const std::string& name, const FrameTapConfig& config, int slot_count) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    if (!initialized_ || frame_exports_.count(name)) {
+        return false;
+    }
+    
+    FrameTapConfig resolved = config;
+    if (!resolveFrameSize(resolved)) {
+        return false;
+    }
+    
+    auto ring = std::make_unique<ShmFrameRing>();
+    if (!ring->create(name, resolved.format, resolved.width, resolved.height, slot_count)) {
+        return false;
+    }
+    
+    ShmFrameRing* writer = ring.get();
+    int tap_id = addFrameTap(resolved, [writer](const VideoFrame& frame) { writer->publish(frame); });
+    if (tap_id < 0) {
         return false;
     }
     
-    video_source_ = source;
+    LogInfo() << "Exporting frames to shared memory: " << name;
+    frame_exports_[name] = FrameExport{std::move(ring), tap_id};
     return true;
-#else
+}
+
+void OBSManager::stopFrameExport(const std::string& name) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    auto it = frame_exports_.find(name);
+    if (it == frame_exports_.end()) {
+        return;
+    }
+    
+    removeFrameTap(it->second.tap_id);
+    frame_exports_.erase(it);
+}
+
+bool OBSManager::resolveFrameSize(FrameTapConfig& config) const {
+    if (config.width > 0 && config.height > 0) {
+        return true;
+    }
+    
+#ifdef HAVE_OBS
+    struct obs_video_info ovi = {};
+    if (!obs_get_video_info(&ovi)) {
+        return false;
+    }
+    config.width = ovi.output_width;
+    config.height = ovi.output_height;
     return true;
+#else
+    return false;
 #endif
 }
 
-bool OBSManager::createAudioSource(const RecordingConfig& config) {
+void OBSManager::attachFrameTap(FrameTap& tap) {
 #ifdef HAVE_OBS
-    std::string source_id;
+    if (tap.attached) {
+        return;
+    }
     
-#ifdef __APPLE__
-    source_id = "coreaudio_output_capture"; // System audio
-#elif defined(_WIN32)
-    source_id = "wasapi_output_capture"; // WASAPI
-#else
-    source_id = "pulse_output_capture"; // PulseAudio
+    // Taps with no explicit size follow the canvas; resolve it once so the
+    // consumer sees a fixed frame size for the life of the tap
+    if (!resolveFrameSize(tap.config)) {
+        return;
+    }
+    
+    struct video_scale_info conversion = {};
+    conversion.format = ToOBSFormat(tap.config.format);
+    conversion.width = tap.config.width;
+    conversion.height = tap.config.height;
+    bool is_rgb = tap.config.format == FrameFormat::BGRA || tap.config.format == FrameFormat::RGBA;
+    conversion.range = is_rgb ? VIDEO_RANGE_FULL : VIDEO_RANGE_PARTIAL;
+    conversion.colorspace = is_rgb ? VIDEO_CS_SRGB : VIDEO_CS_709;
+    
+    tap.last_timestamp = 0;
+    obs_add_raw_video_callback(&conversion, RawVideoCallback, &tap);
+    tap.attached = true;
 #endif
+}
+
+void OBSManager::detachFrameTap(FrameTap& tap) {
+#ifdef HAVE_OBS
+    if (!tap.attached) {
+        return;
+    }
     
-    obs_data_t* settings = obs_data_create();
-    obs_source_t* source = obs_source_create(source_id.c_str(), "audio_source", settings, nullptr);
-    obs_data_release(settings);
+    obs_remove_raw_video_callback(RawVideoCallback, &tap);
+    tap.attached = false;
+#endif
+}
+
+int OBSManager::addAudioTap(AudioCallback callback) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     
-    if (!source) {
-        std::cerr << "Failed to create audio source: " << source_id << std::endl;
-        return false;
+#ifdef HAVE_OBS
+    if (!initialized_) {
+        return -1;
     }
     
-    audio_source_ = source;
-    return true;
+    auto tap = std::make_unique<AudioTap>();
+    tap->id = next_audio_tap_id_++;
+    tap->callback = std::move(callback);
+    
+    attachAudioTap(*tap);
+    if (!tap->attached) {
+        return -1;
+    }
+    int id = tap->id;
+    audio_taps_[id] = std::move(tap);
+    return id;
 #else
-    return true;
+    (void)callback;
+    return -1;
 #endif
 }
 
-void OBSManager::cleanupRecording() {
+void OBSManager::removeAudioTap(int tap_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    auto it = audio_taps_.find(tap_id);
+    if (it == audio_taps_.end()) {
+        return;
+    }
+    
+    // Removal waits for a callback in progress, so the tap is unused after it
+    detachAudioTap(*it->second);
+    audio_taps_.erase(it);
+}
+
+void OBSManager::attachAudioTap(AudioTap& tap) {
 #ifdef HAVE_OBS
-    if (video_source_) {
-        obs_source_release(static_cast<obs_source_t*>(video_source_));
-        video_source_ = nullptr;
+    if (tap.attached) {
+        return;
     }
     
-    if (audio_source_) {
-        obs_source_release(static_cast<obs_source_t*>(audio_source_));
-        audio_source_ = nullptr;
+    struct obs_audio_info ai = {};
+    if (!obs_get_audio_info(&ai)) {
+        return;
+    }
+    
+    tap.channels = std::min<uint32_t>(get_audio_channels(ai.speakers), kMaxAudioChannels);
+    tap.sample_rate = ai.samples_per_sec;
+    
+    // Same rate and layout as the mix, so libobs does not resample for us
+    struct audio_convert_info conversion = {};
+    conversion.samples_per_sec = ai.samples_per_sec;
+    conversion.format = AUDIO_FORMAT_FLOAT_PLANAR;
+    conversion.speakers = ai.speakers;
+    
+    obs_add_raw_audio_callback(0, &conversion, RawAudioCallback, &tap);
+    tap.attached = true;
+#else
+    (void)tap;
+#endif
+}
+
+void OBSManager::detachAudioTap(AudioTap& tap) {
+#ifdef HAVE_OBS
+    if (!tap.attached) {
+        return;
     }
+    
+    obs_remove_raw_audio_callback(0, RawAudioCallback, &tap);
+    tap.attached = false;
+#else
+    (void)tap;
 #endif
 }
 
+bool OBSManager::startAudioMeter() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    if (meter_tap_id_ >= 0) {
+        return true;
+    }
+    
+    auto meter = std::make_shared<AudioMeter>();
+    AudioMeter* target = meter.get();
+    int tap_id = addAudioTap([target](const AudioFrame& frame) { target->process(frame); });
+    if (tap_id < 0) {
+        return false;
+    }
+    
+    meter_tap_id_ = tap_id;
+    std::lock_guard<std::mutex> meter_lock(meter_mutex_);
+    meter_ = std::move(meter);
+    return true;
+}
+
+void OBSManager::stopAudioMeter() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    if (meter_tap_id_ < 0) {
+        return;
+    }
+    
+    // The tap goes first; a reader may still hold the meter after this
+    removeAudioTap(meter_tap_id_);
+    meter_tap_id_ = -1;
+    std::lock_guard<std::mutex> meter_lock(meter_mutex_);
+    meter_.reset();
+}
+
+bool OBSManager::getAudioLevels(AudioLevels& levels) {
+    std::shared_ptr<AudioMeter> meter;
+    {
+        std::lock_guard<std::mutex> meter_lock(meter_mutex_);
+        meter = meter_;
+    }
+    if (!meter) {
+        return false;
+    }
+    levels = meter->levels();
+    return true;
+}
+
 bool OBSManager::setSystemAudioEnabled(bool enabled) {
-    // This would control system audio capture
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    system_audio_enabled_ = enabled;
+#ifdef HAVE_OBS
+    // Muting keeps the sources in the mix, so outputs keep an audio track
+    // with continuous timestamps and re-enabling takes effect immediately
+    for (void* source : {audio_source_, session_audio_source_}) {
+        if (source) {
+            obs_source_set_muted(static_cast<obs_source_t*>(source), !enabled);
+        }
+    }
+#endif
     return true;
 }
 
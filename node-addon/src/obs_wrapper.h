@@ -2,6 +2,15 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <map>
+#include "video_frame.h"
+#include "audio_frame.h"
+#include "audio_meter.h"
+#include "shm_ring.h"
+#include "latency_histogram.h"
 
 struct DisplayInfo {
     std::string id;
@@ -22,6 +31,18 @@ struct WindowInfo {
     int y;
 };
 
+// Live stream to another process, used when the output path is a stream
+// target (see stream_sink.h): "unix:/path", "fd:N" or an existing FIFO
+struct StreamSettings {
+    enum Format {
+        FMP4 = 0,   // fragmented MP4: ftyp+moov, then moof+mdat fragments
+        MPEGTS = 1
+    } format = FMP4;
+    // fMP4: longest fragment (a keyframe also starts one). MPEG-TS: media
+    // time between writes to the reader.
+    int fragment_ms = 500;
+};
+
 struct RecordingConfig {
     // Source type
     enum SourceType { 
@@ -35,12 +56,39 @@ struct RecordingConfig {
     uint64_t window_id = 0;
     std::string application_id;
     
+    // Region of interest within the captured display or window; zero
+    // width/height means the whole source. The canvas is the region size,
+    // so compositing, color conversion and encoding only touch its pixels,
+    // and width/height below may downscale it further.
+    int region_x = 0;
+    int region_y = 0;
+    int region_width = 0;
+    int region_height = 0;
+    
     // Output settings
     int width = 1920;
     int height = 1080;
     int fps = 60;
     int video_bitrate = 8000;
     int audio_bitrate = 160;
+    int sample_rate = 0; // audio mix rate, 44100 or 48000; 0 keeps the current one
+    
+    // Video encoder. Software encoders only; preset/tune apply to obs_x264.
+    std::string video_encoder = "obs_x264";
+    std::string preset = "veryfast";  // or "auto": see SelectX264Preset
+    std::string tune;                 // e.g. "zerolatency", empty for none
+    std::string rate_control = "CBR"; // CBR, ABR, VBR or CRF
+    int crf = 23;
+    int keyint_sec = 2;
+    int encoder_threads = 0;          // 0 = encoder default (all cores)
+    double cpu_budget = 0.75;         // share of the cores "auto" may plan for
+    
+    // Variable frame rate (obs_x264 only, needs a build with libx264):
+    // frames that show no change are not encoded, keeping at least
+    // vfr_min_fps. Changes come from XDamage on X11, otherwise from
+    // comparing each frame with the last encoded one.
+    bool vfr = false;
+    int vfr_min_fps = 1;
     
     // Capture settings
     bool capture_cursor = true;
@@ -48,29 +96,339 @@ struct RecordingConfig {
     bool hide_obs = true; // macOS only
     bool show_empty_names = false;
     bool show_hidden_windows = false;
+    
+    // Segmented recording: when either limit is set, startRecording treats
+    // its path as a directory and the muxer rolls over to a new file on the
+    // first keyframe past the limit. Names come from segment_template, an
+    // OBS filename format (%CCYY %MM %DD %hh %mm %ss ...) plus extension.
+    int segment_seconds = 0;
+    int segment_mb = 0;
+    std::string segment_template = "%CCYY-%MM-%DD_%hh-%mm-%ss.mp4";
+    
+    // Container and fragmenting when startRecording's path is a stream target
+    StreamSettings stream;
+    
+    // Replay buffer limits; whichever is hit first trims the oldest packets
+    int replay_max_seconds = 30;
+    int replay_max_mb = 512;
+};
+
+struct InitOptions {
+    // false: load only an allow-list of modules instead of every plugin on
+    // the search paths (`modules`, or RequiredModules() when empty)
+    bool load_all_modules = true;
+    std::vector<std::string> modules;
+    bool capture_audio = true; // include the platform audio module
+    int sample_rate = 48000;   // audio mix rate, 44100 or 48000
+    bool low_memory = false;   // BufferLimits::LowMemory() for every pipeline
+};
+
+// How much each pipeline stage may buffer. The defaults keep the
+// encoders' own settings; the low-memory profile trades compression
+// efficiency and burst tolerance for a smaller, bounded footprint.
+struct BufferLimits {
+    int capture_buffers = 4;      // grabbed frames waiting for the encoder (built-in backend)
+    int encoder_lookahead = -1;   // x264 rc-lookahead frames; -1 = preset default
+    int encoder_b_frames = -1;    // -1 = preset default
+    int max_encoder_threads = 0;  // cap on encoder threads; 0 = none
+    int packet_queue_packets = 1024; // encoded packets waiting for a writer
+    int packet_queue_mb = 64;
+    int max_replay_mb = 0;        // cap on RecordingConfig::replay_max_mb; 0 = none
+    bool scale_up = true;         // false: never output larger than the source
+    
+    static BufferLimits LowMemory() {
+        BufferLimits limits;
+        limits.capture_buffers = 2;
+        limits.encoder_lookahead = 0;
+        limits.encoder_b_frames = 0;
+        limits.max_encoder_threads = 2;
+        limits.packet_queue_packets = 120;
+        limits.packet_queue_mb = 8;
+        limits.max_replay_mb = 64;
+        limits.scale_up = false;
+        return limits;
+    }
+};
+
+// Snapshot returned by OBSManager::getMemoryStats(), in bytes. Buffers the
+// addon allocates are measured; canvas and encoder are estimates of what
+// libobs and the encoders hold for the current sizes and settings.
+struct MemoryStats {
+    bool low_memory = false;
+    uint64_t rss = 0;          // resident set size of the whole process
+    uint64_t canvas = 0;       // estimate: render targets, staging and cached raw frames
+    uint64_t encoder = 0;      // estimate: pictures held by the video encoders
+    uint64_t capture = 0;      // built-in backend: grabbed and scaled frames
+    uint64_t packets = 0;      // encoded packets queued for writers
+    uint64_t replay_limit = 0; // most the running replay buffer may hold
+    uint64_t frame_taps = 0;
+    uint64_t audio_taps = 0;
+    uint64_t frame_export = 0;
+    uint64_t log = 0;
+    uint64_t trace = 0;
+};
+
+// Per-phase cost of the last initialize()
+struct InitTiming {
+    double startup_ms = 0;
+    std::vector<std::pair<std::string, double>> modules; // open + init per module
+    double post_load_ms = 0;
+    double audio_reset_ms = 0;
+    double video_reset_ms = 0;
+    double total_ms = 0;
+};
+
+// Modules needed for capture, audio, x264 and muxing on this platform
+std::vector<std::string> RequiredModules(bool capture_audio);
+
+// Hash of the RecordingConfig fields that shape the capture pipeline (sources,
+// canvas, encoders). Configs with equal keys can share a prepared pipeline.
+uint64_t PipelineKey(const RecordingConfig& config);
+
+// Latency of the most recent recording start
+struct StartTiming {
+    bool warm = false;      // reused a prepared pipeline
+    double prepare_ms = 0;  // building the pipeline (0 when warm)
+    double start_ms = 0;    // opening the file and starting the output
+};
+
+// Snapshot returned by OBSManager::getStats()
+struct PipelineStats {
+    bool active = false;              // an output is running
+    
+    // Render thread: frames produced and frames missed because rendering
+    // took longer than a frame interval
+    uint32_t total_frames = 0;
+    uint32_t lagged_frames = 0;
+    double average_frame_time_ms = 0;
+    
+    // Encoder input: frames skipped because the encoder fell behind
+    uint32_t video_frames = 0;
+    uint32_t skipped_frames = 0;
+    
+    // Active output
+    int output_frames = 0;
+    int dropped_frames = 0;
+    uint64_t bytes_written = 0;
+    double bitrate_kbps = 0;          // over the interval since the previous poll
+    float congestion = 0;
+    
+    // Frame timestamp to raw frame ready, and per-packet encode time
+    // (encode time needs libobs 31+)
+    LatencyHistogram::Summary render_latency;
+    LatencyHistogram::Summary encode_time;
+    // How late the capture thread woke for each frame (native backend only)
+    LatencyHistogram::Summary capture_jitter;
+    // Frame capture to the bytes reaching the reader, when the recording
+    // is a live stream
+    LatencyHistogram::Summary stream_latency;
+    
+    // Video encoder of the active output, with "auto" resolved
+    std::string video_encoder;
+    std::string preset;
+    
+    std::string backend; // "obs", "native" (built-in X11 capture) or "none"
+};
+
+// An extra output fed by the shared encoders (see OBSManager::addOutput)
+struct OutputConfig {
+    enum Type {
+        FILE = 0,     // one file; a FIFO path is written as a stream (StreamSettings)
+        SEGMENTS = 1, // rolling files in a directory, as in segmented recording
+        URL = 2,      // MPEG-TS to udp://, tcp://, srt:// or rist://
+        STREAM = 3    // fMP4 or MPEG-TS to a local reader (StreamSettings)
+    } type = FILE;
+    
+    std::string path; // file path, segment directory, URL or stream target
+    int segment_seconds = 0;
+    int segment_mb = 0;
+    std::string segment_template = "%CCYY-%MM-%DD_%hh-%mm-%ss.mp4";
+    StreamSettings stream;
+};
+
+struct OutputStatus {
+    std::string name;
+    OutputConfig::Type type = OutputConfig::FILE;
+    bool active = false;
+    int frames = 0;
+    int dropped_frames = 0;
+    uint64_t bytes_written = 0;
+    // Stream outputs: frame capture to the bytes reaching the reader
+    LatencyHistogram::Summary latency;
+};
+
+// Snapshot returned by OBSManager::getSessionStats()
+struct SessionStats {
+    bool active = false;
+    uint32_t encoded_frames = 0;  // frames handed to the session's encoder
+    uint32_t skipped_frames = 0;  // dropped because the encoder fell behind
+    int output_frames = 0;
+    int dropped_frames = 0;
+    uint64_t bytes_written = 0;
+    int encoder_threads = 0;      // share of the encoder thread budget
+    std::string preset;           // x264 preset, with "auto" resolved
+};
+
+// A finished file of a segmented recording
+struct SegmentInfo {
+    std::string path;
+    int index = 0;         // 0-based within the recording
+    bool last = false;     // the recording stopped
 };
 
+// Called from an OBS output thread; must not block
+using SegmentCallback = std::function<void(const SegmentInfo&)>;
+
+// A lifecycle signal of the recording, replay buffer, an extra output or a
+// session, as libobs reports it
+struct OutputEvent {
+    std::string type;    // "start", "stop", "stopping", "activate", "deactivate",
+                         // "reconnect", "reconnect_success"
+    std::string output;  // "recording", "replay", an addOutput name or "session:<id>"
+    int code = 0;        // "stop": OBS_OUTPUT_* code, 0 when stopped normally
+    std::string error;   // "stop" with a non-zero code: the output's last error
+};
+
+// Called from OBS output threads (or the built-in backend's threads); must
+// not block
+using OutputEventCallback = std::function<void(const OutputEvent&)>;
+
+// Raw frame tap request. Zero width/height means the canvas output size.
+struct FrameTapConfig {
+    FrameFormat format = FrameFormat::BGRA;
+    int width = 0;
+    int height = 0;
+    int max_fps = 0; // 0 = every rendered frame
+};
+
+// Called on the OBS video thread; the frame is only valid during the call
+using FrameCallback = std::function<void(const VideoFrame&)>;
+
+// Called on the OBS audio thread with each mixed block (1024 frames); the
+// samples are only valid during the call and it must not block
+using AudioCallback = std::function<void(const AudioFrame&)>;
+
+// Sample rates the audio mix can run at
+bool IsSupportedSampleRate(int sample_rate);
+
+struct FrameTap;
+struct AudioTap;
+struct CaptureSession;
+class X11Topology;
+class NativeRecorder;
+
+// Called from a background thread when the display or window list changes
+using TopologyCallback = std::function<void(bool displays_changed, bool windows_changed)>;
+
 class OBSManager {
 public:
     static OBSManager& getInstance();
     
+    // Public methods are safe to call from any thread; control operations
+    // (initialize, shutdown, start/stop) are serialized internally.
+    
     // Core OBS management
-    bool initialize();
+    bool initialize(const InitOptions& options = InitOptions());
     void shutdown();
     bool isInitialized() const { return initialized_; }
+    InitTiming getInitTiming();
     
     // Source enumeration
     std::vector<DisplayInfo> getDisplays();
     std::vector<WindowInfo> getWindows();
     
-    // Recording control
+    // Change notifications for the lists above. Returns false where the
+    // platform has no change events (currently everything but X11).
+    bool setTopologyCallback(TopologyCallback callback);
+    
+    // Builds video/audio contexts, sources, encoders and the recording output
+    // ahead of time so that startRecording only has to open the file. The
+    // pipeline stays ready across recordings until unprepare() or a start
+    // with a config whose PipelineKey differs.
+    bool prepare(const RecordingConfig& config);
+    void unprepare();
+    bool isPrepared() const { return prepared_; }
+    
+    // Recording control. The single-argument form uses the prepared config.
     bool startRecording(const std::string& output_path, const RecordingConfig& config);
+    bool startRecording(const std::string& output_path);
+    StartTiming getStartTiming();
+    
+    // Extra outputs on the running pipeline (after prepare(), startRecording
+    // or startReplayBuffer). Every output gets the same encoded packets on
+    // the encoder thread and copies them into a bounded queue of its own
+    // (file_output.h, stream_output.h; URLs: ffmpeg_mpegts_muxer), so a
+    // slow sink only drops its own data. Builds without libav write files
+    // through ffmpeg_muxer, which gives no such isolation.
+    bool addOutput(const std::string& name, const OutputConfig& config);
+    bool startOutput(const std::string& name);
+    void stopOutput(const std::string& name);
+    void removeOutput(const std::string& name);
+    std::vector<OutputStatus> getOutputs();
+    
+    // Independent capture sessions. Each has its own source, render mix,
+    // encoders and output, sharing only the OBS core, so several displays
+    // or windows can be recorded at once. Returns a session id, or -1.
+    int createSession(const RecordingConfig& config);
+    bool startSession(int session_id, const std::string& output_path);
+    void stopSession(int session_id);
+    void destroySession(int session_id);
+    SessionStats getSessionStats(int session_id);
+    
+    // Software encoder threads shared by all running encoders (0 = one per
+    // core). A starting session gets an equal share of the budget.
+    void setEncoderThreadBudget(int threads);
+    
+    // Notified as each segment of a segmented recording is closed
+    void setSegmentCallback(SegmentCallback callback);
     void stopRecording();
-    bool isRecording() const { return recording_; }
+    // True from the recording output's "start" signal to its "stop", which
+    // also comes when the output fails on its own (a full disk, say)
+    bool isRecording() const { return recording_active_; }
+    
+    // Lifecycle events of every output; see OutputEvent
+    void setOutputEventCallback(OutputEventCallback callback);
     
-    // Audio control
+    // Replay buffer: keeps the last N seconds of encoded packets in memory
+    bool startReplayBuffer(const RecordingConfig& config);
+    bool saveReplay(const std::string& output_path);
+    void stopReplayBuffer();
+    bool isReplayBufferActive() const { return replay_active_; }
+    
+    // Live statistics. Cheap enough to poll at 10 Hz; never waits on a
+    // control operation in progress.
+    PipelineStats getStats();
+    
+    // Bytes held by each stage; like getStats, never waits on a control
+    // operation (the estimates are then those of the last call)
+    MemoryStats getMemoryStats();
+    
+    // Raw frame taps. Returns a tap id, or -1 when frames are unavailable.
+    int addFrameTap(const FrameTapConfig& config, FrameCallback callback);
+    void removeFrameTap(int tap_id);
+    
+    // Publish frames into a named shared-memory ring (see obs_capture_shm.h)
+    bool startFrameExport(const std::string& name, const FrameTapConfig& config, int slot_count);
+    void stopFrameExport(const std::string& name);
+    
+    // Taps on the main audio mix (track 1) as planar float. Returns a tap id,
+    // or -1 when audio is unavailable. Taps survive audio resets.
+    int addAudioTap(AudioCallback callback);
+    void removeAudioTap(int tap_id);
+    
+    // Level meter on the audio mix (see audio_meter.h). getAudioLevels
+    // returns false while the meter is stopped; it never waits on a control
+    // operation in progress.
+    bool startAudioMeter();
+    void stopAudioMeter();
+    bool getAudioLevels(AudioLevels& levels);
+    
+    // Audio control. Disabling mutes the desktop audio sources, current and
+    // future; recordings keep their (silent) audio track.
     bool setSystemAudioEnabled(bool enabled);
+    bool isSystemAudioEnabled() const { return system_audio_enabled_; }
     bool isCaptureAudioSupported();
+    int getSampleRate() const { return sample_rate_; }
     
 private:
     OBSManager() = default;
@@ -80,25 +438,161 @@ private:
     OBSManager(const OBSManager&) = delete;
     OBSManager& operator=(const OBSManager&) = delete;
     
-    bool initialized_ = false;
-    bool recording_ = false;
+    std::recursive_mutex mutex_;
+    std::atomic<bool> initialized_{false};
+    std::atomic<bool> recording_{false};
+    std::atomic<bool> replay_active_{false};
+    
+    // Pipeline state: built by setupPipeline for pipeline_key_; prepared_
+    // means it was requested explicitly and outlives a single recording
+    bool pipeline_ready_ = false;
+    std::atomic<bool> prepared_{false};
+    uint64_t pipeline_key_ = 0;
+    RecordingConfig pipeline_config_;
+    StartTiming start_timing_;
+    InitTiming init_timing_;
+    bool vfr_encoder_registered_ = false;
+    BufferLimits limits_;
+    std::atomic<bool> low_memory_{false};
+    std::atomic<uint64_t> canvas_estimate_{0};
+    std::atomic<uint64_t> encoder_estimate_{0};
+    std::atomic<uint64_t> replay_limit_bytes_{0};
     
     // OBS objects (using void* to avoid including obs headers here)
     void* obs_output_ = nullptr;
+    void* replay_output_ = nullptr;
     void* video_encoder_ = nullptr;
     void* audio_encoder_ = nullptr;
     void* video_source_ = nullptr;
     void* audio_source_ = nullptr;
     void* scene_ = nullptr;
     
+    struct ManagedOutput {
+        OutputConfig config;
+        void* output = nullptr;
+        void* service = nullptr; // URL outputs
+        bool active = false;
+    };
+    std::map<std::string, ManagedOutput> outputs_;
+    
+    std::map<int, std::unique_ptr<CaptureSession>> sessions_;
+    int next_session_id_ = 1;
+    int encoder_thread_budget_ = 0;
+    // Desktop audio for sessions when the main pipeline has none: the audio
+    // mix only hears output channels, so all sessions share one source there
+    void* session_audio_source_ = nullptr;
+    int session_audio_users_ = 0;
+    
+    // Segment bookkeeping per muxer output, updated from its signals
+    struct SegmentState {
+        std::string current;
+        int index = 0;
+    };
+    std::mutex segment_mutex_;
+    std::map<void*, SegmentState> segments_;
+    SegmentCallback segment_callback_;
+    static void onSegmentFileChanged(void* param, struct calldata* data);
+    static void onSegmentOutputStopped(void* param, struct calldata* data);
+    
+    // Outputs whose signals are forwarded as OutputEvents, by label. An
+    // output is forgotten when released, so a file still finalizing after
+    // its replacement started reports nothing.
+    std::mutex output_events_mutex_;
+    std::map<void*, std::string> watched_outputs_;
+    OutputEventCallback output_event_callback_;
+    std::atomic<bool> recording_active_{false};
+    std::atomic<bool> recording_failed_{false}; // stopped with an error code
+    void watchOutput(void* output, const std::string& label);
+    void unwatchOutput(void* output);
+    void emitOutputEvent(const OutputEvent& event);
+    static void onOutputSignal(void* param, const char* signal, struct calldata* data);
+    
+    // Stats for the running output. Guarded by its own lock so polling does
+    // not contend with mutex_; histograms are recorded from OBS threads.
+    std::mutex stats_mutex_;
+    void* stats_output_ = nullptr;
+    uint64_t stats_last_bytes_ = 0;
+    uint64_t stats_last_time_ns_ = 0;
+    double stats_bitrate_kbps_ = 0;
+    std::string stats_preset_;
+    std::string encoder_preset_; // preset the current encoder was created with
+    LatencyHistogram render_latency_;
+    LatencyHistogram encode_time_;
+    
+    // Frame taps survive video resets; they are re-attached afterwards
+    std::map<int, std::unique_ptr<FrameTap>> frame_taps_;
+    int next_tap_id_ = 1;
+    
+    // Audio taps likewise survive audio resets
+    std::map<int, std::unique_ptr<AudioTap>> audio_taps_;
+    int next_audio_tap_id_ = 1;
+    std::atomic<bool> system_audio_enabled_{true};
+    std::atomic<int> sample_rate_{48000}; // rate the audio mix was last reset to
+    
+    // The meter is fed by its own audio tap; held by shared_ptr so
+    // getAudioLevels can read it without taking mutex_
+    std::mutex meter_mutex_;
+    std::shared_ptr<AudioMeter> meter_;
+    int meter_tap_id_ = -1;
+    
+    struct FrameExport {
+        std::unique_ptr<ShmFrameRing> ring;
+        int tap_id = -1;
+    };
+    std::map<std::string, FrameExport> frame_exports_;
+    
+#ifdef HAVE_NATIVE_CAPTURE
+    // Built-in capture backend used when libobs is absent; replaced per
+    // recording, and read by getStats() under stats_mutex_
+    std::unique_ptr<NativeRecorder> native_recorder_;
+    bool startNativeRecording(const std::string& output_path, const RecordingConfig& config);
+#endif
+    
+#ifdef __linux__
+    // Persistent X connections with cached enumeration results; created on
+    // first use so processes that never enumerate do not connect
+    std::mutex topology_mutex_;
+    std::unique_ptr<X11Topology> topology_;
+    bool topology_unavailable_ = false;
+    X11Topology* getTopology();
+#endif
+    
     // Internal methods
     void setupPluginPaths();
-    bool loadRequiredPlugins();
+    bool loadRequiredPlugins(const InitOptions& options);
     void cleanupRecording();
+    bool setupPipeline(const RecordingConfig& config);
+    bool ensurePipeline(const RecordingConfig& config, bool& warm);
+    bool createRecordingOutput(bool stream = false);
+    void releasePipelineIfUnprepared();
+    bool pipelineInUse() const;
+    void* createMuxerOutput(const std::string& name);
+    void configureMuxerOutput(void* output, const std::string& path, int segment_seconds, int segment_mb,
+                              const std::string& segment_template);
+    void* createStreamOutput(const std::string& name);
+    void configureStreamOutput(void* output, const std::string& target, const StreamSettings& stream);
+    bool createEncoders(const RecordingConfig& config);
+    bool createSessionEncoders(CaptureSession& session);
+    std::string videoEncoderId(const RecordingConfig& config, void* settings);
+    void releaseSessionOutput(CaptureSession& session);
+    int encoderThreadShare(const RecordingConfig& config) const;
+    void acquireSessionAudio();
+    void releaseSessionAudio();
+    void canvasBaseSize(const RecordingConfig& config, uint32_t& width, uint32_t& height);
+    void estimateMemory();
+    void attachEncoders(void* output);
+    void attachStats(void* output);
+    void detachStats(void* output);
     bool setupVideoOutput(const RecordingConfig& config);
     bool setupAudioOutput(const RecordingConfig& config);
     bool createVideoSource(const RecordingConfig& config);
     bool createAudioSource(const RecordingConfig& config);
+    bool resolveFrameSize(FrameTapConfig& config) const;
+    void attachFrameTap(FrameTap& tap);
+    void detachFrameTap(FrameTap& tap);
+    void attachAudioTap(AudioTap& tap);
+    void detachAudioTap(AudioTap& tap);
+    bool resetAudio(int sample_rate);
     std::string getPluginPath() const;
     std::string getDataPath() const;
 };
\ No newline at end of file
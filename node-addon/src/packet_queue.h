@@ -0,0 +1,120 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "memory_stats.h"
+
+// Bounded FIFO of encoded packets between an encoder and a writer thread,
+// limited both in packets and in bytes. The encoder never waits on the
+// writer. Drop policy: a packet that does not fit is dropped, and so is
+// every later packet of its stream up to the next keyframe that fits, so
+// the stream resumes where a decoder can pick it up instead of referencing
+// frames it never received. Queued bytes are charged to
+// MemoryStage::Packets.
+template <typename Packet>
+class PacketQueue {
+public:
+    PacketQueue(size_t max_packets, size_t max_bytes)
+        : max_packets_(max_packets), max_bytes_(max_bytes) {}
+
+    PacketQueue(const PacketQueue&) = delete;
+    PacketQueue& operator=(const PacketQueue&) = delete;
+
+    // Encoder side. Audio and other intra-only streams pass keyframe = true.
+    // Returns false when the packet was dropped (or the queue is closed).
+    bool push(Packet&& packet, size_t bytes, bool keyframe, int stream = 0) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) {
+                return false;
+            }
+            if (static_cast<size_t>(stream) >= skipping_.size()) {
+                skipping_.resize(stream + 1, false);
+            }
+            bool fits = entries_.size() < max_packets_ && bytes_ + bytes <= max_bytes_;
+            if (!fits || (skipping_[stream] && !keyframe)) {
+                skipping_[stream] = true;
+                dropped_++;
+                return false;
+            }
+            skipping_[stream] = false;
+            entries_.push_back(Entry{std::move(packet), bytes});
+            bytes_ += bytes;
+            if (bytes_ > peak_bytes_) {
+                peak_bytes_ = bytes_;
+            }
+            charge_.set(bytes_);
+        }
+        ready_.notify_one();
+        return true;
+    }
+
+    // Writer side: waits for the next packet. Returns false once the queue
+    // is closed and everything queued before close() has been taken.
+    bool pop(Packet& packet) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this] { return closed_ || !entries_.empty(); });
+        if (entries_.empty()) {
+            return false;
+        }
+        packet = std::move(entries_.front().packet);
+        bytes_ -= entries_.front().bytes;
+        entries_.pop_front();
+        charge_.set(bytes_);
+        return true;
+    }
+
+    // Stops accepting packets and wakes the writer to drain what is left
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        ready_.notify_all();
+    }
+
+    // Drops everything queued, e.g. when the writer gave up
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        dropped_ += entries_.size();
+        entries_.clear();
+        bytes_ = 0;
+        charge_.set(0);
+    }
+
+    uint64_t dropped() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return dropped_;
+    }
+
+    size_t queuedBytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return bytes_;
+    }
+
+    size_t peakBytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return peak_bytes_;
+    }
+
+private:
+    struct Entry {
+        Packet packet;
+        size_t bytes;
+    };
+
+    const size_t max_packets_;
+    const size_t max_bytes_;
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<Entry> entries_;
+    std::vector<bool> skipping_; // per stream: dropping until a keyframe
+    size_t bytes_ = 0;
+    size_t peak_bytes_ = 0;
+    uint64_t dropped_ = 0;
+    bool closed_ = false;
+    MemoryCharge charge_{MemoryStage::Packets};
+};
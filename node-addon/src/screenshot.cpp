@@ -0,0 +1,271 @@
+#include "screenshot.h"
+#include "color_convert.h"
+#include "frame_tap.h"
+#include "image_codec.h"
+#include "obs_wrapper.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include "x11_screenshot.h"
+#endif
+
+namespace {
+
+struct ScreenshotRequest {
+    uint64_t window = 0; // 0 = root window
+    int x = 0;
+    int y = 0;
+    int width = 0;       // 0 = to the window edge
+    int height = 0;
+    FrameFormat pixel_format = FrameFormat::BGRA;
+    std::string encoding; // "", "png" or "jpeg"
+    int quality = 90;
+    int scale_width = 0;  // output size; 0 = as grabbed, or keep aspect
+    int scale_height = 0;
+};
+
+struct Screenshot {
+    std::vector<uint8_t> data;
+    int width = 0;
+    int height = 0;
+    std::string error;
+};
+
+#ifdef __linux__
+// One grabber (connection + shared segment) for the process
+std::mutex g_grab_mutex;
+std::unique_ptr<X11Screenshot> g_grabber;
+#endif
+
+#ifdef __linux__
+// Output size from the requested one, filling in a missing side from the
+// grabbed aspect ratio
+void ResolveScaledSize(const ScreenshotRequest& request, int width, int height, int& out_width, int& out_height) {
+    out_width = request.scale_width;
+    out_height = request.scale_height;
+    if (!out_width && !out_height) {
+        out_width = width;
+        out_height = height;
+    } else if (!out_height) {
+        out_height = std::max(1, static_cast<int>((static_cast<int64_t>(height) * out_width + width / 2) / width));
+    } else if (!out_width) {
+        out_width = std::max(1, static_cast<int>((static_cast<int64_t>(width) * out_height + height / 2) / height));
+    }
+}
+#endif
+
+bool TakeScreenshot(const ScreenshotRequest& request, Screenshot& shot) {
+#ifdef __linux__
+    // YUV is converted from BGRA after the grab; scaling is channel-agnostic
+    bool yuv = request.pixel_format == FrameFormat::NV12 || request.pixel_format == FrameFormat::I420;
+    FrameFormat grab_format = yuv ? FrameFormat::BGRA : request.pixel_format;
+    std::vector<uint8_t> pixels;
+    int width = 0;
+    int height = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_grab_mutex);
+        if (!g_grabber) {
+            auto grabber = std::make_unique<X11Screenshot>();
+            if (!grabber->open()) {
+                shot.error = "Cannot connect to the X server";
+                return false;
+            }
+            g_grabber = std::move(grabber);
+        }
+        if (!g_grabber->grab(request.window, request.x, request.y, request.width, request.height,
+                             grab_format, pixels, width, height)) {
+            shot.error = "Screenshot failed: the window is gone, unmapped or the region is empty";
+            return false;
+        }
+    }
+
+    // Scaling, conversion and compression run outside the grab lock so
+    // concurrent requests overlap
+    ResolveScaledSize(request, width, height, shot.width, shot.height);
+    if (shot.width != width || shot.height != height) {
+        std::vector<uint8_t> scaled(static_cast<size_t>(shot.width) * shot.height * 4);
+        std::vector<uint8_t> scratch;
+        ScaleBgra(pixels.data(), width * 4, width, height, scaled.data(), shot.width * 4, shot.width, shot.height,
+                  scratch);
+        pixels.swap(scaled);
+    }
+
+    if (yuv) {
+        FrameLayout layout = GetFrameLayout(request.pixel_format, shot.width, shot.height);
+        shot.data.resize(layout.size);
+        uint8_t* planes = shot.data.data();
+        if (request.pixel_format == FrameFormat::NV12) {
+            BgraToNv12(pixels.data(), shot.width * 4, shot.width, shot.height,
+                       planes + layout.offset[0], layout.stride[0], planes + layout.offset[1], layout.stride[1]);
+        } else {
+            BgraToI420(pixels.data(), shot.width * 4, shot.width, shot.height,
+                       planes + layout.offset[0], layout.stride[0], planes + layout.offset[1], layout.stride[1],
+                       planes + layout.offset[2], layout.stride[2]);
+        }
+    } else if (request.encoding == "png") {
+        if (!EncodePng(pixels.data(), shot.width, shot.height, request.pixel_format, shot.data)) {
+            shot.error = "PNG encoding failed (built without libpng?)";
+            return false;
+        }
+    } else if (request.encoding == "jpeg") {
+        if (!EncodeJpeg(pixels.data(), shot.width, shot.height, request.pixel_format, request.quality, shot.data)) {
+            shot.error = "JPEG encoding failed (built without libjpeg?)";
+            return false;
+        }
+    } else {
+        shot.data = std::move(pixels);
+    }
+    return true;
+#else
+    (void)request;
+    shot.error = "captureFrame is only supported on Linux (X11)";
+    return false;
+#endif
+}
+
+// Reads captureFrame options. Throws a JS exception and returns false on
+// invalid input.
+bool ParseScreenshotRequest(const Napi::CallbackInfo& info, ScreenshotRequest& request) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        return true;
+    }
+    Napi::Object opts = info[0].As<Napi::Object>();
+
+    if (opts.Has("format")) {
+        std::string format = opts.Get("format").As<Napi::String>();
+        if (format == "png" || format == "jpeg") {
+            request.encoding = format;
+        } else if (!ParseFrameFormat(format, request.pixel_format)) {
+            Napi::TypeError::New(env, "Unsupported screenshot format: " + format).ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    request.quality = GetIntOption(opts, "quality", request.quality);
+    if (request.quality < 1 || request.quality > 100) {
+        Napi::RangeError::New(env, "quality must be between 1 and 100").ThrowAsJavaScriptException();
+        return false;
+    }
+    request.scale_width = GetIntOption(opts, "width", 0);
+    request.scale_height = GetIntOption(opts, "height", 0);
+    if (request.scale_width < 0 || request.scale_height < 0) {
+        Napi::RangeError::New(env, "width and height must be positive").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    if (opts.Has("windowId")) {
+        request.window = opts.Get("windowId").As<Napi::Number>().Int64Value();
+    } else if (opts.Has("displayId")) {
+        std::string display_id = opts.Get("displayId").As<Napi::String>();
+        bool found = false;
+        for (const DisplayInfo& display : OBSManager::getInstance().getDisplays()) {
+            if (display.id == display_id) {
+                request.x = display.x;
+                request.y = display.y;
+                request.width = display.width;
+                request.height = display.height;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            Napi::Error::New(env, "Unknown display: " + display_id).ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+
+    // Relative to the display or window, like a recording region
+    if (opts.Has("region") && opts.Get("region").IsObject()) {
+        Napi::Object region = opts.Get("region").As<Napi::Object>();
+        int x = GetIntOption(region, "x", 0);
+        int y = GetIntOption(region, "y", 0);
+        int width = GetIntOption(region, "width", 0);
+        int height = GetIntOption(region, "height", 0);
+        if (width <= 0 || height <= 0) {
+            Napi::RangeError::New(env, "region needs a positive width and height").ThrowAsJavaScriptException();
+            return false;
+        }
+        // Stay inside the display it is relative to
+        if (request.width > 0) {
+            width = std::min(width, request.width - x);
+            height = std::min(height, request.height - y);
+        }
+        request.x += x;
+        request.y += y;
+        request.width = width;
+        request.height = height;
+    }
+    return true;
+}
+
+// Hands the screenshot's storage to JS without copying
+Napi::Value ToBuffer(Napi::Env env, Screenshot& shot) {
+    auto* data = new std::vector<uint8_t>(std::move(shot.data));
+    Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::New(env, data->data(), data->size(),
+        [](Napi::Env, uint8_t*, std::vector<uint8_t>* data) { delete data; }, data);
+    buffer.Set("width", Napi::Number::New(env, shot.width));
+    buffer.Set("height", Napi::Number::New(env, shot.height));
+    return buffer;
+}
+
+class ScreenshotWorker : public Napi::AsyncWorker {
+public:
+    ScreenshotWorker(Napi::Env env, const ScreenshotRequest& request)
+        : Napi::AsyncWorker(env), deferred_(Napi::Promise::Deferred::New(env)), request_(request) {}
+
+    Napi::Promise promise() { return deferred_.Promise(); }
+
+    void Execute() override {
+        if (!TakeScreenshot(request_, shot_)) {
+            SetError(shot_.error);
+        }
+    }
+
+    void OnOK() override {
+        deferred_.Resolve(ToBuffer(Env(), shot_));
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    ScreenshotRequest request_;
+    Screenshot shot_;
+};
+
+} // namespace
+
+Napi::Value CaptureFrame(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    ScreenshotRequest request;
+    if (!ParseScreenshotRequest(info, request)) {
+        return env.Undefined();
+    }
+
+    Screenshot shot;
+    if (!TakeScreenshot(request, shot)) {
+        Napi::Error::New(env, shot.error).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return ToBuffer(env, shot);
+}
+
+Napi::Value CaptureFrameAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    ScreenshotRequest request;
+    if (!ParseScreenshotRequest(info, request)) {
+        return env.Undefined();
+    }
+
+    // Queued on the libuv pool; the worker deletes itself when done
+    auto* worker = new ScreenshotWorker(env, request);
+    Napi::Promise promise = worker->promise();
+    worker->Queue();
+    return promise;
+}
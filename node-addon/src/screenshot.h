@@ -0,0 +1,12 @@
+#pragma once
+#include <napi.h>
+
+// JS bindings for single-frame screenshots, taken straight from the X
+// server without libobs (no init, recording or render loop needed):
+//   captureFrame({ displayId | windowId, region, format, quality }) -> Buffer
+//   captureFrameAsync(options) -> Promise<Buffer>
+// format is 'bgra' (default), 'rgba', 'png' or 'jpeg'. The Buffer carries
+// `width` and `height`. The async form grabs and compresses on the libuv
+// thread pool; grabs are serialized, compression runs in parallel.
+Napi::Value CaptureFrame(const Napi::CallbackInfo& info);
+Napi::Value CaptureFrameAsync(const Napi::CallbackInfo& info);
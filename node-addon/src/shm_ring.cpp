@@ -0,0 +1,157 @@
+#include "shm_ring.h"
+#include "log_sink.h"
+#include <cstring>
+
+#ifndef _WIN32
+#include "obs_capture_shm.h"
+#include <atomic>
+#endif
+
+ShmFrameRing::~ShmFrameRing() {
+    destroy();
+}
+
+#ifndef _WIN32
+
+bool ShmFrameRing::create(const std::string& name, FrameFormat format, uint32_t width, uint32_t height,
+                          uint32_t slot_count) {
+    destroy();
+
+    if (slot_count < 2 || width == 0 || height == 0) {
+        return false;
+    }
+
+    layout_ = GetFrameLayout(format, width, height);
+
+    // Page-align every slot so each frame starts on its own pages
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto align = [page](size_t value) { return (value + page - 1) / page * page; };
+    const size_t data_offset = align(sizeof(obs_shm_ring_header));
+    const size_t slot_stride = align(sizeof(obs_shm_slot_header) + layout_.size);
+    const size_t total = data_offset + slot_stride * slot_count;
+
+    // A stale ring from a crashed writer would otherwise keep its old size
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        LogError() << "Failed to create shared memory: " << name;
+        return false;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(total)) != 0) {
+        LogError() << "Failed to size shared memory: " << name;
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void* base = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        LogError() << "Failed to map shared memory: " << name;
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // ftruncate zero-fills, so every slot starts with seq 0 / frame_index 0.
+    // Readers start at write_index and never look at unpublished slots.
+    header_ = static_cast<obs_shm_ring_header*>(base);
+    header_->version = OBS_SHM_VERSION;
+    header_->slot_count = slot_count;
+    header_->slot_size = static_cast<uint32_t>(layout_.size);
+    header_->slot_stride = slot_stride;
+    header_->data_offset = data_offset;
+    header_->width = width;
+    header_->height = height;
+    header_->format = static_cast<uint32_t>(format);
+    __atomic_store_n(&header_->writer_alive, 1, __ATOMIC_RELAXED);
+    // Magic last, so a reader never accepts a half-initialized header
+    __atomic_store_n(&header_->magic, OBS_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    name_ = name;
+    fd_ = fd;
+    base_ = base;
+    size_ = total;
+    charge_.set(total);
+    return true;
+}
+
+void ShmFrameRing::destroy() {
+    if (!base_) {
+        return;
+    }
+
+    __atomic_store_n(&header_->writer_alive, 0, __ATOMIC_RELEASE);
+    munmap(base_, size_);
+    close(fd_);
+    // Readers that are already attached keep their mapping
+    shm_unlink(name_.c_str());
+
+    base_ = nullptr;
+    header_ = nullptr;
+    fd_ = -1;
+    size_ = 0;
+    charge_.set(0);
+    name_.clear();
+}
+
+void ShmFrameRing::publish(const VideoFrame& frame) {
+    if (!header_ || frame.width != header_->width || frame.height != header_->height) {
+        return;
+    }
+
+    const uint64_t index = __atomic_load_n(&header_->write_index, __ATOMIC_RELAXED);
+    const uint32_t slot_number = static_cast<uint32_t>(index % header_->slot_count);
+    auto* slot = reinterpret_cast<obs_shm_slot_header*>(
+        static_cast<uint8_t*>(base_) + header_->data_offset + slot_number * header_->slot_stride);
+    uint8_t* dst = reinterpret_cast<uint8_t*>(slot) + sizeof(obs_shm_slot_header);
+
+    // Seqlock write: odd while the slot is inconsistent
+    const uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int i = 0; i < layout_.planes; ++i) {
+        uint8_t* plane = dst + layout_.offset[i];
+        const uint8_t* src = frame.data[i];
+        if (frame.linesize[i] == layout_.stride[i]) {
+            std::memcpy(plane, src, static_cast<size_t>(layout_.stride[i]) * layout_.rows[i]);
+        } else {
+            for (uint32_t row = 0; row < layout_.rows[i]; ++row) {
+                std::memcpy(plane + static_cast<size_t>(row) * layout_.stride[i],
+                            src + static_cast<size_t>(row) * frame.linesize[i],
+                            layout_.stride[i]);
+            }
+        }
+        slot->stride[i] = layout_.stride[i];
+        slot->offset[i] = static_cast<uint32_t>(layout_.offset[i]);
+    }
+
+    __atomic_store_n(&slot->frame_index, index, __ATOMIC_RELAXED);
+    slot->timestamp_ns = frame.timestamp;
+    slot->format = static_cast<uint32_t>(frame.format);
+    slot->width = frame.width;
+    slot->height = frame.height;
+    slot->plane_count = static_cast<uint32_t>(layout_.planes);
+    slot->data_size = static_cast<uint32_t>(layout_.size);
+
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&header_->write_index, index + 1, __ATOMIC_RELEASE);
+}
+
+uint64_t ShmFrameRing::framesPublished() const {
+    return header_ ? __atomic_load_n(&header_->write_index, __ATOMIC_ACQUIRE) : 0;
+}
+
+#else // _WIN32
+
+bool ShmFrameRing::create(const std::string&, FrameFormat, uint32_t, uint32_t, uint32_t) {
+    LogError() << "Shared-memory frame export is not supported on Windows";
+    return false;
+}
+
+void ShmFrameRing::destroy() {}
+void ShmFrameRing::publish(const VideoFrame&) {}
+uint64_t ShmFrameRing::framesPublished() const { return 0; }
+
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include "memory_stats.h"
+#include "video_frame.h"
+
+struct obs_shm_ring_header;
+
+// Writer side of the shared-memory frame ring described in
+// include/obs_capture_shm.h. One writer (the OBS video thread) publishes
+// frames; any number of readers attach by name from other processes.
+class ShmFrameRing {
+public:
+    ShmFrameRing() = default;
+    ~ShmFrameRing();
+
+    ShmFrameRing(const ShmFrameRing&) = delete;
+    ShmFrameRing& operator=(const ShmFrameRing&) = delete;
+
+    // Creates (or replaces) the named shm object sized for `slot_count`
+    // frames of the given format and size.
+    bool create(const std::string& name, FrameFormat format, uint32_t width, uint32_t height,
+                uint32_t slot_count);
+    void destroy();
+
+    // Copies one frame into the next slot. Never blocks on readers.
+    void publish(const VideoFrame& frame);
+
+    const std::string& name() const { return name_; }
+    size_t mappedBytes() const { return size_; }
+    uint64_t framesPublished() const;
+
+private:
+    std::string name_;
+    int fd_ = -1;
+    void* base_ = nullptr;
+    size_t size_ = 0;
+    obs_shm_ring_header* header_ = nullptr;
+    FrameLayout layout_;
+    MemoryCharge charge_{MemoryStage::FrameExport};
+};
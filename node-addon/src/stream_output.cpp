@@ -0,0 +1,242 @@
+#include "stream_output.h"
+#include "encoder_stream.h"
+#include "log_sink.h"
+#include "packet_queue.h"
+#include "stream_writer.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <obs/obs.h>
+#include <obs/util/platform.h>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+const char* const kStreamOutputId = "addon_stream_output";
+
+namespace {
+
+struct StreamOutput {
+    obs_output_t* output = nullptr;
+    StreamWriter writer;
+    // Replaced only while no packets arrive (before begin_data_capture)
+    std::unique_ptr<PacketQueue<QueuedPacket>> queue;
+    std::thread thread;
+    std::atomic<bool> active{false};
+    std::atomic<int> dropped{0};
+    int video_stream = -1;
+    int audio_stream = -1;
+};
+
+// libobs has no getter for an output's instance data
+std::mutex g_outputs_mutex;
+std::map<obs_output_t*, StreamOutput*> g_outputs;
+
+// Writer thread failure: the reader went away or muxing failed
+void Fail(StreamOutput* stream, const std::string& error) {
+    stream->queue->close();
+    stream->queue->clear();
+    stream->writer.close();
+    if (stream->active.exchange(false)) {
+        LogError() << "Stream output: " << error;
+        obs_output_set_last_error(stream->output, error.c_str());
+        obs_output_signal_stop(stream->output, OBS_OUTPUT_DISCONNECTED);
+    }
+}
+
+void WriteLoop(StreamOutput* stream) {
+    SetTraceThreadName("stream writer");
+    std::string error;
+    if (!stream->writer.writeHeader(error)) {
+        Fail(stream, error);
+        return;
+    }
+
+    AVPacket* packet = av_packet_alloc();
+    QueuedPacket queued;
+    while (stream->queue->pop(queued)) {
+        TraceSpan span(kTraceFrames, "stream_write");
+        queued.fill(stream->writer.format(), packet);
+        if (!stream->writer.write(packet, queued.capture_ns)) {
+            packet->data = nullptr;
+            Fail(stream, stream->writer.error());
+            break;
+        }
+    }
+    // The data belonged to `queued`
+    packet->data = nullptr;
+    packet->size = 0;
+    av_packet_free(&packet);
+}
+
+// Joins a writer thread that ended on its own or was stopped
+void JoinWriter(StreamOutput* stream) {
+    if (stream->thread.joinable()) {
+        stream->thread.join();
+    }
+    stream->writer.close();
+}
+
+const char* GetName(void*) {
+    return "Live Stream (fMP4 / MPEG-TS)";
+}
+
+void* Create(obs_data_t*, obs_output_t* output) {
+    StreamOutput* stream = new StreamOutput();
+    stream->output = output;
+    std::lock_guard<std::mutex> lock(g_outputs_mutex);
+    g_outputs[output] = stream;
+    return stream;
+}
+
+void Destroy(void* data) {
+    StreamOutput* stream = static_cast<StreamOutput*>(data);
+    if (stream->queue) {
+        stream->queue->close();
+    }
+    JoinWriter(stream);
+    {
+        std::lock_guard<std::mutex> lock(g_outputs_mutex);
+        g_outputs.erase(stream->output);
+    }
+    delete stream;
+}
+
+void GetDefaults(obs_data_t* settings) {
+    obs_data_set_default_int(settings, "format", StreamSettings::FMP4);
+    obs_data_set_default_int(settings, "fragment_ms", 500);
+    obs_data_set_default_int(settings, "queue_packets", 1024);
+    obs_data_set_default_int(settings, "queue_mb", 64);
+}
+
+bool Start(void* data) {
+    StreamOutput* stream = static_cast<StreamOutput*>(data);
+    obs_output_t* output = stream->output;
+    JoinWriter(stream);
+
+    if (!obs_output_can_begin_data_capture(output, 0) || !obs_output_initialize_encoders(output, 0)) {
+        return false;
+    }
+
+    obs_data_t* settings = obs_output_get_settings(output);
+    std::string target = obs_data_get_string(settings, "target");
+    StreamSettings stream_settings;
+    stream_settings.format = obs_data_get_int(settings, "format") == StreamSettings::MPEGTS
+        ? StreamSettings::MPEGTS : StreamSettings::FMP4;
+    stream_settings.fragment_ms = std::max<int>(1, static_cast<int>(obs_data_get_int(settings, "fragment_ms")));
+    size_t queue_packets = static_cast<size_t>(std::max<long long>(1, obs_data_get_int(settings, "queue_packets")));
+    size_t queue_bytes = static_cast<size_t>(std::max<long long>(1, obs_data_get_int(settings, "queue_mb"))) * 1024 * 1024;
+    obs_data_release(settings);
+
+    // The sink is connected here so a missing reader fails the start
+    std::string error;
+    if (!stream->writer.open(target, stream_settings, os_gettime_ns, error)) {
+        LogError() << "Stream output: " << error;
+        obs_output_set_last_error(output, error.c_str());
+        return false;
+    }
+    obs_encoder_t* video = obs_output_get_video_encoder(output);
+    obs_encoder_t* audio = obs_output_get_audio_encoder(output, 0);
+    EncoderStream video_stream;
+    EncoderStream audio_stream;
+    stream->video_stream = video && video_stream.describe(video) ? video_stream.addTo(stream->writer.format()) : -1;
+    stream->audio_stream = audio && audio_stream.describe(audio) ? audio_stream.addTo(stream->writer.format()) : -1;
+    if ((video && stream->video_stream < 0) || (audio && stream->audio_stream < 0)) {
+        stream->writer.close();
+        obs_output_set_last_error(output, "unsupported codec for a live stream");
+        return false;
+    }
+
+    stream->queue = std::make_unique<PacketQueue<QueuedPacket>>(queue_packets, queue_bytes);
+    stream->dropped = 0;
+    stream->active = true;
+    // The header is written by the writer thread too, so a slow reader
+    // never holds up the start
+    stream->thread = std::thread([stream] { WriteLoop(stream); });
+    obs_output_begin_data_capture(output, 0);
+    LogInfo() << "Stream output started: " << target << " ("
+              << (stream_settings.format == StreamSettings::MPEGTS ? "MPEG-TS" : "fMP4") << ", "
+              << stream_settings.fragment_ms << " ms fragments)";
+    return true;
+}
+
+void Stop(void* data, uint64_t) {
+    StreamOutput* stream = static_cast<StreamOutput*>(data);
+    bool was_active = stream->active.exchange(false);
+    if (stream->queue) {
+        // What is queued gets a second to reach the reader
+        stream->writer.drainUntil(std::chrono::steady_clock::now() + std::chrono::seconds(1));
+        stream->queue->close();
+    }
+    JoinWriter(stream);
+    if (was_active) {
+        obs_output_end_data_capture(stream->output);
+    }
+}
+
+void EncodedPacket(void* data, struct encoder_packet* packet) {
+    StreamOutput* stream = static_cast<StreamOutput*>(data);
+    if (!packet) {
+        // The encoder failed
+        if (stream->active.exchange(false)) {
+            stream->queue->close();
+            obs_output_signal_stop(stream->output, OBS_OUTPUT_ENCODE_ERROR);
+        }
+        return;
+    }
+    if (!stream->active) {
+        return;
+    }
+
+    bool video = packet->type == OBS_ENCODER_VIDEO;
+    int index = video ? stream->video_stream : stream->audio_stream;
+    if (index < 0) {
+        return;
+    }
+    QueuedPacket queued;
+    queued.assign(packet, index);
+    bool keyframe = queued.keyframe;
+    if (!stream->queue->push(std::move(queued), packet->size, keyframe, index)) {
+        stream->dropped++;
+    }
+}
+
+uint64_t GetTotalBytes(void* data) {
+    return static_cast<StreamOutput*>(data)->writer.bytesWritten();
+}
+
+int GetDroppedFrames(void* data) {
+    return static_cast<StreamOutput*>(data)->dropped;
+}
+
+} // namespace
+
+void RegisterStreamOutput() {
+    struct obs_output_info info = {};
+    info.id = kStreamOutputId;
+    info.flags = OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED;
+    info.encoded_video_codecs = "h264;hevc;av1";
+    info.encoded_audio_codecs = "aac;opus";
+    info.get_name = GetName;
+    info.create = Create;
+    info.destroy = Destroy;
+    info.start = Start;
+    info.stop = Stop;
+    info.encoded_packet = EncodedPacket;
+    info.get_defaults = GetDefaults;
+    info.get_total_bytes = GetTotalBytes;
+    info.get_dropped_frames = GetDroppedFrames;
+    obs_register_output(&info);
+}
+
+LatencyHistogram::Summary GetStreamOutputLatency(void* output) {
+    std::lock_guard<std::mutex> lock(g_outputs_mutex);
+    auto it = g_outputs.find(static_cast<obs_output_t*>(output));
+    return it != g_outputs.end() ? it->second->writer.latency().summarize() : LatencyHistogram::Summary();
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "latency_histogram.h"
+
+// Live stream output, registered with libobs as "addon_stream_output".
+//
+// Writes the packets of its encoders as fragmented MP4 or MPEG-TS to a
+// stream target (see stream_sink.h) through StreamWriter. encoded_packet
+// only copies each packet into a bounded PacketQueue and a writer thread
+// muxes and writes, so a reader that falls behind costs dropped packets
+// (the output's dropped frames), up to the next keyframe, and never
+// stalls the encoders. A reader that goes away stops the output with
+// OBS_OUTPUT_DISCONNECTED. Settings:
+//
+//   target          "unix:/path", "fd:N" or a FIFO path
+//   format          0 fMP4, 1 MPEG-TS (StreamSettings::Format)
+//   fragment_ms     StreamSettings::fragment_ms
+//   queue_packets   writer queue limits
+//   queue_mb
+//
+// Only built with libav (HAVE_STREAM_OUTPUT).
+extern const char* const kStreamOutputId;
+
+// Call once after obs_startup
+void RegisterStreamOutput();
+
+// Frame capture (the frame's libobs timestamp) to the bytes reaching the
+// reader, for an obs_output_t* of this type; empty for other outputs
+LatencyHistogram::Summary GetStreamOutputLatency(void* output);
@@ -0,0 +1,191 @@
+#include "stream_sink.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Longest single wait for the reader before checking cancel/deadline
+constexpr int kPollMs = 50;
+
+int64_t SteadyNs(std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+StreamTarget ParseStreamTarget(const std::string& target) {
+    StreamTarget parsed;
+    if (target.compare(0, 5, "unix:") == 0) {
+        parsed.kind = StreamTarget::UNIX_SOCKET;
+        parsed.path = target.substr(5);
+        // unix:///path as well as unix:/path
+        if (parsed.path.compare(0, 2, "//") == 0) {
+            parsed.path.erase(0, 2);
+        }
+        return parsed;
+    }
+    if (target.compare(0, 3, "fd:") == 0) {
+        char* end = nullptr;
+        long fd = std::strtol(target.c_str() + 3, &end, 10);
+        if (end != target.c_str() + 3 && *end == '\0' && fd >= 0) {
+            parsed.kind = StreamTarget::FD;
+            parsed.fd = static_cast<int>(fd);
+        }
+        return parsed;
+    }
+#ifndef _WIN32
+    struct stat info;
+    if (stat(target.c_str(), &info) == 0 && S_ISFIFO(info.st_mode)) {
+        parsed.kind = StreamTarget::FIFO;
+        parsed.path = target;
+    }
+#endif
+    return parsed;
+}
+
+StreamSink::~StreamSink() {
+    close();
+}
+
+void StreamSink::setDeadline(std::chrono::steady_clock::time_point deadline) {
+    deadline_ns_ = SteadyNs(deadline);
+}
+
+#ifndef _WIN32
+
+bool StreamSink::open(const StreamTarget& target, std::string& error) {
+    close();
+    cancelled_ = false;
+    deadline_ns_ = 0;
+    bytes_ = 0;
+    error_.clear();
+
+    int fd = -1;
+    switch (target.kind) {
+    case StreamTarget::UNIX_SOCKET: {
+        struct sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (target.path.empty() || target.path.size() >= sizeof(address.sun_path)) {
+            error = "invalid socket path: " + target.path;
+            return false;
+        }
+        std::memcpy(address.sun_path, target.path.c_str(), target.path.size() + 1);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+            error = "cannot connect to " + target.path + ": " + std::strerror(errno);
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            return false;
+        }
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        socket_ = true;
+        break;
+    }
+    case StreamTarget::FD:
+        fd = fcntl(target.fd, F_DUPFD_CLOEXEC, 0);
+        if (fd < 0) {
+            error = "fd " + std::to_string(target.fd) + " is not open: " + std::strerror(errno);
+            return false;
+        }
+        break;
+    case StreamTarget::FIFO:
+        // Fails with ENXIO instead of waiting when nobody reads the FIFO
+        fd = ::open(target.path.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            error = errno == ENXIO ? "no reader has " + target.path + " open"
+                                   : "cannot open " + target.path + ": " + std::strerror(errno);
+            return false;
+        }
+        break;
+    case StreamTarget::NONE:
+    default:
+        error = "not a stream target";
+        return false;
+    }
+
+    int flags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    fd_ = fd;
+    return true;
+}
+
+void StreamSink::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    socket_ = false;
+}
+
+bool StreamSink::write(const uint8_t* data, size_t size) {
+    if (fd_ < 0) {
+        return false;
+    }
+    while (size > 0) {
+        ssize_t written;
+#ifdef MSG_NOSIGNAL
+        written = socket_ ? send(fd_, data, size, MSG_NOSIGNAL) : ::write(fd_, data, size);
+#else
+        written = ::write(fd_, data, size);
+#endif
+        if (written > 0) {
+            data += written;
+            size -= static_cast<size_t>(written);
+            bytes_.fetch_add(static_cast<uint64_t>(written), std::memory_order_relaxed);
+            continue;
+        }
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            error_ = errno == EPIPE || errno == ECONNRESET ? "the reader went away" : std::strerror(errno);
+            return false;
+        }
+
+        // The reader is behind: wait for room without ever blocking for long
+        if (cancelled_) {
+            error_ = "cancelled";
+            return false;
+        }
+        int64_t deadline = deadline_ns_.load(std::memory_order_relaxed);
+        if (deadline && SteadyNs(std::chrono::steady_clock::now()) > deadline) {
+            error_ = "the reader did not keep up before the deadline";
+            return false;
+        }
+        struct pollfd ready = {fd_, POLLOUT, 0};
+        if (poll(&ready, 1, kPollMs) > 0 && (ready.revents & (POLLERR | POLLHUP))) {
+            error_ = "the reader went away";
+            return false;
+        }
+    }
+    return true;
+}
+
+#else
+
+bool StreamSink::open(const StreamTarget&, std::string& error) {
+    error = "live streams are not supported on Windows";
+    return false;
+}
+
+void StreamSink::close() {}
+
+bool StreamSink::write(const uint8_t*, size_t) {
+    return false;
+}
+
+#endif
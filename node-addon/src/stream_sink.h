@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Destination of a live stream: a Unix domain socket that another process
+// listens on ("unix:/run/app/live.sock"), a file descriptor inherited from
+// the parent ("fd:3"), or an existing FIFO.
+struct StreamTarget {
+    enum Kind {
+        NONE = 0,    // an ordinary file path
+        UNIX_SOCKET = 1,
+        FD = 2,
+        FIFO = 3
+    } kind = NONE;
+    std::string path;
+    int fd = -1;
+};
+
+// FIFOs are recognised with stat(), so they must exist already
+StreamTarget ParseStreamTarget(const std::string& target);
+
+inline bool IsStreamTarget(const std::string& target) {
+    return ParseStreamTarget(target).kind != StreamTarget::NONE;
+}
+
+// Non-blocking writer to a StreamTarget, used from one thread. The
+// descriptor is switched to O_NONBLOCK and write() waits for the reader in
+// short polls, so it can be abandoned: it fails once the reader goes away,
+// after cancel(), or past a deadline set for draining on stop. A slow
+// reader therefore holds back only the thread that writes, never a stop.
+//
+// "fd:N" writes to a duplicate of N; the stream ends for the reader when
+// the process closes N as well. O_NONBLOCK is shared with N. Writes to a
+// pipe whose reader is gone raise SIGPIPE, which Node ignores; other hosts
+// must ignore it too. Not available on Windows.
+class StreamSink {
+public:
+    StreamSink() = default;
+    ~StreamSink();
+
+    StreamSink(const StreamSink&) = delete;
+    StreamSink& operator=(const StreamSink&) = delete;
+
+    bool open(const StreamTarget& target, std::string& error);
+    void close();
+    bool isOpen() const { return fd_ >= 0; }
+
+    // Writes all of `data`. False when the reader is gone, on cancel() or
+    // past the deadline; the sink is unusable afterwards.
+    bool write(const uint8_t* data, size_t size);
+
+    // Any thread
+    void cancel() { cancelled_ = true; }
+    void setDeadline(std::chrono::steady_clock::time_point deadline);
+
+    // Why the last write failed, empty when it did not
+    const std::string& error() const { return error_; }
+    uint64_t bytesWritten() const { return bytes_.load(std::memory_order_relaxed); }
+
+private:
+    int fd_ = -1;
+    bool socket_ = false;
+    std::string error_;
+    std::atomic<bool> cancelled_{false};
+    std::atomic<int64_t> deadline_ns_{0}; // steady_clock; 0 for none
+    std::atomic<uint64_t> bytes_{0};
+};
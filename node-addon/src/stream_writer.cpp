@@ -0,0 +1,178 @@
+#include "stream_writer.h"
+#include <cerrno>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/dict.h>
+#include <libavutil/mem.h>
+}
+
+namespace {
+
+// movenc hands over whole fragments; MPEG-TS is flushed every fragment_ms
+// and only reaches the sink earlier when this fills up
+constexpr int kIoBufferSize = 256 * 1024;
+
+std::string AvError(int error) {
+    char text[AV_ERROR_MAX_STRING_SIZE] = {};
+    av_strerror(error, text, sizeof(text));
+    return text;
+}
+
+} // namespace
+
+uint64_t SteadyClockNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+StreamWriter::~StreamWriter() {
+    close();
+}
+
+bool StreamWriter::open(const std::string& target, const StreamSettings& settings, Clock clock,
+                        std::string& error) {
+    close();
+    if (!sink_.open(ParseStreamTarget(target), error)) {
+        return false;
+    }
+    settings_ = settings;
+    clock_ = clock ? clock : SteadyClockNs;
+    failed_ = false;
+    flushed_ = false;
+    last_flush_us_ = -1;
+    pending_.clear();
+    latency_.reset();
+
+    const char* muxer = settings.format == StreamSettings::MPEGTS ? "mpegts" : "mp4";
+    int ret = avformat_alloc_output_context2(&format_, nullptr, muxer, nullptr);
+    if (ret < 0 || !format_) {
+        error = std::string("cannot create the ") + muxer + " muxer: " + AvError(ret);
+        close();
+        return false;
+    }
+
+    uint8_t* buffer = static_cast<uint8_t*>(av_malloc(kIoBufferSize));
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+    auto write = WritePacket;
+#else
+    auto write = [](void* opaque, uint8_t* data, int size) { return WritePacket(opaque, data, size); };
+#endif
+    io_ = buffer ? avio_alloc_context(buffer, kIoBufferSize, 1, this, nullptr, write, nullptr) : nullptr;
+    if (!io_) {
+        av_free(buffer);
+        error = "out of memory";
+        close();
+        return false;
+    }
+    format_->pb = io_;
+    format_->flags |= AVFMT_FLAG_CUSTOM_IO;
+    if (settings.format == StreamSettings::MPEGTS) {
+        // Flushed per fragment in write() instead of after every packet
+        format_->flush_packets = 0;
+    }
+    return true;
+}
+
+bool StreamWriter::wantsGlobalHeader() const {
+    return format_ && (format_->oformat->flags & AVFMT_GLOBALHEADER);
+}
+
+bool StreamWriter::writeHeader(std::string& error) {
+    AVDictionary* options = nullptr;
+    if (settings_.format == StreamSettings::FMP4) {
+        // Nothing is written back into the header later, so a reader can
+        // decode from the first fragment it gets
+        av_dict_set(&options, "movflags", "empty_moov+default_base_moof+frag_keyframe", 0);
+        av_dict_set_int(&options, "frag_duration", static_cast<int64_t>(settings_.fragment_ms) * 1000, 0);
+    }
+    int ret = avformat_write_header(format_, &options);
+    av_dict_free(&options);
+    if (ret >= 0) {
+        avio_flush(format_->pb);
+    }
+    if (ret < 0 || failed_) {
+        error = failed_ ? sink_.error() : "cannot write the stream header: " + AvError(ret);
+        failed_ = true;
+        return false;
+    }
+    header_written_ = true;
+    return true;
+}
+
+bool StreamWriter::write(AVPacket* packet, uint64_t capture_ns) {
+    if (failed_ || !header_written_) {
+        return false;
+    }
+
+    int64_t time_us = packet->dts == AV_NOPTS_VALUE
+        ? last_flush_us_
+        : av_rescale_q(packet->dts, format_->streams[packet->stream_index]->time_base, AV_TIME_BASE_Q);
+    flushed_ = false;
+    int ret = av_write_frame(format_, packet);
+    if (ret < 0 || failed_) {
+        failed_ = true;
+        return false;
+    }
+    // What the muxer wrote during the call were the packets before this
+    // one: a finished fMP4 fragment, or a full buffer of MPEG-TS
+    if (flushed_) {
+        recordPending();
+    }
+    if (capture_ns) {
+        pending_.push_back(capture_ns);
+    }
+
+    if (settings_.format == StreamSettings::MPEGTS) {
+        if (last_flush_us_ < 0) {
+            last_flush_us_ = time_us;
+        }
+        if (time_us - last_flush_us_ >= static_cast<int64_t>(settings_.fragment_ms) * 1000) {
+            avio_flush(format_->pb);
+            last_flush_us_ = time_us;
+            if (failed_) {
+                return false;
+            }
+            recordPending();
+        }
+    }
+    return true;
+}
+
+void StreamWriter::close() {
+    if (format_) {
+        if (header_written_ && !failed_) {
+            av_write_trailer(format_);
+            if (!failed_) {
+                recordPending();
+            }
+        }
+        avformat_free_context(format_);
+        format_ = nullptr;
+    }
+    header_written_ = false;
+    if (io_) {
+        av_freep(&io_->buffer);
+        avio_context_free(&io_);
+    }
+    pending_.clear();
+    sink_.close();
+}
+
+int StreamWriter::WritePacket(void* opaque, const uint8_t* data, int size) {
+    StreamWriter* writer = static_cast<StreamWriter*>(opaque);
+    if (writer->failed_ || !writer->sink_.write(data, static_cast<size_t>(size))) {
+        writer->failed_ = true;
+        return AVERROR(EPIPE);
+    }
+    writer->flushed_ = true;
+    return size;
+}
+
+void StreamWriter::recordPending() {
+    uint64_t now = clock_();
+    for (uint64_t capture_ns : pending_) {
+        latency_.record(now > capture_ns ? now - capture_ns : 0);
+    }
+    pending_.clear();
+}
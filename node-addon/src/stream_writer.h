@@ -0,0 +1,79 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include "latency_histogram.h"
+#include "obs_wrapper.h"
+#include "stream_sink.h"
+
+struct AVFormatContext;
+struct AVIOContext;
+struct AVPacket;
+
+// Muxes encoded packets into fragmented MP4 or MPEG-TS with libavformat
+// and writes the result to a StreamSink, from the caller's thread. Callers
+// run it on a writer thread fed through a PacketQueue, so a slow reader
+// costs dropped packets upstream rather than a stalled encoder.
+//
+// fMP4 starts with ftyp+moov and then emits a moof+mdat fragment at every
+// keyframe and at least every fragment_ms. MPEG-TS is flushed to the sink
+// every fragment_ms of media.
+//
+// Latency: each packet carries the time its frame was captured, on the
+// clock passed to open(); it is recorded once the bytes of the packet have
+// been handed to the sink (for fMP4, when its fragment is written).
+class StreamWriter {
+public:
+    using Clock = uint64_t (*)();
+
+    StreamWriter() = default;
+    ~StreamWriter();
+
+    StreamWriter(const StreamWriter&) = delete;
+    StreamWriter& operator=(const StreamWriter&) = delete;
+
+    // Connects the sink and creates the muxer. Streams are then added to
+    // format() before writeHeader().
+    bool open(const std::string& target, const StreamSettings& settings, Clock clock, std::string& error);
+    AVFormatContext* format() const { return format_; }
+    // True when encoders should put codec headers in extradata
+    bool wantsGlobalHeader() const;
+    bool writeHeader(std::string& error);
+
+    // `packet` is in its stream's time base; it is not taken over. A zero
+    // capture_ns records no latency sample. False once the sink failed.
+    bool write(AVPacket* packet, uint64_t capture_ns);
+
+    // Gives writes until `deadline` to drain, then lets them fail (any thread)
+    void drainUntil(std::chrono::steady_clock::time_point deadline) { sink_.setDeadline(deadline); }
+    // Makes pending and future writes fail at once (any thread)
+    void cancel() { sink_.cancel(); }
+
+    // Writes the trailer when the sink is still healthy, then frees everything
+    void close();
+
+    std::string error() const { return sink_.error(); }
+    uint64_t bytesWritten() const { return sink_.bytesWritten(); }
+    const LatencyHistogram& latency() const { return latency_; }
+
+private:
+    // AVIOContext write callback
+    static int WritePacket(void* opaque, const uint8_t* data, int size);
+    void recordPending();
+
+    StreamSettings settings_;
+    Clock clock_ = nullptr;
+    StreamSink sink_;
+    AVFormatContext* format_ = nullptr;
+    AVIOContext* io_ = nullptr;
+    bool header_written_ = false;
+    bool failed_ = false;
+    bool flushed_ = false;         // the muxer wrote to the sink during a write()
+    int64_t last_flush_us_ = -1;   // MPEG-TS: media time of the last flush
+    std::deque<uint64_t> pending_; // capture times of packets not yet in the sink
+    LatencyHistogram latency_;
+};
+
+// Steady clock in nanoseconds, for writers fed by steady_clock timestamps
+uint64_t SteadyClockNs();
@@ -0,0 +1,209 @@
+#include "trace.h"
+#include "memory_stats.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+namespace trace_detail {
+std::atomic<uint32_t> g_categories{0};
+}
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    uint32_t category;
+    uint64_t start_ns;
+    uint64_t end_ns;
+};
+
+// Written only by its thread. `count` publishes events to the exporter;
+// `session` ties the contents to one StartTrace call.
+struct ThreadBuffer {
+    int tid = 0;
+    std::string name; // guarded by g_registry_mutex
+    std::vector<TraceEvent> events;
+    std::atomic<size_t> count{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> session{0};
+    MemoryCharge charge{MemoryStage::Trace};
+};
+
+// Buffers outlive their threads so spans from finished threads still export
+std::mutex g_registry_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;
+std::atomic<uint64_t> g_session{0};
+std::atomic<size_t> g_events_per_thread{0};
+uint64_t g_session_start_ns = 0;  // guarded by g_registry_mutex
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+std::string CurrentThreadName(int tid) {
+#if defined(__linux__) || defined(__APPLE__)
+    char name[64] = {};
+    if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0 && name[0]) {
+        return name;
+    }
+#endif
+    return "thread " + std::to_string(tid);
+}
+
+ThreadBuffer* GetThreadBuffer() {
+    if (!t_buffer) {
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->tid = static_cast<int>(g_buffers.size()) + 1;
+        buffer->name = CurrentThreadName(buffer->tid);
+        t_buffer = buffer.get();
+        g_buffers.push_back(std::move(buffer));
+    }
+    return t_buffer;
+}
+
+void WriteEscaped(FILE* file, const std::string& text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', file);
+            std::fputc(c, file);
+        } else if (static_cast<unsigned char>(c) >= 0x20) {
+            std::fputc(c, file);
+        }
+    }
+}
+
+const char* CategoryName(uint32_t category) {
+    return category == kTraceFrames ? "frames" : "pipeline";
+}
+
+} // namespace
+
+namespace trace_detail {
+
+uint64_t NowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Record(const char* name, uint32_t category, uint64_t start_ns, uint64_t end_ns) {
+    ThreadBuffer* buffer = GetThreadBuffer();
+
+    // First span of this thread in a new trace: start its buffer over. The
+    // exporter skips buffers of other sessions, so nothing reads it now.
+    uint64_t session = g_session.load(std::memory_order_acquire);
+    if (buffer->session.load(std::memory_order_relaxed) != session) {
+        buffer->events.resize(g_events_per_thread.load(std::memory_order_relaxed));
+        buffer->charge.set(buffer->events.capacity() * sizeof(TraceEvent));
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        buffer->session.store(session, std::memory_order_release);
+    }
+
+    size_t count = buffer->count.load(std::memory_order_relaxed);
+    if (count == buffer->events.size()) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[count] = TraceEvent{name, category, start_ns, end_ns};
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+} // namespace trace_detail
+
+void StartTrace(uint32_t categories, size_t events_per_thread) {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    g_events_per_thread.store(events_per_thread > 0 ? events_per_thread : 1, std::memory_order_relaxed);
+    g_session_start_ns = trace_detail::NowNs();
+    g_session.fetch_add(1, std::memory_order_acq_rel);
+    trace_detail::g_categories.store(categories, std::memory_order_relaxed);
+}
+
+void StopTrace() {
+    trace_detail::g_categories.store(0, std::memory_order_relaxed);
+}
+
+TraceStats GetTraceStats() {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    TraceStats stats;
+    stats.active = trace_detail::g_categories.load(std::memory_order_relaxed) != 0;
+    uint64_t session = g_session.load(std::memory_order_acquire);
+    for (const auto& buffer : g_buffers) {
+        if (buffer->session.load(std::memory_order_acquire) != session) {
+            continue;
+        }
+        stats.events += buffer->count.load(std::memory_order_acquire);
+        stats.dropped += buffer->dropped.load(std::memory_order_relaxed);
+        stats.threads++;
+    }
+    return stats;
+}
+
+bool WriteTrace(const std::string& path, TraceStats* stats) {
+    // Held throughout so no new trace can start (and reset buffers) meanwhile
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+
+    TraceStats totals;
+    totals.active = trace_detail::g_categories.load(std::memory_order_relaxed) != 0;
+    uint64_t session = g_session.load(std::memory_order_acquire);
+    bool first = true;
+    auto separator = [&first, file] {
+        std::fputs(first ? "\n" : ",\n", file);
+        first = false;
+    };
+
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+    separator();
+    std::fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+               "\"args\":{\"name\":\"obs-screen-capture\"}}", file);
+
+    for (const auto& buffer : g_buffers) {
+        if (buffer->session.load(std::memory_order_acquire) != session) {
+            continue;
+        }
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        totals.events += count;
+        totals.dropped += buffer->dropped.load(std::memory_order_relaxed);
+        totals.threads++;
+
+        separator();
+        std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"",
+                     buffer->tid);
+        WriteEscaped(file, buffer->name);
+        std::fputs("\"}}", file);
+
+        for (size_t i = 0; i < count; ++i) {
+            const TraceEvent& event = buffer->events[i];
+            // Spans may have started just before the trace did
+            uint64_t start = event.start_ns > g_session_start_ns ? event.start_ns - g_session_start_ns : 0;
+            uint64_t duration = event.end_ns > event.start_ns ? event.end_ns - event.start_ns : 0;
+            separator();
+            std::fputs("{\"name\":\"", file);
+            WriteEscaped(file, event.name);
+            std::fprintf(file, "\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                         CategoryName(event.category), buffer->tid, start / 1000.0, duration / 1000.0);
+        }
+    }
+
+    std::fputs("\n]}\n", file);
+    bool ok = std::fclose(file) == 0;
+    if (stats) {
+        *stats = totals;
+    }
+    return ok;
+}
+
+void SetTraceThreadName(const char* name) {
+    ThreadBuffer* buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    buffer->name = name;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Timeline tracing for the capture pipeline, exported as Chrome trace JSON
+// (chrome://tracing, ui.perfetto.dev). Spans are recorded into a buffer
+// owned by the recording thread: no locks or allocation after the thread's
+// first span of a trace, and a single relaxed load when tracing is off. A
+// full buffer drops new spans and counts them.
+//
+// Span names must be string literals (or otherwise outlive the trace).
+
+enum TraceCategory : uint32_t {
+    kTracePipeline = 1, // init phases, source/encoder creation, output start/stop
+    kTraceFrames = 2    // per-frame capture, convert, encode and mux
+};
+
+namespace trace_detail {
+extern std::atomic<uint32_t> g_categories;
+uint64_t NowNs();
+void Record(const char* name, uint32_t category, uint64_t start_ns, uint64_t end_ns);
+} // namespace trace_detail
+
+inline bool TraceEnabled(uint32_t category) {
+    return (trace_detail::g_categories.load(std::memory_order_relaxed) & category) != 0;
+}
+
+// Records the enclosing scope as one span
+class TraceSpan {
+public:
+    TraceSpan(uint32_t category, const char* name)
+        : name_(TraceEnabled(category) ? name : nullptr), category_(category) {
+        if (name_) {
+            start_ns_ = trace_detail::NowNs();
+        }
+    }
+
+    ~TraceSpan() { end(); }
+
+    // Ends the span before the scope does
+    void end() {
+        if (name_) {
+            trace_detail::Record(name_, category_, start_ns_, trace_detail::NowNs());
+            name_ = nullptr;
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    uint32_t category_;
+    uint64_t start_ns_ = 0;
+};
+
+struct TraceStats {
+    bool active = false;
+    uint64_t events = 0;
+    uint64_t dropped = 0; // spans lost to full buffers
+    int threads = 0;      // threads that recorded a span
+};
+
+// Starts a new trace, discarding the previous one. `categories` is a mask of
+// TraceCategory values; each thread keeps up to `events_per_thread` spans.
+void StartTrace(uint32_t categories, size_t events_per_thread);
+// Stops recording; the spans stay available to WriteTrace
+void StopTrace();
+TraceStats GetTraceStats();
+// Writes the current trace as Chrome trace JSON. Safe while recording.
+bool WriteTrace(const std::string& path, TraceStats* stats = nullptr);
+
+// Names the calling thread in exported traces (otherwise the OS thread name)
+void SetTraceThreadName(const char* name);
@@ -0,0 +1,323 @@
+#include "vfr_encoder.h"
+#include "log_sink.h"
+#include "trace.h"
+#include "vfr_gate.h"
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <obs/obs.h>
+#include <x264.h>
+
+#ifdef HAVE_XDAMAGE
+#include "damage_tracker.h"
+#endif
+
+const char* const kVfrEncoderId = "vfr_x264";
+
+namespace {
+
+struct VfrEncoder {
+    obs_encoder_t* encoder = nullptr;
+    x264_t* context = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int64_t keyint = 0;          // frames at the canvas rate
+    int64_t last_keyframe_pts = 0; // input pts of the last forced keyframe
+    std::vector<uint8_t> packet;
+    std::vector<uint8_t> extra_data;
+    std::vector<uint8_t> sei;
+
+    std::unique_ptr<VfrGate> gate;
+    std::vector<uint8_t> previous; // last encoded frame, NV12 packed
+#ifdef HAVE_XDAMAGE
+    std::unique_ptr<DamageTracker> damage;
+#endif
+};
+
+const char* GetName(void*) {
+    return "x264 (variable frame rate)";
+}
+
+void GetDefaults(obs_data_t* settings) {
+    obs_data_set_default_string(settings, "rate_control", "CBR");
+    obs_data_set_default_int(settings, "bitrate", 2500);
+    obs_data_set_default_int(settings, "crf", 23);
+    obs_data_set_default_int(settings, "keyint_sec", 2);
+    obs_data_set_default_string(settings, "preset", "veryfast");
+    obs_data_set_default_int(settings, "min_fps", 1);
+    obs_data_set_default_int(settings, "damage_window", -1);
+}
+
+// Applies "key=value" pairs separated by ':' or spaces, as obs_x264 does
+void ApplyOptions(x264_param_t& params, const char* options) {
+    std::string text = options ? options : "";
+    for (char& c : text) {
+        if (c == ':') {
+            c = ' ';
+        }
+    }
+    std::istringstream stream(text);
+    std::string option;
+    while (stream >> option) {
+        size_t eq = option.find('=');
+        std::string name = option.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : option.substr(eq + 1);
+        if (x264_param_parse(&params, name.c_str(), eq == std::string::npos ? nullptr : value.c_str()) != 0) {
+            LogWarning() << "vfr_x264: ignoring option " << option;
+        }
+    }
+}
+
+bool OpenEncoder(VfrEncoder* vfr, obs_data_t* settings) {
+    video_t* video = obs_encoder_video(vfr->encoder);
+    const struct video_output_info* voi = video_output_get_info(video);
+    vfr->width = obs_encoder_get_width(vfr->encoder);
+    vfr->height = obs_encoder_get_height(vfr->encoder);
+
+    const char* preset = obs_data_get_string(settings, "preset");
+    const char* tune = obs_data_get_string(settings, "tune");
+    x264_param_t params;
+    if (x264_param_default_preset(&params, preset, tune && *tune ? tune : nullptr) != 0) {
+        LogError() << "vfr_x264: bad preset/tune " << preset << "/" << tune;
+        return false;
+    }
+
+    params.i_width = static_cast<int>(vfr->width);
+    params.i_height = static_cast<int>(vfr->height);
+    params.i_csp = X264_CSP_NV12;
+    params.i_fps_num = voi->fps_num;
+    params.i_fps_den = voi->fps_den;
+    // libobs frame pts count frames, so the timebase is one frame. With VFR
+    // input x264 budgets bits by timestamp, not by frame count.
+    params.i_timebase_num = voi->fps_den;
+    params.i_timebase_den = voi->fps_num;
+    params.b_vfr_input = 1;
+    // x264 counts the keyframe interval in input frames, which VFR makes
+    // irregular; Encode() forces keyframes by timestamp instead
+    vfr->keyint = obs_data_get_int(settings, "keyint_sec") * voi->fps_num / voi->fps_den;
+    params.i_keyint_max = vfr->keyint > 0 ? static_cast<int>(vfr->keyint) : 250;
+    params.b_repeat_headers = 0;
+    params.b_annexb = 1;
+    params.i_threads = X264_THREADS_AUTO;
+
+    switch (voi->colorspace) {
+    case VIDEO_CS_601:
+        params.vui.i_colorprim = 6;
+        params.vui.i_transfer = 6;
+        params.vui.i_colmatrix = 6;
+        break;
+    case VIDEO_CS_SRGB:
+        params.vui.i_colorprim = 1;
+        params.vui.i_transfer = 13;
+        params.vui.i_colmatrix = 1;
+        break;
+    default:
+        params.vui.i_colorprim = 1;
+        params.vui.i_transfer = 1;
+        params.vui.i_colmatrix = 1;
+        break;
+    }
+    params.vui.b_fullrange = voi->range == VIDEO_RANGE_FULL;
+
+    // CBR would pad the skipped time with filler and undo the savings, so
+    // bitrate modes become ABR capped at the bitrate
+    int bitrate = static_cast<int>(obs_data_get_int(settings, "bitrate"));
+    if (strcmp(obs_data_get_string(settings, "rate_control"), "CRF") == 0) {
+        params.rc.i_rc_method = X264_RC_CRF;
+        params.rc.f_rf_constant = static_cast<float>(obs_data_get_int(settings, "crf"));
+    } else {
+        params.rc.i_rc_method = X264_RC_ABR;
+        params.rc.i_bitrate = bitrate;
+        params.rc.i_vbv_max_bitrate = bitrate;
+        params.rc.i_vbv_buffer_size = bitrate;
+    }
+
+    ApplyOptions(params, obs_data_get_string(settings, "x264opts"));
+    x264_param_apply_profile(&params, "high");
+
+    vfr->context = x264_encoder_open(&params);
+    if (!vfr->context) {
+        LogError() << "vfr_x264: failed to open encoder";
+        return false;
+    }
+
+    x264_nal_t* nals = nullptr;
+    int count = 0;
+    if (x264_encoder_headers(vfr->context, &nals, &count) < 0) {
+        return false;
+    }
+    for (int i = 0; i < count; ++i) {
+        std::vector<uint8_t>& target = nals[i].i_type == NAL_SEI ? vfr->sei : vfr->extra_data;
+        target.insert(target.end(), nals[i].p_payload, nals[i].p_payload + nals[i].i_payload);
+    }
+
+    int64_t min_fps = obs_data_get_int(settings, "min_fps");
+    int64_t max_gap = min_fps > 0 ? voi->fps_num / (voi->fps_den * min_fps) : 1;
+    vfr->gate = std::make_unique<VfrGate>(max_gap);
+    return true;
+}
+
+void Destroy(void* data) {
+    VfrEncoder* vfr = static_cast<VfrEncoder*>(data);
+    if (vfr->gate) {
+        LogInfo() << "vfr_x264: encoded " << vfr->gate->encoded() << " frames, skipped "
+                  << vfr->gate->skipped();
+    }
+#ifdef HAVE_XDAMAGE
+    vfr->damage.reset();
+#endif
+    if (vfr->context) {
+        x264_encoder_close(vfr->context);
+    }
+    delete vfr;
+}
+
+void* Create(obs_data_t* settings, obs_encoder_t* encoder) {
+    VfrEncoder* vfr = new VfrEncoder();
+    vfr->encoder = encoder;
+
+    if (!OpenEncoder(vfr, settings)) {
+        Destroy(vfr);
+        return nullptr;
+    }
+
+#ifdef HAVE_XDAMAGE
+    int64_t window = obs_data_get_int(settings, "damage_window");
+    if (window >= 0) {
+        vfr->damage = std::make_unique<DamageTracker>();
+        if (!vfr->damage->start(static_cast<uint64_t>(window),
+                                static_cast<int>(obs_data_get_int(settings, "damage_x")),
+                                static_cast<int>(obs_data_get_int(settings, "damage_y")),
+                                static_cast<int>(obs_data_get_int(settings, "damage_width")),
+                                static_cast<int>(obs_data_get_int(settings, "damage_height")))) {
+            vfr->damage.reset();
+        }
+    }
+    if (!vfr->damage)
+#endif
+    {
+        // Comparing frames: one packed NV12 copy of the last encoded frame
+        vfr->previous.resize(static_cast<size_t>(vfr->width) * vfr->height * 3 / 2);
+    }
+
+    return vfr;
+}
+
+bool FrameChanged(VfrEncoder* vfr, const struct encoder_frame* frame) {
+#ifdef HAVE_XDAMAGE
+    if (vfr->damage) {
+        return vfr->damage->consume();
+    }
+#endif
+    int width = static_cast<int>(vfr->width);
+    int height = static_cast<int>(vfr->height);
+    uint8_t* luma = vfr->previous.data();
+    uint8_t* chroma = luma + static_cast<size_t>(width) * height;
+    // Evaluate both planes: each refreshes its own copy
+    bool luma_changed = PlaneChanged(frame->data[0], static_cast<int>(frame->linesize[0]), luma, width, height);
+    bool chroma_changed = PlaneChanged(frame->data[1], static_cast<int>(frame->linesize[1]), chroma, width, height / 2);
+    return luma_changed || chroma_changed;
+}
+
+bool Encode(void* data, struct encoder_frame* frame, struct encoder_packet* packet, bool* received_packet) {
+    VfrEncoder* vfr = static_cast<VfrEncoder*>(data);
+    TraceSpan span(kTraceFrames, "vfr_encode");
+    if (!frame || !packet || !received_packet) {
+        return false;
+    }
+    *received_packet = false;
+
+    if (!vfr->gate->shouldEncode(FrameChanged(vfr, frame), frame->pts)) {
+        return true;
+    }
+
+    x264_picture_t picture;
+    x264_picture_init(&picture);
+    picture.i_pts = frame->pts;
+    // Counted from the input: with lookahead and B-frame delay the forced
+    // IDR only comes out of x264 many frames later, and every frame in
+    // between would otherwise be forced as well
+    if (vfr->keyint > 0 && frame->pts - vfr->last_keyframe_pts >= vfr->keyint) {
+        picture.i_type = X264_TYPE_KEYFRAME;
+        vfr->last_keyframe_pts = frame->pts;
+    }
+    picture.img.i_csp = X264_CSP_NV12;
+    picture.img.i_plane = 2;
+    for (int i = 0; i < 2; ++i) {
+        picture.img.plane[i] = frame->data[i];
+        picture.img.i_stride[i] = static_cast<int>(frame->linesize[i]);
+    }
+
+    x264_picture_t encoded;
+    x264_nal_t* nals = nullptr;
+    int count = 0;
+    if (x264_encoder_encode(vfr->context, &nals, &count, &picture, &encoded) < 0) {
+        LogError() << "vfr_x264: encode failed";
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+
+    vfr->packet.clear();
+    int priority = 0;
+    for (int i = 0; i < count; ++i) {
+        vfr->packet.insert(vfr->packet.end(), nals[i].p_payload, nals[i].p_payload + nals[i].i_payload);
+        if (nals[i].i_ref_idc > priority) {
+            priority = nals[i].i_ref_idc;
+        }
+    }
+
+    video_t* video = obs_encoder_video(vfr->encoder);
+    const struct video_output_info* voi = video_output_get_info(video);
+    packet->data = vfr->packet.data();
+    packet->size = vfr->packet.size();
+    packet->type = OBS_ENCODER_VIDEO;
+    packet->pts = encoded.i_pts;
+    packet->dts = encoded.i_dts;
+    packet->timebase_num = static_cast<int32_t>(voi->fps_den);
+    packet->timebase_den = static_cast<int32_t>(voi->fps_num);
+    packet->keyframe = encoded.b_keyframe != 0;
+    packet->priority = priority;
+    *received_packet = true;
+    return true;
+}
+
+bool GetExtraData(void* data, uint8_t** extra_data, size_t* size) {
+    VfrEncoder* vfr = static_cast<VfrEncoder*>(data);
+    *extra_data = vfr->extra_data.data();
+    *size = vfr->extra_data.size();
+    return true;
+}
+
+bool GetSeiData(void* data, uint8_t** sei, size_t* size) {
+    VfrEncoder* vfr = static_cast<VfrEncoder*>(data);
+    *sei = vfr->sei.data();
+    *size = vfr->sei.size();
+    return !vfr->sei.empty();
+}
+
+void GetVideoInfo(void*, struct video_scale_info* info) {
+    info->format = VIDEO_FORMAT_NV12;
+}
+
+} // namespace
+
+void RegisterVfrEncoder() {
+    struct obs_encoder_info info = {};
+    info.id = kVfrEncoderId;
+    info.type = OBS_ENCODER_VIDEO;
+    info.codec = "h264";
+    info.get_name = GetName;
+    info.create = Create;
+    info.destroy = Destroy;
+    info.encode = Encode;
+    info.get_defaults = GetDefaults;
+    info.get_extra_data = GetExtraData;
+    info.get_sei_data = GetSeiData;
+    info.get_video_info = GetVideoInfo;
+    obs_register_encoder(&info);
+}
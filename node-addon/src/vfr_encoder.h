@@ -0,0 +1,21 @@
+#pragma once
+
+// Variable-frame-rate H.264 encoder, registered with libobs as "vfr_x264".
+//
+// libobs hands every rendered frame to its encoders, and obs_x264 encodes
+// each one. This encoder drives libx264 itself and drops frames that show
+// no change, keeping at least `min_fps`. Dropped frames leave gaps in the
+// packet timestamps (x264 runs with VFR input), so output timing stays
+// exact. It takes obs_x264's settings (rate_control, bitrate, crf,
+// keyint_sec, preset, tune, x264opts) plus:
+//
+//   min_fps                       lowest frame rate to keep (default 1)
+//   damage_window                 X11 window to watch for changes, 0 for the
+//   damage_x/_y/_width/_height    root window, with the captured rectangle;
+//                                 absent or -1 to compare frames instead
+//
+// Only built with libx264 (HAVE_X264).
+extern const char* const kVfrEncoderId;
+
+// Call once after obs_startup
+void RegisterVfrEncoder();
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+// Decides per rendered frame whether a variable-frame-rate encoder encodes
+// it. Unchanged frames are dropped, but at least one frame is encoded every
+// `max_gap` frames (the minimum fps) so players and seeking keep working.
+// A change also encodes the following `settle` frames: change notifications
+// can arrive just before the frame that actually shows the change.
+class VfrGate {
+public:
+    VfrGate(int64_t max_gap = 30, int settle = 2) : max_gap_(max_gap > 0 ? max_gap : 1), settle_(settle) {}
+
+    // `pts` counts frames at the canvas rate
+    bool shouldEncode(bool changed, int64_t pts) {
+        if (changed) {
+            hold_ = settle_;
+        }
+        bool encode = !started_ || changed || hold_ > 0 || pts - last_pts_ >= max_gap_;
+        if (!changed && hold_ > 0) {
+            hold_--;
+        }
+        if (encode) {
+            started_ = true;
+            last_pts_ = pts;
+            encoded_++;
+        } else {
+            skipped_++;
+        }
+        return encode;
+    }
+
+    uint64_t encoded() const { return encoded_; }
+    uint64_t skipped() const { return skipped_; }
+
+private:
+    int64_t max_gap_;
+    int settle_;
+    int hold_ = 0;
+    bool started_ = false;
+    int64_t last_pts_ = 0;
+    uint64_t encoded_ = 0;
+    uint64_t skipped_ = 0;
+};
+
+// Compares `rows` rows of `row_bytes` bytes between a frame plane and a
+// packed copy of the previous one, and refreshes the copy when they differ.
+// Static frames cost one linear read; changed frames stop at the first
+// differing row before copying.
+inline bool PlaneChanged(const uint8_t* plane, int stride, uint8_t* previous, int row_bytes, int rows) {
+    int row = 0;
+    for (; row < rows; ++row) {
+        if (std::memcmp(plane + static_cast<size_t>(row) * stride,
+                        previous + static_cast<size_t>(row) * row_bytes, row_bytes) != 0) {
+            break;
+        }
+    }
+    if (row == rows) {
+        return false;
+    }
+    for (; row < rows; ++row) {
+        std::memcpy(previous + static_cast<size_t>(row) * row_bytes,
+                    plane + static_cast<size_t>(row) * stride, row_bytes);
+    }
+    return true;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Pixel formats the addon hands out to consumers (frame taps, exports,
+// screenshots). Values are stable and exposed to JS as strings.
+enum class FrameFormat {
+    BGRA = 0,
+    RGBA = 1,
+    NV12 = 2,
+    I420 = 3
+};
+
+// A borrowed view of one video frame. Plane pointers are only valid for the
+// duration of the callback that receives it.
+struct VideoFrame {
+    const uint8_t* data[4] = {nullptr, nullptr, nullptr, nullptr};
+    uint32_t linesize[4] = {0, 0, 0, 0};
+    uint32_t width = 0;
+    uint32_t height = 0;
+    FrameFormat format = FrameFormat::BGRA;
+    uint64_t timestamp = 0; // ns, OBS video clock
+};
+
+// Tightly packed plane layout (no row padding) for a format and size
+struct FrameLayout {
+    int planes = 0;
+    size_t offset[4] = {0, 0, 0, 0};
+    uint32_t stride[4] = {0, 0, 0, 0};
+    uint32_t rows[4] = {0, 0, 0, 0};
+    size_t size = 0;
+};
+
+inline FrameLayout GetFrameLayout(FrameFormat format, uint32_t width, uint32_t height) {
+    FrameLayout layout;
+    const uint32_t chroma_w = (width + 1) / 2;
+    const uint32_t chroma_h = (height + 1) / 2;
+
+    switch (format) {
+    case FrameFormat::BGRA:
+    case FrameFormat::RGBA:
+        layout.planes = 1;
+        layout.stride[0] = width * 4;
+        layout.rows[0] = height;
+        break;
+    case FrameFormat::NV12:
+        layout.planes = 2;
+        layout.stride[0] = width;
+        layout.rows[0] = height;
+        layout.stride[1] = chroma_w * 2;
+        layout.rows[1] = chroma_h;
+        break;
+    case FrameFormat::I420:
+        layout.planes = 3;
+        layout.stride[0] = width;
+        layout.rows[0] = height;
+        layout.stride[1] = layout.stride[2] = chroma_w;
+        layout.rows[1] = layout.rows[2] = chroma_h;
+        break;
+    }
+
+    for (int i = 0; i < layout.planes; ++i) {
+        layout.offset[i] = layout.size;
+        layout.size += static_cast<size_t>(layout.stride[i]) * layout.rows[i];
+    }
+    return layout;
+}
+
+inline const char* FrameFormatName(FrameFormat format) {
+    switch (format) {
+    case FrameFormat::BGRA: return "bgra";
+    case FrameFormat::RGBA: return "rgba";
+    case FrameFormat::NV12: return "nv12";
+    case FrameFormat::I420: return "i420";
+    }
+    return "bgra";
+}
+
+inline bool ParseFrameFormat(const std::string& name, FrameFormat& format) {
+    if (name == "bgra") format = FrameFormat::BGRA;
+    else if (name == "rgba") format = FrameFormat::RGBA;
+    else if (name == "nv12") format = FrameFormat::NV12;
+    else if (name == "i420") format = FrameFormat::I420;
+    else return false;
+    return true;
+}
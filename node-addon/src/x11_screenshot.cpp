@@ -0,0 +1,280 @@
+#include "x11_screenshot.h"
+#include "log_sink.h"
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+#ifdef HAVE_XSHM
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
+
+#ifdef HAVE_XCOMPOSITE
+#include <X11/extensions/Xcomposite.h>
+#endif
+
+namespace {
+
+// A window can disappear between lookup and grab. Errors on screenshot
+// connections are recorded for the grab to report instead of reaching
+// Xlib's default handler, which exits the process; everything else goes to
+// the previous handler (see damage_tracker.cpp, which chains the same way).
+std::mutex g_errors_mutex;
+std::map<Display*, int> g_errors;
+XErrorHandler g_previous_handler = nullptr;
+
+int RecordScreenshotErrors(Display* display, XErrorEvent* event) {
+    {
+        std::lock_guard<std::mutex> lock(g_errors_mutex);
+        auto it = g_errors.find(display);
+        if (it != g_errors.end()) {
+            it->second = event->error_code;
+            return 0;
+        }
+    }
+    return g_previous_handler ? g_previous_handler(display, event) : 0;
+}
+
+int TakeError(Display* display) {
+    std::lock_guard<std::mutex> lock(g_errors_mutex);
+    int error = g_errors[display];
+    g_errors[display] = 0;
+    return error;
+}
+
+// Copies 32-bit pixels row by row, reordering to the requested format.
+// Depth-24 visuals leave the padding byte undefined, so alpha is forced opaque.
+void CopyPixels(const XImage* image, int width, int height, bool opaque, bool swap_rb, uint8_t* out) {
+    const uint32_t alpha = opaque ? 0xFF000000u : 0;
+    for (int row = 0; row < height; ++row) {
+        const uint32_t* src = reinterpret_cast<const uint32_t*>(image->data + static_cast<size_t>(row) * image->bytes_per_line);
+        uint32_t* dst = reinterpret_cast<uint32_t*>(out + static_cast<size_t>(row) * width * 4);
+        if (swap_rb) {
+            for (int col = 0; col < width; ++col) {
+                uint32_t pixel = src[col];
+                dst[col] = ((pixel & 0xFF) << 16) | ((pixel >> 16) & 0xFF) | (pixel & 0xFF00FF00u) | alpha;
+            }
+        } else if (opaque) {
+            for (int col = 0; col < width; ++col) {
+                dst[col] = src[col] | alpha;
+            }
+        } else {
+            std::memcpy(dst, src, static_cast<size_t>(width) * 4);
+        }
+    }
+}
+
+} // namespace
+
+struct X11Screenshot::Segment {
+    XImage* image = nullptr;
+    Visual* visual = nullptr;
+    int depth = 0;
+#ifdef HAVE_XSHM
+    XShmSegmentInfo info = {};
+    size_t capacity = 0;
+    bool attached = false;
+#endif
+};
+
+X11Screenshot::X11Screenshot() : segment_(new Segment()) {
+#ifdef HAVE_XSHM
+    segment_->info.shmid = -1;
+#endif
+}
+
+X11Screenshot::~X11Screenshot() {
+    if (!display_) {
+        return;
+    }
+
+    if (segment_->image) {
+#ifdef HAVE_XSHM
+        if (use_shm_) {
+            // The data belongs to the segment, not to Xlib
+            segment_->image->data = nullptr;
+        }
+#endif
+        XDestroyImage(segment_->image);
+    }
+#ifdef HAVE_XSHM
+    if (segment_->attached) {
+        XShmDetach(display_, &segment_->info);
+        XSync(display_, False);
+    }
+    if (segment_->info.shmaddr) {
+        shmdt(segment_->info.shmaddr);
+    }
+#endif
+
+    XCloseDisplay(display_);
+    std::lock_guard<std::mutex> lock(g_errors_mutex);
+    g_errors.erase(display_);
+}
+
+bool X11Screenshot::open() {
+    if (display_) {
+        return true;
+    }
+
+    display_ = XOpenDisplay(nullptr);
+    if (!display_) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_errors_mutex);
+        g_errors[display_] = 0;
+    }
+    // Installed once: reinstalling over a handler chained after ours would
+    // make the chain loop
+    static std::once_flag install;
+    std::call_once(install, [] { g_previous_handler = XSetErrorHandler(RecordScreenshotErrors); });
+
+#ifdef HAVE_XSHM
+    use_shm_ = XShmQueryExtension(display_);
+#endif
+    if (!use_shm_) {
+        LogWarning() << "MIT-SHM unavailable, screenshots use XGetImage";
+    }
+    return true;
+}
+
+bool X11Screenshot::redirect(uint64_t window) {
+#ifdef HAVE_XCOMPOSITE
+    int event_base = 0;
+    int error_base = 0;
+    if (!display_ || !XCompositeQueryExtension(display_, &event_base, &error_base)) {
+        return false;
+    }
+    XCompositeRedirectWindow(display_, static_cast<Window>(window), CompositeRedirectAutomatic);
+    XSync(display_, False);
+    return !TakeError(display_);
+#else
+    (void)window;
+    return false;
+#endif
+}
+
+bool X11Screenshot::grabImage(unsigned long drawable, void* visual, int depth, int x, int y, int width, int height) {
+    Segment& segment = *segment_;
+
+#ifdef HAVE_XSHM
+    if (use_shm_) {
+        Visual* target_visual = static_cast<Visual*>(visual);
+        if (!segment.image || segment.image->width != width || segment.image->height != height ||
+            segment.visual != target_visual || segment.depth != depth) {
+            if (segment.image) {
+                segment.image->data = nullptr;
+                XDestroyImage(segment.image);
+            }
+            segment.image = XShmCreateImage(display_, target_visual, depth, ZPixmap, nullptr,
+                                            &segment.info, width, height);
+            segment.visual = target_visual;
+            segment.depth = depth;
+            if (!segment.image) {
+                return false;
+            }
+
+            // Only ever grows: a smaller grab reuses the attached segment
+            size_t needed = static_cast<size_t>(segment.image->bytes_per_line) * height;
+            if (needed > segment.capacity) {
+                if (segment.attached) {
+                    XShmDetach(display_, &segment.info);
+                    XSync(display_, False);
+                    segment.attached = false;
+                }
+                if (segment.info.shmaddr) {
+                    shmdt(segment.info.shmaddr);
+                    segment.info.shmaddr = nullptr;
+                }
+                segment.capacity = 0;
+
+                segment.info.shmid = shmget(IPC_PRIVATE, needed, IPC_CREAT | 0600);
+                if (segment.info.shmid < 0) {
+                    return false;
+                }
+                void* address = shmat(segment.info.shmid, nullptr, 0);
+                if (address == reinterpret_cast<void*>(-1)) {
+                    shmctl(segment.info.shmid, IPC_RMID, nullptr);
+                    return false;
+                }
+                segment.info.shmaddr = static_cast<char*>(address);
+                segment.info.readOnly = False;
+                bool attached = XShmAttach(display_, &segment.info);
+                XSync(display_, False);
+                segment.attached = attached && !TakeError(display_);
+                // Freed once both sides detach, even if the process dies
+                shmctl(segment.info.shmid, IPC_RMID, nullptr);
+                if (!segment.attached) {
+                    LogWarning() << "XShmAttach failed, screenshots use XGetImage";
+                    use_shm_ = false;
+                    segment.image->data = nullptr;
+                    XDestroyImage(segment.image);
+                    segment.image = nullptr;
+                    return grabImage(drawable, visual, depth, x, y, width, height);
+                }
+                segment.capacity = needed;
+            }
+            segment.image->data = segment.info.shmaddr;
+        }
+
+        return XShmGetImage(display_, drawable, segment.image, x, y, AllPlanes) && !TakeError(display_);
+    }
+#else
+    (void)visual;
+    (void)depth;
+#endif
+
+    if (segment.image) {
+        XDestroyImage(segment.image);
+    }
+    segment.image = XGetImage(display_, drawable, x, y, width, height, AllPlanes, ZPixmap);
+    return segment.image && !TakeError(display_);
+}
+
+bool X11Screenshot::grab(uint64_t window, int x, int y, int width, int height, FrameFormat format,
+                         std::vector<uint8_t>& out, int& out_width, int& out_height) {
+    if (!display_ || (format != FrameFormat::BGRA && format != FrameFormat::RGBA)) {
+        return false;
+    }
+
+    Window target = window ? static_cast<Window>(window) : DefaultRootWindow(display_);
+    XWindowAttributes attributes;
+    if (!XGetWindowAttributes(display_, target, &attributes) || TakeError(display_) ||
+        attributes.map_state != IsViewable) {
+        return false;
+    }
+
+    // Clip to the window
+    int left = std::max(x, 0);
+    int top = std::max(y, 0);
+    int right = width > 0 ? std::min(x + width, attributes.width) : attributes.width;
+    int bottom = height > 0 ? std::min(y + height, attributes.height) : attributes.height;
+    if (right <= left || bottom <= top) {
+        return false;
+    }
+    out_width = right - left;
+    out_height = bottom - top;
+
+    if (!grabImage(target, attributes.visual, attributes.depth, left, top, out_width, out_height)) {
+        return false;
+    }
+
+    const XImage* image = segment_->image;
+    if (image->bits_per_pixel != 32 || image->byte_order != LSBFirst) {
+        LogError() << "Unsupported screenshot pixel layout: " << image->bits_per_pixel << " bpp";
+        return false;
+    }
+
+    // Server order is BGRX unless the visual puts red in the low byte
+    bool source_rgb = image->red_mask == 0xFF;
+    bool swap_rb = source_rgb != (format == FrameFormat::RGBA);
+    out.resize(static_cast<size_t>(out_width) * out_height * 4);
+    CopyPixels(image, out_width, out_height, attributes.depth != 32, swap_rb, out.data());
+    return true;
+}
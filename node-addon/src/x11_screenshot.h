@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "video_frame.h"
+
+typedef struct _XDisplay Display;
+
+// Single-frame grabs from an X server, independent of libobs.
+//
+// Keeps one connection and one MIT-SHM segment for its lifetime: the
+// segment grows to the largest grab seen and is reused, so a grab is one
+// XShmGetImage round trip plus a copy out of shared memory. Falls back to
+// XGetImage when the server has no MIT-SHM (e.g. a remote display).
+// Not thread-safe; callers serialize grabs.
+class X11Screenshot {
+public:
+    X11Screenshot();
+    ~X11Screenshot();
+
+    X11Screenshot(const X11Screenshot&) = delete;
+    X11Screenshot& operator=(const X11Screenshot&) = delete;
+
+    // Returns false without an X server
+    bool open();
+
+    // Copies a rectangle of `window` (0 = root window) into `out` as tightly
+    // packed BGRA or RGBA. Zero width/height extends to the window edge; the
+    // rectangle is clipped to the window. Returns false if the window is
+    // gone, unmapped, or the rectangle is empty.
+    bool grab(uint64_t window, int x, int y, int width, int height, FrameFormat format,
+              std::vector<uint8_t>& out, int& out_width, int& out_height);
+
+    // Keeps the window's contents in an offscreen buffer (XComposite
+    // automatic redirection) so grabs see it while covered by other windows.
+    // Lasts until the connection closes. Returns false without XComposite.
+    bool redirect(uint64_t window);
+
+    bool usesShm() const { return use_shm_; }
+
+private:
+    struct Segment;
+
+    bool grabImage(unsigned long drawable, void* visual, int depth, int x, int y, int width, int height);
+
+    Display* display_ = nullptr;
+    bool use_shm_ = false;
+    std::unique_ptr<Segment> segment_;
+};
@@ -0,0 +1,321 @@
+#include "x11_topology.h"
+#include "log_sink.h"
+#include "x11_windows.h"
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/Xrandr.h>
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+// Xlib's default error handler terminates the process. Windows we watch can
+// be destroyed at any moment, so errors on our own connections are ignored
+// and everything else is passed to whatever handler was installed before.
+std::atomic<Display*> g_query_display{nullptr};
+std::atomic<Display*> g_event_display{nullptr};
+XErrorHandler g_previous_handler = nullptr;
+
+int IgnoreOwnErrors(Display* display, XErrorEvent* event) {
+    if (display == g_query_display.load() || display == g_event_display.load()) {
+        return 0;
+    }
+    return g_previous_handler ? g_previous_handler(display, event) : 0;
+}
+
+} // namespace
+
+X11Topology::~X11Topology() {
+    stop();
+}
+
+bool X11Topology::start() {
+    if (query_display_) {
+        return true;
+    }
+
+    query_display_ = XOpenDisplay(nullptr);
+    event_display_ = XOpenDisplay(nullptr);
+    int screen_number = 0;
+    xcb_ = xcb_connect(nullptr, &screen_number);
+
+    if (!query_display_ || !event_display_ || xcb_connection_has_error(xcb_)) {
+        stop();
+        return false;
+    }
+
+    xcb_screen_iterator_t it = xcb_setup_roots_iterator(xcb_get_setup(xcb_));
+    for (int i = 0; i < screen_number && it.rem; ++i) {
+        xcb_screen_next(&it);
+    }
+    xcb_root_ = it.rem ? it.data->root : 0;
+
+    g_query_display = query_display_;
+    g_event_display = event_display_;
+    XErrorHandler previous = XSetErrorHandler(IgnoreOwnErrors);
+    if (previous != IgnoreOwnErrors) {
+        g_previous_handler = previous;
+    }
+
+    if (pipe(wake_fds_) != 0) {
+        stop();
+        return false;
+    }
+
+    event_thread_ = std::thread([this] { eventLoop(); });
+    return true;
+}
+
+void X11Topology::stop() {
+    if (event_thread_.joinable()) {
+        char byte = 0;
+        ssize_t written = write(wake_fds_[1], &byte, 1);
+        (void)written;
+        event_thread_.join();
+    }
+
+    for (int& fd : wake_fds_) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    if (query_display_) {
+        g_query_display = nullptr;
+        XCloseDisplay(query_display_);
+        query_display_ = nullptr;
+    }
+    if (event_display_) {
+        g_event_display = nullptr;
+        XCloseDisplay(event_display_);
+        event_display_ = nullptr;
+    }
+    if (xcb_) {
+        xcb_disconnect(xcb_);
+        xcb_ = nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    displays_valid_ = false;
+    windows_valid_ = false;
+}
+
+void X11Topology::setChangeCallback(ChangeCallback callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    callback_ = std::move(callback);
+}
+
+std::vector<DisplayInfo> X11Topology::getDisplays() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (displays_valid_) {
+        return displays_;
+    }
+
+    uint64_t generation = displays_generation_.load();
+    std::vector<DisplayInfo> displays = QueryX11Displays(query_display_);
+    if (generation == displays_generation_.load()) {
+        displays_ = displays;
+        displays_valid_ = true;
+    }
+    return displays;
+}
+
+std::vector<WindowInfo> X11Topology::getWindows() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (windows_valid_) {
+        return windows_;
+    }
+
+    uint64_t generation = windows_generation_.load();
+    std::vector<WindowInfo> windows = EnumerateX11Windows(xcb_, xcb_root_);
+    if (generation == windows_generation_.load()) {
+        windows_ = windows;
+        windows_valid_ = true;
+    }
+    return windows;
+}
+
+void X11Topology::invalidate(int kinds) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (kinds & DISPLAYS) {
+            displays_generation_++;
+            displays_valid_ = false;
+        }
+        if (kinds & WINDOWS) {
+            windows_generation_++;
+            windows_valid_ = false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    if (callback_) {
+        callback_(kinds);
+    }
+}
+
+// Subscribes to title and structure changes on every client window. Runs on
+// the event thread whenever the client list changes.
+void X11Topology::watchClientWindows() {
+    Window root = DefaultRootWindow(event_display_);
+    Atom client_list = XInternAtom(event_display_, "_NET_CLIENT_LIST", False);
+
+    Atom type = None;
+    int format = 0;
+    unsigned long count = 0;
+    unsigned long remaining = 0;
+    unsigned char* data = nullptr;
+
+    std::vector<Window> clients;
+    if (XGetWindowProperty(event_display_, root, client_list, 0, ~0L, False, XA_WINDOW, &type, &format,
+                           &count, &remaining, &data) == Success && data && type == XA_WINDOW) {
+        Window* ids = reinterpret_cast<Window*>(data);
+        clients.assign(ids, ids + count);
+    }
+    if (data) {
+        XFree(data);
+    }
+
+    if (clients.empty()) {
+        Window root_return = 0;
+        Window parent_return = 0;
+        Window* children = nullptr;
+        unsigned int child_count = 0;
+        if (XQueryTree(event_display_, root, &root_return, &parent_return, &children, &child_count)) {
+            clients.assign(children, children + child_count);
+            XFree(children);
+        }
+    }
+
+    for (Window window : clients) {
+        XSelectInput(event_display_, window, PropertyChangeMask | StructureNotifyMask);
+    }
+    XFlush(event_display_);
+}
+
+void X11Topology::eventLoop() {
+    Window root = DefaultRootWindow(event_display_);
+    Atom client_list = XInternAtom(event_display_, "_NET_CLIENT_LIST", False);
+    Atom net_wm_name = XInternAtom(event_display_, "_NET_WM_NAME", False);
+
+    int randr_event_base = 0;
+    int randr_error_base = 0;
+    bool has_randr = XRRQueryExtension(event_display_, &randr_event_base, &randr_error_base);
+    if (has_randr) {
+        XRRSelectInput(event_display_, root,
+                       RRScreenChangeNotifyMask | RRCrtcChangeNotifyMask | RROutputChangeNotifyMask);
+    }
+    XSelectInput(event_display_, root, PropertyChangeMask | SubstructureNotifyMask | StructureNotifyMask);
+    watchClientWindows();
+
+    const int x_fd = ConnectionNumber(event_display_);
+
+    for (;;) {
+        // Events can already be queued inside Xlib, so drain before polling
+        int changed = 0;
+        bool client_list_changed = false;
+
+        while (XPending(event_display_)) {
+            XEvent event;
+            XNextEvent(event_display_, &event);
+
+            if (has_randr && (event.type == randr_event_base + RRScreenChangeNotify ||
+                              event.type == randr_event_base + RRNotify)) {
+                XRRUpdateConfiguration(&event);
+                changed |= DISPLAYS;
+                continue;
+            }
+
+            switch (event.type) {
+            case PropertyNotify:
+                if (event.xproperty.window == root) {
+                    if (event.xproperty.atom == client_list) {
+                        client_list_changed = true;
+                        changed |= WINDOWS;
+                    }
+                } else if (event.xproperty.atom == net_wm_name || event.xproperty.atom == XA_WM_NAME) {
+                    changed |= WINDOWS;
+                }
+                break;
+            case ConfigureNotify:
+                // The root itself is reconfigured when the screen size changes
+                changed |= event.xconfigure.window == root ? (DISPLAYS | WINDOWS) : WINDOWS;
+                break;
+            case CreateNotify:
+                // Covers sessions without a window manager maintaining the client list
+                XSelectInput(event_display_, event.xcreatewindow.window, PropertyChangeMask | StructureNotifyMask);
+                changed |= WINDOWS;
+                break;
+            case DestroyNotify:
+            case MapNotify:
+            case UnmapNotify:
+            case ReparentNotify:
+                changed |= WINDOWS;
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (client_list_changed) {
+            watchClientWindows();
+        }
+        if (changed) {
+            invalidate(changed);
+        }
+
+        pollfd fds[2] = {{x_fd, POLLIN, 0}, {wake_fds_[0], POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LogError() << "X11 topology watcher stopped: poll failed";
+            return;
+        }
+        if (fds[1].revents) {
+            return;
+        }
+        if (fds[0].revents & (POLLERR | POLLHUP)) {
+            LogError() << "X11 topology watcher stopped: connection lost";
+            return;
+        }
+    }
+}
+
+std::vector<DisplayInfo> QueryX11Displays(Display* display) {
+    std::vector<DisplayInfo> displays;
+    Window root = DefaultRootWindow(display);
+    XRRScreenResources* resources = XRRGetScreenResourcesCurrent(display, root);
+
+    if (resources) {
+        for (int i = 0; i < resources->noutput; ++i) {
+            XRROutputInfo* output_info = XRRGetOutputInfo(display, resources, resources->outputs[i]);
+
+            if (output_info && output_info->connection == RR_Connected && output_info->crtc) {
+                XRRCrtcInfo* crtc_info = XRRGetCrtcInfo(display, resources, output_info->crtc);
+
+                if (crtc_info) {
+                    DisplayInfo info;
+                    info.id = std::to_string(resources->outputs[i]);
+                    info.name = std::string(output_info->name);
+                    info.width = crtc_info->width;
+                    info.height = crtc_info->height;
+                    info.x = crtc_info->x;
+                    info.y = crtc_info->y;
+                    displays.push_back(info);
+
+                    XRRFreeCrtcInfo(crtc_info);
+                }
+            }
+
+            if (output_info) {
+                XRRFreeOutputInfo(output_info);
+            }
+        }
+        XRRFreeScreenResources(resources);
+    }
+
+    return displays;
+}
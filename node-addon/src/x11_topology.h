@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <xcb/xcb.h>
+#include "obs_wrapper.h"
+
+typedef struct _XDisplay Display;
+
+// Cached display/window topology for an X11 session.
+//
+// Queries run over persistent connections and their results are kept until
+// the X server tells us they are stale: RandR screen/CRTC/output changes
+// invalidate the display list; changes to the root window's client list,
+// top-level structure (map/unmap/move/resize/destroy) or a client's title
+// invalidate the window list. A background thread waits for those events.
+class X11Topology {
+public:
+    enum Kind { DISPLAYS = 1, WINDOWS = 2 };
+    using ChangeCallback = std::function<void(int kinds)>;
+
+    X11Topology() = default;
+    ~X11Topology();
+
+    X11Topology(const X11Topology&) = delete;
+    X11Topology& operator=(const X11Topology&) = delete;
+
+    // Opens the connections and starts watching. Returns false without an X server.
+    bool start();
+    void stop();
+
+    std::vector<DisplayInfo> getDisplays();
+    std::vector<WindowInfo> getWindows();
+
+    // Called from the event thread, at most once per batch of X events
+    void setChangeCallback(ChangeCallback callback);
+
+private:
+    void eventLoop();
+    void watchClientWindows();
+    void invalidate(int kinds);
+
+    Display* query_display_ = nullptr;   // RandR queries (under mutex_)
+    Display* event_display_ = nullptr;   // owned by the event thread
+    xcb_connection_t* xcb_ = nullptr;    // window queries (under mutex_)
+    xcb_window_t xcb_root_ = 0;
+
+    std::mutex mutex_;
+    std::vector<DisplayInfo> displays_;
+    std::vector<WindowInfo> windows_;
+    bool displays_valid_ = false;
+    bool windows_valid_ = false;
+    // Bumped on invalidation so a query that raced with an event is not cached
+    std::atomic<uint64_t> displays_generation_{0};
+    std::atomic<uint64_t> windows_generation_{0};
+
+    std::mutex callback_mutex_;
+    ChangeCallback callback_;
+
+    int wake_fds_[2] = {-1, -1};
+    std::thread event_thread_;
+};
+
+// Connected RandR outputs of `display`, one round trip per output/CRTC
+std::vector<DisplayInfo> QueryX11Displays(Display* display);
@@ -0,0 +1,172 @@
+#include "x11_windows.h"
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace {
+
+enum AtomIndex {
+    ATOM_NET_CLIENT_LIST,
+    ATOM_NET_WM_NAME,
+    ATOM_UTF8_STRING,
+    ATOM_COUNT
+};
+
+const char* const kAtomNames[ATOM_COUNT] = {
+    "_NET_CLIENT_LIST",
+    "_NET_WM_NAME",
+    "UTF8_STRING",
+};
+
+struct FreeDeleter {
+    void operator()(void* p) const { std::free(p); }
+};
+
+template <typename T>
+using XcbReply = std::unique_ptr<T, FreeDeleter>;
+
+// Per-window cookies, all sent before the first reply is awaited
+struct WindowCookies {
+    xcb_window_t window;
+    xcb_get_window_attributes_cookie_t attributes;
+    xcb_get_geometry_cookie_t geometry;
+    xcb_translate_coordinates_cookie_t position;
+    xcb_get_property_cookie_t net_wm_name;
+    xcb_get_property_cookie_t wm_name;
+    xcb_get_property_cookie_t wm_class;
+};
+
+std::string PropertyString(xcb_connection_t* connection, xcb_get_property_cookie_t cookie) {
+    XcbReply<xcb_get_property_reply_t> reply(xcb_get_property_reply(connection, cookie, nullptr));
+    if (!reply || reply->format != 8) {
+        return std::string();
+    }
+    int length = xcb_get_property_value_length(reply.get());
+    return std::string(static_cast<const char*>(xcb_get_property_value(reply.get())), length);
+}
+
+} // namespace
+
+std::vector<WindowInfo> EnumerateX11Windows(xcb_connection_t* connection, xcb_window_t root) {
+    std::vector<WindowInfo> windows;
+
+    // Round trip 1: atoms
+    xcb_intern_atom_cookie_t atom_cookies[ATOM_COUNT];
+    for (int i = 0; i < ATOM_COUNT; ++i) {
+        atom_cookies[i] = xcb_intern_atom(connection, 0, std::strlen(kAtomNames[i]), kAtomNames[i]);
+    }
+    xcb_atom_t atoms[ATOM_COUNT];
+    for (int i = 0; i < ATOM_COUNT; ++i) {
+        XcbReply<xcb_intern_atom_reply_t> reply(xcb_intern_atom_reply(connection, atom_cookies[i], nullptr));
+        atoms[i] = reply ? reply->atom : static_cast<xcb_atom_t>(XCB_ATOM_NONE);
+    }
+
+    // Round trip 2: the list of client windows
+    std::vector<xcb_window_t> candidates;
+    bool from_client_list = false;
+    {
+        xcb_get_property_cookie_t list_cookie = xcb_get_property(
+            connection, 0, root, atoms[ATOM_NET_CLIENT_LIST], XCB_ATOM_WINDOW, 0, UINT32_MAX / 4);
+        xcb_query_tree_cookie_t tree_cookie = xcb_query_tree(connection, root);
+
+        XcbReply<xcb_get_property_reply_t> list(xcb_get_property_reply(connection, list_cookie, nullptr));
+        XcbReply<xcb_query_tree_reply_t> tree(xcb_query_tree_reply(connection, tree_cookie, nullptr));
+
+        if (list && list->type == XCB_ATOM_WINDOW && xcb_get_property_value_length(list.get()) > 0) {
+            auto* ids = static_cast<const xcb_window_t*>(xcb_get_property_value(list.get()));
+            int count = xcb_get_property_value_length(list.get()) / static_cast<int>(sizeof(xcb_window_t));
+            candidates.assign(ids, ids + count);
+            from_client_list = true;
+        } else if (tree) {
+            // No EWMH window manager: use the root's children instead
+            xcb_window_t* children = xcb_query_tree_children(tree.get());
+            candidates.assign(children, children + xcb_query_tree_children_length(tree.get()));
+        }
+    }
+
+    // Round trip 3: every property of every window, pipelined
+    std::vector<WindowCookies> cookies;
+    cookies.reserve(candidates.size());
+    for (xcb_window_t window : candidates) {
+        WindowCookies c;
+        c.window = window;
+        c.attributes = xcb_get_window_attributes(connection, window);
+        c.geometry = xcb_get_geometry(connection, window);
+        c.position = xcb_translate_coordinates(connection, window, root, 0, 0);
+        c.net_wm_name = xcb_get_property(connection, 0, window, atoms[ATOM_NET_WM_NAME],
+                                         atoms[ATOM_UTF8_STRING], 0, 1024);
+        c.wm_name = xcb_get_property(connection, 0, window, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 0, 1024);
+        c.wm_class = xcb_get_property(connection, 0, window, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 0, 1024);
+        cookies.push_back(c);
+    }
+    xcb_flush(connection);
+
+    windows.reserve(cookies.size());
+    for (const WindowCookies& c : cookies) {
+        // Every reply must be collected even for windows that get skipped
+        XcbReply<xcb_get_window_attributes_reply_t> attributes(
+            xcb_get_window_attributes_reply(connection, c.attributes, nullptr));
+        XcbReply<xcb_get_geometry_reply_t> geometry(xcb_get_geometry_reply(connection, c.geometry, nullptr));
+        XcbReply<xcb_translate_coordinates_reply_t> position(
+            xcb_translate_coordinates_reply(connection, c.position, nullptr));
+        std::string net_wm_name = PropertyString(connection, c.net_wm_name);
+        std::string wm_name = PropertyString(connection, c.wm_name);
+        std::string wm_class = PropertyString(connection, c.wm_class);
+
+        // Windows may disappear between the list and the queries
+        if (!attributes || !geometry || !position) {
+            continue;
+        }
+
+        // Without a WM the tree contains helper windows; keep viewable ones
+        if (!from_client_list && (attributes->override_redirect ||
+                                  attributes->map_state != XCB_MAP_STATE_VIEWABLE)) {
+            continue;
+        }
+
+        WindowInfo info;
+        info.id = c.window;
+        info.name = !net_wm_name.empty() ? net_wm_name : wm_name;
+
+        // WM_CLASS is "instance\0class\0"; the class names the application
+        size_t split = wm_class.find('\0');
+        if (split != std::string::npos && split + 1 < wm_class.size()) {
+            info.owner = wm_class.substr(split + 1);
+            if (!info.owner.empty() && info.owner.back() == '\0') {
+                info.owner.pop_back();
+            }
+        } else {
+            info.owner = wm_class;
+        }
+
+        info.x = position->dst_x;
+        info.y = position->dst_y;
+        info.width = geometry->width;
+        info.height = geometry->height;
+        windows.push_back(std::move(info));
+    }
+
+    return windows;
+}
+
+std::vector<WindowInfo> EnumerateX11Windows() {
+    int screen_number = 0;
+    xcb_connection_t* connection = xcb_connect(nullptr, &screen_number);
+    if (xcb_connection_has_error(connection)) {
+        xcb_disconnect(connection);
+        return {};
+    }
+
+    xcb_screen_iterator_t it = xcb_setup_roots_iterator(xcb_get_setup(connection));
+    for (int i = 0; i < screen_number && it.rem; ++i) {
+        xcb_screen_next(&it);
+    }
+
+    std::vector<WindowInfo> windows;
+    if (it.rem) {
+        windows = EnumerateX11Windows(connection, it.data->root);
+    }
+    xcb_disconnect(connection);
+    return windows;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <vector>
+#include <xcb/xcb.h>
+#include "obs_wrapper.h"
+
+// Enumerates top-level client windows on an X11 screen.
+//
+// Uses the window manager's _NET_CLIENT_LIST when present and falls back to
+// the mapped children of the root window otherwise (e.g. bare Xvfb). All
+// per-window requests are issued before any reply is read, so the cost is a
+// fixed handful of round trips regardless of the number of windows.
+std::vector<WindowInfo> EnumerateX11Windows(xcb_connection_t* connection, xcb_window_t root);
+
+// Convenience overload that opens (and closes) its own connection to $DISPLAY
+std::vector<WindowInfo> EnumerateX11Windows();
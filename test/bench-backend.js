@@ -0,0 +1,96 @@
+const obs = require('..');
+const os = require('os');
+const path = require('path');
+const fs = require('fs');
+
+// Records the first display at a few frame rates and reports throughput and
+// frame pacing for whichever backend this build uses (OBS or the built-in
+// X11 backend). Run it in each build on the same machine and compare the
+// JSON lines it prints.
+//
+//   xvfb-run -s "-screen 0 1920x1080x24" node test/bench-backend.js [seconds]
+const seconds = Number(process.argv[2]) || 5;
+const RATES = [30, 60];
+
+function sleep(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+async function runRate(display, fps, outputPath) {
+    if (fs.existsSync(outputPath)) {
+        fs.unlinkSync(outputPath);
+    }
+    const options = {
+        displayId: display.id,
+        width: display.width & ~1,
+        height: display.height & ~1,
+        fps,
+        preset: 'veryfast',
+        capture_audio: false
+    };
+    if (!obs.startRecording(outputPath, options)) {
+        throw new Error(`Failed to start recording at ${fps} fps`);
+    }
+
+    const cpuBefore = process.cpuUsage();
+    const wallBefore = process.hrtime.bigint();
+    await sleep(seconds * 1000);
+    const cpu = process.cpuUsage(cpuBefore);
+    const wallSeconds = Number(process.hrtime.bigint() - wallBefore) / 1e9;
+    const stats = obs.getStats();
+    obs.stopRecording();
+    await sleep(500);
+
+    return {
+        backend: stats.backend,
+        encoder: stats.encoder,
+        fps,
+        size: `${options.width}x${options.height}`,
+        outputFps: +(stats.frames.output / wallSeconds).toFixed(1),
+        lagged: stats.frames.lagged,
+        skipped: stats.frames.skipped,
+        jitterP50Ms: stats.captureJitterMs.p50,
+        jitterP99Ms: stats.captureJitterMs.p99,
+        jitterMaxMs: stats.captureJitterMs.max,
+        captureP99Ms: stats.renderLatencyMs.p99,
+        encodeP50Ms: stats.encodeTimeMs.p50,
+        cpuCores: +((cpu.user + cpu.system) / 1e6 / wallSeconds).toFixed(2),
+        fileKB: fs.existsSync(outputPath) ? Math.round(fs.statSync(outputPath).size / 1024) : 0
+    };
+}
+
+async function runBenchmark() {
+    const outputPath = path.join(os.tmpdir(), 'bench-backend.mkv');
+
+    try {
+        if (!obs.init({ modules: 'required', captureAudio: false })) {
+            throw new Error('Failed to initialize');
+        }
+        const display = obs.listDisplays()[0];
+        if (!display) {
+            throw new Error('No display found');
+        }
+        console.log(`⏱️ Backend benchmark on ${display.width}x${display.height}, ${os.cpus().length} cores, ${seconds}s per run`);
+
+        const rows = [];
+        for (const fps of RATES) {
+            const row = await runRate(display, fps, outputPath);
+            console.log(JSON.stringify(row));
+            rows.push(row);
+        }
+
+        console.log('\n📊 Results:');
+        console.table(rows);
+        console.log('Jitter is only measured by the built-in backend; OBS reports render lag in frames.lagged');
+    } catch (error) {
+        console.error('❌ Benchmark failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        obs.shutdown();
+        if (fs.existsSync(outputPath)) {
+            fs.unlinkSync(outputPath);
+        }
+    }
+}
+
+runBenchmark();
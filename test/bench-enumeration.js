@@ -0,0 +1,95 @@
+const obs = require('..');
+
+// Marshalling cost of window lists: one object per window (listWindows)
+// against the packed struct-of-arrays form (listWindowsPacked). Uses
+// synthetic windows so only the N-API side is measured, then the real
+// lists once if a display server is available. Needs no OBS init. The
+// synthetic windows come from a hook only built with
+// -DBUILD_BENCHMARK_HOOKS=ON; without it only the real lists are measured.
+//
+//   node test/bench-enumeration.js [milliseconds per case]
+const budgetMs = Number(process.argv[2]) || 1000;
+const COUNTS = [10, 100, 1000];
+
+// Calls fn repeatedly for the time budget; returns microseconds per call
+function measure(fn) {
+    for (let i = 0; i < 50; i++) {
+        fn();
+    }
+    let calls = 0;
+    const start = process.hrtime.bigint();
+    const end = start + BigInt(budgetMs) * 1000000n;
+    let now = start;
+    while (now < end) {
+        for (let i = 0; i < 20; i++) {
+            fn();
+        }
+        calls += 20;
+        now = process.hrtime.bigint();
+    }
+    return Number(now - start) / 1000 / calls;
+}
+
+// Reads every field the way a window picker would
+function touchAll(windows) {
+    let sum = 0;
+    for (const w of windows) {
+        sum += w.id + w.x + w.y + w.width + w.height + w.name.length + w.owner.length;
+    }
+    return sum;
+}
+
+// Looks a window up by id, the common case when following one window
+function findById(list, id) {
+    return list.indexOfId ? list.indexOfId(id) : list.findIndex(w => w.id === id);
+}
+
+function runBenchmark() {
+    console.log(`⏱️ Enumeration marshalling, ${budgetMs} ms per case`);
+    const rows = [];
+
+    for (const count of obs.marshalTestWindows ? COUNTS : []) {
+        const lastId = 0x3a00001 + count - 1;
+        const objects = measure(() => touchAll(obs.marshalTestWindows(count, false)));
+        const packedAll = measure(() => touchAll(new obs.WindowList(obs.marshalTestWindows(count, true))));
+        const objectsFind = measure(() => findById(obs.marshalTestWindows(count, false), lastId));
+        const packedFind = measure(() => findById(new obs.WindowList(obs.marshalTestWindows(count, true)), lastId));
+
+        const row = {
+            windows: count,
+            objectsUs: +objects.toFixed(2),
+            packedUs: +packedAll.toFixed(2),
+            speedup: +(objects / packedAll).toFixed(2),
+            objectsFindUs: +objectsFind.toFixed(2),
+            packedFindUs: +packedFind.toFixed(2),
+            findSpeedup: +(objectsFind / packedFind).toFixed(2)
+        };
+        console.log(JSON.stringify(row));
+        rows.push(row);
+    }
+
+    if (rows.length) {
+        console.log('\n📊 Synthetic windows (µs per call, all fields read / lookup by id):');
+        console.table(rows);
+    } else {
+        console.log('⚠️ Skipping synthetic windows: rebuild with -DBUILD_BENCHMARK_HOOKS=ON');
+    }
+
+    try {
+        const real = obs.listWindows().length;
+        console.log(`\n🪟 Real window list (${real} windows):`);
+        console.table([{
+            listWindowsUs: +measure(() => touchAll(obs.listWindows())).toFixed(2),
+            listWindowsPackedUs: +measure(() => touchAll(obs.listWindowsPacked())).toFixed(2)
+        }]);
+    } catch (error) {
+        console.log(`⚠️ Skipping the real window list: ${error.message}`);
+    }
+}
+
+try {
+    runBenchmark();
+} catch (error) {
+    console.error('❌ Benchmark failed:', error.message);
+    process.exitCode = 1;
+}
@@ -0,0 +1,95 @@
+const obs = require('..');
+const os = require('os');
+const path = require('path');
+const fs = require('fs');
+
+// Records a few seconds with each x264 preset and reports achieved fps,
+// encoder skips and process CPU use. Intended for CPU-only Linux hosts:
+//
+//   node test/bench-presets.js [width] [height] [fps] [seconds]
+const width = Number(process.argv[2]) || 1920;
+const height = Number(process.argv[3]) || 1080;
+const fps = Number(process.argv[4]) || 30;
+const seconds = Number(process.argv[5]) || 5;
+
+const PRESETS = ['ultrafast', 'superfast', 'veryfast', 'faster', 'fast', 'medium', 'auto'];
+
+console.log(`🏎️ x264 preset benchmark: ${width}x${height}@${fps}, ${seconds}s each, ${os.cpus().length} cores`);
+
+function sleep(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+async function runPreset(preset, displayId, outputPath) {
+    if (fs.existsSync(outputPath)) {
+        fs.unlinkSync(outputPath);
+    }
+    if (!obs.startRecording(outputPath, {
+        width, height, fps, displayId, preset, capture_audio: false
+    })) {
+        throw new Error(`Failed to start recording with preset ${preset}`);
+    }
+
+    // Skip the first second: encoder startup and lookahead fill
+    await sleep(1000);
+    const before = obs.getStats();
+    const cpuBefore = process.cpuUsage();
+    const wallBefore = process.hrtime.bigint();
+
+    await sleep(seconds * 1000);
+
+    const after = obs.getStats();
+    const cpu = process.cpuUsage(cpuBefore);
+    const wallSeconds = Number(process.hrtime.bigint() - wallBefore) / 1e9;
+    obs.stopRecording();
+    await sleep(500);
+
+    const encoded = after.frames.output - before.frames.output;
+    const skipped = after.frames.skipped - before.frames.skipped;
+    const cpuSeconds = (cpu.user + cpu.system) / 1e6;
+    return {
+        preset: after.preset || preset,
+        fps: encoded / wallSeconds,
+        skipped,
+        cpuCores: cpuSeconds / wallSeconds,
+        cpuPercent: 100 * cpuSeconds / wallSeconds / os.cpus().length,
+        bitrateKbps: after.bitrateKbps,
+        encodeP99: after.encodeTimeMs.p99
+    };
+}
+
+async function run() {
+    const outputPath = path.join(__dirname, 'bench-presets.mp4');
+
+    try {
+        if (!obs.init({ modules: 'required', captureAudio: false })) {
+            throw new Error('Failed to initialize OBS');
+        }
+        const displays = obs.listDisplays();
+        const displayId = displays[0] ? displays[0].id : '';
+
+        const results = [];
+        for (const preset of PRESETS) {
+            const result = await runPreset(preset, displayId, outputPath);
+            results.push(result);
+            const label = preset === 'auto' ? `auto→${result.preset}` : preset;
+            console.log(`   ${label.padEnd(18)} ${result.fps.toFixed(1).padStart(6)} fps  ` +
+                        `${String(result.skipped).padStart(4)} skipped  ` +
+                        `${result.cpuCores.toFixed(2)} cores (${result.cpuPercent.toFixed(0)}%)  ` +
+                        `encode p99 ${result.encodeP99.toFixed(1)} ms`);
+        }
+
+        const holding = results.filter(r => r.fps >= fps * 0.98 && r.skipped === 0);
+        console.log(`\n📊 Presets holding ${fps} fps: ${holding.map(r => r.preset).join(', ') || 'none'}`);
+    } catch (error) {
+        console.error('\n❌ Benchmark failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        obs.shutdown();
+        if (fs.existsSync(outputPath)) {
+            fs.unlinkSync(outputPath);
+        }
+    }
+}
+
+run();
@@ -0,0 +1,118 @@
+const obs = require('..');
+const os = require('os');
+const path = require('path');
+const fs = require('fs');
+
+// Records the full display and centred regions of decreasing area at 1:1,
+// reporting process CPU and encode time for each. Encode cost should fall
+// roughly in proportion to the region area.
+//
+//   node test/bench-roi.js [fps] [seconds]
+const fps = Number(process.argv[2]) || 30;
+const seconds = Number(process.argv[3]) || 5;
+
+const AREAS = [1, 1 / 4, 1 / 16];
+
+function sleep(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+async function runRegion(display, area, outputPath) {
+    const scale = Math.sqrt(area);
+    const width = Math.round(display.width * scale) & ~1;
+    const height = Math.round(display.height * scale) & ~1;
+    const region = {
+        x: Math.round((display.width - width) / 2),
+        y: Math.round((display.height - height) / 2),
+        width,
+        height
+    };
+
+    if (fs.existsSync(outputPath)) {
+        fs.unlinkSync(outputPath);
+    }
+    const options = { displayId: display.id, fps, preset: 'veryfast', capture_audio: false };
+    if (area < 1) {
+        options.region = region;
+    } else {
+        options.width = width;
+        options.height = height;
+    }
+    if (!obs.startRecording(outputPath, options)) {
+        throw new Error(`Failed to start recording ${width}x${height}`);
+    }
+
+    await sleep(1000);
+    const cpuBefore = process.cpuUsage();
+    const wallBefore = process.hrtime.bigint();
+    await sleep(seconds * 1000);
+    const cpu = process.cpuUsage(cpuBefore);
+    const wallSeconds = Number(process.hrtime.bigint() - wallBefore) / 1e9;
+    const stats = obs.getStats();
+    obs.stopRecording();
+    await sleep(500);
+
+    return {
+        label: `${width}x${height}`,
+        area,
+        cpuCores: (cpu.user + cpu.system) / 1e6 / wallSeconds,
+        encodeP50: stats.encodeTimeMs.p50,
+        skipped: stats.frames.skipped
+    };
+}
+
+async function run() {
+    const outputPath = path.join(__dirname, 'bench-roi.mp4');
+
+    try {
+        if (!obs.init({ modules: 'required', captureAudio: false })) {
+            throw new Error('Failed to initialize OBS');
+        }
+        const display = obs.listDisplays()[0];
+        if (!display) {
+            throw new Error('No display to capture');
+        }
+        console.log(`🔍 Region-of-interest benchmark: ${display.width}x${display.height}@${fps}, ` +
+                    `${seconds}s each, ${os.cpus().length} cores`);
+
+        // An incomplete region would otherwise record a 2x2 file
+        for (const region of [{ x: 100, y: 100 }, { x: -1, y: 0, width: 640, height: 480 }]) {
+            let rejected = false;
+            try {
+                obs.startRecording(outputPath, { displayId: display.id, region });
+            } catch (error) {
+                rejected = error instanceof TypeError;
+            }
+            if (!rejected) {
+                throw new Error(`region ${JSON.stringify(region)} was accepted`);
+            }
+        }
+
+        const results = [];
+        for (const area of AREAS) {
+            const result = await runRegion(display, area, outputPath);
+            results.push(result);
+            console.log(`   ${result.label.padEnd(11)} ${(area * 100).toFixed(1).padStart(5)}% area  ` +
+                        `${result.cpuCores.toFixed(2)} cores  encode p50 ${result.encodeP50.toFixed(2)} ms  ` +
+                        `${result.skipped} skipped`);
+        }
+
+        const full = results[0];
+        console.log('\n📊 Cost relative to the full display:');
+        results.slice(1).forEach(result => {
+            console.log(`   ${result.label.padEnd(11)} area ${result.area.toFixed(3)}  ` +
+                        `cpu ${(result.cpuCores / full.cpuCores).toFixed(3)}  ` +
+                        `encode ${full.encodeP50 ? (result.encodeP50 / full.encodeP50).toFixed(3) : 'n/a'}`);
+        });
+    } catch (error) {
+        console.error('\n❌ Benchmark failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        obs.shutdown();
+        if (fs.existsSync(outputPath)) {
+            fs.unlinkSync(outputPath);
+        }
+    }
+}
+
+run();
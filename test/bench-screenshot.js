@@ -0,0 +1,81 @@
+const obs = require('..');
+const os = require('os');
+
+// Screenshots per second at 1080p and 4K for each format, one at a time
+// (captureFrame) and with parallel compression (captureFrameAsync). Needs
+// no OBS init. Run on a screen at least 4K:
+//
+//   xvfb-run -s "-screen 0 3840x2160x24" node test/bench-screenshot.js [seconds]
+const seconds = Number(process.argv[2]) || 3;
+
+const SIZES = [
+    { label: '1080p', width: 1920, height: 1080 },
+    { label: '4K', width: 3840, height: 2160 }
+];
+const FORMATS = ['bgra', 'nv12', 'png', 'jpeg'];
+
+function screenSize() {
+    // Without a display or window the whole root window is captured
+    const full = obs.captureFrame();
+    return { width: full.width, height: full.height };
+}
+
+function runSync(options) {
+    let count = 0;
+    let bytes = 0;
+    const end = Date.now() + seconds * 1000;
+    while (Date.now() < end) {
+        bytes += obs.captureFrame(options).length;
+        count++;
+    }
+    return { perSecond: count / seconds, bytes: bytes / count };
+}
+
+async function runAsync(options, concurrency) {
+    let count = 0;
+    let bytes = 0;
+    const end = Date.now() + seconds * 1000;
+    async function lane() {
+        while (Date.now() < end) {
+            bytes += (await obs.captureFrameAsync(options)).length;
+            count++;
+        }
+    }
+    await Promise.all(Array.from({ length: concurrency }, lane));
+    return { perSecond: count / seconds, bytes: bytes / count };
+}
+
+async function runBenchmark() {
+    const screen = screenSize();
+    const concurrency = Number(process.env.UV_THREADPOOL_SIZE) || 4;
+    console.log(`📸 Screenshot benchmark on a ${screen.width}x${screen.height} screen, ` +
+                `${os.cpus().length} cores, ${concurrency} async lanes`);
+
+    const rows = [];
+    for (const size of SIZES) {
+        if (size.width > screen.width || size.height > screen.height) {
+            console.log(`⚠️ Screen smaller than ${size.label}, skipping`);
+            continue;
+        }
+        for (const format of FORMATS) {
+            const options = { format, region: { x: 0, y: 0, width: size.width, height: size.height } };
+            const sync = runSync(options);
+            const parallel = await runAsync(options, concurrency);
+            rows.push({
+                size: size.label,
+                format,
+                'sync /s': sync.perSecond.toFixed(1),
+                'async /s': parallel.perSecond.toFixed(1),
+                'KB each': (sync.bytes / 1024).toFixed(0)
+            });
+        }
+    }
+
+    console.log('\n📊 Results:');
+    console.table(rows);
+}
+
+runBenchmark().catch(error => {
+    console.error('❌ Benchmark failed:', error.message);
+    process.exitCode = 1;
+});
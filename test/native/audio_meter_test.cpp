@@ -0,0 +1,156 @@
+// Checks the audio meter against BS.1770 reference points (a 0 dBFS 1 kHz
+// sine in one channel reads -3.01 LUFS), the SIMD block kernels against the
+// scalar ones, and the CPU budget: metering 48 kHz stereo must cost under 1%
+// of one core.
+#include "audio_meter.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+static void Expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static bool Near(double value, double expected, double tolerance) {
+    return std::fabs(value - expected) <= tolerance;
+}
+
+// Feeds `seconds` of planar audio in 1024-frame blocks, the size OBS mixes in
+struct Signal {
+    uint32_t sample_rate = 48000;
+    std::vector<std::vector<float>> channels;
+};
+
+static void Feed(AudioMeter& meter, const Signal& signal) {
+    const uint32_t block = 1024;
+    size_t length = signal.channels[0].size();
+    for (size_t offset = 0; offset < length; offset += block) {
+        AudioFrame frame;
+        frame.channels = static_cast<uint32_t>(signal.channels.size());
+        frame.sample_rate = signal.sample_rate;
+        frame.frames = static_cast<uint32_t>(std::min<size_t>(block, length - offset));
+        for (size_t ch = 0; ch < signal.channels.size(); ++ch) {
+            frame.data[ch] = signal.channels[ch].data() + offset;
+        }
+        meter.process(frame);
+    }
+}
+
+static Signal Sine(uint32_t sample_rate, double seconds, double frequency, double amplitude,
+                   const std::vector<double>& channel_gains) {
+    Signal signal;
+    signal.sample_rate = sample_rate;
+    size_t length = static_cast<size_t>(sample_rate * seconds);
+    for (double gain : channel_gains) {
+        std::vector<float> samples(length);
+        for (size_t i = 0; i < length; ++i) {
+            samples[i] = static_cast<float>(gain * amplitude *
+                                            std::sin(2 * 3.14159265358979323846 * frequency * i / sample_rate));
+        }
+        signal.channels.push_back(std::move(samples));
+    }
+    return signal;
+}
+
+static void TestReferenceLevels() {
+    for (uint32_t rate : {44100u, 48000u, 96000u}) {
+        AudioMeter meter;
+        Feed(meter, Sine(rate, 4.0, 1000, 1.0, {1.0, 0.0}));
+        AudioLevels levels = meter.levels();
+        if (!Near(levels.momentary_lufs, -3.01, 0.05) || !Near(levels.short_term_lufs, -3.01, 0.05)) {
+            std::printf("%u Hz: momentary %.3f short-term %.3f LUFS\n", rate, levels.momentary_lufs,
+                        levels.short_term_lufs);
+        }
+        Expect(levels.channels == 2 && levels.sample_rate == rate, "format follows the input");
+        Expect(Near(levels.momentary_lufs, -3.01, 0.05), "0 dBFS 1 kHz sine in one channel is -3.01 LUFS momentary");
+        Expect(Near(levels.short_term_lufs, -3.01, 0.05), "and -3.01 LUFS short-term");
+        Expect(Near(levels.peak[0], 1.0, 0.001) && levels.peak[1] == 0, "peak per channel");
+        Expect(Near(levels.rms[0], std::sqrt(0.5), 0.001) && levels.rms[1] == 0, "RMS per channel");
+    }
+
+    // Same sine in both channels is 3 dB louder; -20 dB is 20 LU quieter
+    AudioMeter both;
+    Feed(both, Sine(48000, 4.0, 1000, 1.0, {1.0, 1.0}));
+    Expect(Near(both.levels().momentary_lufs, 0.0, 0.05), "stereo 0 dBFS sine is 0 LUFS");
+    AudioMeter quiet;
+    Feed(quiet, Sine(48000, 4.0, 1000, 0.1, {1.0, 1.0}));
+    Expect(Near(quiet.levels().momentary_lufs, -20.0, 0.05), "-20 dBFS stereo sine is -20 LUFS");
+
+    // K-weighting: the high pass takes most of 20 Hz away, and the shelf puts
+    // 8 kHz about 3.35 dB above 1 kHz
+    AudioMeter low;
+    Feed(low, Sine(48000, 4.0, 20, 1.0, {1.0, 1.0}));
+    Expect(low.levels().momentary_lufs < -10.0, "20 Hz is attenuated");
+    AudioMeter high;
+    Feed(high, Sine(48000, 4.0, 8000, 1.0, {1.0, 1.0}));
+    Expect(Near(high.levels().momentary_lufs, 3.35, 0.1), "8 kHz is boosted by the shelf");
+
+    // Windows only report once full: 400 ms for momentary, 3 s short-term
+    AudioMeter partial;
+    Feed(partial, Sine(48000, 1.0, 1000, 1.0, {1.0, 1.0}));
+    Expect(std::isfinite(partial.levels().momentary_lufs), "momentary after 1 s");
+    Expect(std::isinf(partial.levels().short_term_lufs), "no short-term before 3 s");
+    Expect(partial.levels().blocks == 10, "ten 100 ms blocks in 1 s");
+}
+
+static void TestKernelsMatchReference() {
+    std::vector<const MeterKernels*> kernels = AvailableMeterKernels();
+    const MeterKernels* scalar = kernels.front();
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> samples(4803);
+    for (float& sample : samples) {
+        sample = dist(rng);
+    }
+    samples[4801] = -1.5f; // the peak sits in the scalar tail
+
+    for (size_t k = 1; k < kernels.size(); ++k) {
+        std::printf("checking %s against scalar\n", kernels[k]->name);
+        for (size_t count : {size_t(0), size_t(1), size_t(7), size_t(8), size_t(1024), size_t(4803)}) {
+            Expect(kernels[k]->peak(samples.data(), count) == scalar->peak(samples.data(), count), "peak exact");
+            double expected = scalar->sum_squares(samples.data(), count);
+            double actual = kernels[k]->sum_squares(samples.data(), count);
+            Expect(Near(actual, expected, 1e-5 * expected + 1e-9), "sum of squares within 1e-5");
+        }
+    }
+    std::printf("dispatching to %s\n", BestMeterKernels().name);
+}
+
+static void TestCpuBudget() {
+    // 60 s of 48 kHz stereo noise; the budget is 1% of a core, i.e. 600 ms
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    Signal signal;
+    for (int ch = 0; ch < 2; ++ch) {
+        std::vector<float> samples(48000 * 60);
+        for (float& sample : samples) {
+            sample = dist(rng);
+        }
+        signal.channels.push_back(std::move(samples));
+    }
+
+    AudioMeter meter;
+    auto start = std::chrono::steady_clock::now();
+    Feed(meter, signal);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    double share = ms / 60000.0 * 100.0;
+    std::printf("48 kHz stereo: %.2f ms per second of audio (%.3f%% of one core)\n", ms / 60.0, share);
+    Expect(share < 1.0, "metering stays under 1% of one core");
+}
+
+int main() {
+    TestReferenceLevels();
+    TestKernelsMatchReference();
+    TestCpuBudget();
+
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
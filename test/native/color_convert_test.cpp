@@ -0,0 +1,168 @@
+// Checks the colour conversion and scaling kernels: known BT.709 values from
+// the scalar reference, and every SIMD implementation this CPU runs against
+// it, byte for byte, over odd sizes and padded strides.
+#include "color_convert.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+static void Expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+struct Image {
+    int width;
+    int height;
+    int stride;
+    std::vector<uint8_t> pixels;
+};
+
+// Rows padded past the width so kernels that ignore the stride show up
+static Image RandomImage(int width, int height, std::mt19937& rng) {
+    Image image{width, height, width * 4 + 12, {}};
+    image.pixels.resize(static_cast<size_t>(image.stride) * height);
+    for (uint8_t& byte : image.pixels) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    return image;
+}
+
+static Image SolidImage(int width, int height, uint8_t b, uint8_t g, uint8_t r) {
+    Image image{width, height, width * 4, {}};
+    image.pixels.resize(static_cast<size_t>(width) * height * 4);
+    for (size_t i = 0; i < image.pixels.size(); i += 4) {
+        image.pixels[i] = b;
+        image.pixels[i + 1] = g;
+        image.pixels[i + 2] = r;
+        image.pixels[i + 3] = 255;
+    }
+    return image;
+}
+
+static std::vector<uint8_t> ToI420(const Image& image, const ColorKernels* kernels) {
+    int chroma_w = (image.width + 1) / 2;
+    int chroma_h = (image.height + 1) / 2;
+    size_t luma = static_cast<size_t>(image.width) * image.height;
+    size_t chroma = static_cast<size_t>(chroma_w) * chroma_h;
+    std::vector<uint8_t> out(luma + chroma * 2);
+    BgraToI420(image.pixels.data(), image.stride, image.width, image.height, out.data(), image.width,
+               out.data() + luma, chroma_w, out.data() + luma + chroma, chroma_w, kernels);
+    return out;
+}
+
+static std::vector<uint8_t> ToNv12(const Image& image, const ColorKernels* kernels) {
+    int chroma_w = (image.width + 1) / 2;
+    int chroma_h = (image.height + 1) / 2;
+    size_t luma = static_cast<size_t>(image.width) * image.height;
+    std::vector<uint8_t> out(luma + static_cast<size_t>(chroma_w) * 2 * chroma_h);
+    BgraToNv12(image.pixels.data(), image.stride, image.width, image.height, out.data(), image.width,
+               out.data() + luma, chroma_w * 2, kernels);
+    return out;
+}
+
+static std::vector<uint8_t> Box2x(const Image& image, const ColorKernels* kernels) {
+    std::vector<uint8_t> out(static_cast<size_t>(image.width / 2) * (image.height / 2) * 4);
+    DownscaleBgraBox2x(image.pixels.data(), image.stride, image.width, image.height, out.data(),
+                       (image.width / 2) * 4, kernels);
+    return out;
+}
+
+static std::vector<uint8_t> Bilinear(const Image& image, int width, int height, const ColorKernels* kernels) {
+    std::vector<uint8_t> out(static_cast<size_t>(width) * height * 4);
+    ScaleBgraBilinear(image.pixels.data(), image.stride, image.width, image.height, out.data(), width * 4,
+                      width, height, kernels);
+    return out;
+}
+
+static bool Near(int value, int expected) {
+    return value >= expected - 1 && value <= expected + 1;
+}
+
+// Reference values from the BT.709 equations, rounded; the 8-bit fixed
+// point coefficients may be off by one
+static void TestKnownValues() {
+    const ColorKernels* scalar = AvailableColorKernels().front();
+    struct Case { uint8_t b, g, r, y, u, v; const char* name; };
+    const Case cases[] = {
+        {255, 255, 255, 235, 128, 128, "white"},
+        {0, 0, 0, 16, 128, 128, "black"},
+        {0, 0, 255, 63, 102, 240, "red"},
+        {0, 255, 0, 173, 42, 26, "green"},
+        {255, 0, 0, 32, 240, 118, "blue"},
+    };
+    for (const Case& c : cases) {
+        Image image = SolidImage(4, 2, c.b, c.g, c.r);
+        std::vector<uint8_t> yuv = ToI420(image, scalar);
+        bool ok = Near(yuv[0], c.y) && Near(yuv[8], c.u) && Near(yuv[10], c.v);
+        if (!ok) {
+            std::printf("%s: got Y %d U %d V %d\n", c.name, yuv[0], yuv[8], yuv[10]);
+        }
+        Expect(ok, "BT.709 limited range values");
+    }
+}
+
+static void TestScaleIdentities() {
+    const ColorKernels* scalar = AvailableColorKernels().front();
+    std::mt19937 rng(7);
+    Image image = RandomImage(37, 23, rng);
+
+    // Same size bilinear samples every pixel exactly
+    std::vector<uint8_t> same = Bilinear(image, image.width, image.height, scalar);
+    bool identical = true;
+    for (int y = 0; y < image.height; ++y) {
+        identical &= std::memcmp(same.data() + y * image.width * 4, image.pixels.data() + y * image.stride,
+                                 image.width * 4) == 0;
+    }
+    Expect(identical, "same-size bilinear copies");
+
+    // 4x down goes through two box steps and matches doing them by hand
+    Image big = RandomImage(64, 48, rng);
+    std::vector<uint8_t> scratch;
+    std::vector<uint8_t> scaled(16 * 12 * 4);
+    ScaleBgra(big.pixels.data(), big.stride, 64, 48, scaled.data(), 16 * 4, 16, 12, scratch);
+    std::vector<uint8_t> half = Box2x(big, scalar);
+    Image half_image{32, 24, 32 * 4, half};
+    Expect(scaled == Box2x(half_image, scalar), "ScaleBgra uses box steps for 4x");
+}
+
+static void TestKernelsMatchReference() {
+    std::vector<const ColorKernels*> kernels = AvailableColorKernels();
+    const ColorKernels* scalar = kernels.front();
+    const int sizes[][2] = {{1, 1}, {2, 2}, {3, 5}, {16, 2}, {17, 3}, {31, 7}, {33, 17},
+                            {64, 31}, {127, 9}, {640, 360}, {1921, 1081}};
+    std::mt19937 rng(42);
+
+    for (size_t k = 1; k < kernels.size(); ++k) {
+        std::printf("checking %s against scalar\n", kernels[k]->name);
+        for (const auto& size : sizes) {
+            Image image = RandomImage(size[0], size[1], rng);
+            Expect(ToI420(image, kernels[k]) == ToI420(image, scalar), "I420 bit-exact");
+            Expect(ToNv12(image, kernels[k]) == ToNv12(image, scalar), "NV12 bit-exact");
+            Expect(Box2x(image, kernels[k]) == Box2x(image, scalar), "box 2x bit-exact");
+            int down_w = size[0] * 2 / 3 + 1;
+            int down_h = size[1] * 2 / 3 + 1;
+            Expect(Bilinear(image, down_w, down_h, kernels[k]) == Bilinear(image, down_w, down_h, scalar),
+                   "bilinear down bit-exact");
+            Expect(Bilinear(image, size[0] * 3 / 2 + 1, size[1] + 3, kernels[k]) ==
+                       Bilinear(image, size[0] * 3 / 2 + 1, size[1] + 3, scalar),
+                   "bilinear up bit-exact");
+        }
+    }
+    std::printf("dispatching to %s\n", BestColorKernels().name);
+}
+
+int main() {
+    TestKnownValues();
+    TestScaleIdentities();
+    TestKernelsMatchReference();
+
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,79 @@
+// Checks the capture schedule: deadlines do not drift, stalls skip to the
+// latest due tick, and a real sleep loop on it stays on time.
+#include "frame_clock.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using Clock = FrameClock::Clock;
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+
+static int failures = 0;
+
+static void Expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static void TestDeadlinesDoNotDrift() {
+    Clock::time_point start;
+    FrameClock clock(30, start);
+    // Wake up 5 ms late every time: the schedule must not shift
+    for (int i = 0; i < 300; ++i) {
+        Expect(clock.advance(clock.deadline() + milliseconds(5)) == 0, "late wake-ups skip nothing");
+    }
+    Expect(clock.tick() == 300, "one tick per frame");
+    Expect(clock.deadline() == start + nanoseconds(10000000000LL), "300 frames at 30 fps end at 10 s");
+}
+
+static void TestStallSkipsToLatestDueTick() {
+    Clock::time_point start;
+    FrameClock clock(60, start);
+    clock.advance(start);
+    // Stalled until just past the deadline of tick 10
+    Clock::time_point now = start + nanoseconds(10 * 1000000000LL / 60 + 1000);
+    Expect(clock.advance(now) == 8, "ticks 2..9 skipped");
+    Expect(clock.tick() == 10, "tick 10 captured at once");
+    Expect(clock.deadline() <= now, "it is already due");
+}
+
+static void TestFractionalRates() {
+    Clock::time_point start;
+    FrameClock clock(24, start);
+    // A wake-up exactly on each deadline must never count as a skip
+    for (int i = 0; i < 1000; ++i) {
+        Expect(clock.advance(clock.deadline()) == 0, "on-time wake-ups skip nothing");
+    }
+}
+
+static void TestSleepLoopJitter() {
+    const int fps = 100;
+    FrameClock clock(fps, Clock::now());
+    std::vector<double> late_ms;
+    int64_t skipped = 0;
+    for (int i = 0; i < fps / 2; ++i) {
+        std::this_thread::sleep_until(clock.deadline());
+        Clock::time_point woke = Clock::now();
+        late_ms.push_back(std::chrono::duration<double, std::milli>(woke - clock.deadline()).count());
+        skipped += clock.advance(woke);
+    }
+    std::sort(late_ms.begin(), late_ms.end());
+    std::printf("sleep loop at %d fps: p50 %.3f ms, max %.3f ms late, %lld skipped\n", fps,
+                late_ms[late_ms.size() / 2], late_ms.back(), static_cast<long long>(skipped));
+    Expect(late_ms.front() >= 0, "never early");
+}
+
+int main() {
+    TestDeadlinesDoNotDrift();
+    TestStallSkipsToLatestDueTick();
+    TestFractionalRates();
+    TestSleepLoopJitter();
+
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
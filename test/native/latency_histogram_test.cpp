@@ -0,0 +1,89 @@
+// Checks LatencyHistogram bucketing accuracy and that concurrent recording
+// from several threads loses no samples, then reports the cost per record.
+#include "latency_histogram.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+static void Expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static void TestBuckets() {
+    // Every bucket's midpoint must map back to the same bucket, and the
+    // midpoint must be within 12.5% of any value in the bucket
+    for (uint64_t us = 0; us < 5000000; us += 1 + us / 64) {
+        int bucket = LatencyHistogram::bucketFor(us);
+        double value = LatencyHistogram::bucketValue(bucket);
+        if (LatencyHistogram::bucketFor(static_cast<uint64_t>(value)) != bucket ||
+            std::fabs(value - static_cast<double>(us)) > 0.125 * static_cast<double>(us) + 0.5) {
+            std::printf("FAIL: %llu us -> bucket %d (%.1f us)\n", static_cast<unsigned long long>(us), bucket, value);
+            failures++;
+            return;
+        }
+    }
+    Expect(LatencyHistogram::bucketFor(UINT64_MAX) == LatencyHistogram::kBuckets - 1, "largest value fits");
+}
+
+static void TestPercentiles() {
+    LatencyHistogram histogram;
+    // 1..1000 ms, uniformly
+    for (uint64_t ms = 1; ms <= 1000; ++ms) {
+        histogram.record(ms * 1000000);
+    }
+
+    LatencyHistogram::Summary summary = histogram.summarize();
+    std::printf("uniform 1..1000 ms: p50 %.1f p90 %.1f p99 %.1f max %.1f mean %.1f\n",
+                summary.p50_ms, summary.p90_ms, summary.p99_ms, summary.max_ms, summary.mean_ms);
+    Expect(summary.count == 1000, "count");
+    Expect(std::fabs(summary.p50_ms - 500) < 500 * 0.125, "p50 within bucket error");
+    Expect(std::fabs(summary.p90_ms - 900) < 900 * 0.125, "p90 within bucket error");
+    Expect(std::fabs(summary.p99_ms - 990) < 990 * 0.125, "p99 within bucket error");
+    Expect(summary.max_ms == 1000, "max is exact");
+    Expect(std::fabs(summary.mean_ms - 500.5) < 0.01, "mean is exact");
+
+    histogram.reset();
+    Expect(histogram.summarize().count == 0, "reset clears counts");
+}
+
+static void TestConcurrentRecording() {
+    const int kThreads = 4;
+    const int kPerThread = 1000000;
+    LatencyHistogram histogram;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&histogram, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                histogram.record(static_cast<uint64_t>(1000 + (i + t) % 50000) * 1000);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    LatencyHistogram::Summary summary = histogram.summarize();
+    std::printf("%d threads x %d records: %.1f ns per record (wall / per-thread count)\n",
+                kThreads, kPerThread, ns / kPerThread);
+    Expect(summary.count == static_cast<uint64_t>(kThreads) * kPerThread, "no samples lost");
+}
+
+int main() {
+    TestBuckets();
+    TestPercentiles();
+    TestConcurrentRecording();
+
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+// Checks the log sink: messages from several threads reach the handler in
+// each thread's order, levels filter, libobs messages are tagged and mapped,
+// long messages are truncated, the file output is written, and a flood that
+// outruns the writer drops and counts instead of blocking. Reports the cost
+// of queueing a message.
+#include "log_sink.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+static void Expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// Collects what the writer thread hands to the handler
+struct Collector {
+    std::mutex mutex;
+    std::vector<LogEntry> entries;
+
+    void install() {
+        LogSink::instance().setHandler([this](const std::vector<LogEntry>& batch) {
+            std::lock_guard<std::mutex> lock(mutex);
+            entries.insert(entries.end(), batch.begin(), batch.end());
+        });
+    }
+
+    std::vector<LogEntry> take() {
+        LogSink::instance().flush();
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::move(entries);
+    }
+};
+
+static void ObsLog(int level, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    LogSink::obsLogHandler(level, format, args, nullptr);
+    va_end(args);
+}
+
+static void TestOrderAcrossThreads(Collector& collector) {
+    const int threads = 4;
+    const int messages = 200; // well under the queue size: nothing drops
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([t] {
+            for (int i = 0; i < messages; ++i) {
+                LogInfo() << t << " " << i;
+            }
+        });
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+
+    std::vector<LogEntry> entries = collector.take();
+    Expect(entries.size() == static_cast<size_t>(threads) * messages, "every message delivered");
+
+    std::vector<int> next(threads, 0);
+    bool in_order = true;
+    for (const LogEntry& entry : entries) {
+        int t = -1;
+        int i = -1;
+        std::istringstream(entry.message) >> t >> i;
+        if (t < 0 || t >= threads) {
+            in_order = false;
+            continue;
+        }
+        in_order &= i == next[t]++;
+    }
+    Expect(in_order, "each thread's messages arrive in order");
+}
+
+static void TestLevelsAndObs(Collector& collector) {
+    LogSink& sink = LogSink::instance();
+    sink.setLevel(LogLevel::Warning);
+    LogInfo() << "filtered";
+    LogDebug() << "filtered";
+    LogWarning() << "kept";
+    ObsLog(300, "obs %s", "filtered");
+    ObsLog(200, "obs %d", 42);
+    sink.setLevel(LogLevel::Debug);
+    ObsLog(250, "between warning and info");
+    LogDebug() << "debug";
+
+    std::vector<LogEntry> entries = collector.take();
+    Expect(entries.size() == 4, "levels above the threshold filtered");
+    if (entries.size() == 4) {
+        Expect(entries[0].level == LogLevel::Warning && !entries[0].from_obs, "addon warning kept");
+        Expect(entries[1].from_obs && entries[1].message == "obs 42", "libobs message formatted and tagged");
+        Expect(entries[2].level == LogLevel::Info, "libobs in-between levels map down");
+        Expect(entries[3].level == LogLevel::Debug && entries[3].message == "debug", "debug after lowering level");
+    }
+    sink.setLevel(LogLevel::Info);
+
+    LogInfo() << std::string(2000, 'x');
+    entries = collector.take();
+    Expect(entries.size() == 1 && entries[0].message.size() < 2000 && !entries[0].message.empty(),
+           "long messages truncated");
+}
+
+static void TestFile(const std::string& path, Collector& collector) {
+    LogSink& sink = LogSink::instance();
+    std::remove(path.c_str());
+    Expect(sink.setFile(path), "log file opened");
+    LogWarning() << "to the file";
+    sink.flush();
+    Expect(sink.setFile(""), "log file closed");
+    LogInfo() << "after close";
+    collector.take();
+
+    std::ifstream file(path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+    Expect(text.find(" warning addon to the file\n") != std::string::npos, "file line has level and source");
+    Expect(text.find("after close") == std::string::npos, "nothing written after closing");
+    std::remove(path.c_str());
+}
+
+static void TestFlood(Collector& collector) {
+    LogSink& sink = LogSink::instance();
+    const int count = 200000;
+    uint64_t dropped_before = sink.dropped();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        LogInfo() << "flood " << i;
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<LogEntry> entries = collector.take();
+    uint64_t dropped = sink.dropped() - dropped_before;
+    Expect(entries.size() + dropped == static_cast<size_t>(count), "every message delivered or counted");
+
+    std::printf("%.1f ns per message queued (%llu of %d dropped while flooding)\n", ns / count,
+                static_cast<unsigned long long>(dropped), count);
+}
+
+int main() {
+    LogSink::instance().setConsole(false);
+    Collector collector;
+    collector.install();
+
+    TestOrderAcrossThreads(collector);
+    TestLevelsAndObs(collector);
+    TestFile("log_sink_test.log", collector);
+    TestFlood(collector);
+
+    LogSink::instance().setHandler(nullptr);
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,106 @@
+// Checks the encoder-to-writer packet queue: it holds no more than its
+// packet and byte limits, a stream that lost a packet resumes only at a
+// keyframe (without affecting other streams), close() lets the writer drain,
+// and queued bytes show up in the memory accounting.
+#include "packet_queue.h"
+
+#include <cstdio>
+#include <thread>
+
+static int failures = 0;
+
+static void Expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static void TestLimits() {
+    PacketQueue<int> by_count(3, 1000);
+    for (int i = 0; i < 5; ++i) {
+        by_count.push(int(i), 10, true);
+    }
+    Expect(by_count.queuedBytes() == 30, "three packets queued");
+    Expect(by_count.dropped() == 2, "packets past the count limit dropped");
+
+    PacketQueue<int> by_bytes(100, 250);
+    for (int i = 0; i < 5; ++i) {
+        by_bytes.push(int(i), 100, true);
+    }
+    Expect(by_bytes.queuedBytes() == 200, "bytes stay under the limit");
+    Expect(by_bytes.peakBytes() == 200, "peak tracks the high-water mark");
+    Expect(MemoryStageBytes(MemoryStage::Packets) == 230, "queued bytes charged to the packet stage");
+
+    by_bytes.clear();
+    Expect(by_bytes.queuedBytes() == 0, "clear empties the queue");
+    Expect(by_bytes.dropped() == 5, "cleared packets count as dropped");
+}
+
+static void TestKeyframeResume() {
+    PacketQueue<int> queue(2, 1000);
+    Expect(queue.push(0, 10, true, 0), "video keyframe queued");
+    Expect(queue.push(1, 10, false, 0), "video delta queued");
+    Expect(!queue.push(2, 10, false, 0), "delta dropped when full");
+
+    int packet = -1;
+    queue.pop(packet);
+    queue.pop(packet);
+    Expect(!queue.push(3, 10, false, 0), "deltas after a drop are skipped");
+    Expect(queue.push(4, 10, true, 1), "other streams are unaffected");
+    Expect(queue.push(5, 10, true, 0), "video resumes at the next keyframe");
+    Expect(queue.pop(packet) && packet == 4, "audio packet first");
+    Expect(queue.pop(packet) && packet == 5, "then the keyframe");
+    Expect(queue.push(6, 10, false, 0), "deltas queue again after the keyframe");
+}
+
+static void TestCloseDrains() {
+    PacketQueue<int> queue(10, 1000);
+    queue.push(1, 10, true);
+    queue.push(2, 10, false);
+    queue.close();
+    Expect(!queue.push(3, 10, true), "closed queue rejects packets");
+
+    int packet = 0;
+    Expect(queue.pop(packet) && packet == 1, "first packet drained after close");
+    Expect(queue.pop(packet) && packet == 2, "second packet drained after close");
+    Expect(!queue.pop(packet), "pop ends once drained");
+}
+
+static void TestTwoThreads() {
+    const int count = 200000;
+    PacketQueue<int> queue(64, 64 * 100);
+
+    std::thread writer([&queue] {
+        int packet = 0;
+        int last = -1;
+        bool ordered = true;
+        while (queue.pop(packet)) {
+            ordered &= packet > last;
+            last = packet;
+        }
+        Expect(ordered, "packets arrive in order");
+    });
+
+    int queued = 0;
+    for (int i = 0; i < count; ++i) {
+        queued += queue.push(int(i), 100, i % 30 == 0) ? 1 : 0;
+    }
+    queue.close();
+    writer.join();
+
+    Expect(queued + static_cast<int>(queue.dropped()) == count, "every packet queued or counted as dropped");
+    Expect(queue.peakBytes() <= 64 * 100, "peak within the byte limit");
+    std::printf("%d of %d packets queued, peak %zu bytes\n", queued, count, queue.peakBytes());
+}
+
+int main() {
+    TestLimits();
+    TestKeyframeResume();
+    TestCloseDrains();
+    TestTwoThreads();
+    Expect(MemoryStageBytes(MemoryStage::Packets) == 0, "nothing charged once the queues are gone");
+
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+// Attaches a reader process to the shared-memory frame ring and checks that
+// it keeps up with a 1080p BGRA writer running at 60 fps.
+#include "obs_capture_shm.h"
+#include "shm_ring.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+
+static const uint32_t kWidth = 1920;
+static const uint32_t kHeight = 1080;
+static const int kFps = 60;
+static const int kSeconds = 3;
+static const int kFrames = kFps * kSeconds;
+
+// Every frame is filled with a byte derived from its index so a torn read
+// (pixels from two different frames) is detectable at the start and end.
+static uint8_t PatternFor(uint64_t index) {
+    return static_cast<uint8_t>(index * 37 + 11);
+}
+
+static int RunReader(const std::string& name) {
+    obs_shm_reader reader;
+    for (int attempt = 0; obs_shm_reader_open(&reader, name.c_str()) != 0; ++attempt) {
+        if (attempt > 200) {
+            std::fprintf(stderr, "reader: failed to attach to %s\n", name.c_str());
+            return 2;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    uint64_t received = 0;
+    uint64_t torn = 0;
+    uint64_t last_index = 0;
+    auto started = std::chrono::steady_clock::now();
+
+    while (obs_shm_writer_alive(&reader)) {
+        obs_shm_frame frame;
+        int rc = obs_shm_reader_next(&reader, &frame);
+        if (rc == OBS_SHM_NONE) {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+            continue;
+        }
+        if (rc == OBS_SHM_LAPPED) {
+            continue;
+        }
+
+        // Zero-copy check of the first and last byte, then validate
+        uint8_t expected = PatternFor(frame.info.frame_index);
+        bool ok = frame.data[0] == expected && frame.data[frame.info.data_size - 1] == expected;
+        if (!obs_shm_reader_validate(&reader, &frame)) {
+            continue;
+        }
+        if (!ok) {
+            torn++;
+        }
+        received++;
+        last_index = frame.info.frame_index;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::printf("reader: %llu frames in %.2fs (%.1f fps), %llu lapped, %llu torn, last index %llu\n",
+                (unsigned long long)received, seconds, received / seconds,
+                (unsigned long long)reader.lapped, (unsigned long long)torn,
+                (unsigned long long)last_index);
+
+    obs_shm_reader_close(&reader);
+    // The reader attaches after the first frames; everything after must arrive
+    return (torn == 0 && reader.lapped == 0 && received >= kFrames - kFps / 2) ? 0 : 1;
+}
+
+int main() {
+    const std::string name = "/obs-shm-test-" + std::to_string(getpid());
+
+    ShmFrameRing ring;
+    if (!ring.create(name, FrameFormat::BGRA, kWidth, kHeight, 4)) {
+        std::fprintf(stderr, "writer: failed to create ring\n");
+        return 1;
+    }
+
+    pid_t child = fork();
+    if (child == 0) {
+        int rc = RunReader(name);
+        std::fflush(stdout);
+        _exit(rc);
+    }
+
+    // Give the reader a moment to attach before publishing
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::vector<uint8_t> pixels(kWidth * kHeight * 4);
+    VideoFrame frame;
+    frame.width = kWidth;
+    frame.height = kHeight;
+    frame.format = FrameFormat::BGRA;
+    frame.data[0] = pixels.data();
+    frame.linesize[0] = kWidth * 4;
+
+    const auto interval = std::chrono::nanoseconds(1000000000 / kFps);
+    auto next = std::chrono::steady_clock::now();
+    double worst_publish_ms = 0;
+
+    for (int i = 0; i < kFrames; ++i) {
+        std::memset(pixels.data(), PatternFor(ring.framesPublished()), pixels.size());
+        frame.timestamp = static_cast<uint64_t>(i) * interval.count();
+
+        auto before = std::chrono::steady_clock::now();
+        ring.publish(frame);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - before).count();
+        if (ms > worst_publish_ms) {
+            worst_publish_ms = ms;
+        }
+
+        next += interval;
+        std::this_thread::sleep_until(next);
+    }
+
+    std::printf("writer: %llu frames published, worst publish %.2f ms\n",
+                (unsigned long long)ring.framesPublished(), worst_publish_ms);
+
+    // Let the reader drain the last slots, then signal end of stream
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ring.destroy();
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    bool passed = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    std::printf("%s\n", passed ? "PASS" : "FAIL");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+// Checks the SPSC ring: full rings drop and count instead of overwriting,
+// and a producer and consumer on two threads see every item in order with
+// its payload intact. Reports the cost per item.
+#include "spsc_ring.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+static int failures = 0;
+
+static void Expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+struct Item {
+    uint64_t sequence = 0;
+    uint64_t payload[7] = {};
+};
+
+static void TestFullRingDrops() {
+    SpscRing<int> ring(3);
+    Expect(ring.capacity() == 4, "capacity rounds up to a power of two");
+
+    for (int i = 0; i < 6; ++i) {
+        int* slot = ring.writeSlot();
+        if (slot) {
+            *slot = i;
+            ring.publish();
+        }
+    }
+    Expect(ring.size() == 4, "four items queued");
+    Expect(ring.dropped() == 2, "two items dropped");
+
+    // The queued items are the oldest ones, untouched by the drops
+    for (int i = 0; i < 4; ++i) {
+        int* slot = ring.readSlot();
+        Expect(slot && *slot == i, "items read back in order");
+        ring.release();
+    }
+    Expect(ring.readSlot() == nullptr, "ring empty");
+}
+
+static void TestTwoThreads() {
+    const uint64_t count = 2000000;
+    SpscRing<Item> ring(64);
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread producer([&ring, count] {
+        for (uint64_t i = 0; i < count;) {
+            Item* item = ring.writeSlot();
+            if (!item) {
+                std::this_thread::yield();
+                continue;
+            }
+            item->sequence = i;
+            for (uint64_t& value : item->payload) {
+                value = i * 31;
+            }
+            ring.publish();
+            ++i;
+        }
+    });
+
+    uint64_t expected = 0;
+    bool in_order = true;
+    bool intact = true;
+    while (expected < count) {
+        Item* item = ring.readSlot();
+        if (!item) {
+            std::this_thread::yield();
+            continue;
+        }
+        in_order &= item->sequence == expected;
+        for (uint64_t value : item->payload) {
+            intact &= value == expected * 31;
+        }
+        ring.release();
+        ++expected;
+    }
+    producer.join();
+
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    Expect(in_order, "items arrive in order without gaps");
+    Expect(intact, "payloads are complete when read");
+    std::printf("%.1f ns per item across threads (%llu retried writes)\n", ns / count,
+                static_cast<unsigned long long>(ring.dropped()));
+}
+
+int main() {
+    TestFullRingDrops();
+    TestTwoThreads();
+
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
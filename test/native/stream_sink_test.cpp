@@ -0,0 +1,189 @@
+// Checks the live stream sink: target parsing, writes to a Unix socket, a
+// FIFO and an inherited fd, and that a reader which stops reading or goes
+// away makes write() fail within the deadline or on cancel() instead of
+// blocking.
+#include "stream_sink.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static int failures = 0;
+
+static void Expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void TestParse() {
+    StreamTarget unix_target = ParseStreamTarget("unix:/tmp/live.sock");
+    Expect(unix_target.kind == StreamTarget::UNIX_SOCKET && unix_target.path == "/tmp/live.sock",
+           "unix:/path is a socket");
+    Expect(ParseStreamTarget("unix:///tmp/live.sock").path == "/tmp/live.sock", "unix:///path as well");
+
+    StreamTarget fd_target = ParseStreamTarget("fd:3");
+    Expect(fd_target.kind == StreamTarget::FD && fd_target.fd == 3, "fd:3 is an fd");
+    Expect(!IsStreamTarget("fd:"), "fd: without a number is a file");
+    Expect(!IsStreamTarget("fd:3x"), "fd: with junk is a file");
+    Expect(!IsStreamTarget("/tmp/recording.mp4"), "plain paths are files");
+
+    std::string fifo = "/tmp/stream_sink_test_" + std::to_string(getpid()) + ".fifo";
+    mkfifo(fifo.c_str(), 0600);
+    Expect(ParseStreamTarget(fifo).kind == StreamTarget::FIFO, "an existing FIFO is a stream target");
+    unlink(fifo.c_str());
+}
+
+// Listens on a fresh socket path; returns the listening fd
+static int Listen(const std::string& path) {
+    unlink(path.c_str());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, 1) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void TestUnixSocket() {
+    std::string path = "/tmp/stream_sink_test_" + std::to_string(getpid()) + ".sock";
+    StreamSink sink;
+    std::string error;
+    Expect(!sink.open(ParseStreamTarget("unix:" + path), error) && !error.empty(),
+           "connecting without a listener fails");
+
+    int listener = Listen(path);
+    Expect(listener >= 0, "listening socket");
+    Expect(sink.open(ParseStreamTarget("unix:" + path), error), "connects to a listener");
+    int reader = accept(listener, nullptr, nullptr);
+
+    std::vector<uint8_t> data(1 << 20);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+    std::vector<uint8_t> received;
+    std::thread consumer([reader, &received] {
+        uint8_t buffer[65536];
+        ssize_t n;
+        while ((n = read(reader, buffer, sizeof(buffer))) > 0) {
+            received.insert(received.end(), buffer, buffer + n);
+        }
+    });
+    Expect(sink.write(data.data(), data.size()), "1 MB written to a reading peer");
+    Expect(sink.bytesWritten() == data.size(), "bytes counted");
+    sink.close();
+    consumer.join();
+    Expect(received == data, "reader got every byte in order");
+
+    // A peer that stops reading: the deadline bounds the wait
+    Expect(sink.open(ParseStreamTarget("unix:" + path), error), "reconnects");
+    int stalled = accept(listener, nullptr, nullptr);
+    sink.setDeadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(200));
+    auto start = std::chrono::steady_clock::now();
+    bool written = true;
+    for (int i = 0; i < 64 && written; ++i) {
+        written = sink.write(data.data(), data.size());
+    }
+    Expect(!written, "write fails once the socket stays full past the deadline");
+    Expect(SecondsSince(start) < 2.0, "the deadline bounds the wait");
+    Expect(!sink.error().empty(), "the failure is explained");
+
+    // cancel() from another thread releases a waiting write
+    Expect(sink.open(ParseStreamTarget("unix:" + path), error), "reconnects again");
+    int stalled_again = accept(listener, nullptr, nullptr);
+    std::thread canceller([&sink] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        sink.cancel();
+    });
+    start = std::chrono::steady_clock::now();
+    written = true;
+    for (int i = 0; i < 64 && written; ++i) {
+        written = sink.write(data.data(), data.size());
+    }
+    canceller.join();
+    Expect(!written && sink.error() == "cancelled", "cancel() fails a waiting write");
+    Expect(SecondsSince(start) < 2.0, "cancel() is prompt");
+
+    // The reader goes away
+    Expect(sink.open(ParseStreamTarget("unix:" + path), error), "connects a third time");
+    int leaving = accept(listener, nullptr, nullptr);
+    close(leaving);
+    written = true;
+    for (int i = 0; i < 64 && written; ++i) {
+        written = sink.write(data.data(), data.size());
+    }
+    Expect(!written && sink.error() == "the reader went away", "a closed reader fails the write");
+
+    sink.close();
+    close(stalled);
+    close(stalled_again);
+    close(reader);
+    close(listener);
+    unlink(path.c_str());
+}
+
+static void TestFifoAndFd() {
+    std::string fifo = "/tmp/stream_sink_test_" + std::to_string(getpid()) + ".fifo";
+    mkfifo(fifo.c_str(), 0600);
+
+    StreamSink sink;
+    std::string error;
+    Expect(!sink.open(ParseStreamTarget(fifo), error), "a FIFO without a reader fails at once");
+
+    int reader = open(fifo.c_str(), O_RDONLY | O_NONBLOCK);
+    Expect(sink.open(ParseStreamTarget(fifo), error), "opens a FIFO with a reader");
+    const uint8_t hello[] = "hello";
+    Expect(sink.write(hello, 5), "writes to the FIFO");
+    char buffer[8] = {};
+    Expect(read(reader, buffer, sizeof(buffer)) == 5 && std::memcmp(buffer, "hello", 5) == 0,
+           "reader gets the bytes");
+    close(reader);
+    Expect(!sink.write(hello, 5), "write fails once the FIFO reader is gone");
+    sink.close();
+    unlink(fifo.c_str());
+
+    int pipe_fds[2];
+    Expect(pipe(pipe_fds) == 0, "pipe");
+    Expect(sink.open(ParseStreamTarget("fd:" + std::to_string(pipe_fds[1])), error), "opens an inherited fd");
+    Expect(sink.write(hello, 5), "writes to the fd");
+    Expect(read(pipe_fds[0], buffer, sizeof(buffer)) == 5, "pipe reader gets the bytes");
+    sink.close();
+    Expect(fcntl(pipe_fds[1], F_GETFD) != -1, "closing the sink leaves the inherited fd open");
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    Expect(!sink.open(ParseStreamTarget("fd:" + std::to_string(pipe_fds[1])), error), "a closed fd fails");
+}
+
+int main() {
+    // As in Node: a pipe whose reader is gone fails writes with EPIPE
+    std::signal(SIGPIPE, SIG_IGN);
+
+    TestParse();
+    TestUnixSocket();
+    TestFifoAndFd();
+
+    if (failures) {
+        std::printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    std::printf("stream_sink_test: all passed\n");
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Checks the tracer: nothing is recorded while tracing is off, spans from
+// several threads are kept per thread and exported as Chrome trace JSON, full
+// buffers drop and count, and a new trace starts empty. Reports the cost of
+// a span with tracing off and on.
+#include "trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+static void Expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static size_t CountOf(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+static double NsPerSpan(uint32_t category, int count) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        TraceSpan span(category, "bench");
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+}
+
+static void TestDisabled() {
+    StartTrace(kTracePipeline, 16);
+    {
+        TraceSpan span(kTraceFrames, "frame");
+    }
+    StopTrace();
+    {
+        TraceSpan span(kTracePipeline, "after stop");
+    }
+    TraceStats stats = GetTraceStats();
+    Expect(!stats.active, "trace inactive after StopTrace");
+    Expect(stats.events == 0, "disabled categories record nothing");
+}
+
+static void TestThreadsAndExport(const std::string& path) {
+    const int threads = 4;
+    const int spans = 1000;
+    StartTrace(kTracePipeline | kTraceFrames, spans);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([t] {
+            std::string name = "worker " + std::to_string(t);
+            SetTraceThreadName(name.c_str());
+            for (int i = 0; i < spans; ++i) {
+                TraceSpan outer(kTraceFrames, "frame");
+                TraceSpan inner(kTraceFrames, "convert \"bgra\"");
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    TraceStats stats = GetTraceStats();
+    Expect(stats.active, "trace active while recording");
+    Expect(stats.threads == threads, "one buffer per recording thread");
+    Expect(stats.events == static_cast<uint64_t>(threads) * spans, "buffers keep spans up to their size");
+    Expect(stats.dropped == static_cast<uint64_t>(threads) * spans, "spans beyond the buffer are counted");
+
+    TraceStats written;
+    Expect(WriteTrace(path, &written), "trace written");
+    Expect(written.events == stats.events, "written event count matches");
+
+    std::ifstream file(path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string json = buffer.str();
+    Expect(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0, "Chrome trace header");
+    Expect(json.find("\n]}") != std::string::npos, "trace array closed");
+    Expect(CountOf(json, "\"ph\":\"X\"") == written.events, "one complete event per span");
+    Expect(CountOf(json, "\"thread_name\"") == static_cast<size_t>(threads), "one name per thread");
+    Expect(json.find("\"name\":\"worker 2\"") != std::string::npos, "thread names exported");
+    Expect(json.find("convert \\\"bgra\\\"") != std::string::npos, "names escaped");
+    Expect(json.find(",\n]") == std::string::npos, "no trailing comma");
+
+    // A new trace forgets the old spans
+    StartTrace(kTracePipeline, spans);
+    stats = GetTraceStats();
+    Expect(stats.events == 0 && stats.dropped == 0, "new trace starts empty");
+    StopTrace();
+    std::remove(path.c_str());
+}
+
+static void TestOverhead() {
+    const int count = 1000000;
+    StopTrace();
+    double off = NsPerSpan(kTraceFrames, count);
+
+    StartTrace(kTraceFrames, count);
+    double on = NsPerSpan(kTraceFrames, count);
+    StopTrace();
+    Expect(GetTraceStats().events == static_cast<uint64_t>(count), "every span recorded");
+
+    std::printf("%.2f ns per span with tracing off, %.1f ns with tracing on\n", off, on);
+}
+
+int main() {
+    TestDisabled();
+    TestThreadsAndExport("trace_test.json");
+    TestOverhead();
+
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,89 @@
+// Checks the VFR frame decisions: unchanged frames are dropped down to the
+// minimum rate, changes are encoded with their settle frames, and the frame
+// comparison finds a one-byte change anywhere in a plane.
+#include "vfr_gate.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static int failures = 0;
+
+static void Expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static void TestStaticFramesHitMinimumRate() {
+    // 30 fps canvas, 1 fps minimum
+    VfrGate gate(30);
+    int encoded = 0;
+    for (int64_t pts = 0; pts < 300; ++pts) {
+        encoded += gate.shouldEncode(false, pts);
+    }
+    // The first frame, then one per 30
+    Expect(encoded == 10, "static: one frame per max_gap");
+    Expect(gate.skipped() == 290, "static: the rest skipped");
+}
+
+static void TestChangesAreEncodedWithSettleFrames() {
+    VfrGate gate(30, 2);
+    gate.shouldEncode(false, 0);
+    Expect(!gate.shouldEncode(false, 1), "idle frame skipped");
+    Expect(gate.shouldEncode(true, 2), "changed frame encoded");
+    Expect(gate.shouldEncode(false, 3), "first settle frame encoded");
+    Expect(gate.shouldEncode(false, 4), "second settle frame encoded");
+    Expect(!gate.shouldEncode(false, 5), "idle again after settling");
+
+    // Continuous change keeps every frame
+    for (int64_t pts = 6; pts < 36; ++pts) {
+        Expect(gate.shouldEncode(true, pts), "moving content: every frame encoded");
+    }
+}
+
+static void TestMaxGapRestartsAfterChange() {
+    VfrGate gate(10, 0);
+    gate.shouldEncode(false, 0);
+    gate.shouldEncode(true, 7);
+    Expect(!gate.shouldEncode(false, 10), "gap counts from the last encoded frame");
+    Expect(gate.shouldEncode(false, 17), "gap reached");
+}
+
+static void TestPlaneChanged() {
+    const int width = 1920;
+    const int height = 1080;
+    const int stride = 2048;
+    std::vector<uint8_t> frame(static_cast<size_t>(stride) * height, 7);
+    std::vector<uint8_t> previous(static_cast<size_t>(width) * height, 0);
+
+    Expect(PlaneChanged(frame.data(), stride, previous.data(), width, height), "first frame differs");
+    Expect(!PlaneChanged(frame.data(), stride, previous.data(), width, height), "copy refreshed");
+
+    // Padding past the row width is ignored
+    frame[stride - 1] = 99;
+    Expect(!PlaneChanged(frame.data(), stride, previous.data(), width, height), "stride padding ignored");
+
+    frame[static_cast<size_t>(stride) * (height - 1) + width - 1] = 8;
+    Expect(PlaneChanged(frame.data(), stride, previous.data(), width, height), "last pixel change found");
+    Expect(!PlaneChanged(frame.data(), stride, previous.data(), width, height), "last pixel copied");
+
+    auto start = std::chrono::steady_clock::now();
+    const int kRuns = 200;
+    for (int i = 0; i < kRuns; ++i) {
+        PlaneChanged(frame.data(), stride, previous.data(), width, height);
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::printf("static 1080p luma compare: %.1f us per frame\n", us / kRuns);
+}
+
+int main() {
+    TestStaticFramesHitMinimumRate();
+    TestChangesAreEncodedWithSettleFrames();
+    TestMaxGapRestartsAfterChange();
+    TestPlaneChanged();
+
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+// Creates hundreds of windows on an X server (run under Xvfb) and times
+// EnumerateX11Windows with and without an EWMH client list.
+//
+//   xvfb-run -s "-screen 0 1920x1080x24" ./x11_enum_test [window_count]
+#include "x11_windows.h"
+
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static const int kSkip = 77; // ctest SKIP_RETURN_CODE
+
+static double TimeEnumeration(size_t& found, int iterations) {
+    double best_ms = 1e9;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<WindowInfo> windows = EnumerateX11Windows();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        found = windows.size();
+        if (ms < best_ms) {
+            best_ms = ms;
+        }
+    }
+    return best_ms;
+}
+
+int main(int argc, char** argv) {
+    const int count = argc > 1 ? std::atoi(argv[1]) : 500;
+
+    Display* display = XOpenDisplay(nullptr);
+    if (!display) {
+        std::printf("SKIP: no X display (run under xvfb-run)\n");
+        return kSkip;
+    }
+
+    Window root = DefaultRootWindow(display);
+    Atom net_wm_name = XInternAtom(display, "_NET_WM_NAME", False);
+    Atom utf8_string = XInternAtom(display, "UTF8_STRING", False);
+    Atom net_client_list = XInternAtom(display, "_NET_CLIENT_LIST", False);
+
+    std::vector<Window> created;
+    for (int i = 0; i < count; ++i) {
+        Window window = XCreateSimpleWindow(display, root, (i * 7) % 1800, (i * 5) % 1000,
+                                            100 + i % 50, 80 + i % 30, 0, 0, 0);
+        std::string title = "Test Window " + std::to_string(i);
+        XStoreName(display, window, title.c_str());
+        XChangeProperty(display, window, net_wm_name, utf8_string, 8, PropModeReplace,
+                        reinterpret_cast<const unsigned char*>(title.c_str()), title.size());
+        XClassHint hint;
+        std::string res_name = "instance" + std::to_string(i);
+        hint.res_name = const_cast<char*>(res_name.c_str());
+        hint.res_class = const_cast<char*>("EnumTest");
+        XSetClassHint(display, window, &hint);
+        XMapWindow(display, window);
+        created.push_back(window);
+    }
+    XSync(display, False);
+
+    int failures = 0;
+    size_t found = 0;
+
+    // Without a window manager the root children are used
+    XDeleteProperty(display, root, net_client_list);
+    XSync(display, False);
+    double tree_ms = TimeEnumeration(found, 5);
+    std::printf("query-tree fallback: %zu windows in %.2f ms\n", found, tree_ms);
+    if (found < static_cast<size_t>(count)) {
+        failures++;
+    }
+
+    // With an EWMH client list, as a window manager would publish it
+    XChangeProperty(display, root, net_client_list, XA_WINDOW, 32, PropModeReplace,
+                    reinterpret_cast<const unsigned char*>(created.data()), created.size());
+    XSync(display, False);
+    double list_ms = TimeEnumeration(found, 5);
+    std::printf("_NET_CLIENT_LIST:    %zu windows in %.2f ms\n", found, list_ms);
+    if (found != static_cast<size_t>(count)) {
+        failures++;
+    }
+
+    std::vector<WindowInfo> windows = EnumerateX11Windows();
+    for (const WindowInfo& info : windows) {
+        if (info.owner != "EnumTest" || info.name.rfind("Test Window ", 0) != 0) {
+            std::printf("unexpected window: '%s' owned by '%s'\n", info.name.c_str(), info.owner.c_str());
+            failures++;
+            break;
+        }
+    }
+
+    XDeleteProperty(display, root, net_client_list);
+    XCloseDisplay(display);
+
+    std::printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+// Grabs a window of known colour through X11Screenshot (root rectangle,
+// window drawable, clipped region, vanished window), checks the compressed
+// forms, and times full-screen grabs and compression.
+//
+//   xvfb-run -s "-screen 0 3840x2160x24" ./x11_screenshot_test
+#include "image_codec.h"
+#include "x11_screenshot.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#ifdef HAVE_PNG
+#include <png.h>
+#endif
+
+static const int kSkip = 77; // ctest SKIP_RETURN_CODE
+
+static int failures = 0;
+
+static void Expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static bool PixelIs(const std::vector<uint8_t>& pixels, size_t index, uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    const uint8_t* p = &pixels[index * 4];
+    return p[0] == a && p[1] == b && p[2] == c && p[3] == d;
+}
+
+template <typename Fn>
+static double TimeMs(int runs, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; ++i) {
+        fn();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+}
+
+static void TestCodecs(const std::vector<uint8_t>& bgra, int width, int height) {
+    std::vector<uint8_t> png;
+    if (EncodePng(bgra.data(), width, height, FrameFormat::BGRA, png)) {
+        Expect(png.size() > 8 && png[1] == 'P' && png[2] == 'N' && png[3] == 'G', "png signature");
+#ifdef HAVE_PNG
+        png_image image = {};
+        image.version = PNG_IMAGE_VERSION;
+        Expect(png_image_begin_read_from_memory(&image, png.data(), png.size()) != 0, "png readable");
+        image.format = PNG_FORMAT_BGRA;
+        std::vector<uint8_t> decoded(PNG_IMAGE_SIZE(image));
+        Expect(png_image_finish_read(&image, nullptr, decoded.data(), 0, nullptr) != 0, "png decodes");
+        Expect(decoded == bgra, "png round trip is lossless");
+#endif
+    } else {
+        std::printf("png: not built\n");
+    }
+
+    std::vector<uint8_t> jpeg;
+    if (EncodeJpeg(bgra.data(), width, height, FrameFormat::BGRA, 90, jpeg)) {
+        Expect(jpeg.size() > 2 && jpeg[0] == 0xFF && jpeg[1] == 0xD8, "jpeg start of image");
+    } else {
+        std::printf("jpeg: not built\n");
+    }
+}
+
+int main() {
+    Display* display = XOpenDisplay(nullptr);
+    if (!display) {
+        std::printf("SKIP: no X display (run under xvfb-run)\n");
+        return kSkip;
+    }
+
+    // Pure red, placed directly (override-redirect) so no window manager moves it
+    XSetWindowAttributes attributes = {};
+    attributes.override_redirect = True;
+    attributes.background_pixel = 0xFF0000;
+    Window window = XCreateWindow(display, DefaultRootWindow(display), 50, 60, 200, 100, 0, CopyFromParent,
+                                  InputOutput, CopyFromParent, CWOverrideRedirect | CWBackPixel, &attributes);
+    XMapWindow(display, window);
+    XSync(display, False);
+
+    X11Screenshot grabber;
+    if (!grabber.open()) {
+        std::printf("FAIL: open\n");
+        return 1;
+    }
+    std::printf("MIT-SHM: %s\n", grabber.usesShm() ? "yes" : "no");
+
+    std::vector<uint8_t> pixels;
+    int width = 0;
+    int height = 0;
+
+    Expect(grabber.grab(0, 50, 60, 200, 100, FrameFormat::BGRA, pixels, width, height), "root rectangle");
+    Expect(width == 200 && height == 100, "root rectangle size");
+    Expect(PixelIs(pixels, 0, 0, 0, 255, 255) && PixelIs(pixels, 200 * 100 - 1, 0, 0, 255, 255), "bgra red, opaque");
+
+    Expect(grabber.grab(window, 0, 0, 0, 0, FrameFormat::RGBA, pixels, width, height), "window drawable");
+    Expect(width == 200 && height == 100, "whole window size");
+    Expect(PixelIs(pixels, 0, 255, 0, 0, 255), "rgba red, opaque");
+
+    Expect(grabber.grab(window, 150, 50, 100, 100, FrameFormat::BGRA, pixels, width, height), "clipped region");
+    Expect(width == 50 && height == 50, "region clipped to the window");
+    TestCodecs(pixels, width, height);
+
+    XDestroyWindow(display, window);
+    XSync(display, False);
+    Expect(!grabber.grab(window, 0, 0, 0, 0, FrameFormat::BGRA, pixels, width, height), "destroyed window fails");
+    Expect(grabber.grab(0, 0, 0, 16, 16, FrameFormat::BGRA, pixels, width, height), "grabs continue after an error");
+
+    // Full screen, then 1080p when the screen is larger
+    Screen* screen = DefaultScreenOfDisplay(display);
+    struct Size { int width, height; } sizes[] = {
+        {WidthOfScreen(screen), HeightOfScreen(screen)}, {1920, 1080}};
+    for (const Size& size : sizes) {
+        if (size.width > WidthOfScreen(screen) || size.height > HeightOfScreen(screen)) {
+            continue;
+        }
+        const int runs = 20;
+        double grab_ms = TimeMs(runs, [&] {
+            grabber.grab(0, 0, 0, size.width, size.height, FrameFormat::BGRA, pixels, width, height);
+        });
+        std::vector<uint8_t> encoded;
+        double png_ms = TimeMs(5, [&] { EncodePng(pixels.data(), width, height, FrameFormat::BGRA, encoded); });
+        double jpeg_ms = TimeMs(5, [&] { EncodeJpeg(pixels.data(), width, height, FrameFormat::BGRA, 90, encoded); });
+        std::printf("%dx%d: grab %.2f ms (%.0f/s), png %.1f ms, jpeg %.1f ms\n",
+                    size.width, size.height, grab_ms, 1000.0 / grab_ms, png_ms, jpeg_ms);
+    }
+
+    XCloseDisplay(display);
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
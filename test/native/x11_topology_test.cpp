@@ -0,0 +1,112 @@
+// Checks that X11Topology serves repeated queries from its cache and that
+// creating or renaming a window invalidates the window list.
+//
+//   xvfb-run -s "-screen 0 1920x1080x24" ./x11_topology_test
+#include "x11_topology.h"
+
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+
+static const int kSkip = 77; // ctest SKIP_RETURN_CODE
+
+struct ChangeCounter {
+    std::mutex mutex;
+    std::condition_variable cv;
+    int windows = 0;
+
+    bool waitForWindows(int expected) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::seconds(2), [&] { return windows >= expected; });
+    }
+};
+
+template <typename F>
+static double MicrosPerCall(F fn, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+int main() {
+    Display* display = XOpenDisplay(nullptr);
+    if (!display) {
+        std::printf("SKIP: no X display (run under xvfb-run)\n");
+        return kSkip;
+    }
+
+    X11Topology topology;
+    if (!topology.start()) {
+        std::printf("FAIL: topology did not start\n");
+        return 1;
+    }
+
+    ChangeCounter changes;
+    topology.setChangeCallback([&](int kinds) {
+        if (kinds & X11Topology::WINDOWS) {
+            std::lock_guard<std::mutex> lock(changes.mutex);
+            changes.windows++;
+            changes.cv.notify_all();
+        }
+    });
+
+    double cold_us = MicrosPerCall([&] { topology.getWindows(); }, 1);
+    double warm_us = MicrosPerCall([&] { topology.getWindows(); }, 1000);
+    double displays_us = MicrosPerCall([&] { topology.getDisplays(); }, 1000);
+    size_t before = topology.getWindows().size();
+    std::printf("getWindows: cold %.1f us, cached %.2f us; getDisplays cached %.2f us\n",
+                cold_us, warm_us, displays_us);
+
+    int failures = 0;
+
+    Window window = XCreateSimpleWindow(display, DefaultRootWindow(display), 10, 10, 200, 100, 0, 0, 0);
+    XStoreName(display, window, "Topology Test");
+    XMapWindow(display, window);
+    XSync(display, False);
+
+    if (!changes.waitForWindows(1)) {
+        std::printf("FAIL: no window change notification after map\n");
+        failures++;
+    }
+    size_t after = topology.getWindows().size();
+    if (after != before + 1) {
+        std::printf("FAIL: expected %zu windows after map, got %zu\n", before + 1, after);
+        failures++;
+    }
+
+    int seen = 0;
+    {
+        std::lock_guard<std::mutex> lock(changes.mutex);
+        seen = changes.windows;
+    }
+    XStoreName(display, window, "Topology Test Renamed");
+    XSync(display, False);
+    if (!changes.waitForWindows(seen + 1)) {
+        std::printf("FAIL: no window change notification after rename\n");
+        failures++;
+    }
+
+    bool renamed = false;
+    for (const WindowInfo& info : topology.getWindows()) {
+        if (info.id == window && info.name == "Topology Test Renamed") {
+            renamed = true;
+        }
+    }
+    if (!renamed) {
+        std::printf("FAIL: cached window list still has the old title\n");
+        failures++;
+    }
+
+    topology.setChangeCallback(nullptr);
+    topology.stop();
+    XDestroyWindow(display, window);
+    XCloseDisplay(display);
+
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
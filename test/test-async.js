@@ -0,0 +1,101 @@
+const obs = require('..');
+const path = require('path');
+const fs = require('fs');
+const { monitorEventLoopDelay } = require('perf_hooks');
+
+console.log('⏱️ Testing async API event-loop impact');
+
+// Runs `fn` while sampling event-loop delay and returns the worst lag seen (ms)
+async function measureLag(label, fn) {
+    const histogram = monitorEventLoopDelay({ resolution: 5 });
+    histogram.enable();
+    const started = process.hrtime.bigint();
+    const result = await fn();
+    const elapsedMs = Number(process.hrtime.bigint() - started) / 1e6;
+    // Let the monitor take at least one more sample after the call returns
+    await new Promise(resolve => setTimeout(resolve, 20));
+    histogram.disable();
+
+    const maxLagMs = histogram.max / 1e6;
+    console.log(`   ${label}: ${elapsedMs.toFixed(1)} ms wall, max event-loop lag ${maxLagMs.toFixed(1)} ms`);
+    return { result, elapsedMs, maxLagMs };
+}
+
+async function runTests() {
+    const outputPath = path.join(__dirname, 'test-async-recording.mp4');
+    const results = {};
+
+    try {
+        console.log('\n1️⃣ Async initialization...');
+        results.init = await measureLag('initAsync', () => obs.initAsync());
+        if (!results.init.result) {
+            throw new Error('Failed to initialize OBS');
+        }
+
+        console.log('\n2️⃣ Async enumeration...');
+        const displays = (await measureLag('listDisplaysAsync', () => obs.listDisplaysAsync())).result;
+        await measureLag('listWindowsAsync', () => obs.listWindowsAsync());
+
+        console.log('\n3️⃣ Async start/stop...');
+        if (fs.existsSync(outputPath)) {
+            fs.unlinkSync(outputPath);
+        }
+        results.start = await measureLag('startRecordingAsync', () => obs.startRecordingAsync(outputPath, {
+            width: 1280,
+            height: 720,
+            fps: 30,
+            displayId: displays[0] ? displays[0].id : '',
+            capture_audio: false
+        }));
+        await new Promise(resolve => setTimeout(resolve, 2000));
+        results.stop = await measureLag('stopRecordingAsync', () => obs.stopRecordingAsync());
+
+        console.log('\n4️⃣ Call ordering without awaiting...');
+        const ordered = await Promise.all([
+            obs.startRecordingAsync(outputPath, { displayId: displays[0] ? displays[0].id : '', capture_audio: false }),
+            obs.stopRecordingAsync()
+        ]);
+        console.log('   ✅ start/stop settled in order:', ordered[0]);
+
+        console.log('\n5️⃣ Bad configs settle instead of crashing...');
+        // An unknown display id fails on the control thread; the process must
+        // survive and the Promise settle (false, or rejected with the error)
+        const bad = await obs.startRecordingAsync(outputPath, { displayId: 'not-a-display', capture_audio: false })
+            .then(value => ({ value }), error => ({ error }));
+        if (bad.error) {
+            console.log(`   ✅ rejected: ${bad.error.message}`);
+        } else if (bad.value === false) {
+            console.log('   ✅ resolved false');
+        } else {
+            throw new Error('A recording started with an invalid display id');
+        }
+        // Without displayId the first display is used
+        const defaulted = await obs.prepareAsync({ capture_audio: false })
+            .then(value => ({ value }), error => ({ error }));
+        console.log(`   prepareAsync without displayId: ${defaulted.error ? defaulted.error.message : defaulted.value}`);
+        // The control thread is still serving calls
+        await obs.stopRecordingAsync();
+
+        // The control thread does the blocking work; the loop should only ever
+        // see scheduling jitter, not the duration of the OBS call itself.
+        const budgetMs = 50;
+        for (const [name, sample] of Object.entries(results)) {
+            if (sample.maxLagMs > budgetMs) {
+                throw new Error(`${name} blocked the event loop for ${sample.maxLagMs.toFixed(1)} ms`);
+            }
+        }
+
+        console.log('\n✅ Async API kept event-loop lag under', budgetMs, 'ms');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        await obs.shutdownAsync();
+        if (fs.existsSync(outputPath)) {
+            fs.unlinkSync(outputPath);
+        }
+        console.log('🔄 OBS shutdown complete');
+    }
+}
+
+runTests();
@@ -0,0 +1,83 @@
+const obs = require('..');
+
+console.log('🔊 Testing audio tap and meter');
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+// Process CPU time over `ms`, as a share of one core
+async function cpuShare(ms) {
+    const start = process.cpuUsage();
+    await sleep(ms);
+    const used = process.cpuUsage(start);
+    return (used.user + used.system) / 1000 / ms;
+}
+
+async function runTests() {
+    let tapId = -1;
+
+    try {
+        console.log('\n1️⃣ Initializing OBS at 48 kHz...');
+        if (!obs.init({ sampleRate: 48000 })) {
+            throw new Error('Failed to initialize OBS');
+        }
+        const idle = await cpuShare(2000);
+
+        console.log('\n2️⃣ Receiving PCM blocks for 3 seconds...');
+        let blocks = 0;
+        let frames = 0;
+        let format = null;
+        tapId = obs.onAudio(block => {
+            blocks++;
+            frames += block.frames;
+            format = `${block.channels.length} ch @ ${block.sampleRate} Hz`;
+            if (block.channels.some(channel => channel.length !== block.frames)) {
+                throw new Error('Channel length does not match frames');
+            }
+        });
+        await sleep(3000);
+
+        const stats = obs.getAudioTapStats(tapId);
+        console.log(`   📊 ${blocks} blocks (${format}), ${frames} frames, ${stats.dropped} dropped`);
+        if (blocks === 0) {
+            throw new Error('No audio delivered');
+        }
+        if (!format.endsWith('@ 48000 Hz')) {
+            throw new Error(`Expected the 48 kHz mix, got ${format}`);
+        }
+        obs.offAudio(tapId);
+        tapId = -1;
+
+        console.log('\n3️⃣ Metering for 3.5 seconds...');
+        obs.startAudioMeter();
+        const metered = await cpuShare(3500);
+        const levels = obs.getAudioLevels();
+        if (!levels || levels.blocks < 30) {
+            throw new Error('Meter produced no levels');
+        }
+        console.log(`   🎚️ momentary ${levels.momentaryLufs.toFixed(1)} LUFS, ` +
+                    `short-term ${levels.shortTermLufs.toFixed(1)} LUFS, ` +
+                    `peaks ${levels.channels.map(c => c.peakDb.toFixed(1)).join(' / ')} dBFS`);
+        console.log(`   ⏱️ Process CPU idle ${(idle * 100).toFixed(2)}%, metering ${(metered * 100).toFixed(2)}% of a core`);
+        obs.stopAudioMeter();
+        if (obs.getAudioLevels() !== null) {
+            throw new Error('Levels reported after stopAudioMeter');
+        }
+
+        console.log('\n4️⃣ Muting system audio...');
+        obs.setSystemAudioEnabled(false);
+        obs.setSystemAudioEnabled(true);
+
+        console.log('\n✅ Audio test completed successfully!');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        if (tapId >= 0) {
+            obs.offAudio(tapId);
+        }
+        obs.shutdown();
+        console.log('🔄 OBS shutdown complete');
+    }
+}
+
+runTests();
@@ -0,0 +1,99 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const obs = require('..');
+
+console.log('📣 Testing output lifecycle events');
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+// Resolves with the next `type` event of the recording, or null after `ms`
+function nextEvent(type, ms) {
+    return new Promise(resolve => {
+        const timer = setTimeout(() => {
+            obs.outputEvents.off(type, listener);
+            resolve(null);
+        }, ms);
+        function listener(event) {
+            if (event.output !== 'recording') {
+                return;
+            }
+            clearTimeout(timer);
+            obs.outputEvents.off(type, listener);
+            resolve(event);
+        }
+        obs.outputEvents.on(type, listener);
+    });
+}
+
+async function runTests() {
+    const outputPath = path.join(os.tmpdir(), `obs-events-${process.pid}.mp4`);
+
+    try {
+        console.log('\n1️⃣ Initializing OBS...');
+        if (!obs.init()) {
+            throw new Error('Failed to initialize OBS');
+        }
+        const displays = obs.listDisplays();
+        const config = { displayId: displays[0] ? displays[0].id : '', fps: 30, capture_audio: false };
+
+        console.log('\n2️⃣ Recording: start event instead of polling...');
+        const started = nextEvent('start', 5000);
+        const requested = process.hrtime.bigint();
+        if (!obs.startRecording(outputPath, config)) {
+            throw new Error('Failed to start recording');
+        }
+        const start = await started;
+        if (!start) {
+            throw new Error('No start event');
+        }
+        console.log(`   ⏱️ start event ${(Number(process.hrtime.bigint() - requested) / 1e6).toFixed(1)} ms after startRecording`);
+        if (!obs.isRecording()) {
+            throw new Error('isRecording() false after the start event');
+        }
+
+        await sleep(1000);
+        const stopped = nextEvent('stop', 10000);
+        obs.stopRecording();
+        const stop = await stopped;
+        if (!stop || stop.reason !== 'success') {
+            throw new Error(`Expected a clean stop, got ${stop ? stop.reason : 'nothing'}`);
+        }
+        if (obs.isRecording()) {
+            throw new Error('isRecording() true after the stop event');
+        }
+        console.log(`   📼 stopped: code ${stop.code} (${stop.reason})`);
+
+        console.log('\n3️⃣ Output failing on its own...');
+        const failed = nextEvent('stop', 10000);
+        if (obs.startRecording('/nonexistent-dir/obs-events.mp4', config)) {
+            const failure = await failed;
+            if (!failure || failure.code === 0) {
+                throw new Error('No failure reported for an unwritable path');
+            }
+            console.log(`   💥 stop: ${failure.reason} (${failure.error || 'no message'})`);
+            if (obs.isRecording()) {
+                throw new Error('isRecording() still true after the output failed');
+            }
+        } else {
+            console.log('   ℹ️ Rejected synchronously by startRecording');
+        }
+
+        // A failed recording does not block the next one
+        if (!obs.startRecording(outputPath, config)) {
+            throw new Error('Could not record again after a failure');
+        }
+        obs.stopRecording();
+
+        console.log('\n✅ Events test completed successfully!');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        obs.shutdown();
+        console.log('🔄 OBS shutdown complete');
+        fs.rmSync(outputPath, { force: true });
+    }
+}
+
+runTests();
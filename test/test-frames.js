@@ -0,0 +1,55 @@
+const obs = require('..');
+
+console.log('🎞️ Testing raw frame tap');
+
+async function runTests() {
+    let tapId = -1;
+
+    try {
+        console.log('\n1️⃣ Initializing OBS...');
+        if (!obs.init()) {
+            throw new Error('Failed to initialize OBS');
+        }
+
+        console.log('\n2️⃣ Subscribing to 640x360 BGRA frames at 15 fps...');
+        let frames = 0;
+        let slowFrames = 0;
+        tapId = obs.onFrame(frame => {
+            frames++;
+            if (frame.data.byteLength !== frame.width * frame.height * 4) {
+                throw new Error(`Unexpected frame size ${frame.data.byteLength}`);
+            }
+            // Simulate a consumer that is too slow for every third frame
+            if (frames % 3 === 0) {
+                slowFrames++;
+                const until = Date.now() + 150;
+                while (Date.now() < until) {}
+            }
+        }, { format: 'bgra', width: 640, height: 360, maxFps: 15 });
+
+        await new Promise(resolve => setTimeout(resolve, 3000));
+
+        const stats = obs.getFrameTapStats(tapId);
+        console.log(`   📊 Received ${frames} frames, ${stats.dropped} dropped (${slowFrames} slow callbacks)`);
+
+        if (frames === 0) {
+            throw new Error('No frames delivered');
+        }
+        if (stats.delivered !== frames) {
+            throw new Error(`Stats mismatch: ${stats.delivered} vs ${frames}`);
+        }
+
+        console.log('\n✅ Frame tap test completed successfully!');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        if (tapId >= 0) {
+            obs.offFrame(tapId);
+        }
+        obs.shutdown();
+        console.log('🔄 OBS shutdown complete');
+    }
+}
+
+runTests();
@@ -0,0 +1,118 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const obs = require('..');
+
+console.log('🧠 Testing the low-memory profile');
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+const mb = bytes => (bytes / (1024 * 1024)).toFixed(1);
+
+// RSS ceiling for the low-memory profile: libobs, its modules and a 1080p
+// canvas with the profile's buffers, plus headroom for Node
+const DEFAULT_RSS_CEILING_MB = 512;
+
+// Records with a frame tap, an audio tap and a replay buffer for
+// OBS_TEST_DURATION_MS, sampling RSS; fails if RSS ever exceeds
+// OBS_TEST_RSS_MB (default DEFAULT_RSS_CEILING_MB). Run long (e.g. an hour)
+// to catch slow growth.
+async function runTests() {
+    const duration = Number(process.env.OBS_TEST_DURATION_MS || 30000);
+    const ceilingMb = Number(process.env.OBS_TEST_RSS_MB || DEFAULT_RSS_CEILING_MB);
+    const outputPath = path.join(os.tmpdir(), `obs-memory-${process.pid}.mp4`);
+    let frameTap = null;
+    let audioTap = null;
+
+    try {
+        if (!(ceilingMb > 0)) {
+            throw new Error(`OBS_TEST_RSS_MB must be a positive number of MB, got "${process.env.OBS_TEST_RSS_MB}"`);
+        }
+        console.log(`   RSS ceiling: ${ceilingMb} MB`);
+
+        console.log('\n1️⃣ Initializing OBS with lowMemory...');
+        if (!obs.init({ lowMemory: true })) {
+            throw new Error('Failed to initialize OBS');
+        }
+        const baseline = obs.getMemoryStats();
+        if (!baseline.lowMemory) {
+            throw new Error('getMemoryStats() does not report the low-memory profile');
+        }
+        console.log(`   📊 RSS ${mb(baseline.rss)} MB after init, ${mb(baseline.total)} MB accounted`);
+
+        console.log('\n2️⃣ Recording with taps attached...');
+        const displays = obs.listDisplays();
+        const config = { displayId: displays[0] ? displays[0].id : '', fps: 30, capture_audio: true };
+        let frames = 0;
+        frameTap = obs.onFrame(() => frames++, { width: 320, height: 180, format: 'i420' });
+        audioTap = obs.onAudio(() => {});
+        if (!obs.startRecording(outputPath, config)) {
+            throw new Error('Failed to start recording');
+        }
+        // Held in memory; the profile caps it below maxSizeMb
+        const replay = obs.startReplayBuffer({ ...config, maxSeconds: 30, maxSizeMb: 512 });
+
+        let peakRss = 0;
+        let peak = null;
+        const samples = [];
+        const deadline = Date.now() + duration;
+        while (Date.now() < deadline) {
+            await sleep(1000);
+            const stats = obs.getMemoryStats();
+            samples.push(stats.rss);
+            if (stats.rss > peakRss) {
+                peakRss = stats.rss;
+                peak = stats;
+            }
+            if (stats.rss > ceilingMb * 1024 * 1024) {
+                throw new Error(`RSS ${mb(stats.rss)} MB exceeds the ${ceilingMb} MB ceiling`);
+            }
+        }
+
+        if (replay) {
+            obs.stopReplayBuffer();
+        }
+        obs.stopRecording();
+
+        console.log(`   🎞️ ${frames} tapped frames, ${obs.getStats().frames.dropped} packets dropped`);
+        console.log(`   📈 peak RSS ${mb(peakRss)} MB (process.memoryUsage ${mb(process.memoryUsage().rss)} MB now)`);
+        for (const [stage, bytes] of Object.entries(peak ? peak.stages : {})) {
+            console.log(`      ${stage.padEnd(12)} ${mb(bytes)} MB`);
+        }
+
+        // Growth between the first and last quarter of the run hints at a leak
+        const quarter = Math.max(1, Math.floor(samples.length / 4));
+        const average = list => list.reduce((sum, value) => sum + value, 0) / list.length;
+        const growth = average(samples.slice(-quarter)) - average(samples.slice(0, quarter));
+        console.log(`   ↗️ RSS growth over the run: ${mb(growth)} MB`);
+
+        console.log('\n3️⃣ Buffers released after stopping...');
+        obs.offFrame(frameTap);
+        frameTap = null;
+        if (audioTap !== null) {
+            obs.offAudio(audioTap);
+            audioTap = null;
+        }
+        // Tap buffers may still be referenced from JS until collected
+        const after = obs.getMemoryStats();
+        if (after.stages.capture || after.stages.packets || after.stages.encoder) {
+            throw new Error(`Buffers still accounted after stopping: ${JSON.stringify(after.stages)}`);
+        }
+
+        console.log('\n✅ Memory test completed successfully!');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        if (frameTap !== null) {
+            obs.offFrame(frameTap);
+        }
+        if (audioTap !== null) {
+            obs.offAudio(audioTap);
+        }
+        obs.shutdown();
+        console.log('🔄 OBS shutdown complete');
+        fs.rmSync(outputPath, { force: true });
+    }
+}
+
+runTests();
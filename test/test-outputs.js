@@ -0,0 +1,171 @@
+const obs = require('..');
+const path = require('path');
+const fs = require('fs');
+const { execFileSync } = require('child_process');
+
+console.log('🔀 Testing encode-once fan-out to multiple outputs');
+
+function sleep(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+// CPU cores used by the process while `names` are written for `seconds`
+async function measure(names, seconds) {
+    names.forEach(name => {
+        if (!obs.startOutput(name)) {
+            throw new Error(`Failed to start output ${name}`);
+        }
+    });
+    await sleep(1000);
+    const cpuBefore = process.cpuUsage();
+    const wallBefore = process.hrtime.bigint();
+    await sleep(seconds * 1000);
+    const cpu = process.cpuUsage(cpuBefore);
+    const wallSeconds = Number(process.hrtime.bigint() - wallBefore) / 1e9;
+    names.forEach(name => obs.stopOutput(name));
+    await sleep(500);
+    return (cpu.user + cpu.system) / 1e6 / wallSeconds;
+}
+
+// One output writes into a FIFO whose reader never reads: once the pipe
+// is full it must only drop its own packets while the others keep going
+async function testStalledOutput(directory) {
+    console.log('\n5️⃣ One stalled output next to two healthy ones...');
+    const fifo = path.join(directory, 'stalled.fifo');
+    execFileSync('mkfifo', [fifo]);
+    // Opened for reading (so the writer can connect) and never read
+    const reader = fs.openSync(fifo, fs.constants.O_RDONLY | fs.constants.O_NONBLOCK);
+
+    try {
+        const added = [
+            obs.addOutput('stalled', { type: 'file', path: fifo }),
+            obs.addOutput('healthy', { type: 'file', path: path.join(directory, 'healthy.mkv') }),
+            obs.addOutput('healthy-chunks', { type: 'segments', path: path.join(directory, 'healthy-chunks'), segmentSeconds: 2 })
+        ];
+        if (added.includes(false)) {
+            throw new Error('Failed to add outputs');
+        }
+        ['stalled', 'healthy', 'healthy-chunks'].forEach(name => {
+            if (!obs.startOutput(name)) {
+                throw new Error(`Failed to start output ${name}`);
+            }
+        });
+
+        // Long enough for the pipe and then the stalled writer's queue to fill
+        await sleep(3000);
+        const byName = () => Object.fromEntries(obs.listOutputs().map(output => [output.name, output]));
+        const before = byName();
+        await sleep(3000);
+        const after = byName();
+
+        Object.values(after).forEach(output => {
+            console.log(`   ${output.name.padEnd(14)} ${output.frames} frames, ` +
+                        `${output.droppedFrames} dropped, ${output.bytesWritten} bytes`);
+        });
+        if (after.stalled.droppedFrames === 0) {
+            throw new Error('The stalled output dropped nothing; was its reader draining the FIFO?');
+        }
+        ['healthy', 'healthy-chunks'].forEach(name => {
+            // 3 s at 30 fps, with generous slack for a loaded machine
+            const frames = after[name].frames - before[name].frames;
+            if (frames < 45) {
+                throw new Error(`Output ${name} got only ${frames} frames while another output was stalled`);
+            }
+            if (after[name].droppedFrames !== 0) {
+                throw new Error(`Output ${name} dropped frames because of another output`);
+            }
+            if (after[name].bytesWritten <= before[name].bytesWritten) {
+                throw new Error(`Output ${name} stopped writing while another output was stalled`);
+            }
+        });
+
+        // Stopping a stalled output is bounded too
+        const stopStart = Date.now();
+        obs.stopOutput('stalled');
+        console.log(`   Stalled output stopped in ${Date.now() - stopStart} ms`);
+        ['stalled', 'healthy', 'healthy-chunks'].forEach(name => obs.removeOutput(name));
+    } finally {
+        fs.closeSync(reader);
+    }
+}
+
+async function runTests() {
+    const directory = path.join(__dirname, 'test-outputs');
+    fs.rmSync(directory, { recursive: true, force: true });
+    fs.mkdirSync(directory);
+
+    try {
+        console.log('\n1️⃣ Initializing OBS and preparing the pipeline...');
+        if (!obs.init({ modules: 'required', captureAudio: false })) {
+            throw new Error('Failed to initialize OBS');
+        }
+        const displays = obs.listDisplays();
+        if (!obs.prepare({
+            width: 1280,
+            height: 720,
+            fps: 30,
+            displayId: displays[0] ? displays[0].id : '',
+            capture_audio: false
+        })) {
+            throw new Error('Failed to prepare pipeline');
+        }
+
+        console.log('\n2️⃣ Adding outputs...');
+        const added = [
+            obs.addOutput('single', { type: 'file', path: path.join(directory, 'single.mkv') }),
+            obs.addOutput('a', { type: 'file', path: path.join(directory, 'a.mkv') }),
+            obs.addOutput('b', { type: 'file', path: path.join(directory, 'b.mp4') }),
+            obs.addOutput('c', { type: 'segments', path: path.join(directory, 'chunks'), segmentSeconds: 2 })
+        ];
+        if (added.includes(false)) {
+            throw new Error('Failed to add outputs');
+        }
+        if (obs.addOutput('a', { type: 'file', path: path.join(directory, 'dup.mkv') })) {
+            throw new Error('Duplicate output name was accepted');
+        }
+
+        console.log('\n3️⃣ One output for 4 seconds...');
+        const single = await measure(['single'], 4);
+        console.log(`   ${single.toFixed(2)} cores`);
+
+        console.log('\n4️⃣ Three outputs for 4 seconds...');
+        const fanOut = await measure(['a', 'b', 'c'], 4);
+        console.log(`   ${fanOut.toFixed(2)} cores`);
+
+        const outputs = obs.listOutputs();
+        outputs.forEach(output => {
+            console.log(`   ${output.name.padEnd(7)} ${output.type.padEnd(9)} ` +
+                        `${output.frames} frames, ${output.droppedFrames} dropped, ${output.bytesWritten} bytes`);
+            if (output.frames === 0 || output.bytesWritten === 0) {
+                throw new Error(`Output ${output.name} wrote nothing`);
+            }
+        });
+
+        // Encoding dominates; muxing two more copies should cost a fraction of it
+        console.log(`\n📊 Three outputs cost ${(fanOut / single).toFixed(2)}x one output`);
+        if (fanOut > single * 1.5) {
+            throw new Error('Extra outputs appear to re-encode');
+        }
+
+        outputs.forEach(output => obs.removeOutput(output.name));
+
+        if (process.platform !== 'win32') {
+            await testStalledOutput(directory);
+        }
+
+        if (obs.listOutputs().length !== 0) {
+            throw new Error('Outputs left after removeOutput');
+        }
+
+        console.log('\n✅ Multiple outputs test passed');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        obs.shutdown();
+        fs.rmSync(directory, { recursive: true, force: true });
+        console.log('🔄 OBS shutdown complete');
+    }
+}
+
+runTests();
@@ -0,0 +1,101 @@
+const obs = require('..');
+const path = require('path');
+const fs = require('fs');
+
+console.log('⏪ Testing replay buffer');
+
+async function waitForFile(file, timeoutMs) {
+    const deadline = Date.now() + timeoutMs;
+    while (Date.now() < deadline) {
+        if (fs.existsSync(file) && fs.statSync(file).size > 0) {
+            return true;
+        }
+        await new Promise(resolve => setTimeout(resolve, 100));
+    }
+    return false;
+}
+
+async function runTests() {
+    const saves = [
+        path.join(__dirname, 'test-replay-1.mp4'),
+        path.join(__dirname, 'test-replay-2.mp4')
+    ];
+    // Saved by name relative to the working directory, and a name that
+    // looks like a filename template; both must land exactly there
+    process.chdir(__dirname);
+    const literal = [
+        { request: 'test-replay-relative.mp4', file: path.join(__dirname, 'test-replay-relative.mp4') },
+        { request: path.join(__dirname, 'test-replay-100%_%d_%CCYY.mp4'),
+          file: path.join(__dirname, 'test-replay-100%_%d_%CCYY.mp4') }
+    ];
+    const cleanUp = () => saves.concat(literal.map(save => save.file))
+        .forEach(file => fs.existsSync(file) && fs.unlinkSync(file));
+    cleanUp();
+
+    try {
+        console.log('\n1️⃣ Initializing OBS...');
+        if (!obs.init()) {
+            throw new Error('Failed to initialize OBS');
+        }
+        const displays = obs.listDisplays();
+
+        console.log('\n2️⃣ Starting a 5 second / 64 MB replay buffer...');
+        const started = obs.startReplayBuffer({
+            width: 1280,
+            height: 720,
+            fps: 30,
+            displayId: displays[0] ? displays[0].id : '',
+            capture_audio: false,
+            maxSeconds: 5,
+            maxSizeMb: 64
+        });
+        if (!started) {
+            throw new Error('Failed to start replay buffer');
+        }
+
+        // Run past the time limit so the buffer has to trim, and sample RSS
+        const rss = [];
+        for (let i = 0; i < 10; i++) {
+            await new Promise(resolve => setTimeout(resolve, 1000));
+            rss.push(process.memoryUsage().rss);
+        }
+        const growthMb = (rss[rss.length - 1] - rss[4]) / (1024 * 1024);
+        console.log(`   📈 RSS growth after the buffer filled: ${growthMb.toFixed(1)} MB`);
+
+        console.log('\n3️⃣ Saving twice without stopping capture...');
+        for (const file of saves) {
+            if (!obs.saveReplay(file)) {
+                throw new Error('saveReplay failed');
+            }
+            if (!(await waitForFile(file, 10000))) {
+                throw new Error(`Replay was not written: ${file}`);
+            }
+            console.log(`   📁 ${path.basename(file)}: ${fs.statSync(file).size} bytes`);
+            await new Promise(resolve => setTimeout(resolve, 1000));
+        }
+
+        console.log('\n4️⃣ Saving to a relative path and to a name containing %...');
+        for (const save of literal) {
+            if (!obs.saveReplay(save.request)) {
+                throw new Error(`saveReplay failed for ${save.request}`);
+            }
+            if (!(await waitForFile(save.file, 10000))) {
+                throw new Error(`Replay was not written to the requested path: ${save.file}`);
+            }
+            console.log(`   📁 ${save.request}: ${fs.statSync(save.file).size} bytes`);
+            await new Promise(resolve => setTimeout(resolve, 1000));
+        }
+
+        console.log('\n✅ Replay buffer test completed successfully!');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        obs.stopReplayBuffer();
+        obs.shutdown();
+        cleanUp();
+        console.log('🔄 OBS shutdown complete');
+    }
+}
+
+runTests();
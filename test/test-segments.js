@@ -0,0 +1,105 @@
+const obs = require('..');
+const path = require('path');
+const fs = require('fs');
+const { execFileSync } = require('child_process');
+
+console.log('✂️ Testing segmented recording');
+
+// Duration in seconds via ffprobe, or null when ffprobe is not installed
+function probeDuration(file) {
+    try {
+        const output = execFileSync('ffprobe', [
+            '-v', 'error', '-show_entries', 'format=duration', '-of', 'csv=p=0', file
+        ]);
+        return parseFloat(output.toString());
+    } catch (error) {
+        return null;
+    }
+}
+
+async function runTests() {
+    const directory = path.join(__dirname, 'test-segments');
+    fs.rmSync(directory, { recursive: true, force: true });
+
+    const segments = [];
+    let finished;
+    const done = new Promise(resolve => { finished = resolve; });
+
+    try {
+        console.log('\n1️⃣ Initializing OBS...');
+        if (!obs.init()) {
+            throw new Error('Failed to initialize OBS');
+        }
+        const displays = obs.listDisplays();
+
+        obs.onSegment(segment => {
+            console.log(`   📁 segment ${segment.index}${segment.last ? ' (last)' : ''}: ${path.basename(segment.path)}`);
+            segments.push(segment);
+            if (segment.last) {
+                finished();
+            }
+        });
+
+        console.log('\n2️⃣ Recording 9 seconds in 2 second segments...');
+        const started = obs.startRecording(directory, {
+            width: 1280,
+            height: 720,
+            fps: 30,
+            keyintSec: 1,
+            displayId: displays[0] ? displays[0].id : '',
+            segmentSeconds: 2,
+            segmentTemplate: 'segment-%CCYY%MM%DD-%hh%mm%ss.mkv'
+        });
+        if (!started) {
+            throw new Error('Failed to start segmented recording');
+        }
+        const recordStart = Date.now();
+        await new Promise(resolve => setTimeout(resolve, 9000));
+        obs.stopRecording();
+        const recordedSeconds = (Date.now() - recordStart) / 1000;
+
+        await Promise.race([done, new Promise(resolve => setTimeout(resolve, 5000))]);
+
+        console.log('\n3️⃣ Checking segments...');
+        if (segments.length < 4) {
+            throw new Error(`Expected at least 4 segments, got ${segments.length}`);
+        }
+        segments.forEach((segment, i) => {
+            if (segment.index !== i) {
+                throw new Error(`Segment ${i} reported index ${segment.index}`);
+            }
+            if (!fs.existsSync(segment.path) || fs.statSync(segment.path).size === 0) {
+                throw new Error(`Segment file missing or empty: ${segment.path}`);
+            }
+        });
+        if (!segments[segments.length - 1].last) {
+            throw new Error('No final segment event after stop');
+        }
+
+        const durations = segments.map(segment => probeDuration(segment.path));
+        if (durations.every(duration => duration !== null)) {
+            const total = durations.reduce((a, b) => a + b, 0);
+            console.log(`   Segment durations: ${durations.map(d => d.toFixed(2)).join(', ')} s`);
+            console.log(`   Total ${total.toFixed(2)} s for ${recordedSeconds.toFixed(2)} s recorded`);
+            // Gapless: the segments add up to the recording, give or take a frame
+            // at either end and the encoder start-up delay
+            if (Math.abs(total - recordedSeconds) > 0.5) {
+                throw new Error('Segment durations do not add up to the recording length');
+            }
+        } else {
+            console.log('   ffprobe not found, skipping duration check');
+        }
+
+        console.log('\n✅ Segmented recording test passed');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        obs.onSegment(null);
+        obs.shutdown();
+        fs.rmSync(directory, { recursive: true, force: true });
+        console.log('🔄 OBS shutdown complete');
+    }
+}
+
+runTests();
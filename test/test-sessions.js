@@ -0,0 +1,97 @@
+const obs = require('..');
+const os = require('os');
+const path = require('path');
+const fs = require('fs');
+
+console.log('🎬 Testing concurrent capture sessions');
+
+function sleep(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+async function runTests() {
+    const directory = path.join(__dirname, 'test-sessions');
+    fs.rmSync(directory, { recursive: true, force: true });
+    fs.mkdirSync(directory);
+    const sessions = [];
+
+    try {
+        console.log('\n1️⃣ Initializing OBS...');
+        if (!obs.init({ modules: 'required', captureAudio: false })) {
+            throw new Error('Failed to initialize OBS');
+        }
+        const displays = obs.listDisplays();
+        const displayId = displays[0] ? displays[0].id : '';
+        const cores = os.cpus().length;
+        obs.setEncoderThreadBudget(cores);
+
+        console.log('\n2️⃣ Creating three sessions...');
+        const configs = [
+            { width: 1280, height: 720, fps: 30 },
+            { width: 960, height: 540, fps: 15 },
+            { width: 640, height: 360, fps: 30, preset: 'auto' }
+        ];
+        configs.forEach((config, i) => {
+            const session = obs.createSession({ ...config, displayId, capture_audio: false });
+            if (!session) {
+                throw new Error(`Failed to create session ${i}`);
+            }
+            sessions.push(session);
+        });
+
+        console.log('\n3️⃣ Recording all sessions for 4 seconds...');
+        sessions.forEach((session, i) => {
+            if (!session.start(path.join(directory, `session-${i}.mkv`))) {
+                throw new Error(`Failed to start session ${session.id}`);
+            }
+        });
+        if (sessions[0].start(path.join(directory, 'again.mkv'))) {
+            throw new Error('A running session started twice');
+        }
+        await sleep(4000);
+
+        let threads = 0;
+        sessions.forEach((session, i) => {
+            const stats = session.getStats();
+            threads += stats.encoderThreads;
+            console.log(`   session ${session.id}: ${stats.frames.output} frames ` +
+                        `(${stats.frames.skipped} skipped), ${stats.bytesWritten} bytes, ` +
+                        `${stats.encoderThreads} threads, preset ${stats.preset}`);
+            if (!stats.active || stats.frames.output === 0) {
+                throw new Error(`Session ${session.id} produced no frames`);
+            }
+            // Each session renders at its own frame rate
+            const expected = configs[i].fps * 4;
+            if (stats.frames.encoderInput < expected * 0.5 || stats.frames.encoderInput > expected * 1.5) {
+                throw new Error(`Session ${session.id} rendered ${stats.frames.encoderInput} frames, expected ~${expected}`);
+            }
+        });
+        if (threads > Math.max(cores, sessions.length)) {
+            throw new Error(`Sessions use ${threads} encoder threads on ${cores} cores`);
+        }
+
+        console.log('\n4️⃣ Stopping and destroying...');
+        sessions.forEach(session => session.stop());
+        await sleep(1000);
+        sessions.forEach((session, i) => {
+            const file = path.join(directory, `session-${i}.mkv`);
+            if (!fs.existsSync(file) || fs.statSync(file).size === 0) {
+                throw new Error(`Session ${session.id} wrote no file`);
+            }
+            session.destroy();
+        });
+        sessions.length = 0;
+
+        console.log('\n✅ Capture sessions test passed');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        sessions.forEach(session => session.destroy());
+        obs.shutdown();
+        fs.rmSync(directory, { recursive: true, force: true });
+        console.log('🔄 OBS shutdown complete');
+    }
+}
+
+runTests();
@@ -0,0 +1,55 @@
+const { execFileSync } = require('child_process');
+
+// Each mode runs in a fresh process so that module loading is really cold
+const mode = process.argv[2];
+
+if (mode) {
+    const obs = require('..');
+    const ok = obs.init({ modules: mode });
+    const timing = obs.getInitTiming();
+    obs.shutdown();
+    process.stdout.write(JSON.stringify({ ok, timing }));
+    return;
+}
+
+console.log('🚀 Testing OBS startup profile');
+
+function runMode(name) {
+    const output = execFileSync(process.execPath, [__filename, name], { stdio: ['ignore', 'pipe', 'ignore'] });
+    return JSON.parse(output.toString());
+}
+
+function printTiming(label, timing) {
+    console.log(`\n   ${label}: ${timing.totalMs.toFixed(1)} ms total`);
+    console.log(`      startup      ${timing.startupMs.toFixed(1)} ms`);
+    for (const module of timing.modules) {
+        console.log(`      ${module.name.padEnd(12)} ${module.ms.toFixed(1)} ms`);
+    }
+    console.log(`      post-load    ${timing.postLoadMs.toFixed(1)} ms`);
+    console.log(`      audio reset  ${timing.audioResetMs.toFixed(1)} ms`);
+    console.log(`      video reset  ${timing.videoResetMs.toFixed(1)} ms`);
+}
+
+try {
+    console.log('\n1️⃣ Loading every module...');
+    const all = runMode('all');
+    if (!all.ok) {
+        throw new Error('init with all modules failed');
+    }
+    printTiming('all modules', all.timing);
+
+    console.log('\n2️⃣ Loading the required allow-list...');
+    const required = runMode('required');
+    if (!required.ok) {
+        throw new Error('init with required modules failed');
+    }
+    printTiming('required modules', required.timing);
+
+    const saved = all.timing.totalMs - required.timing.totalMs;
+    console.log(`\n📊 Allow-list saved ${saved.toFixed(1)} ms ` +
+                `(${(100 * saved / all.timing.totalMs).toFixed(0)}%)`);
+    console.log('\n✅ Startup profile test passed');
+} catch (error) {
+    console.error('\n❌ Test failed:', error.message);
+    process.exitCode = 1;
+}
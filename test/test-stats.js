@@ -0,0 +1,76 @@
+const obs = require('..');
+const path = require('path');
+const fs = require('fs');
+
+console.log('📈 Testing live pipeline statistics');
+
+async function runTests() {
+    const outputPath = path.join(__dirname, 'test-stats.mp4');
+
+    try {
+        console.log('\n1️⃣ Initializing OBS...');
+        if (!obs.init()) {
+            throw new Error('Failed to initialize OBS');
+        }
+        const displays = obs.listDisplays();
+
+        const idle = obs.getStats();
+        if (idle.active) {
+            throw new Error('Stats report an active output before recording');
+        }
+
+        console.log('\n2️⃣ Recording for 3 seconds, polling getStats() at 10 Hz...');
+        if (!obs.startRecording(outputPath, {
+            width: 1280,
+            height: 720,
+            fps: 30,
+            displayId: displays[0] ? displays[0].id : '',
+            capture_audio: false
+        })) {
+            throw new Error('Failed to start recording');
+        }
+
+        const pollCostsUs = [];
+        let stats;
+        for (let i = 0; i < 30; i++) {
+            await new Promise(resolve => setTimeout(resolve, 100));
+            const started = process.hrtime.bigint();
+            stats = obs.getStats();
+            pollCostsUs.push(Number(process.hrtime.bigint() - started) / 1000);
+            if (i % 10 === 9) {
+                console.log(`   frames ${stats.frames.output} out / ${stats.frames.dropped} dropped, ` +
+                            `${stats.bitrateKbps.toFixed(0)} kbps, render p99 ${stats.renderLatencyMs.p99.toFixed(2)} ms`);
+            }
+        }
+        obs.stopRecording();
+
+        console.log('\n3️⃣ Final snapshot:');
+        console.log(JSON.stringify(stats, null, 2));
+
+        if (!stats.active || stats.frames.output === 0) {
+            throw new Error('No frames reached the output');
+        }
+        if (stats.bytesWritten === 0) {
+            throw new Error('No bytes written');
+        }
+        if (stats.renderLatencyMs.count === 0) {
+            throw new Error('Render latency histogram is empty');
+        }
+
+        pollCostsUs.sort((a, b) => a - b);
+        const p99 = pollCostsUs[Math.floor(pollCostsUs.length * 0.99)];
+        console.log(`\n📊 getStats() cost: median ${pollCostsUs[15].toFixed(1)} us, p99 ${p99.toFixed(1)} us`);
+        console.log('\n✅ Stats test passed');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        obs.shutdown();
+        if (fs.existsSync(outputPath)) {
+            fs.unlinkSync(outputPath);
+        }
+        console.log('🔄 OBS shutdown complete');
+    }
+}
+
+runTests();
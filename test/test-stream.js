@@ -0,0 +1,197 @@
+const net = require('net');
+const os = require('os');
+const path = require('path');
+const fs = require('fs');
+const obs = require('..');
+
+console.log('📡 Testing live streams to a Unix socket');
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+// A reader on a Unix socket that collects what the recorder sends; pause()
+// stops reading so the socket fills up
+function listen(socketPath) {
+    fs.rmSync(socketPath, { force: true });
+    const reader = { chunks: [], connection: null, closed: false };
+    reader.server = net.createServer(connection => {
+        reader.connection = connection;
+        connection.on('data', chunk => reader.chunks.push(chunk));
+        connection.on('close', () => { reader.closed = true; });
+    });
+    return new Promise(resolve => reader.server.listen(socketPath, () => resolve(reader)));
+}
+
+function close(reader) {
+    if (reader.connection) {
+        reader.connection.destroy();
+    }
+    return new Promise(resolve => reader.server.close(resolve));
+}
+
+// Top-level ISO BMFF box types, in order
+function boxTypes(data) {
+    const types = [];
+    let offset = 0;
+    while (offset + 8 <= data.length) {
+        const size = data.readUInt32BE(offset);
+        types.push(data.toString('latin1', offset + 4, offset + 8));
+        if (size < 8) {
+            break;
+        }
+        offset += size;
+    }
+    return types;
+}
+
+function printLatency(label, latency) {
+    console.log(`   ${label}: ${latency.count} packets, p50 ${latency.p50.toFixed(1)} ms, ` +
+                `p99 ${latency.p99.toFixed(1)} ms, max ${latency.max.toFixed(1)} ms`);
+}
+
+async function runTests() {
+    const socketPath = path.join(os.tmpdir(), `obs-stream-${process.pid}.sock`);
+    const target = `unix:${socketPath}`;
+    let reader = null;
+
+    try {
+        console.log('\n1️⃣ Initializing...');
+        if (!obs.init({ modules: 'required', captureAudio: false })) {
+            throw new Error('Failed to initialize OBS');
+        }
+        const displays = obs.listDisplays();
+        const config = {
+            width: 1280,
+            height: 720,
+            fps: 30,
+            keyintSec: 1,
+            displayId: displays[0] ? displays[0].id : '',
+            capture_audio: false
+        };
+
+        if (obs.startRecording(target, config)) {
+            throw new Error('Started a stream without a listener');
+        }
+        let rejected = false;
+        try {
+            obs.startRecording(target, { ...config, streamFormat: 'webm' });
+        } catch (error) {
+            rejected = error instanceof TypeError;
+        }
+        if (!rejected) {
+            throw new Error('An unknown streamFormat was accepted');
+        }
+
+        console.log('\n2️⃣ Fragmented MP4, 250 ms fragments...');
+        reader = await listen(socketPath);
+        if (!obs.startRecording(target, { ...config, streamFormat: 'fmp4', fragmentMs: 250 })) {
+            throw new Error('Failed to start the fMP4 stream');
+        }
+        await sleep(3000);
+        const fmp4Stats = obs.getStats();
+        obs.stopRecording();
+        await sleep(500);
+        const fmp4 = Buffer.concat(reader.chunks);
+        const boxes = boxTypes(fmp4);
+        const fragments = boxes.filter(type => type === 'moof').length;
+        console.log(`   ${fmp4.length} bytes, boxes ${boxes.slice(0, 4).join(' ')} ..., ${fragments} fragments`);
+        if (boxes[0] !== 'ftyp' || boxes[1] !== 'moov') {
+            throw new Error('The stream does not start with ftyp+moov');
+        }
+        if (fragments < 4) {
+            throw new Error(`Expected a fragment at least every 250 ms, got ${fragments} in 3 s`);
+        }
+        printLatency('capture to socket', fmp4Stats.streamLatencyMs);
+        if (fmp4Stats.streamLatencyMs.count === 0) {
+            throw new Error('No stream latency samples');
+        }
+        await close(reader);
+
+        console.log('\n3️⃣ MPEG-TS...');
+        reader = await listen(socketPath);
+        if (!obs.startRecording(target, { ...config, streamFormat: 'mpegts', fragmentMs: 100 })) {
+            throw new Error('Failed to start the MPEG-TS stream');
+        }
+        await sleep(2000);
+        printLatency('capture to socket', obs.getStats().streamLatencyMs);
+        obs.stopRecording();
+        await sleep(500);
+        const ts = Buffer.concat(reader.chunks);
+        console.log(`   ${ts.length} bytes`);
+        if (ts.length < 188 * 10 || ts.length % 188 !== 0) {
+            throw new Error('MPEG-TS output is not a whole number of packets');
+        }
+        for (let offset = 0; offset < ts.length; offset += 188) {
+            if (ts[offset] !== 0x47) {
+                throw new Error(`Lost MPEG-TS sync at byte ${offset}`);
+            }
+        }
+        await close(reader);
+
+        console.log('\n4️⃣ A reader that stops reading...');
+        reader = await listen(socketPath);
+        if (!obs.startRecording(target, { ...config, video_bitrate: 8000 })) {
+            throw new Error('Failed to start the stream');
+        }
+        await sleep(500);
+        reader.connection.pause();
+        await sleep(5000);
+        const stalled = obs.getStats();
+        console.log(`   ${stalled.frames.output} packets written, ${stalled.frames.dropped} dropped, ` +
+                    `${stalled.frames.skipped} frames skipped by the encoder`);
+        if (!obs.isRecording()) {
+            throw new Error('A slow reader stopped the recording');
+        }
+        if (stalled.frames.dropped === 0) {
+            throw new Error('A stalled reader caused no drops; is the writer queue bounded?');
+        }
+        const stopStart = Date.now();
+        obs.stopRecording();
+        const stopMs = Date.now() - stopStart;
+        console.log(`   stopRecording() took ${stopMs} ms with the reader stalled`);
+        if (stopMs > 3000) {
+            throw new Error('A stalled reader held up stopRecording()');
+        }
+        await close(reader);
+
+        if (obs.getStats().backend === 'obs') {
+            console.log('\n5️⃣ Stream output next to a file output...');
+            reader = await listen(socketPath);
+            const file = path.join(os.tmpdir(), `obs-stream-${process.pid}.mkv`);
+            if (!obs.prepare(config) ||
+                !obs.addOutput('live', { type: 'stream', path: target, streamFormat: 'mpegts' }) ||
+                !obs.addOutput('file', { type: 'file', path: file })) {
+                throw new Error('Failed to add outputs');
+            }
+            obs.startOutput('live');
+            obs.startOutput('file');
+            await sleep(2000);
+            const live = obs.listOutputs().find(output => output.name === 'live');
+            console.log(`   live: ${live.frames} frames, ${live.bytesWritten} bytes`);
+            printLatency('capture to socket', live.latencyMs);
+            if (live.type !== 'stream' || live.bytesWritten === 0 || live.latencyMs.count === 0) {
+                throw new Error('The stream output wrote nothing');
+            }
+            obs.removeOutput('live');
+            obs.removeOutput('file');
+            obs.unprepare();
+            fs.rmSync(file, { force: true });
+        }
+
+        console.log('\n✅ Live stream test passed');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        if (obs.isRecording()) {
+            obs.stopRecording();
+        }
+        if (reader) {
+            await close(reader);
+        }
+        obs.shutdown();
+        fs.rmSync(socketPath, { force: true });
+        console.log('🔄 OBS shutdown complete');
+    }
+}
+
+runTests();
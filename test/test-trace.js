@@ -0,0 +1,79 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const obs = require('..');
+
+console.log('🧭 Testing tracing and log sink');
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+async function runTests() {
+    const tracePath = path.join(os.tmpdir(), `obs-trace-${process.pid}.json`);
+    const logPath = path.join(os.tmpdir(), `obs-log-${process.pid}.log`);
+    const outputPath = path.join(os.tmpdir(), `obs-trace-${process.pid}.mp4`);
+    const entries = [];
+
+    try {
+        console.log('\n1️⃣ Routing logs to JS and a file...');
+        obs.setLogOptions({ level: 'debug', console: false, file: logPath });
+        obs.onLog(batch => entries.push(...batch));
+
+        console.log('\n2️⃣ Tracing init and a short recording...');
+        obs.startTrace({ frames: true });
+        if (!obs.init()) {
+            throw new Error('Failed to initialize OBS');
+        }
+        const displays = obs.listDisplays();
+        if (displays.length > 0 && obs.startRecording(outputPath, { displayId: displays[0].id, fps: 30 })) {
+            await sleep(2000);
+            obs.stopRecording();
+        }
+        obs.stopTrace();
+
+        const written = obs.writeTrace(tracePath);
+        if (!written) {
+            throw new Error('writeTrace failed');
+        }
+        const trace = JSON.parse(fs.readFileSync(tracePath, 'utf8'));
+        const spans = trace.traceEvents.filter(event => event.ph === 'X');
+        const names = new Set(spans.map(event => event.name));
+        console.log(`   📊 ${written.events} spans on ${written.threads} threads, ${written.dropped} dropped`);
+        if (spans.length !== written.events) {
+            throw new Error('Span count does not match the file');
+        }
+        for (const name of ['initialize', 'obs_startup', 'load_modules', 'reset_video']) {
+            if (!names.has(name)) {
+                throw new Error(`Missing ${name} span`);
+            }
+        }
+
+        console.log('\n3️⃣ Checking delivered log messages...');
+        await sleep(200);
+        const fromObs = entries.filter(entry => entry.source === 'obs').length;
+        console.log(`   📝 ${entries.length} messages (${fromObs} from libobs), ${obs.getLogStats().dropped} dropped`);
+        if (!entries.some(entry => entry.source === 'addon' && entry.message.includes('Initializing OBS core'))) {
+            throw new Error('Addon messages not delivered');
+        }
+        if (fromObs === 0) {
+            throw new Error('libobs messages not captured');
+        }
+        if (!fs.readFileSync(logPath, 'utf8').includes(' info addon Initializing OBS core')) {
+            throw new Error('Log file not written');
+        }
+
+        console.log('\n✅ Trace test completed successfully!');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        obs.onLog(null);
+        obs.setLogOptions({ console: true, file: null });
+        obs.shutdown();
+        console.log('🔄 OBS shutdown complete');
+        for (const file of [tracePath, logPath, outputPath]) {
+            fs.rmSync(file, { force: true });
+        }
+    }
+}
+
+runTests();
@@ -0,0 +1,103 @@
+const obs = require('..');
+const path = require('path');
+const fs = require('fs');
+const { execFileSync } = require('child_process');
+
+// Records a static desktop at a constant and at a variable frame rate and
+// compares process CPU and file size. Run on an idle display, e.g.
+//   xvfb-run -s "-screen 0 1920x1080x24" npm run test:vfr
+console.log('🐢 Testing variable frame rate on a static desktop');
+
+const SECONDS = 8;
+
+function sleep(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+// Duration in seconds via ffprobe, or null when ffprobe is not installed
+function probeDuration(file) {
+    try {
+        const output = execFileSync('ffprobe', [
+            '-v', 'error', '-show_entries', 'format=duration', '-of', 'csv=p=0', file
+        ]);
+        return parseFloat(output.toString());
+    } catch (error) {
+        return null;
+    }
+}
+
+async function record(file, options) {
+    if (!obs.startRecording(file, options)) {
+        throw new Error('Failed to start recording');
+    }
+    const cpuBefore = process.cpuUsage();
+    await sleep(SECONDS * 1000);
+    const cpu = process.cpuUsage(cpuBefore);
+    const stats = obs.getStats();
+    obs.stopRecording();
+    await sleep(1000);
+    return {
+        cpuSeconds: (cpu.user + cpu.system) / 1e6,
+        bytes: fs.statSync(file).size,
+        encoder: stats.encoder,
+        duration: probeDuration(file)
+    };
+}
+
+async function runTests() {
+    const cfrPath = path.join(__dirname, 'test-cfr.mkv');
+    const vfrPath = path.join(__dirname, 'test-vfr.mkv');
+
+    try {
+        console.log('\n1️⃣ Initializing OBS...');
+        if (!obs.init({ modules: 'required', captureAudio: false })) {
+            throw new Error('Failed to initialize OBS');
+        }
+        const displays = obs.listDisplays();
+        const base = {
+            width: 1280,
+            height: 720,
+            fps: 30,
+            displayId: displays[0] ? displays[0].id : '',
+            capture_audio: false,
+            capture_cursor: false
+        };
+
+        console.log(`\n2️⃣ Constant frame rate, ${SECONDS}s...`);
+        const cfr = await record(cfrPath, base);
+        console.log(`   ${cfr.cpuSeconds.toFixed(2)} CPU s, ${cfr.bytes} bytes (${cfr.encoder})`);
+
+        console.log(`\n3️⃣ Variable frame rate, ${SECONDS}s...`);
+        const vfr = await record(vfrPath, { ...base, vfr: { minFps: 1 } });
+        console.log(`   ${vfr.cpuSeconds.toFixed(2)} CPU s, ${vfr.bytes} bytes (${vfr.encoder})`);
+
+        if (vfr.encoder !== 'vfr_x264') {
+            console.log('\n⚠️ Built without libx264: VFR is unavailable, skipping comparison');
+            return;
+        }
+
+        console.log(`\n📊 VFR: ${(100 * vfr.cpuSeconds / cfr.cpuSeconds).toFixed(0)}% of the CPU, ` +
+                    `${(100 * vfr.bytes / cfr.bytes).toFixed(0)}% of the size`);
+        if (vfr.bytes > cfr.bytes * 0.5) {
+            throw new Error('VFR file is not substantially smaller on a static desktop');
+        }
+        if (vfr.cpuSeconds > cfr.cpuSeconds * 0.8) {
+            throw new Error('VFR did not reduce CPU on a static desktop');
+        }
+        // Skipped frames must not shorten the recording
+        if (vfr.duration !== null && Math.abs(vfr.duration - cfr.duration) > 1.5) {
+            throw new Error(`VFR duration ${vfr.duration}s differs from CFR ${cfr.duration}s`);
+        }
+
+        console.log('\n✅ Variable frame rate test passed');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        obs.shutdown();
+        [cfrPath, vfrPath].forEach(file => fs.existsSync(file) && fs.unlinkSync(file));
+        console.log('🔄 OBS shutdown complete');
+    }
+}
+
+runTests();
@@ -0,0 +1,104 @@
+const obs = require('..');
+const path = require('path');
+const fs = require('fs');
+
+console.log('🔥 Testing cold vs warm recording start');
+
+const RUNS = 5;
+
+function sleep(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+// Starts and stops a short recording, returning the addon's start timing
+async function recordOnce(outputPath, config) {
+    if (fs.existsSync(outputPath)) {
+        fs.unlinkSync(outputPath);
+    }
+    const started = config ? obs.startRecording(outputPath, config) : obs.startRecording(outputPath);
+    if (!started) {
+        throw new Error('Failed to start recording');
+    }
+    const timing = obs.getStartTiming();
+    await sleep(500);
+    obs.stopRecording();
+    // Give ffmpeg-mux time to finalize the file
+    await sleep(500);
+    return timing;
+}
+
+function median(values) {
+    const sorted = [...values].sort((a, b) => a - b);
+    return sorted[Math.floor(sorted.length / 2)];
+}
+
+async function runTests() {
+    const outputPath = path.join(__dirname, 'test-warm-start.mp4');
+
+    try {
+        console.log('\n1️⃣ Initializing OBS...');
+        if (!obs.init()) {
+            throw new Error('Failed to initialize OBS');
+        }
+        const displays = obs.listDisplays();
+        const config = {
+            width: 1280,
+            height: 720,
+            fps: 30,
+            displayId: displays[0] ? displays[0].id : '',
+            capture_audio: false
+        };
+
+        console.log(`\n2️⃣ ${RUNS} cold starts (pipeline rebuilt every time)...`);
+        const cold = [];
+        for (let i = 0; i < RUNS; i++) {
+            const timing = await recordOnce(outputPath, config);
+            if (timing.warm) {
+                throw new Error('Unprepared start reused a pipeline');
+            }
+            cold.push(timing.totalMs);
+        }
+
+        console.log(`\n3️⃣ prepare() then ${RUNS} warm starts...`);
+        if (!obs.prepare(config)) {
+            throw new Error('prepare() failed');
+        }
+        const warm = [];
+        for (let i = 0; i < RUNS; i++) {
+            const timing = await recordOnce(outputPath);
+            if (!timing.warm) {
+                throw new Error('Prepared start rebuilt the pipeline');
+            }
+            warm.push(timing.totalMs);
+        }
+
+        console.log('\n4️⃣ A different config invalidates the prepared pipeline...');
+        const changed = await recordOnce(outputPath, { ...config, fps: 60 });
+        console.log(`   warm=${changed.warm}, ${changed.totalMs.toFixed(2)} ms`);
+        if (changed.warm) {
+            throw new Error('Changed config reused the old pipeline');
+        }
+        obs.unprepare();
+
+        const coldMs = median(cold);
+        const warmMs = median(warm);
+        console.log(`\n📊 Median start latency: cold ${coldMs.toFixed(2)} ms, warm ${warmMs.toFixed(2)} ms`);
+        console.log(`   One frame at ${config.fps} fps is ${(1000 / config.fps).toFixed(2)} ms`);
+
+        if (warmMs >= coldMs) {
+            throw new Error('Warm start was not faster than cold start');
+        }
+        console.log('\n✅ Warm start test passed');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        obs.shutdown();
+        if (fs.existsSync(outputPath)) {
+            fs.unlinkSync(outputPath);
+        }
+        console.log('🔄 OBS shutdown complete');
+    }
+}
+
+runTests();
@@ -0,0 +1,153 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { Worker, isMainThread, parentPort, workerData } = require('worker_threads');
+const { monitorEventLoopDelay } = require('perf_hooks');
+const obs = require('..');
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+// Each worker hammers the shared core for `duration` ms: enumeration (sync,
+// async and packed), screenshots, frame taps, listeners, its own hold on
+// the core, and start/stop racing the other workers for the one recording.
+async function runWorker({ index, duration, outputPath }) {
+    const counts = { enumerations: 0, screenshots: 0, taps: 0, frames: 0, starts: 0, stops: 0 };
+
+    if (!obs.init()) {
+        throw new Error(`worker ${index}: init failed`);
+    }
+    obs.onTopologyChange(() => {});
+    obs.outputEvents.on('stop', () => {});
+
+    const deadline = Date.now() + duration;
+    let canScreenshot = process.platform === 'linux';
+    while (Date.now() < deadline) {
+        const displays = obs.listDisplays();
+        obs.listWindows();
+        obs.listWindowsPacked();
+        await Promise.all([obs.listDisplaysAsync(), obs.listWindowsPackedAsync()]);
+        counts.enumerations += 5;
+
+        if (canScreenshot && displays.length > 0) {
+            try {
+                obs.captureFrame({ displayId: displays[0].id, width: 160, format: 'bgra' });
+                counts.screenshots++;
+            } catch (error) {
+                canScreenshot = false;
+            }
+        }
+
+        const tap = obs.onFrame(() => counts.frames++, { width: 320, height: 180, format: 'i420' });
+        counts.taps++;
+
+        const config = { displayId: displays[0] ? displays[0].id : '', fps: 30, capture_audio: false };
+        if (index % 2 === 0) {
+            if (obs.startRecording(outputPath, config)) {
+                counts.starts++;
+            }
+            await sleep(20);
+            obs.stopRecording();
+            counts.stops++;
+        } else {
+            if (await obs.startRecordingAsync(outputPath, config)) {
+                counts.starts++;
+            }
+            await sleep(20);
+            await obs.stopRecordingAsync();
+            counts.stops++;
+        }
+
+        obs.offFrame(tap);
+    }
+
+    // Leaves a tap and listeners behind on purpose: the environment's
+    // cleanup hooks must release them when the worker exits
+    obs.onFrame(() => {});
+    // Drops this worker's hold; the main thread still holds the core
+    obs.shutdown();
+    return counts;
+}
+
+async function runTests() {
+    console.log('🧵 Testing the addon from many worker_threads');
+
+    const workers = Number(process.env.OBS_TEST_WORKERS || Math.max(4, os.cpus().length));
+    const duration = Number(process.env.OBS_TEST_DURATION_MS || 5000);
+    const outputs = [];
+    const lag = monitorEventLoopDelay({ resolution: 10 });
+
+    try {
+        console.log('\n1️⃣ Initializing OBS on the main thread...');
+        if (!obs.init()) {
+            throw new Error('Failed to initialize OBS');
+        }
+
+        console.log(`\n2️⃣ Running ${workers} workers for ${duration} ms...`);
+        lag.enable();
+        const runs = [];
+        for (let i = 0; i < workers; ++i) {
+            const outputPath = path.join(os.tmpdir(), `obs-worker-${process.pid}-${i}.mp4`);
+            outputs.push(outputPath);
+            const worker = new Worker(__filename, { workerData: { index: i, duration, outputPath } });
+            runs.push(new Promise((resolve, reject) => {
+                worker.once('message', resolve);
+                worker.once('error', reject);
+                worker.once('exit', code => code !== 0 && reject(new Error(`worker ${i} exited with ${code}`)));
+            }));
+        }
+
+        // Workers terminated mid-call must not take the core or other workers down
+        const doomed = [];
+        for (let i = 0; i < 4; ++i) {
+            doomed.push(new Worker(__filename, {
+                workerData: { index: workers + i, duration: 60000, outputPath: path.join(os.tmpdir(), `obs-worker-${process.pid}-doomed.mp4`) }
+            }));
+        }
+        outputs.push(path.join(os.tmpdir(), `obs-worker-${process.pid}-doomed.mp4`));
+        await sleep(Math.min(duration / 2, 1000));
+        await Promise.all(doomed.map(worker => worker.terminate()));
+
+        const results = await Promise.all(runs);
+        lag.disable();
+
+        const total = results.reduce((sum, counts) => {
+            for (const key of Object.keys(counts)) {
+                sum[key] = (sum[key] || 0) + counts[key];
+            }
+            return sum;
+        }, {});
+        console.log(`   📊 ${total.enumerations} enumerations, ${total.screenshots} screenshots, ` +
+                    `${total.taps} frame taps (${total.frames} frames), ${total.starts}/${total.stops} starts/stops`);
+        console.log(`   ⏱️ main thread max event-loop lag ${(lag.max / 1e6).toFixed(1)} ms`);
+        if (total.starts === 0) {
+            throw new Error('No worker managed to start a recording');
+        }
+
+        console.log('\n3️⃣ Core still usable from the main thread...');
+        if (obs.isRecording()) {
+            throw new Error('A recording is still running after every worker stopped');
+        }
+        // Throws if a worker's shutdown took the core down under us
+        obs.offFrame(obs.onFrame(() => {}));
+        if (obs.listDisplays().length === 0 && process.platform === 'linux') {
+            console.log('   ℹ️ No displays reported');
+        }
+
+        console.log('\n✅ Workers test completed successfully!');
+    } catch (error) {
+        console.error('\n❌ Test failed:', error.message);
+        process.exitCode = 1;
+    } finally {
+        obs.shutdown();
+        console.log('🔄 OBS shutdown complete');
+        for (const file of outputs) {
+            fs.rmSync(file, { force: true });
+        }
+    }
+}
+
+if (isMainThread) {
+    runTests();
+} else {
+    runWorker(workerData).then(counts => parentPort.postMessage(counts));
+}